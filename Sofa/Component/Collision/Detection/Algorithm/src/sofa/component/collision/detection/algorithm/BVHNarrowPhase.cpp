@@ -45,6 +45,41 @@ bool BVHNarrowPhase::isSelfCollision(core::CollisionModel* cm1, core::CollisionM
 }
 
 void BVHNarrowPhase::addCollisionPair(const std::pair<core::CollisionModel*, core::CollisionModel*>& cmPair)
+{
+    const auto [finestCollisionModel1, finestCollisionModel2] = getFinestCollisionModels(cmPair);
+    if (finestCollisionModel1 == nullptr)
+        return;
+
+    // NOTE: outputs is a reference to a pointer! The original pointer resides in a map in NarrowPhaseDetection and will be modified in beginIntersect
+    addCollisionPair(cmPair, this->getDetectionOutputs(finestCollisionModel1, finestCollisionModel2));
+}
+
+std::pair<core::CollisionModel*, core::CollisionModel*> BVHNarrowPhase::getFinestCollisionModels(
+        const std::pair<core::CollisionModel*, core::CollisionModel*>& cmPair) const
+{
+    core::CollisionModel *cm1 = cmPair.first;
+    core::CollisionModel *cm2 = cmPair.second;
+
+    if (!cm1->isSimulated() && !cm2->isSimulated())
+        return {nullptr, nullptr};
+
+    if (cm1->empty() || cm2->empty())
+        return {nullptr, nullptr};
+
+    core::CollisionModel *finestCollisionModel1 = cm1->getLast();
+    core::CollisionModel *finestCollisionModel2 = cm2->getLast();
+
+    bool swapModels = false;
+    if (intersectionMethod->findIntersector(finestCollisionModel1, finestCollisionModel2, swapModels) == nullptr)
+        return {nullptr, nullptr};
+    if (swapModels)
+        std::swap(finestCollisionModel1, finestCollisionModel2);
+
+    return {finestCollisionModel1, finestCollisionModel2};
+}
+
+void BVHNarrowPhase::addCollisionPair(const std::pair<core::CollisionModel*, core::CollisionModel*>& cmPair,
+                                      sofa::core::collision::DetectionOutputVector*& outputs)
 {
     core::CollisionModel *cm1 = cmPair.first; //->getNext();
     core::CollisionModel *cm2 = cmPair.second; //->getNext();
@@ -70,9 +105,6 @@ void BVHNarrowPhase::addCollisionPair(const std::pair<core::CollisionModel*, cor
         std::swap(finestCollisionModel1, finestCollisionModel2);
     }
 
-    // NOTE: outputs is a reference to a pointer! The original pointer resides in a map in NarrowPhaseDetection and will be modified in beginIntersect
-    sofa::core::collision::DetectionOutputVector*& outputs = this->getDetectionOutputs(finestCollisionModel1, finestCollisionModel2);
-
     finestIntersector->beginIntersect(finestCollisionModel1, finestCollisionModel2, outputs);//creates outputs if null
 
     if (finestCollisionModel1 == cm1 || finestCollisionModel2 == cm2)
@@ -315,20 +347,8 @@ void BVHNarrowPhase::finalCollisionPairs(const TestPair& pair,
                                          sofa::core::collision::DetectionOutputVector*& outputs,
                                          const sofa::core::collision::Intersection* currentIntersection)
 {
-    const core::CollisionElementIterator begin1 = pair.first.first;
-    const core::CollisionElementIterator end1 = pair.first.second;
-    const core::CollisionElementIterator begin2 = pair.second.first;
-    const core::CollisionElementIterator end2 = pair.second.second;
-
-    for (auto it1 = begin1; it1 != end1; ++it1)
-    {
-        for (auto it2 = begin2; it2 != end2; ++it2)
-        {
-            // Final collision pair
-            if (!selfCollision || it1.canCollideWith(it2))
-                intersector->intersect(it1, it2, outputs, currentIntersection);
-        }
-    }
+    // Final collision pairs, given at once to the intersector so that it can process them in batch
+    intersector->intersectRanges(pair.first, pair.second, selfCollision, outputs, currentIntersection);
 }
 
 std::pair<core::CollisionModel*, core::CollisionModel*> BVHNarrowPhase::getCollisionModelsFromTestPair(const TestPair& pair)
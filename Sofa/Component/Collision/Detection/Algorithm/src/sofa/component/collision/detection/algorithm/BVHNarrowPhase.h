@@ -81,6 +81,16 @@ protected:
     /// Return true if both collision models belong to the same object, false otherwise
     static bool isSelfCollision(core::CollisionModel* cm1, core::CollisionModel* cm2);
 
+    /// Return the finest collision models of a pair of collision models, in the order expected by their intersector.
+    /// They are the key of the detection outputs of the pair. Both are nullptr if the pair is not examined.
+    std::pair<core::CollisionModel*, core::CollisionModel*> getFinestCollisionModels(
+            const std::pair<core::CollisionModel*, core::CollisionModel*>& cmPair) const;
+
+    /// Same as addCollisionPair, but the contacts are written in the given output vector (allocated if nullptr),
+    /// instead of the one stored in the detection outputs for the finest collision models of the pair
+    void addCollisionPair(const std::pair<core::CollisionModel*, core::CollisionModel*>& cmPair,
+                          sofa::core::collision::DetectionOutputVector*& outputs);
+
     /// Build a list of TestPair's from internal and external children of two CollisionModel's
     static void initializeExternalCells(
             core::CollisionModel *cm1,
@@ -0,0 +1,544 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/collision/detection/algorithm/SpatialHashBroadPhase.h>
+#include <sofa/component/collision/detection/algorithm/BruteForceBroadPhase.h>
+#include <sofa/component/collision/geometry/CubeModel.h>
+
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/collision/Intersection.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sofa::component::collision::detection::algorithm
+{
+
+void registerSpatialHashBroadPhase(sofa::core::ObjectFactory* factory)
+{
+    factory->registerObjects(core::ObjectRegistrationData("Broad phase collision detection using a multi-level uniform spatial hash.")
+        .add< SpatialHashBroadPhase >());
+}
+
+namespace
+{
+/// Cell coordinates are bounded so that the ranges of cells can be iterated without overflow
+constexpr SReal maxCellCoord = static_cast<SReal>(1 << 29);
+
+/// Maximal number of levels in the grid
+constexpr int maxNbLevels = 32;
+
+int toCellCoord(SReal x, SReal cellSize)
+{
+    return static_cast<int>(std::clamp(std::floor(x / cellSize), -maxCellCoord, maxCellCoord));
+}
+}
+
+std::size_t SpatialHashBroadPhase::CellKeyHash::operator()(const CellKey& key) const
+{
+    // Large primes to spread the neighboring cells in the table
+    std::size_t h = static_cast<std::size_t>(key.level) * 2654435761u;
+    h ^= static_cast<std::size_t>(key.coord[0]) * 73856093u;
+    h ^= static_cast<std::size_t>(key.coord[1]) * 19349663u;
+    h ^= static_cast<std::size_t>(key.coord[2]) * 83492791u;
+    return h;
+}
+
+SpatialHashBroadPhase::SpatialHashBroadPhase()
+    : d_cellSize(initData(&d_cellSize, 0_sreal, "cellSize", "Size of the cells of the finest level of the grid. If 0, it is computed from the median size of the bounding boxes of the collision models"))
+    , d_parallelPairGeneration(initData(&d_parallelPairGeneration, false, "parallelPairGeneration", "If true, the potentially colliding pairs of the collision models are searched in parallel using the task scheduler"))
+{
+    this->addUpdateCallback("parallelPairGeneration", {&d_parallelPairGeneration},
+    [this](const core::DataTracker& tracker) -> sofa::core::objectmodel::ComponentState
+    {
+        SOFA_UNUSED(tracker);
+        if (d_parallelPairGeneration.getValue())
+        {
+            simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+            assert(taskScheduler);
+
+            if (taskScheduler->getThreadCount() < 1)
+            {
+                taskScheduler->init(0);
+                msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+            else
+            {
+                msg_info() << "Task scheduler already initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+        }
+        return this->d_componentState.getValue();
+    },
+    {});
+}
+
+void SpatialHashBroadPhase::beginBroadPhase()
+{
+    core::collision::BroadPhaseDetection::beginBroadPhase();
+    m_addedModels.clear();
+    m_unboundedModels.clear();
+    ++m_timeStamp;
+}
+
+void SpatialHashBroadPhase::addCollisionModel(core::CollisionModel *cm)
+{
+    if (cm == nullptr || cm->empty())
+        return;
+    assert(intersectionMethod != nullptr);
+
+    Index modelId;
+    const auto modelIdIt = m_modelIds.find(cm);
+    if (modelIdIt != m_modelIds.end())
+    {
+        modelId = modelIdIt->second;
+    }
+    else
+    {
+        if (m_freeModelIds.empty())
+        {
+            modelId = static_cast<Index>(m_models.size());
+            m_models.emplace_back();
+        }
+        else
+        {
+            modelId = m_freeModelIds.back();
+            m_freeModelIds.pop_back();
+        }
+        m_modelIds.emplace(cm, modelId);
+        m_models[modelId].firstCollisionModel = cm;
+    }
+
+    HashedModel& model = m_models[modelId];
+    if (model.timeStamp == m_timeStamp)
+    {
+        // already added during this time step
+        return;
+    }
+
+    dmsg_info() << "CollisionModel " << cm->getName() << "(" << cm << ") of class " << cm->getClassName()
+                << " is added in broad phase (" << m_addedModels.size() << " collision models)";
+
+    model.lastCollisionModel = cm->getLast();
+    model.order = static_cast<Index>(m_addedModels.size());
+    model.timeStamp = m_timeStamp;
+    model.selfCollision = doesSelfCollide(cm);
+    computeBoundingBox(model, intersectionMethod->getAlarmDistance() * 0.5 + cm->getProximity());
+
+    m_addedModels.push_back(modelId);
+    if (!model.isBounded)
+    {
+        m_unboundedModels.push_back(modelId);
+    }
+}
+
+void SpatialHashBroadPhase::endBroadPhase()
+{
+    core::collision::BroadPhaseDetection::endBroadPhase();
+
+    // Remove the models which have not been added during this time step
+    for (Index modelId = 0; modelId < m_models.size(); ++modelId)
+    {
+        HashedModel& model = m_models[modelId];
+        if (model.firstCollisionModel != nullptr && model.timeStamp != m_timeStamp)
+        {
+            if (model.isInGrid)
+            {
+                removeFromGrid(modelId);
+            }
+            m_modelIds.erase(model.firstCollisionModel);
+            model = HashedModel();
+            m_freeModelIds.push_back(modelId);
+        }
+    }
+
+    if (m_addedModels.empty())
+        return;
+
+    // The grid is rebuilt only if the size of the cells changes significantly
+    const SReal cellSize = d_cellSize.getValue() > 0 ? d_cellSize.getValue() : computeCellSize();
+    const bool isCellSizeFixed = d_cellSize.getValue() > 0;
+    if (m_cellSize <= 0
+        || (isCellSizeFixed && cellSize != m_cellSize)
+        || (!isCellSizeFixed && (cellSize > 2 * m_cellSize || 2 * cellSize < m_cellSize)))
+    {
+        clearGrid();
+        m_cellSize = cellSize;
+    }
+
+    // Move the models whose cells changed
+    for (const Index modelId : m_addedModels)
+    {
+        HashedModel& model = m_models[modelId];
+        if (!model.isBounded)
+        {
+            if (model.isInGrid)
+            {
+                removeFromGrid(modelId);
+            }
+            continue;
+        }
+
+        const int level = computeLevel(model.maxBBox - model.minBBox);
+        CellCoord minCell, maxCell;
+        computeCellRange(model.minBBox, model.maxBBox, level, minCell, maxCell);
+
+        if (model.isInGrid)
+        {
+            if (level == model.level && minCell == model.minCell && maxCell == model.maxCell)
+            {
+                continue;
+            }
+            removeFromGrid(modelId);
+        }
+
+        model.level = level;
+        model.minCell = minCell;
+        model.maxCell = maxCell;
+        insertInGrid(modelId);
+    }
+
+    // Release the cells left empty by the moving models, when they are too many
+    if (m_cells.size() > 2 * m_nbCellEntries + 1024)
+    {
+        for (auto it = m_cells.begin(); it != m_cells.end();)
+        {
+            if (it->second.empty())
+                it = m_cells.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    const simulation::ForEachExecutionPolicy execution = d_parallelPairGeneration.getValue() ?
+        simulation::ForEachExecutionPolicy::PARALLEL :
+        simulation::ForEachExecutionPolicy::SEQUENTIAL;
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+    assert(taskScheduler);
+
+    const Index nbAddedModels = static_cast<Index>(m_addedModels.size());
+    if (m_candidatePairs.size() < nbAddedModels)
+    {
+        m_candidatePairs.resize(nbAddedModels);
+    }
+
+    simulation::forEachRange(execution, *taskScheduler, Index(0), nbAddedModels,
+        [this](const auto& range)
+        {
+            for (auto order = range.start; order != range.end; ++order)
+            {
+                findCandidatePairs(order);
+            }
+        });
+
+    addCandidatePairs();
+}
+
+bool SpatialHashBroadPhase::doesSelfCollide(core::CollisionModel *cm) const
+{
+    if (cm->isSimulated() && cm->getLast()->canCollideWith(cm->getLast()))
+    {
+        // self collision
+        bool swapModels = false;
+        core::collision::ElementIntersector* intersector = intersectionMethod->findIntersector(cm, cm, swapModels);
+        if (intersector != nullptr)
+        {
+            return intersector->canIntersect(cm->begin(), cm->begin(), intersectionMethod);
+        }
+    }
+
+    return false;
+}
+
+void SpatialHashBroadPhase::computeBoundingBox(HashedModel& model, SReal margin) const
+{
+    model.isBounded = false;
+
+    auto* cubeModel = dynamic_cast<collision::geometry::CubeCollisionModel*>(model.firstCollisionModel);
+    if (cubeModel == nullptr)
+        return;
+
+    // Here we assume a single root element is present in the model
+    const collision::geometry::Cube root(cubeModel, 0);
+    const type::Vec3 marginVec(margin, margin, margin);
+    model.minBBox = root.minVect() - marginVec;
+    model.maxBBox = root.maxVect() + marginVec;
+
+    model.isBounded = true;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        model.isBounded &= std::isfinite(model.minBBox[i]) && std::isfinite(model.maxBBox[i])
+                           && model.minBBox[i] <= model.maxBBox[i];
+    }
+}
+
+SReal SpatialHashBroadPhase::computeCellSize()
+{
+    m_sizes.clear();
+    for (const Index modelId : m_addedModels)
+    {
+        const HashedModel& model = m_models[modelId];
+        if (model.isBounded)
+        {
+            const type::Vec3 size = model.maxBBox - model.minBBox;
+            m_sizes.push_back(std::max({size[0], size[1], size[2]}));
+        }
+    }
+
+    if (m_sizes.empty())
+    {
+        return m_cellSize > 0 ? m_cellSize : 1_sreal;
+    }
+
+    // The median size is robust to a few large models, such as the floor of the scene
+    const auto median = m_sizes.begin() + m_sizes.size() / 2;
+    std::nth_element(m_sizes.begin(), median, m_sizes.end());
+    if (*median > 0)
+    {
+        return *median;
+    }
+
+    const SReal maxSize = *std::max_element(m_sizes.begin(), m_sizes.end());
+    return maxSize > 0 ? maxSize : 1_sreal;
+}
+
+int SpatialHashBroadPhase::computeLevel(const type::Vec3& size) const
+{
+    const SReal maxSize = std::max({size[0], size[1], size[2]});
+    int level = 0;
+    SReal cellSize = m_cellSize;
+    while (cellSize < maxSize && level < maxNbLevels - 1)
+    {
+        cellSize *= 2;
+        ++level;
+    }
+    return level;
+}
+
+void SpatialHashBroadPhase::computeCellRange(const type::Vec3& minBBox, const type::Vec3& maxBBox, int level,
+                                             CellCoord& minCell, CellCoord& maxCell) const
+{
+    const SReal cellSize = std::ldexp(m_cellSize, level);
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        minCell[i] = toCellCoord(minBBox[i], cellSize);
+        maxCell[i] = toCellCoord(maxBBox[i], cellSize);
+    }
+}
+
+void SpatialHashBroadPhase::insertInGrid(Index modelId)
+{
+    HashedModel& model = m_models[modelId];
+    CellKey key;
+    key.level = model.level;
+    for (key.coord[0] = model.minCell[0]; key.coord[0] <= model.maxCell[0]; ++key.coord[0])
+    {
+        for (key.coord[1] = model.minCell[1]; key.coord[1] <= model.maxCell[1]; ++key.coord[1])
+        {
+            for (key.coord[2] = model.minCell[2]; key.coord[2] <= model.maxCell[2]; ++key.coord[2])
+            {
+                m_cells[key].push_back(modelId);
+                ++m_nbCellEntries;
+            }
+        }
+    }
+
+    if (m_levelSizes.size() <= static_cast<std::size_t>(model.level))
+    {
+        m_levelSizes.resize(model.level + 1, 0);
+    }
+    ++m_levelSizes[model.level];
+    model.isInGrid = true;
+}
+
+void SpatialHashBroadPhase::removeFromGrid(Index modelId)
+{
+    HashedModel& model = m_models[modelId];
+    CellKey key;
+    key.level = model.level;
+    for (key.coord[0] = model.minCell[0]; key.coord[0] <= model.maxCell[0]; ++key.coord[0])
+    {
+        for (key.coord[1] = model.minCell[1]; key.coord[1] <= model.maxCell[1]; ++key.coord[1])
+        {
+            for (key.coord[2] = model.minCell[2]; key.coord[2] <= model.maxCell[2]; ++key.coord[2])
+            {
+                const auto cellIt = m_cells.find(key);
+                if (cellIt == m_cells.end())
+                    continue;
+
+                auto& cell = cellIt->second;
+                const auto it = std::find(cell.begin(), cell.end(), modelId);
+                if (it != cell.end())
+                {
+                    *it = cell.back();
+                    cell.pop_back();
+                    --m_nbCellEntries;
+                }
+            }
+        }
+    }
+
+    --m_levelSizes[model.level];
+    model.isInGrid = false;
+}
+
+void SpatialHashBroadPhase::clearGrid()
+{
+    m_cells.clear();
+    m_levelSizes.clear();
+    m_nbCellEntries = 0;
+    for (auto& model : m_models)
+    {
+        model.isInGrid = false;
+    }
+}
+
+void SpatialHashBroadPhase::findCandidatePairs(Index order)
+{
+    auto& pairs = m_candidatePairs[order];
+    pairs.clear();
+
+    const HashedModel& model = m_models[m_addedModels[order]];
+
+    // The models without bounding box are paired with all the models added before them
+    if (!model.isBounded)
+    {
+        for (Index otherOrder = 0; otherOrder < order; ++otherOrder)
+        {
+            pairs.emplace_back(order, otherOrder);
+        }
+        return;
+    }
+
+    for (const Index otherId : m_unboundedModels)
+    {
+        const Index otherOrder = m_models[otherId].order;
+        if (otherOrder < order)
+        {
+            pairs.emplace_back(order, otherOrder);
+        }
+    }
+
+    // The models of the finer levels are not visited: they find this model from their side
+    for (int level = model.level; level < static_cast<int>(m_levelSizes.size()); ++level)
+    {
+        if (m_levelSizes[level] == 0)
+            continue;
+
+        CellKey key;
+        key.level = level;
+        CellCoord minCell, maxCell;
+        computeCellRange(model.minBBox, model.maxBBox, level, minCell, maxCell);
+
+        for (key.coord[0] = minCell[0]; key.coord[0] <= maxCell[0]; ++key.coord[0])
+        {
+            for (key.coord[1] = minCell[1]; key.coord[1] <= maxCell[1]; ++key.coord[1])
+            {
+                for (key.coord[2] = minCell[2]; key.coord[2] <= maxCell[2]; ++key.coord[2])
+                {
+                    const auto cellIt = m_cells.find(key);
+                    if (cellIt == m_cells.end())
+                        continue;
+
+                    for (const Index otherId : cellIt->second)
+                    {
+                        const HashedModel& other = m_models[otherId];
+
+                        // In the same level, the pair is found from the model added last
+                        if (other.order == order || (other.level == model.level && other.order > order))
+                            continue;
+
+                        if (model.minBBox[0] > other.maxBBox[0] || other.minBBox[0] > model.maxBBox[0]
+                            || model.minBBox[1] > other.maxBBox[1] || other.minBBox[1] > model.maxBBox[1]
+                            || model.minBBox[2] > other.maxBBox[2] || other.minBBox[2] > model.maxBBox[2])
+                            continue;
+
+                        pairs.emplace_back(std::max(order, other.order), std::min(order, other.order));
+                    }
+                }
+            }
+        }
+    }
+
+    // A pair of models sharing several cells is found several times
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+void SpatialHashBroadPhase::addCandidatePairs()
+{
+    const Index nbAddedModels = static_cast<Index>(m_addedModels.size());
+
+    m_sortedCandidatePairs.clear();
+    for (Index order = 0; order < nbAddedModels; ++order)
+    {
+        m_sortedCandidatePairs.insert(m_sortedCandidatePairs.end(), m_candidatePairs[order].begin(), m_candidatePairs[order].end());
+    }
+    std::sort(m_sortedCandidatePairs.begin(), m_sortedCandidatePairs.end());
+
+    // Same tests, and same order of the pairs, as in BruteForceBroadPhase
+    auto pairIt = m_sortedCandidatePairs.cbegin();
+    for (Index order = 0; order < nbAddedModels; ++order)
+    {
+        const HashedModel& model = m_models[m_addedModels[order]];
+        core::CollisionModel* cm = model.firstCollisionModel;
+
+        if (model.selfCollision)
+        {
+            // add the collision model to be tested against itself
+            cmPairs.emplace_back(cm, cm);
+        }
+
+        for (; pairIt != m_sortedCandidatePairs.cend() && pairIt->first == order; ++pairIt)
+        {
+            const HashedModel& other = m_models[m_addedModels[pairIt->second]];
+            core::CollisionModel* cm2 = other.firstCollisionModel;
+
+            // ignore this pair if both are NOT simulated (inactive)
+            if (!cm->isSimulated() && !cm2->isSimulated())
+                continue;
+
+            if (!BruteForceBroadPhase::keepCollisionBetween(model.lastCollisionModel, other.lastCollisionModel))
+                continue;
+
+            bool swapModels = false;
+            core::collision::ElementIntersector* intersector = intersectionMethod->findIntersector(cm, cm2, swapModels);
+            if (intersector == nullptr)
+                continue;
+
+            core::CollisionModel* cm1 = cm;
+            if (swapModels)
+            {
+                std::swap(cm1, cm2);
+            }
+
+            // Here we assume a single root element is present in both models
+            if (intersector->canIntersect(cm1->begin(), cm2->begin(), intersectionMethod))
+            {
+                //both collision models will be further examined in the narrow phase
+                cmPairs.emplace_back(cm1, cm2);
+            }
+        }
+    }
+}
+
+}
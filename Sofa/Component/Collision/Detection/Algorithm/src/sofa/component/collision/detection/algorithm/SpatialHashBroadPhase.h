@@ -0,0 +1,169 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/component/collision/detection/algorithm/config.h>
+#include <sofa/core/collision/BroadPhaseDetection.h>
+#include <sofa/type/Vec.h>
+
+#include <unordered_map>
+
+namespace sofa::component::collision::detection::algorithm
+{
+
+/**
+ * @brief Broad phase collision detection based on a multi-level uniform spatial hash
+ *
+ * The bounding box of each collision model (the root of its bounding tree) is stored in the cells of a uniform grid.
+ * The grid has several levels: the size of the cells doubles from a level to the next one, and each collision model
+ * is stored in the finest level where its cells are larger than its bounding box, so it overlaps at most 8 cells.
+ * The cells are hashed, so the grid is not bounded. The size of the cells of the finest level is either given, or
+ * computed from the median size of the bounding boxes.
+ *
+ * The grid is kept from a time step to the next one: only the collision models whose cells changed are moved in the
+ * grid, and the collision models which are no longer added to the broad phase are removed from it.
+ * The potentially colliding pairs of a collision model are found by looking at the cells it overlaps in its own level
+ * and in the coarser ones. This search can be done in parallel.
+ *
+ * The resulting pairs, and their order, are the same as with BruteForceBroadPhase. Collision models whose root is not
+ * a CubeCollisionModel are tested against all the other collision models.
+ */
+class SOFA_COMPONENT_COLLISION_DETECTION_ALGORITHM_API SpatialHashBroadPhase : public core::collision::BroadPhaseDetection
+{
+public:
+    SOFA_CLASS(SpatialHashBroadPhase, core::collision::BroadPhaseDetection);
+
+    Data<SReal> d_cellSize; ///< Size of the cells of the finest level of the grid. If 0, it is computed from the median size of the bounding boxes of the collision models
+    Data<bool> d_parallelPairGeneration; ///< If true, the potentially colliding pairs of the collision models are searched in parallel using the task scheduler
+
+    void beginBroadPhase() override;
+
+    /// Register the collision model for this time step. The pairs are computed in endBroadPhase
+    void addCollisionModel(core::CollisionModel *cm) override;
+
+    /// Update the grid and compute the potentially colliding pairs of the collision models added during this time step
+    void endBroadPhase() override;
+
+    /// Bounding tree is not required by this detection algorithm
+    bool needsDeepBoundingTree() const override { return false; }
+
+    /// Size of the cells of the finest level used during the last time step
+    SReal getCurrentCellSize() const { return m_cellSize; }
+
+protected:
+    SpatialHashBroadPhase();
+    ~SpatialHashBroadPhase() override = default;
+
+    using Index = sofa::Index;
+    using CellCoord = sofa::type::Vec<3, int>;
+
+    /// Key of a cell in the hash table
+    struct CellKey
+    {
+        int level { 0 };
+        CellCoord coord;
+
+        bool operator==(const CellKey& other) const { return level == other.level && coord == other.coord; }
+    };
+
+    struct CellKeyHash
+    {
+        std::size_t operator()(const CellKey& key) const;
+    };
+
+    /// A collision model stored in the grid, and its state during the current time step
+    struct HashedModel
+    {
+        /// First collision model in the hierarchy of collision models of an object. Usually a bounding box
+        core::CollisionModel* firstCollisionModel { nullptr };
+        /// Last collision model in the hierarchy of collision models of an object
+        core::CollisionModel* lastCollisionModel { nullptr };
+
+        /// Bounding box, enlarged by the proximity and half of the alarm distance
+        type::Vec3 minBBox;
+        type::Vec3 maxBBox;
+        bool isBounded { false };
+        bool selfCollision { false };
+
+        /// Position of the collision model in the order of addition during the current time step
+        Index order { sofa::InvalidID };
+        /// Time step of the last addition of the collision model
+        std::size_t timeStamp { 0 };
+
+        /// Cells occupied in the grid
+        bool isInGrid { false };
+        int level { 0 };
+        CellCoord minCell;
+        CellCoord maxCell;
+    };
+
+    /// Return true if the provided CollisionModel can collide with itself
+    bool doesSelfCollide(core::CollisionModel *cm) const;
+
+    /// Compute the bounding box of the collision model, from the root of its bounding tree
+    void computeBoundingBox(HashedModel& model, SReal margin) const;
+
+    /// Compute the size of the cells of the finest level from the bounding boxes of the models added this time step
+    SReal computeCellSize();
+
+    /// Level of the grid where a box of the given size is stored
+    int computeLevel(const type::Vec3& size) const;
+
+    /// Range of the cells overlapped by a box, in a given level
+    void computeCellRange(const type::Vec3& minBBox, const type::Vec3& maxBBox, int level, CellCoord& minCell, CellCoord& maxCell) const;
+
+    void insertInGrid(Index modelId);
+    void removeFromGrid(Index modelId);
+    void clearGrid();
+
+    /// Search the pairs of the models added this time step which involve the given model, and are not found from the other model
+    void findCandidatePairs(Index order);
+
+    /// Keep the candidate pairs accepted by the intersection method, in the same order as BruteForceBroadPhase
+    void addCandidatePairs();
+
+    /// All the collision models known by the grid. Removed models leave free slots
+    sofa::type::vector<HashedModel> m_models;
+    sofa::type::vector<Index> m_freeModelIds;
+    std::unordered_map<core::CollisionModel*, Index> m_modelIds;
+
+    /// Identifiers of the models added during the current time step, in the order of addition
+    sofa::type::vector<Index> m_addedModels;
+    /// Identifiers of the added models whose root is not a CubeCollisionModel
+    sofa::type::vector<Index> m_unboundedModels;
+
+    std::unordered_map<CellKey, sofa::type::vector<Index>, CellKeyHash> m_cells;
+    /// Number of models stored in each level of the grid
+    sofa::type::vector<Index> m_levelSizes;
+    /// Number of model references stored in the cells
+    std::size_t m_nbCellEntries { 0 };
+
+    SReal m_cellSize { 0 };
+    std::size_t m_timeStamp { 0 };
+
+    /// Candidate pairs (by order of addition, the greatest first) found from each added model
+    sofa::type::vector<sofa::type::vector<std::pair<Index, Index> > > m_candidatePairs;
+    sofa::type::vector<std::pair<Index, Index> > m_sortedCandidatePairs;
+    sofa::type::vector<SReal> m_sizes;
+};
+
+}
@@ -0,0 +1,290 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/collision/detection/algorithm/SpatialHashBroadPhase.h>
+using sofa::component::collision::detection::algorithm::SpatialHashBroadPhase;
+
+#include <sofa/component/collision/detection/algorithm/BruteForceBroadPhase.h>
+using sofa::component::collision::detection::algorithm::BruteForceBroadPhase;
+
+#include <sofa/component/collision/detection/algorithm/BVHNarrowPhase.h>
+using sofa::component::collision::detection::algorithm::BVHNarrowPhase;
+
+#include <sofa/component/collision/detection/algorithm/DirectSAPNarrowPhase.h>
+using sofa::component::collision::detection::algorithm::DirectSAPNarrowPhase;
+
+#include <sofa/component/collision/detection/algorithm/IncrSAP.h>
+using sofa::component::collision::detection::algorithm::IncrSAP;
+
+#include <sofa/component/collision/geometry/SphereModel.h>
+#include <sofa/core/collision/Intersection.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simpleapi/SimpleApi.h>
+#include <sofa/testing/BaseSimulationTest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace
+{
+
+using sofa::type::Vec3;
+using sofa::core::CollisionModel;
+using sofa::core::collision::BroadPhaseDetection;
+using sofa::core::collision::NarrowPhaseDetection;
+using SphereModel = sofa::component::collision::geometry::SphereCollisionModel<sofa::defaulttype::Vec3Types>;
+using CollisionModelPairs = sofa::type::vector<BroadPhaseDetection::CollisionModelPair>;
+
+void initTaskScheduler()
+{
+    sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::MainTaskSchedulerFactory::createInRegistry();
+    if (taskScheduler->getThreadCount() < 1)
+    {
+        taskScheduler->init(0);
+    }
+}
+
+/**
+ * Many small spheres, and a few large ones, moving fast and clustered along the x axis
+ */
+struct SpatialHashBroadPhase_test : public sofa::testing::BaseSimulationTest
+{
+    sofa::simulation::Node::SPtr root;
+    sofa::core::collision::Intersection* intersection { nullptr };
+    sofa::type::vector<SphereModel*> spheres;
+    sofa::type::vector<Vec3> velocities;
+    std::mt19937 generator { 42 };
+
+    void createScene(unsigned int nbSpheres)
+    {
+        sofa::simpleapi::importPlugin("Sofa.Component.StateContainer");
+        sofa::simpleapi::importPlugin("Sofa.Component.Collision.Geometry");
+        sofa::simpleapi::importPlugin("Sofa.Component.Collision.Detection.Intersection");
+
+        root = sofa::simulation::getSimulation()->createNewGraph("root");
+        const auto intersectionObject = sofa::simpleapi::createObject(root, "MinProximityIntersection",
+            {{"alarmDistance", "0.05"}, {"contactDistance", "0.02"}});
+        intersection = dynamic_cast<sofa::core::collision::Intersection*>(intersectionObject.get());
+        ASSERT_NE(intersection, nullptr);
+
+        const SReal length = nbSpheres * 0.05;
+        std::uniform_real_distribution<SReal> alongX(0, length), across(0, 1), velocity(-0.1, 0.1);
+
+        for (unsigned int i = 0; i < nbSpheres; ++i)
+        {
+            const auto node = sofa::simpleapi::createChild(root, "sphere" + std::to_string(i));
+            const Vec3 position(alongX(generator), across(generator), across(generator));
+            std::stringstream positionStr;
+            positionStr << position;
+            sofa::simpleapi::createObject(node, "MechanicalObject", {{"template", "Vec3"}, {"position", positionStr.str()}});
+
+            // a few tools much larger than the fragments
+            const std::string radius = (i % 100 == 0) ? "2" : (i % 10 == 0) ? "0.3" : "0.1";
+            const auto sphere = sofa::simpleapi::createObject(node, "SphereCollisionModel", {{"radius", radius}});
+            spheres.push_back(dynamic_cast<SphereModel*>(sphere.get()));
+            velocities.emplace_back(velocity(generator), velocity(generator), velocity(generator));
+        }
+
+        sofa::simulation::node::initRoot(root.get());
+    }
+
+    void moveSpheres()
+    {
+        for (std::size_t i = 0; i < spheres.size(); ++i)
+        {
+            auto x = sofa::helper::getWriteAccessor(*spheres[i]->getMechanicalState()->write(sofa::core::VecCoordId::position()));
+            x[0] += velocities[i];
+        }
+    }
+
+    /// Roots of the bounding trees of the spheres, skipping one sphere out of skip if skip is not 0
+    sofa::type::vector<CollisionModel*> computeBoundingTrees(unsigned int skip = 0)
+    {
+        sofa::type::vector<CollisionModel*> roots;
+        for (std::size_t i = 0; i < spheres.size(); ++i)
+        {
+            if (skip != 0 && i % skip == 0)
+                continue;
+            spheres[i]->computeBoundingTree(6);
+            roots.push_back(spheres[i]->getFirst());
+        }
+        return roots;
+    }
+
+    CollisionModelPairs computePairs(BroadPhaseDetection* broadPhase, const sofa::type::vector<CollisionModel*>& roots) const
+    {
+        broadPhase->setIntersectionMethod(intersection);
+        broadPhase->beginBroadPhase();
+        broadPhase->addCollisionModels(roots);
+        broadPhase->endBroadPhase();
+        return broadPhase->getCollisionModelPairs();
+    }
+
+    void detect(BroadPhaseDetection* broadPhase, NarrowPhaseDetection* narrowPhase, const sofa::type::vector<CollisionModel*>& roots) const
+    {
+        const auto& pairs = computePairs(broadPhase, roots);
+        narrowPhase->setIntersectionMethod(intersection);
+        narrowPhase->beginNarrowPhase();
+        narrowPhase->addCollisionPairs(pairs);
+        narrowPhase->endNarrowPhase();
+    }
+
+    void unloadScene()
+    {
+        if (root)
+        {
+            sofa::simulation::node::unload(root);
+            root.reset();
+        }
+        spheres.clear();
+        velocities.clear();
+    }
+
+    void onTearDown() override
+    {
+        unloadScene();
+    }
+};
+
+TEST_F(SpatialHashBroadPhase_test, samePairsAsBruteForce)
+{
+    createScene(1000);
+
+    const auto bruteForce = sofa::core::objectmodel::New<BruteForceBroadPhase>();
+    const auto spatialHash = sofa::core::objectmodel::New<SpatialHashBroadPhase>();
+
+    const auto roots = computeBoundingTrees();
+    const auto expected = computePairs(bruteForce.get(), roots);
+    EXPECT_GT(expected.size(), spheres.size());
+    EXPECT_EQ(computePairs(spatialHash.get(), roots), expected);
+    EXPECT_GT(spatialHash->getCurrentCellSize(), 0);
+}
+
+TEST_F(SpatialHashBroadPhase_test, incrementalUpdate)
+{
+    createScene(1000);
+
+    const auto bruteForce = sofa::core::objectmodel::New<BruteForceBroadPhase>();
+    const auto spatialHash = sofa::core::objectmodel::New<SpatialHashBroadPhase>();
+
+    for (unsigned int step = 0; step < 6; ++step)
+    {
+        // some models are removed from the broad phase during a few steps, then added again
+        const auto roots = computeBoundingTrees(step == 2 || step == 3 ? 7 : 0);
+        EXPECT_EQ(computePairs(spatialHash.get(), roots), computePairs(bruteForce.get(), roots)) << "step " << step;
+        moveSpheres();
+    }
+}
+
+TEST_F(SpatialHashBroadPhase_test, parallelPairGeneration)
+{
+    initTaskScheduler();
+    createScene(1000);
+
+    const auto sequential = sofa::core::objectmodel::New<SpatialHashBroadPhase>();
+    const auto parallel = sofa::core::objectmodel::New<SpatialHashBroadPhase>();
+    parallel->d_parallelPairGeneration.setValue(true);
+
+    for (unsigned int step = 0; step < 3; ++step)
+    {
+        const auto roots = computeBoundingTrees();
+        EXPECT_EQ(computePairs(parallel.get(), roots), computePairs(sequential.get(), roots)) << "step " << step;
+        moveSpheres();
+    }
+}
+
+TEST_F(SpatialHashBroadPhase_test, cellSize)
+{
+    createScene(1000);
+
+    const auto bruteForce = sofa::core::objectmodel::New<BruteForceBroadPhase>();
+    const auto spatialHash = sofa::core::objectmodel::New<SpatialHashBroadPhase>();
+
+    for (const SReal cellSize : { 0.01, 0.5, 10.0 })
+    {
+        spatialHash->d_cellSize.setValue(cellSize);
+        const auto roots = computeBoundingTrees();
+        EXPECT_EQ(computePairs(spatialHash.get(), roots), computePairs(bruteForce.get(), roots)) << "cell size " << cellSize;
+        EXPECT_EQ(spatialHash->getCurrentCellSize(), cellSize);
+    }
+}
+
+/// Time of the collision detection between 1k to 10k moving spheres, compared to the other broad phases
+TEST_F(SpatialHashBroadPhase_test, DISABLED_benchmark)
+{
+    initTaskScheduler();
+    static constexpr int NbSteps = 10;
+
+    for (const unsigned int nbSpheres : { 1000u, 2500u, 5000u, 10000u })
+    {
+        createScene(nbSpheres);
+
+        const auto bruteForce = sofa::core::objectmodel::New<BruteForceBroadPhase>();
+        const auto spatialHash = sofa::core::objectmodel::New<SpatialHashBroadPhase>();
+        const auto parallelSpatialHash = sofa::core::objectmodel::New<SpatialHashBroadPhase>();
+        parallelSpatialHash->d_parallelPairGeneration.setValue(true);
+        const auto bvhNarrowPhase = sofa::core::objectmodel::New<BVHNarrowPhase>();
+        const auto directSAPNarrowPhase = sofa::core::objectmodel::New<DirectSAPNarrowPhase>();
+        const auto incrSAP = sofa::core::objectmodel::New<IncrSAP>();
+        incrSAP->init();
+
+        const std::vector<std::tuple<std::string, BroadPhaseDetection*, NarrowPhaseDetection*> > detections {
+            { "BruteForceBroadPhase + BVHNarrowPhase", bruteForce.get(), bvhNarrowPhase.get() },
+            { "DirectSAP", bruteForce.get(), directSAPNarrowPhase.get() },
+            { "IncrSAP", incrSAP.get(), incrSAP.get() },
+            { "SpatialHashBroadPhase + BVHNarrowPhase", spatialHash.get(), bvhNarrowPhase.get() },
+            { "SpatialHashBroadPhase (parallel) + BVHNarrowPhase", parallelSpatialHash.get(), bvhNarrowPhase.get() }
+        };
+
+        sofa::type::vector<double> broadPhaseTimes(detections.size(), 0), detectionTimes(detections.size(), 0);
+        for (int step = 0; step < NbSteps; ++step)
+        {
+            moveSpheres();
+            const auto roots = computeBoundingTrees();
+
+            for (std::size_t d = 0; d < detections.size(); ++d)
+            {
+                const auto& [name, broadPhase, narrowPhase] = detections[d];
+                const auto start = std::chrono::steady_clock::now();
+                computePairs(broadPhase, roots);
+                broadPhaseTimes[d] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                const auto detectionStart = std::chrono::steady_clock::now();
+                detect(broadPhase, narrowPhase, roots);
+                detectionTimes[d] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - detectionStart).count();
+            }
+        }
+
+        for (std::size_t d = 0; d < detections.size(); ++d)
+        {
+            std::cout << nbSpheres << " spheres, " << std::get<0>(detections[d])
+                << ": broad phase " << broadPhaseTimes[d] / NbSteps << " ms"
+                << ", broad and narrow phases " << detectionTimes[d] / NbSteps << " ms" << std::endl;
+        }
+
+        unloadScene();
+    }
+}
+
+} // namespace
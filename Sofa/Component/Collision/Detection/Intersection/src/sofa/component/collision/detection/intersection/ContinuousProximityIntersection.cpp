@@ -0,0 +1,52 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/collision/detection/intersection/ContinuousProximityIntersection.h>
+#include <sofa/component/collision/detection/intersection/MeshContinuousProximityIntersection.h>
+
+#include <sofa/core/ObjectFactory.h>
+
+namespace sofa::component::collision::detection::intersection
+{
+
+void registerContinuousProximityIntersection(sofa::core::ObjectFactory* factory)
+{
+    factory->registerObjects(core::ObjectRegistrationData("Proximity Intersection with continuous collision detection of the Triangle/Point and Line/Line crossings during the time step")
+        .add< ContinuousProximityIntersection >());
+}
+
+ContinuousProximityIntersection::ContinuousProximityIntersection()
+    : NewProximityIntersection()
+    , d_continuousLineLine(initData(&d_continuousLineLine, true, "continuousLineLine", "Continuous collision detection between the lines (edge-edge crossings)"))
+{
+}
+
+ContinuousProximityIntersection::~ContinuousProximityIntersection() = default;
+
+void ContinuousProximityIntersection::init()
+{
+    NewProximityIntersection::init();
+
+    // Replaces the intersectors of NewProximityIntersection for the pairs supporting continuous detection
+    m_meshIntersector = std::make_unique<MeshContinuousProximityIntersection>(this);
+}
+
+} // namespace sofa::component::collision::detection::intersection
@@ -0,0 +1,67 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/collision/detection/intersection/config.h>
+
+#include <sofa/component/collision/detection/intersection/NewProximityIntersection.h>
+
+#include <memory>
+
+namespace sofa::component::collision::detection::intersection
+{
+
+class MeshContinuousProximityIntersection;
+
+/**
+ * NewProximityIntersection extended with a continuous collision detection between meshes.
+ *
+ * The collision models compute their bounding trees around the motion of their elements during the time step
+ * (see CollisionModel::computeContinuousBoundingTree), and the pairs of elements which are not in proximity at
+ * the beginning of the time step are tested along their linear motion. A contact is created if a point crosses
+ * a triangle, or if two lines cross each other, before the end of the time step. Fast objects then do not tunnel
+ * through thin meshes, without having to reduce the time step.
+ *
+ * Continuous detection is added to:
+ * - Triangle/Point
+ * - Line/Line (if d_continuousLineLine is true)
+ * The other pairs are supported as in NewProximityIntersection.
+ */
+class SOFA_COMPONENT_COLLISION_DETECTION_INTERSECTION_API ContinuousProximityIntersection : public NewProximityIntersection
+{
+public:
+    SOFA_CLASS(ContinuousProximityIntersection, NewProximityIntersection);
+
+    Data<bool> d_continuousLineLine; ///< Continuous collision detection between the lines (edge-edge crossings)
+
+    void init() override;
+
+    /// Returns true: the bounding trees must include the motion of the elements during the time step
+    bool useContinuous() const override { return true; }
+
+protected:
+    ContinuousProximityIntersection();
+    ~ContinuousProximityIntersection() override;
+
+    std::unique_ptr<MeshContinuousProximityIntersection> m_meshIntersector;
+};
+
+} // namespace sofa::component::collision::detection::intersection
@@ -0,0 +1,373 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/collision/detection/intersection/MeshContinuousProximityIntersection.h>
+
+#include <sofa/core/collision/Intersection.inl>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sofa::component::collision::detection::intersection
+{
+
+using namespace sofa::type;
+using namespace sofa::defaulttype;
+using namespace sofa::core::collision;
+using namespace sofa::component::collision::geometry;
+
+namespace
+{
+
+/// Tolerance on the coordinates of the point of impact, so that the crossings through an edge or a vertex are not missed
+constexpr SReal ImpactTolerance = 1e-6;
+
+/// Relative tolerance of the root finding, both in time and on the value of the polynomial
+constexpr SReal RootTolerance = 1e-12;
+
+/// Polynomial c[0] + c[1] t + c[2] t^2 + c[3] t^3
+struct Cubic
+{
+    SReal c[4];
+
+    SReal operator()(SReal t) const { return ((c[3] * t + c[2]) * t + c[1]) * t + c[0]; }
+};
+
+/// Six times the signed volume of the tetrahedron (x0,x1,x2,x3) while its vertices move along (d0,d1,d2,d3) for t in [0,1].
+/// It vanishes when the four points are coplanar.
+Cubic computeCoplanarityCubic(const Vec3& x0, const Vec3& x1, const Vec3& x2, const Vec3& x3,
+                              const Vec3& d0, const Vec3& d1, const Vec3& d2, const Vec3& d3)
+{
+    const Vec3 a1 = x1 - x0, a2 = x2 - x0, a3 = x3 - x0;
+    const Vec3 b1 = d1 - d0, b2 = d2 - d0, b3 = d3 - d0;
+
+    // (a1 + t b1) x (a2 + t b2) = n0 + t n1 + t^2 n2
+    const Vec3 n0 = a1.cross(a2);
+    const Vec3 n1 = a1.cross(b2) + b1.cross(a2);
+    const Vec3 n2 = b1.cross(b2);
+
+    return { { n0 * a3, n0 * b3 + n1 * a3, n1 * b3 + n2 * a3, n2 * b3 } };
+}
+
+/// Conservative filter: the cubic is bounded on [0,1] by its coefficients in the Bernstein basis, so it cannot vanish
+/// if they all have the same sign. Most of the pairs given by the swept bounding boxes are discarded here.
+bool mayHaveRoot(const Cubic& f)
+{
+    const SReal bernstein[4] = {
+        f.c[0],
+        f.c[0] + f.c[1] / 3,
+        f.c[0] + (2 * f.c[1] + f.c[2]) / 3,
+        f.c[0] + f.c[1] + f.c[2] + f.c[3] };
+
+    bool allPositive = true;
+    bool allNegative = true;
+    for (const SReal b : bernstein)
+    {
+        allPositive &= b > 0;
+        allNegative &= b < 0;
+    }
+    return !allPositive && !allNegative;
+}
+
+/// Roots of the cubic in [0,1], in increasing order. [0,1] is split at the extrema of the cubic, so that each interval
+/// contains at most one root, found by bisection. An extremum touching zero within the tolerance is also a root.
+int findRoots(const Cubic& f, SReal roots[7])
+{
+    SReal bounds[4] = { 0, 0, 0, 0 };
+    int nbBounds = 0;
+    bounds[nbBounds++] = 0;
+
+    // Extrema: roots of 3 c3 t^2 + 2 c2 t + c1
+    const SReal a = 3 * f.c[3], b = 2 * f.c[2], c = f.c[1];
+    SReal extrema[2];
+    int nbExtrema = 0;
+    if (std::abs(a) > RootTolerance * (std::abs(b) + std::abs(c)))
+    {
+        const SReal delta = b * b - 4 * a * c;
+        if (delta >= 0)
+        {
+            const SReal q = -0.5 * (b + std::copysign(std::sqrt(delta), b));
+            if (q != 0)
+            {
+                extrema[nbExtrema++] = q / a;
+                extrema[nbExtrema++] = c / q;
+            }
+            else
+            {
+                extrema[nbExtrema++] = 0;
+            }
+        }
+    }
+    else if (b != 0)
+    {
+        extrema[nbExtrema++] = -c / b;
+    }
+    std::sort(extrema, extrema + nbExtrema);
+    for (int i = 0; i < nbExtrema; ++i)
+    {
+        if (extrema[i] > 0 && extrema[i] < 1)
+            bounds[nbBounds++] = extrema[i];
+    }
+    bounds[nbBounds++] = 1;
+
+    const SReal scale = std::max({ std::abs(f.c[0]), std::abs(f.c[1]), std::abs(f.c[2]), std::abs(f.c[3]) });
+    const SReal zero = RootTolerance * scale;
+
+    int nbRoots = 0;
+    SReal fLow = f(bounds[0]);
+    for (int i = 0; i < nbBounds; ++i)
+    {
+        if (std::abs(fLow) <= zero)
+        {
+            roots[nbRoots++] = bounds[i];
+        }
+        if (i + 1 == nbBounds)
+            break;
+
+        SReal low = bounds[i], high = bounds[i + 1];
+        const SReal fHigh = f(high);
+        if (std::abs(fLow) > zero && std::abs(fHigh) > zero && (fLow < 0) != (fHigh < 0))
+        {
+            SReal fBisection = fLow;
+            while (high - low > RootTolerance)
+            {
+                const SReal middle = 0.5 * (low + high);
+                const SReal fMiddle = f(middle);
+                if ((fMiddle < 0) == (fBisection < 0))
+                {
+                    low = middle;
+                    fBisection = fMiddle;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            roots[nbRoots++] = 0.5 * (low + high);
+        }
+        fLow = fHigh;
+    }
+    return nbRoots;
+}
+
+/// Coordinates of q along the edges p1p2 and p1p3 of the triangle, if q projects inside the triangle
+bool isInTriangle(const Vec3& p1, const Vec3& p2, const Vec3& p3, const Vec3& q, Vec2& bary)
+{
+    const Vec3 AB = p2 - p1;
+    const Vec3 AC = p3 - p1;
+    const Vec3 AQ = q - p1;
+    const SReal a00 = AB * AB;
+    const SReal a01 = AB * AC;
+    const SReal a11 = AC * AC;
+    const SReal det = a00 * a11 - a01 * a01;
+    if (det <= RootTolerance * a00 * a11)
+        return false; // degenerated triangle
+
+    const SReal b0 = AQ * AB;
+    const SReal b1 = AQ * AC;
+    bary[0] = (b0 * a11 - b1 * a01) / det;
+    bary[1] = (b1 * a00 - b0 * a01) / det;
+    return bary[0] >= -ImpactTolerance && bary[1] >= -ImpactTolerance && bary[0] + bary[1] <= 1 + ImpactTolerance;
+}
+
+/// Positions along the segments p1p2 and q1q2 of their closest points, if they are inside both segments
+bool areSegmentsCrossing(const Vec3& p1, const Vec3& p2, const Vec3& q1, const Vec3& q2, Vec2& params)
+{
+    const Vec3 AB = p2 - p1;
+    const Vec3 CD = q2 - q1;
+    const Vec3 AC = q1 - p1;
+    const SReal a00 = AB * AB;
+    const SReal a11 = CD * CD;
+    const SReal a01 = -(CD * AB);
+    const SReal det = a00 * a11 - a01 * a01;
+    if (det <= RootTolerance * a00 * a11)
+        return false; // parallel segments
+
+    const SReal b0 = AB * AC;
+    const SReal b1 = -(CD * AC);
+    params[0] = (b0 * a11 - b1 * a01) / det;
+    params[1] = (b1 * a00 - b0 * a01) / det;
+    return params[0] >= -ImpactTolerance && params[0] <= 1 + ImpactTolerance
+        && params[1] >= -ImpactTolerance && params[1] <= 1 + ImpactTolerance;
+}
+
+/// Adds a contact between the point p of the first element and q of the second one, along the normal oriented towards
+/// the side of q at the beginning of the time step (or, if q starts on the surface, against the relative motion of q).
+/// As the elements are not in proximity, the contact distance is larger than the alarm distance.
+int addContinuousContact(sofa::type::vector<DetectionOutput>* contacts, const Vec3& p, const Vec3& q, Vec3 normal,
+                         const Vec3& relativeMotion, Index id, SReal timeOfImpact)
+{
+    if (!normal.normalize())
+    {
+        normal = q - p;
+        if (!normal.normalize())
+        {
+            normal = -relativeMotion;
+            if (!normal.normalize())
+                return 0;
+        }
+    }
+
+    SReal side = normal * (q - p);
+    if (side == 0)
+        side = -(normal * relativeMotion);
+    if (side < 0)
+        normal = -normal;
+
+    contacts->resize(contacts->size() + 1);
+    DetectionOutput* detection = &*(contacts->end() - 1);
+    detection->id = id;
+    detection->point[0] = p;
+    detection->point[1] = q;
+    detection->normal = normal;
+    detection->value = normal * (q - p);
+    detection->deltaT = timeOfImpact;
+    return 1;
+}
+
+} // namespace
+
+MeshContinuousProximityIntersection::MeshContinuousProximityIntersection(ContinuousProximityIntersection* intersection, bool addSelf)
+    : m_proximityIntersector(intersection, false)
+{
+    if (addSelf)
+    {
+        intersection->intersectors.add<TriangleCollisionModel<sofa::defaulttype::Vec3Types>, PointCollisionModel<sofa::defaulttype::Vec3Types>, MeshContinuousProximityIntersection>(this);
+        if (intersection->d_continuousLineLine.getValue())
+            intersection->intersectors.add<LineCollisionModel<sofa::defaulttype::Vec3Types>, LineCollisionModel<sofa::defaulttype::Vec3Types>, MeshContinuousProximityIntersection>(this);
+    }
+}
+
+bool MeshContinuousProximityIntersection::testIntersection(Triangle& tri, Point& pt, const core::collision::Intersection* currentIntersection)
+{
+    return m_proximityIntersector.testIntersection(tri, pt, currentIntersection);
+}
+
+bool MeshContinuousProximityIntersection::testIntersection(Line& line1, Line& line2, const core::collision::Intersection* currentIntersection)
+{
+    return m_proximityIntersector.testIntersection(line1, line2, currentIntersection);
+}
+
+int MeshContinuousProximityIntersection::computeIntersection(Triangle& e1, Point& e2, OutputVector* contacts, const core::collision::Intersection* currentIntersection)
+{
+    const int n = m_proximityIntersector.computeIntersection(e1, e2, contacts, currentIntersection);
+    if (n > 0)
+        return n;
+
+    const SReal dt = currentIntersection->getContext()->getDt();
+    const Vec3 dp1 = e1.v1() * dt;
+    const Vec3 dp2 = e1.v2() * dt;
+    const Vec3 dp3 = e1.v3() * dt;
+    const Vec3 dq = e2.v() * dt;
+
+    SReal t;
+    Vec2 bary;
+    if (!computeTimeOfImpactTrianglePoint(e1.p1(), e1.p2(), e1.p3(), e2.p(), dp1, dp2, dp3, dq, t, bary))
+        return 0;
+
+    const Vec3 p = e1.p1() + (e1.p2() - e1.p1()) * bary[0] + (e1.p3() - e1.p1()) * bary[1];
+    const Vec3 dp = dp1 + (dp2 - dp1) * bary[0] + (dp3 - dp1) * bary[1];
+    if (!addContinuousContact(contacts, p, e2.p(), cross(e1.p2() - e1.p1(), e1.p3() - e1.p1()), dq - dp, e2.getIndex(), t * dt))
+        return 0;
+
+    DetectionOutput* detection = &*(contacts->end() - 1);
+    detection->elem = std::pair<core::CollisionElementIterator, core::CollisionElementIterator>(e1, e2);
+    detection->value -= currentIntersection->getContactDistance() + e1.getProximity() + e2.getProximity();
+    return 1;
+}
+
+int MeshContinuousProximityIntersection::computeIntersection(Line& e1, Line& e2, OutputVector* contacts, const core::collision::Intersection* currentIntersection)
+{
+    const int n = m_proximityIntersector.computeIntersection(e1, e2, contacts, currentIntersection);
+    if (n > 0)
+        return n;
+
+    const SReal dt = currentIntersection->getContext()->getDt();
+    const Vec3 dp1 = e1.v1() * dt;
+    const Vec3 dp2 = e1.v2() * dt;
+    const Vec3 dq1 = e2.v1() * dt;
+    const Vec3 dq2 = e2.v2() * dt;
+
+    SReal t;
+    Vec2 params;
+    if (!computeTimeOfImpactLineLine(e1.p1(), e1.p2(), e2.p1(), e2.p2(), dp1, dp2, dq1, dq2, t, params))
+        return 0;
+
+    const Vec3 p = e1.p1() + (e1.p2() - e1.p1()) * params[0];
+    const Vec3 q = e2.p1() + (e2.p2() - e2.p1()) * params[1];
+    const Vec3 dp = dp1 + (dp2 - dp1) * params[0];
+    const Vec3 dq = dq1 + (dq2 - dq1) * params[1];
+    const Index id = (e1.getCollisionModel()->getSize() > e2.getCollisionModel()->getSize()) ? e1.getIndex() : e2.getIndex();
+    if (!addContinuousContact(contacts, p, q, cross(e1.p2() - e1.p1(), e2.p2() - e2.p1()), dq - dp, id, t * dt))
+        return 0;
+
+    DetectionOutput* detection = &*(contacts->end() - 1);
+    detection->elem = std::pair<core::CollisionElementIterator, core::CollisionElementIterator>(e1, e2);
+    detection->value -= currentIntersection->getContactDistance() + e1.getProximity() + e2.getProximity();
+    return 1;
+}
+
+bool MeshContinuousProximityIntersection::computeTimeOfImpactTrianglePoint(const Vec3& p1, const Vec3& p2, const Vec3& p3, const Vec3& q,
+                                                                           const Vec3& dp1, const Vec3& dp2, const Vec3& dp3, const Vec3& dq,
+                                                                           SReal& t, Vec2& bary)
+{
+    const Cubic coplanarity = computeCoplanarityCubic(p1, p2, p3, q, dp1, dp2, dp3, dq);
+    if (!mayHaveRoot(coplanarity))
+        return false;
+
+    SReal roots[7];
+    const int nbRoots = findRoots(coplanarity, roots);
+    for (int i = 0; i < nbRoots; ++i)
+    {
+        const SReal r = roots[i];
+        if (isInTriangle(p1 + dp1 * r, p2 + dp2 * r, p3 + dp3 * r, q + dq * r, bary))
+        {
+            t = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MeshContinuousProximityIntersection::computeTimeOfImpactLineLine(const Vec3& p1, const Vec3& p2, const Vec3& q1, const Vec3& q2,
+                                                                      const Vec3& dp1, const Vec3& dp2, const Vec3& dq1, const Vec3& dq2,
+                                                                      SReal& t, Vec2& params)
+{
+    const Cubic coplanarity = computeCoplanarityCubic(p1, p2, q1, q2, dp1, dp2, dq1, dq2);
+    if (!mayHaveRoot(coplanarity))
+        return false;
+
+    SReal roots[7];
+    const int nbRoots = findRoots(coplanarity, roots);
+    for (int i = 0; i < nbRoots; ++i)
+    {
+        const SReal r = roots[i];
+        if (areSegmentsCrossing(p1 + dp1 * r, p2 + dp2 * r, q1 + dq1 * r, q2 + dq2 * r, params))
+        {
+            t = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace sofa::component::collision::detection::intersection
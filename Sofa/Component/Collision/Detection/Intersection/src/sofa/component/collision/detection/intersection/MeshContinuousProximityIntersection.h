@@ -0,0 +1,72 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/collision/detection/intersection/config.h>
+
+#include <sofa/component/collision/detection/intersection/ContinuousProximityIntersection.h>
+#include <sofa/component/collision/detection/intersection/MeshNewProximityIntersection.h>
+#include <sofa/component/collision/geometry/TriangleModel.h>
+#include <sofa/component/collision/geometry/LineModel.h>
+#include <sofa/component/collision/geometry/PointModel.h>
+
+namespace sofa::component::collision::detection::intersection
+{
+
+/**
+ * Continuous intersectors of ContinuousProximityIntersection.
+ *
+ * The pairs in proximity at the beginning of the time step are handled by MeshNewProximityIntersection. Otherwise,
+ * the elements are moved linearly along their velocity during the time step, and the first time at which they
+ * become coplanar with the point inside the triangle (or the lines crossing each other) is searched. The contact
+ * is given at the beginning of the time step, between the points of the elements which meet at the time of impact.
+ */
+class SOFA_COMPONENT_COLLISION_DETECTION_INTERSECTION_API MeshContinuousProximityIntersection : public core::collision::BaseIntersector
+{
+    typedef NewProximityIntersection::OutputVector OutputVector;
+
+public:
+    MeshContinuousProximityIntersection(ContinuousProximityIntersection* intersection, bool addSelf=true);
+
+    bool testIntersection(collision::geometry::Triangle&, collision::geometry::Point&, const core::collision::Intersection* currentIntersection);
+    int computeIntersection(collision::geometry::Triangle&, collision::geometry::Point&, OutputVector*, const core::collision::Intersection* currentIntersection);
+    bool testIntersection(collision::geometry::Line&, collision::geometry::Line&, const core::collision::Intersection* currentIntersection);
+    int computeIntersection(collision::geometry::Line&, collision::geometry::Line&, OutputVector*, const core::collision::Intersection* currentIntersection);
+
+    /// First time t in [0,1] at which the point q+t*dq is in the triangle (p1+t*dp1, p2+t*dp2, p3+t*dp3).
+    /// bary receives the coordinates of the point along the edges p1p2 and p1p3 of the triangle at that time.
+    /// Returns false if they do not meet during the motion.
+    static bool computeTimeOfImpactTrianglePoint(const type::Vec3& p1, const type::Vec3& p2, const type::Vec3& p3, const type::Vec3& q,
+                                                 const type::Vec3& dp1, const type::Vec3& dp2, const type::Vec3& dp3, const type::Vec3& dq,
+                                                 SReal& t, type::Vec2& bary);
+
+    /// First time t in [0,1] at which the segments (p1+t*dp1, p2+t*dp2) and (q1+t*dq1, q2+t*dq2) cross each other.
+    /// params receives the positions of the crossing point along both segments at that time.
+    /// Returns false if they do not meet during the motion.
+    static bool computeTimeOfImpactLineLine(const type::Vec3& p1, const type::Vec3& p2, const type::Vec3& q1, const type::Vec3& q2,
+                                            const type::Vec3& dp1, const type::Vec3& dp2, const type::Vec3& dq1, const type::Vec3& dq2,
+                                            SReal& t, type::Vec2& params);
+
+protected:
+    MeshNewProximityIntersection m_proximityIntersector;
+};
+
+} // namespace sofa::component::collision::detection::intersection
@@ -24,6 +24,9 @@
 #include <sofa/core/collision/Intersection.inl>
 #include <sofa/core/collision/IntersectorFactory.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace sofa::component::collision::detection::intersection
 {
@@ -35,6 +38,108 @@ using namespace sofa::component::collision::geometry;
 
 IntersectorCreator<NewProximityIntersection, MeshNewProximityIntersection> MeshNewProximityIntersectors("Mesh");
 
+namespace
+{
+
+/// Coordinates of the second elements of a batch of intersection tests, stored per component so that the culling
+/// loops can be vectorized
+struct IntersectionBatch
+{
+    sofa::type::vector<SReal> x;
+    sofa::type::vector<SReal> y;
+    sofa::type::vector<SReal> z;
+    sofa::type::vector<SReal> radius;
+    sofa::type::vector<unsigned char> isCandidate;
+
+    void clear()
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+    }
+
+    void add(const Vec3& center, SReal r = 0)
+    {
+        x.push_back(center[0]);
+        y.push_back(center[1]);
+        z.push_back(center[2]);
+        radius.push_back(r);
+    }
+};
+
+/// The intersections of several pairs of collision models can be computed concurrently (see ParallelBVHNarrowPhase)
+IntersectionBatch& getIntersectionBatch()
+{
+    thread_local IntersectionBatch batch;
+    return batch;
+}
+
+/// Relative margin on the culling distances, so that rounding errors never discard a detected contact
+constexpr SReal CullingMargin = 1e-6;
+
+/// Mark the candidates closer than the given distance to a sphere. The comparisons are written so that NaN
+/// coordinates are kept, as computeIntersection would process them.
+std::size_t cullOutsideSphere(IntersectionBatch& batch, const Vec3& center, SReal radius, SReal distance)
+{
+    const std::size_t size = batch.x.size();
+    batch.isCandidate.resize(size);
+
+    const SReal* x = batch.x.data();
+    const SReal* y = batch.y.data();
+    const SReal* z = batch.z.data();
+    const SReal* r = batch.radius.data();
+    unsigned char* isCandidate = batch.isCandidate.data();
+
+    const SReal cx = center[0], cy = center[1], cz = center[2];
+    const SReal scale = 1 + CullingMargin;
+    std::size_t nbCandidates = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const SReal dx = x[i] - cx;
+        const SReal dy = y[i] - cy;
+        const SReal dz = z[i] - cz;
+        const SReal cullingDistance = (radius + r[i] + distance) * scale;
+        isCandidate[i] = !(dx * dx + dy * dy + dz * dz >= cullingDistance * cullingDistance);
+        nbCandidates += isCandidate[i];
+    }
+    return nbCandidates;
+}
+
+/// Among the candidates, keep the ones closer than the given distance to a plane
+std::size_t cullOutsidePlane(IntersectionBatch& batch, const Vec3& normal, SReal offset, SReal distance)
+{
+    const std::size_t size = batch.x.size();
+
+    const SReal* x = batch.x.data();
+    const SReal* y = batch.y.data();
+    const SReal* z = batch.z.data();
+    unsigned char* isCandidate = batch.isCandidate.data();
+
+    const SReal nx = normal[0], ny = normal[1], nz = normal[2];
+    const SReal distance2 = distance * distance;
+    std::size_t nbCandidates = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const SReal d = nx * x[i] + ny * y[i] + nz * z[i] - offset;
+        isCandidate[i] &= !(d * d >= distance2);
+        nbCandidates += isCandidate[i];
+    }
+    return nbCandidates;
+}
+
+/// Make room for the contacts of the candidates, keeping the geometric growth of the vector
+void reserveContacts(sofa::type::vector<DetectionOutput>* contacts, std::size_t nbNewContacts)
+{
+    const std::size_t size = contacts->size() + nbNewContacts;
+    if (size > contacts->capacity())
+    {
+        contacts->reserve(std::max(size, 2 * contacts->capacity()));
+    }
+}
+
+} // namespace
+
 MeshNewProximityIntersection::MeshNewProximityIntersection(NewProximityIntersection* intersection, bool addSelf)
 {
     if (addSelf)
@@ -355,4 +460,115 @@ int MeshNewProximityIntersection::computeIntersection(Triangle& e1, Triangle& e2
     return n;
 }
 
+int MeshNewProximityIntersection::computeIntersections(const std::pair<Triangle, Triangle>& triangles, const std::pair<Point, Point>& points, bool selfCollision, OutputVector* contacts, const core::collision::Intersection* currentIntersection)
+{
+    if (triangles.first == triangles.second || points.first == points.second)
+        return 0;
+
+    // The proximity is the same for all the elements of a collision model
+    const SReal alarmDist = currentIntersection->getAlarmDistance() + triangles.first.getProximity() + points.first.getProximity();
+
+    IntersectionBatch& batch = getIntersectionBatch();
+    batch.clear();
+    for (Point pt = points.first; pt != points.second; ++pt)
+    {
+        batch.add(pt.p());
+    }
+
+    int n = 0;
+    for (Triangle tri = triangles.first; tri != triangles.second; ++tri)
+    {
+        const Vec3& p1 = tri.p1();
+        const Vec3& p2 = tri.p2();
+        const Vec3& p3 = tri.p3();
+
+        // Same determinant as in doIntersectionTrianglePoint: if the triangle is degenerated, its contacts are not
+        // bounded by the triangle and all the pairs are computed
+        const Vec3 AB = p2 - p1;
+        const Vec3 AC = p3 - p1;
+        Matrix2 A;
+        A[0][0] = AB * AB;
+        A[1][1] = AC * AC;
+        A[0][1] = A[1][0] = AB * AC;
+        const SReal det = type::determinant(A);
+
+        std::size_t nbCandidates = batch.x.size();
+        if (det > 0)
+        {
+            // The closest point of the triangle is inside its bounding sphere
+            const Vec3 center = (p1 + p2 + p3) / 3;
+            const SReal radius = std::sqrt(std::max({ (p1 - center).norm2(), (p2 - center).norm2(), (p3 - center).norm2() }));
+            nbCandidates = cullOutsideSphere(batch, center, radius, alarmDist);
+
+            // The normal is accurate enough to bound the distance to the plane of the triangle if it is not too flat
+            Vec3 normal = AB.cross(AC);
+            if (nbCandidates > 0 && normal.norm2() > CullingMargin * A[0][0] * A[1][1])
+            {
+                normal.normalize();
+                nbCandidates = cullOutsidePlane(batch, normal, normal * p1, alarmDist * (1 + CullingMargin) + radius * CullingMargin);
+            }
+        }
+        else
+        {
+            batch.isCandidate.assign(batch.x.size(), 1);
+        }
+
+        if (nbCandidates == 0)
+            continue;
+
+        reserveContacts(contacts, nbCandidates);
+
+        std::size_t i = 0;
+        for (Point pt = points.first; pt != points.second; ++pt, ++i)
+        {
+            if (!batch.isCandidate[i])
+                continue;
+            if (selfCollision && !core::CollisionElementIterator(tri.getCollisionModel(), tri.getIndex()).canCollideWith(
+                    core::CollisionElementIterator(pt.getCollisionModel(), pt.getIndex())))
+                continue;
+            n += computeIntersection(tri, pt, contacts, currentIntersection);
+        }
+    }
+    return n;
+}
+
+int MeshNewProximityIntersection::computeIntersections(const std::pair<Line, Line>& lines1, const std::pair<Line, Line>& lines2, bool selfCollision, OutputVector* contacts, const core::collision::Intersection* currentIntersection)
+{
+    if (lines1.first == lines1.second || lines2.first == lines2.second)
+        return 0;
+
+    // The proximity is the same for all the elements of a collision model
+    const SReal alarmDist = currentIntersection->getAlarmDistance() + lines1.first.getProximity() + lines2.first.getProximity();
+
+    // Both closest points computed in doIntersectionLineLine are on the segments, inside their bounding spheres
+    IntersectionBatch& batch = getIntersectionBatch();
+    batch.clear();
+    for (Line line = lines2.first; line != lines2.second; ++line)
+    {
+        batch.add((line.p1() + line.p2()) * 0.5, (line.p2() - line.p1()).norm() * 0.5);
+    }
+
+    int n = 0;
+    for (Line line1 = lines1.first; line1 != lines1.second; ++line1)
+    {
+        const std::size_t nbCandidates = cullOutsideSphere(batch, (line1.p1() + line1.p2()) * 0.5, (line1.p2() - line1.p1()).norm() * 0.5, alarmDist);
+        if (nbCandidates == 0)
+            continue;
+
+        reserveContacts(contacts, nbCandidates);
+
+        std::size_t i = 0;
+        for (Line line2 = lines2.first; line2 != lines2.second; ++line2, ++i)
+        {
+            if (!batch.isCandidate[i])
+                continue;
+            if (selfCollision && !core::CollisionElementIterator(line1.getCollisionModel(), line1.getIndex()).canCollideWith(
+                    core::CollisionElementIterator(line2.getCollisionModel(), line2.getIndex())))
+                continue;
+            n += computeIntersection(line1, line2, contacts, currentIntersection);
+        }
+    }
+    return n;
+}
+
 } // namespace sofa::component::collision::detection::intersection
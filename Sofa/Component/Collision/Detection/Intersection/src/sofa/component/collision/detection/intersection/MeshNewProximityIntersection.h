@@ -49,6 +49,12 @@ public:
     int computeIntersection(collision::geometry::Triangle&, collision::geometry::Line&, OutputVector*, const core::collision::Intersection* currentIntersection);
     bool testIntersection(collision::geometry::Triangle&, collision::geometry::Triangle&, const core::collision::Intersection* currentIntersection);
     int computeIntersection(collision::geometry::Triangle&, collision::geometry::Triangle&, OutputVector*, const core::collision::Intersection* currentIntersection);
+
+    /// Intersection between all the pairs of elements of two ranges. A first pass over the whole range of the second
+    /// elements, written to be vectorized, discards the pairs farther than the alarm distance from their bounding
+    /// spheres. The remaining pairs are given to computeIntersection: the contacts are the same, in the same order.
+    int computeIntersections(const std::pair<collision::geometry::Triangle, collision::geometry::Triangle>& triangles, const std::pair<collision::geometry::Point, collision::geometry::Point>& points, bool selfCollision, OutputVector*, const core::collision::Intersection* currentIntersection);
+    int computeIntersections(const std::pair<collision::geometry::Line, collision::geometry::Line>& lines1, const std::pair<collision::geometry::Line, collision::geometry::Line>& lines2, bool selfCollision, OutputVector*, const core::collision::Intersection* currentIntersection);
     
     template <class T>
     bool testIntersection(collision::geometry::TSphere<T>& sph, collision::geometry::Point& pt, const core::collision::Intersection* currentIntersection);
@@ -0,0 +1,182 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/collision/detection/intersection/ContinuousProximityIntersection.h>
+#include <sofa/component/collision/detection/intersection/MeshContinuousProximityIntersection.h>
+using sofa::component::collision::detection::intersection::ContinuousProximityIntersection;
+using sofa::component::collision::detection::intersection::MeshContinuousProximityIntersection;
+
+#include <sofa/core/collision/Intersection.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simpleapi/SimpleApi.h>
+#include <sofa/testing/BaseSimulationTest.h>
+
+namespace
+{
+
+using sofa::type::Vec2;
+using sofa::type::Vec3;
+
+TEST(MeshContinuousProximityIntersection, pointCrossingTriangle)
+{
+    SReal t;
+    Vec2 bary;
+
+    // Static triangle, point going through it
+    EXPECT_TRUE(MeshContinuousProximityIntersection::computeTimeOfImpactTrianglePoint(
+        Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(0.2, 0.3, 1),
+        Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, -4), t, bary));
+    EXPECT_NEAR(t, 0.25, 1e-9);
+    EXPECT_NEAR(bary[0], 0.2, 1e-9);
+    EXPECT_NEAR(bary[1], 0.3, 1e-9);
+
+    // Triangle going through a static point
+    EXPECT_TRUE(MeshContinuousProximityIntersection::computeTimeOfImpactTrianglePoint(
+        Vec3(0, 0, -1), Vec3(1, 0, -1), Vec3(0, 1, -1), Vec3(0.2, 0.3, 0),
+        Vec3(0, 0, 2), Vec3(0, 0, 2), Vec3(0, 0, 2), Vec3(0, 0, 0), t, bary));
+    EXPECT_NEAR(t, 0.5, 1e-9);
+
+    // Rotating triangle: only its vertex p3 moves, and sweeps the point at the middle of its motion
+    EXPECT_TRUE(MeshContinuousProximityIntersection::computeTimeOfImpactTrianglePoint(
+        Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 1), Vec3(0.2, 0.4, 0),
+        Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, -2), Vec3(0, 0, 0), t, bary));
+    EXPECT_NEAR(t, 0.5, 1e-9);
+    EXPECT_NEAR(bary[1], 0.4, 1e-9);
+
+    // Point crossing the plane of the triangle outside of it
+    EXPECT_FALSE(MeshContinuousProximityIntersection::computeTimeOfImpactTrianglePoint(
+        Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(0.7, 0.7, 1),
+        Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, -4), t, bary));
+
+    // Point stopping before the triangle
+    EXPECT_FALSE(MeshContinuousProximityIntersection::computeTimeOfImpactTrianglePoint(
+        Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(0.2, 0.3, 1),
+        Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, -0.9), t, bary));
+
+    // Point moving parallel to the triangle
+    EXPECT_FALSE(MeshContinuousProximityIntersection::computeTimeOfImpactTrianglePoint(
+        Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(-1, 0.3, 0.1),
+        Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(2, 0, 0), t, bary));
+}
+
+TEST(MeshContinuousProximityIntersection, linesCrossing)
+{
+    SReal t;
+    Vec2 params;
+
+    // Orthogonal lines, the second one going through the first one
+    EXPECT_TRUE(MeshContinuousProximityIntersection::computeTimeOfImpactLineLine(
+        Vec3(-1, 0, 0), Vec3(1, 0, 0), Vec3(0.5, -1, 1), Vec3(0.5, 1, 1),
+        Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, -1.6), Vec3(0, 0, -1.6), t, params));
+    EXPECT_NEAR(t, 0.625, 1e-9);
+    EXPECT_NEAR(params[0], 0.75, 1e-9);
+    EXPECT_NEAR(params[1], 0.5, 1e-9);
+
+    // Both lines moving towards each other
+    EXPECT_TRUE(MeshContinuousProximityIntersection::computeTimeOfImpactLineLine(
+        Vec3(-1, 0, -1), Vec3(1, 0, -1), Vec3(0, -1, 1), Vec3(0, 1, 1),
+        Vec3(0, 0, 1.5), Vec3(0, 0, 1.5), Vec3(0, 0, -1.5), Vec3(0, 0, -1.5), t, params));
+    EXPECT_NEAR(t, 2. / 3., 1e-9);
+
+    // The second line passes beside the end of the first one
+    EXPECT_FALSE(MeshContinuousProximityIntersection::computeTimeOfImpactLineLine(
+        Vec3(-1, 0, 0), Vec3(1, 0, 0), Vec3(1.5, -1, 1), Vec3(1.5, 1, 1),
+        Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, -2), Vec3(0, 0, -2), t, params));
+
+    // Parallel lines
+    EXPECT_FALSE(MeshContinuousProximityIntersection::computeTimeOfImpactLineLine(
+        Vec3(-1, 0, 0), Vec3(1, 0, 0), Vec3(-1, 0, 1), Vec3(1, 0, 1),
+        Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(0, 0, -2), Vec3(0, 0, -2), t, params));
+}
+
+/// A point going through a triangle during one time step, far from it at the beginning of the time step
+struct ContinuousProximityIntersection_test : public sofa::testing::BaseSimulationTest
+{
+    sofa::simulation::Node::SPtr root;
+    sofa::core::CollisionModel* triangleModel { nullptr };
+    sofa::core::CollisionModel* pointModel { nullptr };
+
+    void createScene()
+    {
+        sofa::simpleapi::importPlugin("Sofa.Component.StateContainer");
+        sofa::simpleapi::importPlugin("Sofa.Component.Topology.Container.Constant");
+        sofa::simpleapi::importPlugin("Sofa.Component.Collision.Geometry");
+        sofa::simpleapi::importPlugin("Sofa.Component.Collision.Detection.Intersection");
+
+        root = sofa::simulation::getSimulation()->createNewGraph("root");
+        root->setDt(0.01);
+
+        const auto triangle = sofa::simpleapi::createChild(root, "triangle");
+        sofa::simpleapi::createObject(triangle, "MeshTopology", {{"triangles", "0 1 2"}});
+        sofa::simpleapi::createObject(triangle, "MechanicalObject", {{"template", "Vec3"}, {"position", "0 0 0  1 0 0  0 1 0"}});
+        triangleModel = dynamic_cast<sofa::core::CollisionModel*>(sofa::simpleapi::createObject(triangle, "TriangleCollisionModel").get());
+
+        const auto point = sofa::simpleapi::createChild(root, "point");
+        sofa::simpleapi::createObject(point, "MechanicalObject", {{"template", "Vec3"}, {"position", "0.2 0.3 1"}, {"velocity", "0 0 -200"}});
+        pointModel = dynamic_cast<sofa::core::CollisionModel*>(sofa::simpleapi::createObject(point, "PointCollisionModel").get());
+
+        ASSERT_NE(triangleModel, nullptr);
+        ASSERT_NE(pointModel, nullptr);
+    }
+
+    sofa::type::vector<sofa::core::collision::DetectionOutput> detect(const std::string& intersectionType)
+    {
+        const auto intersectionObject = sofa::simpleapi::createObject(root, intersectionType, {{"alarmDistance", "0.1"}, {"contactDistance", "0.05"}});
+        auto* intersection = dynamic_cast<sofa::core::collision::Intersection*>(intersectionObject.get());
+        sofa::simulation::node::initRoot(root.get());
+
+        bool swapModels = false;
+        sofa::core::collision::ElementIntersector* intersector = intersection->findIntersector(triangleModel, pointModel, swapModels);
+        EXPECT_NE(intersector, nullptr);
+        EXPECT_FALSE(swapModels);
+
+        sofa::type::vector<sofa::core::collision::DetectionOutput> contacts;
+        if (intersector != nullptr)
+        {
+            sofa::core::collision::DetectionOutputVector* outputs = nullptr;
+            intersector->beginIntersect(triangleModel, pointModel, outputs);
+            intersector->intersect(triangleModel->begin(), pointModel->begin(), outputs, intersection);
+            contacts = *dynamic_cast<sofa::type::vector<sofa::core::collision::DetectionOutput>*>(outputs);
+            outputs->release();
+        }
+
+        root->removeObject(intersectionObject);
+        return contacts;
+    }
+};
+
+TEST_F(ContinuousProximityIntersection_test, pointTunnelingThroughTriangle)
+{
+    createScene();
+
+    EXPECT_TRUE(detect("NewProximityIntersection").empty());
+
+    const auto contacts = detect("ContinuousProximityIntersection");
+    ASSERT_EQ(contacts.size(), 1);
+    EXPECT_NEAR(contacts[0].deltaT, 0.005, 1e-9);
+    EXPECT_NEAR(contacts[0].point[0][0], 0.2, 1e-9);
+    EXPECT_NEAR(contacts[0].point[0][1], 0.3, 1e-9);
+    EXPECT_NEAR(contacts[0].point[0][2], 0, 1e-9);
+    EXPECT_NEAR(contacts[0].normal[2], 1, 1e-9);
+    EXPECT_NEAR(contacts[0].value, 1 - 0.05, 1e-9);
+}
+
+}
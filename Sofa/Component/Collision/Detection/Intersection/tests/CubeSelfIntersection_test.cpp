@@ -0,0 +1,101 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/collision/detection/intersection/DiscreteIntersection.h>
+#include <sofa/component/collision/detection/intersection/LocalMinDistance.h>
+#include <sofa/component/collision/detection/intersection/MinProximityIntersection.h>
+#include <sofa/component/collision/detection/intersection/NewProximityIntersection.h>
+#include <sofa/component/collision/geometry/CubeModel.h>
+#include <sofa/testing/BaseTest.h>
+
+namespace
+{
+using sofa::component::collision::detection::intersection::DiscreteIntersection;
+using sofa::component::collision::detection::intersection::LocalMinDistance;
+using sofa::component::collision::detection::intersection::MinProximityIntersection;
+using sofa::component::collision::detection::intersection::NewProximityIntersection;
+using sofa::component::collision::geometry::Cube;
+using sofa::component::collision::geometry::CubeCollisionModel;
+using sofa::type::Vec3;
+
+/// Hierarchy of the bounding boxes of a flat grid of n*n unit squares in the plane z = 0.
+/// The normals of the squares are all +z if flat, or alternate between +z and -z otherwise (e.g. a folded sheet).
+CubeCollisionModel::SPtr createGrid(unsigned int n, bool flat)
+{
+    auto model = sofa::core::objectmodel::New<CubeCollisionModel>();
+    model->resize(n * n);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        for (unsigned int j = 0; j < n; ++j)
+        {
+            const Vec3 normal(0, 0, (flat || (i + j) % 2 == 0) ? 1 : -1);
+            model->setParentOf(i * n + j, Vec3(i, j, 0), Vec3(i + 1, j + 1, 0), normal);
+        }
+    }
+    model->computeBoundingTree(8);
+    return model;
+}
+
+Cube getRoot(CubeCollisionModel& model)
+{
+    return Cube(static_cast<CubeCollisionModel*>(model.getFirst()), 0);
+}
+
+/// The self pair of the root, and a pair of neighbor leaves, are tested by a proximity intersection
+template<class TIntersection>
+void checkProximitySelfCollision(CubeCollisionModel& model)
+{
+    auto intersection = sofa::core::objectmodel::New<TIntersection>();
+    intersection->setAlarmDistance(0.2);
+
+    // neighbor elements of a flat surface are closer than the alarm distance: the normal cone cannot prune them
+    Cube root = getRoot(model);
+    EXPECT_TRUE(intersection->testIntersection(root, root, intersection.get()));
+
+    Cube leaf0(&model, 0), leaf1(&model, 1);
+    EXPECT_TRUE(intersection->testIntersection(leaf0, leaf1, intersection.get()));
+}
+}
+
+TEST(CubeSelfIntersection, discreteIntersectionPrunesFlatSubtree)
+{
+    const auto flat = createGrid(16, true);
+    Cube flatRoot = getRoot(*flat);
+    ASSERT_LT(flatRoot.getConeAngle(), M_PI / 2);
+
+    const auto folded = createGrid(16, false);
+    Cube foldedRoot = getRoot(*folded);
+    ASSERT_GE(foldedRoot.getConeAngle(), M_PI / 2);
+
+    const auto intersection = sofa::core::objectmodel::New<DiscreteIntersection>();
+    EXPECT_FALSE(intersection->testIntersection(flatRoot, flatRoot, intersection.get()));
+    EXPECT_TRUE(intersection->testIntersection(foldedRoot, foldedRoot, intersection.get()));
+}
+
+TEST(CubeSelfIntersection, proximityIntersectionsKeepFlatSubtree)
+{
+    const auto flat = createGrid(16, true);
+    ASSERT_LT(getRoot(*flat).getConeAngle(), M_PI / 2);
+
+    checkProximitySelfCollision<MinProximityIntersection>(*flat);
+    checkProximitySelfCollision<NewProximityIntersection>(*flat);
+    checkProximitySelfCollision<LocalMinDistance>(*flat);
+}
@@ -28,6 +28,16 @@
 #include <sofa/testing/BaseTest.h>
 using sofa::testing::BaseTest;
 #include <sofa/testing/NumericTest.h>
+#include <sofa/testing/BaseSimulationTest.h>
+
+#include <sofa/component/collision/geometry/TriangleModel.h>
+#include <sofa/component/collision/geometry/LineModel.h>
+#include <sofa/component/collision/geometry/PointModel.h>
+#include <sofa/core/collision/Intersection.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simpleapi/SimpleApi.h>
+
+#include <random>
 
 
 namespace sofa{
@@ -165,4 +175,132 @@ TEST_F(MeshNewProximityIntersectionTest, pointTriangle ) {
     ASSERT_TRUE( pointTriangle());
 }
 
+/**
+ * Two noisy parallel grids close to each other: the ranges of elements given at once to the intersector
+ * must produce exactly the same contacts as the element pairs tested one by one, including in self-collision.
+ */
+struct MeshNewProximityIntersectionRangeTest : public sofa::testing::BaseSimulationTest
+{
+    typedef sofa::type::Vec3 Vec3;
+    typedef sofa::core::CollisionElementIterator CollisionElementIterator;
+    typedef std::pair<CollisionElementIterator, CollisionElementIterator> ElementRange;
+    typedef sofa::type::vector<sofa::core::collision::DetectionOutput> OutputVector;
+
+    simulation::Node::SPtr root;
+    sofa::core::collision::Intersection* intersection { nullptr };
+    sofa::type::vector<simulation::Node::SPtr> grids;
+
+    void createScene(unsigned int n)
+    {
+        sofa::simpleapi::importPlugin("Sofa.Component.StateContainer");
+        sofa::simpleapi::importPlugin("Sofa.Component.Topology.Container.Constant");
+        sofa::simpleapi::importPlugin("Sofa.Component.Collision.Geometry");
+        sofa::simpleapi::importPlugin("Sofa.Component.Collision.Detection.Intersection");
+
+        root = simulation::getSimulation()->createNewGraph("root");
+        const auto intersectionObject = sofa::simpleapi::createObject(root, "NewProximityIntersection",
+            {{"alarmDistance", "0.05"}, {"contactDistance", "0.01"}});
+        intersection = dynamic_cast<sofa::core::collision::Intersection*>(intersectionObject.get());
+        ASSERT_NE(intersection, nullptr);
+
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<SReal> noise(-0.01, 0.01);
+        for (const SReal z : { 0.0, 0.03 })
+        {
+            const auto node = sofa::simpleapi::createChild(root, "grid" + std::to_string(grids.size()));
+
+            std::stringstream positionStr, triangleStr;
+            for (unsigned int j = 0; j <= n; ++j)
+                for (unsigned int i = 0; i <= n; ++i)
+                    positionStr << Vec3(SReal(i) / n + noise(generator), SReal(j) / n + noise(generator), z + noise(generator)) << " ";
+            for (unsigned int j = 0; j < n; ++j)
+            {
+                for (unsigned int i = 0; i < n; ++i)
+                {
+                    const unsigned int a = j * (n + 1) + i;
+                    triangleStr << a << " " << a + 1 << " " << a + n + 2 << " " << a << " " << a + n + 2 << " " << a + n + 1 << " ";
+                }
+            }
+
+            sofa::simpleapi::createObject(node, "MeshTopology", {{"triangles", triangleStr.str()}});
+            sofa::simpleapi::createObject(node, "MechanicalObject", {{"template", "Vec3"}, {"position", positionStr.str()}});
+            sofa::simpleapi::createObject(node, "TriangleCollisionModel", {{"selfCollision", "true"}});
+            sofa::simpleapi::createObject(node, "LineCollisionModel", {{"selfCollision", "true"}});
+            sofa::simpleapi::createObject(node, "PointCollisionModel", {{"selfCollision", "true"}});
+            grids.push_back(node);
+        }
+
+        sofa::simulation::node::initRoot(root.get());
+    }
+
+    template<class Model>
+    Model* getModel(unsigned int grid) const
+    {
+        return grids[grid]->get<Model>();
+    }
+
+    /// Splits the elements of a model into ranges, as in the leaves of its bounding tree
+    static sofa::type::vector<ElementRange> splitIntoRanges(sofa::core::CollisionModel* model, sofa::Size rangeSize)
+    {
+        sofa::type::vector<ElementRange> ranges;
+        for (sofa::Size i = 0; i < model->getSize(); i += rangeSize)
+        {
+            ranges.emplace_back(CollisionElementIterator(model, i), CollisionElementIterator(model, std::min(i + rangeSize, model->getSize())));
+        }
+        return ranges;
+    }
+
+    void checkSameContacts(sofa::core::CollisionModel* model1, sofa::core::CollisionModel* model2)
+    {
+        bool swapModels = false;
+        sofa::core::collision::ElementIntersector* intersector = intersection->findIntersector(model1, model2, swapModels);
+        ASSERT_NE(intersector, nullptr);
+        ASSERT_FALSE(swapModels);
+
+        const bool selfCollision = model1->getContext() == model2->getContext();
+        sofa::core::collision::DetectionOutputVector* pairwiseOutputs = nullptr;
+        sofa::core::collision::DetectionOutputVector* rangeOutputs = nullptr;
+        intersector->beginIntersect(model1, model2, pairwiseOutputs);
+        intersector->beginIntersect(model1, model2, rangeOutputs);
+
+        for (const auto& range1 : splitIntoRanges(model1, 8))
+        {
+            for (const auto& range2 : splitIntoRanges(model2, 8))
+            {
+                intersector->ElementIntersector::intersectRanges(range1, range2, selfCollision, pairwiseOutputs, intersection);
+                intersector->intersectRanges(range1, range2, selfCollision, rangeOutputs, intersection);
+            }
+        }
+
+        const auto* expected = dynamic_cast<OutputVector*>(pairwiseOutputs);
+        const auto* actual = dynamic_cast<OutputVector*>(rangeOutputs);
+        ASSERT_NE(expected, nullptr);
+        ASSERT_NE(actual, nullptr);
+        EXPECT_FALSE(expected->empty());
+        ASSERT_EQ(expected->size(), actual->size());
+        for (std::size_t i = 0; i < expected->size(); ++i)
+        {
+            EXPECT_EQ((*expected)[i].elem, (*actual)[i].elem);
+            EXPECT_EQ((*expected)[i].id, (*actual)[i].id);
+            EXPECT_EQ((*expected)[i].point[0], (*actual)[i].point[0]);
+            EXPECT_EQ((*expected)[i].point[1], (*actual)[i].point[1]);
+            EXPECT_EQ((*expected)[i].normal, (*actual)[i].normal);
+            EXPECT_EQ((*expected)[i].value, (*actual)[i].value);
+        }
+
+        pairwiseOutputs->release();
+        rangeOutputs->release();
+    }
+};
+
+TEST_F(MeshNewProximityIntersectionRangeTest, sameContactsAsPairwise)
+{
+    using namespace sofa::component::collision::geometry;
+    createScene(20);
+
+    checkSameContacts(getModel<TriangleCollisionModel<defaulttype::Vec3Types> >(0), getModel<PointCollisionModel<defaulttype::Vec3Types> >(1));
+    checkSameContacts(getModel<LineCollisionModel<defaulttype::Vec3Types> >(0), getModel<LineCollisionModel<defaulttype::Vec3Types> >(1));
+    checkSameContacts(getModel<TriangleCollisionModel<defaulttype::Vec3Types> >(0), getModel<PointCollisionModel<defaulttype::Vec3Types> >(0));
+}
+
 }
@@ -24,7 +24,11 @@
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/helper/visual/DrawTool.h>
 #include <sofa/core/ObjectFactory.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/ParallelForEach.h>
 #include <algorithm>
+#include <array>
+#include <limits>
 
 namespace sofa::component::collision::geometry
 {
@@ -39,8 +43,34 @@ void registerCubeCollisionModel(sofa::core::ObjectFactory* factory)
 }
 
 CubeCollisionModel::CubeCollisionModel()
+    : d_parallelBuild(initData(&d_parallelBuild, false, "parallelBuild", "If true, the cells of a same level of the hierarchy are split, and updated, in parallel using the task scheduler"))
+    , d_surfaceAreaHeuristic(initData(&d_surfaceAreaHeuristic, false, "surfaceAreaHeuristic", "If true, the cells are split at the position minimizing the surface area heuristic, evaluated on bins of their elements, instead of at the median of their largest dimension"))
+    , d_rebuildThreshold(initData(&d_rebuildThreshold, 0_sreal, "rebuildThreshold", "The hierarchy is only updated while the topology does not change. It is rebuilt if the sum of the areas of its cubes, relative to the area of the root, exceeds this factor times its value after the last build. 0 to never rebuild."))
 {
     enum_type = AABB_TYPE;
+
+    this->addUpdateCallback("parallelBuild", {&d_parallelBuild},
+    [this](const core::DataTracker& tracker) -> sofa::core::objectmodel::ComponentState
+    {
+        SOFA_UNUSED(tracker);
+        if (d_parallelBuild.getValue())
+        {
+            simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+            assert(taskScheduler);
+
+            if (taskScheduler->getThreadCount() < 1)
+            {
+                taskScheduler->init(0);
+                msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+            else
+            {
+                msg_info() << "Task scheduler already initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+        }
+        return this->d_componentState.getValue();
+    },
+    {});
 }
 
 void CubeCollisionModel::resize(sofa::Size size)
@@ -120,39 +150,77 @@ void CubeCollisionModel::updateCube(sofa::Index index)
     const std::pair<Cube,Cube>& subcells = elems[index].subcells;
     if (subcells.first != subcells.second)
     {
-        Cube c = subcells.first;
-        Vec3 minBBox = c.minVect();
-        Vec3 maxBBox = c.maxVect();
+        computeCubeData(subcells.first, subcells.second, elems[index]);
+    }
+}
 
-        elems[index].coneAxis = c.getConeAxis();
-        elems[index].coneAngle = c.getConeAngle();
+namespace
+{
 
-        ++c;
-        while(c != subcells.second)
-        {
-            const Vec3& cmin = c.minVect();
-            const Vec3& cmax = c.maxVect();
+/// Replaces the cone (axis1, angle1) by the narrowest cone containing it and the cone (axis2, angle2). A cone wider
+/// than a half-space does not prune any self-intersection test: it is replaced by the whole space.
+void mergeNormalCones(Vec3& axis1, SReal& angle1, const Vec3& axis2, SReal angle2)
+{
+    if (angle1 > M_PI / 2 || angle2 > M_PI / 2)
+    {
+        angle1 = 2 * M_PI;
+        return;
+    }
 
-            const SReal alpha = std::max<SReal>(elems[index].coneAngle, c.getConeAngle());
-            if(alpha <= M_PI/2)
-            {
-                const SReal beta = acos(c.getConeAxis() *  elems[index].coneAxis);
-                elems[index].coneAxis = (c.getConeAxis() + elems[index].coneAxis).normalized();
-                elems[index].coneAngle = beta/2 + alpha;
-            }
-            else
-                elems[index].coneAngle = 2*M_PI;
-            
-            for (int j=0; j<3; j++)
-            {
-                if (cmax[j] > maxBBox[j]) maxBBox[j] = cmax[j];
-                if (cmin[j] < minBBox[j]) minBBox[j] = cmin[j];
-            }
-            ++c;
+    const SReal beta = std::acos(std::clamp<SReal>(axis1 * axis2, -1, 1));
+    if (beta + angle2 <= angle1)
+    {
+        return;
+    }
+    if (beta + angle1 <= angle2)
+    {
+        axis1 = axis2;
+        angle1 = angle2;
+        return;
+    }
+
+    const SReal angle = (beta + angle1 + angle2) / 2;
+    if (angle > M_PI / 2)
+    {
+        angle1 = 2 * M_PI;
+        return;
+    }
+
+    // The axis is rotated from axis1 toward axis2, in their plane, until the cone touches both cones
+    const SReal rotation = angle - angle1;
+    axis1 = (axis1 * std::sin(beta - rotation) + axis2 * std::sin(rotation)) / std::sin(beta);
+    axis1.normalize();
+    angle1 = angle;
+}
+
+} // namespace
+
+void CubeCollisionModel::computeCubeData(Cube subcellsBegin, Cube subcellsEnd, CubeData& data)
+{
+    Cube c = subcellsBegin;
+    Vec3 minBBox = c.minVect();
+    Vec3 maxBBox = c.maxVect();
+
+    data.coneAxis = c.getConeAxis();
+    data.coneAngle = c.getConeAngle();
+
+    ++c;
+    while(c != subcellsEnd)
+    {
+        const Vec3& cmin = c.minVect();
+        const Vec3& cmax = c.maxVect();
+
+        mergeNormalCones(data.coneAxis, data.coneAngle, c.getConeAxis(), c.getConeAngle());
+
+        for (int j=0; j<3; j++)
+        {
+            if (cmax[j] > maxBBox[j]) maxBBox[j] = cmax[j];
+            if (cmin[j] < minBBox[j]) minBBox[j] = cmin[j];
         }
-        elems[index].minBBox = minBBox;
-        elems[index].maxBBox = maxBBox;
+        ++c;
     }
+    data.minBBox = minBBox;
+    data.maxBBox = maxBBox;
 }
 
 void CubeCollisionModel::updateCubes()
@@ -232,6 +300,184 @@ bool CubeCollisionModel::isLeaf(sofa::Index index ) const
     return elems[index].children.first.valid();
 }
 
+namespace
+{
+
+SReal surfaceArea(const Vec3& minBBox, const Vec3& maxBBox)
+{
+    const Vec3 l = maxBBox - minBBox;
+    return 2 * (l[0] * l[1] + l[1] * l[2] + l[2] * l[0]);
+}
+
+int largestDimension(const Vec3& l)
+{
+    if(l[0]>l[1])
+        if (l[0]>l[2])
+            return 0;
+        else
+            return 2;
+    else if (l[1]>l[2])
+        return 1;
+    else
+        return 2;
+}
+
+} // namespace
+
+sofa::Index CubeCollisionModel::splitCell(const CubeData& cell, bool surfaceAreaHeuristic)
+{
+    const sofa::Index first = cell.subcells.first.getIndex();
+    const sofa::Index last = cell.subcells.second.getIndex();
+    const sofa::Index ncells = last - first;
+    if (ncells <= 4)
+    {
+        // Only split cells with more than 4 childs
+        return last;
+    }
+
+    if (surfaceAreaHeuristic)
+    {
+        static constexpr int NbBins = 16;
+
+        // the bins are distributed along the largest dimension of the centers of the children
+        // (centers are multiplied by 2, as in CubeSortPredicate)
+        Vec3 minCenter = elems[first].minBBox + elems[first].maxBBox;
+        Vec3 maxCenter = minCenter;
+        for (sofa::Index i = first + 1; i < last; ++i)
+        {
+            const Vec3 center = elems[i].minBBox + elems[i].maxBBox;
+            for (int j = 0; j < 3; ++j)
+            {
+                minCenter[j] = std::min(minCenter[j], center[j]);
+                maxCenter[j] = std::max(maxCenter[j], center[j]);
+            }
+        }
+        const int axis = largestDimension(maxCenter - minCenter);
+        const SReal extent = maxCenter[axis] - minCenter[axis];
+
+        if (extent > 0)
+        {
+            const auto binOf = [axis, extent, origin = minCenter[axis]](const CubeData& c)
+            {
+                const int bin = static_cast<int>((c.minBBox[axis] + c.maxBBox[axis] - origin) * NbBins / extent);
+                return std::min(bin, NbBins - 1);
+            };
+
+            struct Bin
+            {
+                sofa::Index count { 0 };
+                Vec3 minBBox, maxBBox;
+
+                void add(const Vec3& cmin, const Vec3& cmax)
+                {
+                    if (count == 0)
+                    {
+                        minBBox = cmin;
+                        maxBBox = cmax;
+                    }
+                    else
+                    {
+                        for (int j = 0; j < 3; ++j)
+                        {
+                            minBBox[j] = std::min(minBBox[j], cmin[j]);
+                            maxBBox[j] = std::max(maxBBox[j], cmax[j]);
+                        }
+                    }
+                }
+            };
+
+            std::array<Bin, NbBins> bins;
+            for (sofa::Index i = first; i < last; ++i)
+            {
+                Bin& bin = bins[binOf(elems[i])];
+                bin.add(elems[i].minBBox, elems[i].maxBBox);
+                ++bin.count;
+            }
+
+            // area and number of children of the bins [b, NbBins)
+            std::array<SReal, NbBins> rightArea {};
+            std::array<sofa::Index, NbBins> rightCount {};
+            Bin right;
+            for (int b = NbBins - 1; b > 0; --b)
+            {
+                if (bins[b].count > 0)
+                {
+                    right.add(bins[b].minBBox, bins[b].maxBBox);
+                    right.count += bins[b].count;
+                }
+                rightArea[b] = right.count > 0 ? surfaceArea(right.minBBox, right.maxBBox) : 0;
+                rightCount[b] = right.count;
+            }
+
+            // The split must leave enough children on each side, for the depth of the tree to remain
+            // close to the depth obtained with median splits
+            const sofa::Index minCount = std::max<sofa::Index>(1, ncells / 8);
+            int bestSplit = 0;
+            SReal bestCost = std::numeric_limits<SReal>::max();
+            Bin left;
+            for (int b = 1; b < NbBins; ++b)
+            {
+                if (bins[b - 1].count > 0)
+                {
+                    left.add(bins[b - 1].minBBox, bins[b - 1].maxBBox);
+                    left.count += bins[b - 1].count;
+                }
+                if (left.count < minCount || rightCount[b] < minCount)
+                {
+                    continue;
+                }
+                const SReal cost = surfaceArea(left.minBBox, left.maxBBox) * left.count + rightArea[b] * rightCount[b];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestSplit = b;
+                }
+            }
+
+            if (bestSplit > 0)
+            {
+                const auto middle = std::partition(elems.begin() + first, elems.begin() + last,
+                    [&binOf, bestSplit](const CubeData& c) { return binOf(c) < bestSplit; });
+                return static_cast<sofa::Index>(middle - elems.begin());
+            }
+        }
+        // no acceptable split: fall back to the median split
+    }
+
+    // Find the biggest dimension
+    const int splitAxis = largestDimension(cell.maxBBox - cell.minBBox);
+
+    // Separate cells on each side of the median cell
+    const CubeSortPredicate sortpred(splitAxis);
+    std::stable_sort(elems.begin() + first, elems.begin() + last, sortpred);
+
+    return first + (ncells + 1) / 2;
+}
+
+SReal CubeCollisionModel::computeTreeCost(const std::list<CubeCollisionModel*>& levels)
+{
+    const CubeCollisionModel* root = levels.front();
+    if (root->empty())
+    {
+        return 0;
+    }
+    const SReal rootArea = surfaceArea(root->elems[0].minBBox, root->elems[0].maxBBox);
+    if (rootArea <= 0)
+    {
+        return 0;
+    }
+
+    SReal cost = 0;
+    for (const auto* level : levels)
+    {
+        for (const auto& cube : level->elems)
+        {
+            cost += surfaceArea(cube.minBBox, cube.maxBBox);
+        }
+    }
+    return cost / rootArea;
+}
+
 void CubeCollisionModel::computeBoundingTree(int maxDepth)
 {
 
@@ -242,7 +488,47 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
         levels.push_front(levels.front()->createPrevious<CubeCollisionModel>());
     CubeCollisionModel* root = levels.front();
 
-    if (root->empty() || root->getPrevious() != nullptr)
+    const simulation::ForEachExecutionPolicy execution = d_parallelBuild.getValue() ?
+        simulation::ForEachExecutionPolicy::PARALLEL :
+        simulation::ForEachExecutionPolicy::SEQUENTIAL;
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+    assert(taskScheduler);
+
+    bool rebuild = root->empty() || root->getPrevious() != nullptr;
+
+    if (!rebuild)
+    {
+        // Simply update the existing tree, starting from the bottom
+        int lvl = 0;
+        for (auto it = levels.rbegin(); it != levels.rend(); ++it)
+        {
+            dmsg_info() << "CubeCollisionModel: update level " << lvl;
+            CubeCollisionModel* level = *it;
+            simulation::forEachRange(execution, *taskScheduler, 0u, level->size,
+                [level](const auto& range)
+                {
+                    for (auto i = range.start; i != range.end; ++i)
+                    {
+                        level->updateCube(i);
+                    }
+                });
+            ++lvl;
+        }
+
+        const SReal rebuildThreshold = d_rebuildThreshold.getValue();
+        if (rebuildThreshold > 0 && m_builtTreeCost > 0)
+        {
+            // The splits of a tree built on a configuration become less relevant as the elements move
+            const SReal cost = computeTreeCost(levels);
+            if (cost > rebuildThreshold * m_builtTreeCost)
+            {
+                dmsg_info() << "Tree cost increased from " << m_builtTreeCost << " to " << cost << ": rebuilding";
+                rebuild = true;
+            }
+        }
+    }
+
+    if (rebuild)
     {
         // Tree must be reconstructed
         dmsg_info() << "Building Tree with depth " << maxDepth << " from " << size << " elements.";
@@ -266,49 +552,63 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
         dmsg_info() << "CubeCollisionModel: add root cube";
         root->addCube(Cube(this,0),Cube(this,size));
         // Construct tree by splitting cells along their biggest dimension
+        const bool surfaceAreaHeuristic = d_surfaceAreaHeuristic.getValue();
         auto it = levels.begin();
         CubeCollisionModel* level = *it;
         ++it;
         int lvl = 0;
+
+        // The cells of a level cover disjoint ranges of the children: they are split independently.
+        // The new cells are then added in the order of the cells of the level.
+        struct CellSplit
+        {
+            sofa::Index middle;
+            CubeData first, second;
+        };
+        sofa::type::vector<CellSplit> splits;
+
         while(it != levels.end())
         {
             dmsg_info() << "CubeCollisionModel: split level " << lvl;
             CubeCollisionModel* clevel = *it;
+
+            splits.resize(level->size);
+            simulation::forEachRange(execution, *taskScheduler, 0u, level->size,
+                [this, level, clevel, &splits, surfaceAreaHeuristic](const auto& range)
+                {
+                    for (auto c = range.start; c != range.end; ++c)
+                    {
+                        const CubeData& cell = level->elems[c];
+                        CellSplit& split = splits[c];
+                        split.middle = splitCell(cell, surfaceAreaHeuristic);
+                        if (split.middle != cell.subcells.second.getIndex())
+                        {
+                            const Cube cmiddle(this, split.middle);
+                            split.first.subcells = std::make_pair(cell.subcells.first, cmiddle);
+                            split.second.subcells = std::make_pair(cmiddle, cell.subcells.second);
+                            computeCubeData(cell.subcells.first, cmiddle, split.first);
+                            computeCubeData(cmiddle, cell.subcells.second, split.second);
+                        }
+                    }
+                });
+
             clevel->elems.reserve(level->size*2);
-            for(Cube cell = Cube(level->begin()); level->end() != cell; ++cell)
+            for (sofa::Index c = 0; c < level->size; ++c)
             {
-                const std::pair<Cube,Cube>& subcells = cell.subcells();
-                const sofa::Index ncells = subcells.second.getIndex() - subcells.first.getIndex();
-                dmsg_info() << "CubeCollisionModel: level " << lvl << " cell " << cell.getIndex() << ": current subcells " << subcells.first.getIndex() << " - " << subcells.second.getIndex();
-                if (ncells > 4)
+                const CellSplit& split = splits[c];
+                const std::pair<Cube,Cube>& subcells = level->elems[c].subcells;
+                dmsg_info() << "CubeCollisionModel: level " << lvl << " cell " << c << ": current subcells " << subcells.first.getIndex() << " - " << subcells.second.getIndex();
+                if (split.middle != subcells.second.getIndex())
                 {
-                    // Only split cells with more than 4 childs
-                    // Find the biggest dimension
-                    int splitAxis;
-                    Vec3 l = cell.maxVect()-cell.minVect();
-                    const sofa::Index middle = subcells.first.getIndex()+(ncells+1)/2;
-                    if(l[0]>l[1])
-                        if (l[0]>l[2])
-                            splitAxis = 0;
-                        else
-                            splitAxis = 2;
-                    else if (l[1]>l[2])
-                        splitAxis = 1;
-                    else
-                        splitAxis = 2;
-
-                    // Separate cells on each side of the median cell
-                    const CubeSortPredicate sortpred(splitAxis);
-                    std::stable_sort(elems.begin() + subcells.first.getIndex(), elems.begin() + subcells.second.getIndex(), sortpred);
-
                     // Create the two new subcells
-                    const Cube cmiddle(this, middle);
-                    sofa::Index c1 = clevel->addCube(subcells.first, cmiddle);
-                    sofa::Index c2 = clevel->addCube(cmiddle, subcells.second);
-                    dmsg_info() << "L" << lvl << " cell " << cell.getIndex() << " split along " << (splitAxis == 0 ? 'X' : splitAxis == 1 ? 'Y' : 'Z') << " in cell " << c1 << " size " << middle - subcells.first.getIndex() << " and cell " << c2 << " size " << subcells.second.getIndex() - middle << ".";
-                    //level->elems[cell.getIndex()].subcells = std::make_pair(Cube(clevel,c1),Cube(clevel,c2+1));
-                    level->elems[cell.getIndex()].subcells.first = Cube(clevel,c1);
-                    level->elems[cell.getIndex()].subcells.second = Cube(clevel,c2+1);
+                    const sofa::Index c1 = clevel->size;
+                    const sofa::Index c2 = c1 + 1;
+                    clevel->core::CollisionModel::resize(c2 + 1);
+                    clevel->elems.push_back(split.first);
+                    clevel->elems.push_back(split.second);
+                    dmsg_info() << "L" << lvl << " cell " << c << " split in cell " << c1 << " size " << split.middle - subcells.first.getIndex() << " and cell " << c2 << " size " << subcells.second.getIndex() - split.middle << ".";
+                    level->elems[c].subcells.first = Cube(clevel,c1);
+                    level->elems[c].subcells.second = Cube(clevel,c2+1);
                 }
             }
             ++it;
@@ -321,17 +621,8 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
             for (sofa::Size i=0; i<size; i++)
                 parentOf[elems[i].children.first.getIndex()] = i;
         }
-    }
-    else
-    {
-        // Simply update the existing tree, starting from the bottom
-        int lvl = 0;
-        for (auto it = levels.rbegin(); it != levels.rend(); ++it)
-        {
-            dmsg_info() << "CubeCollisionModel: update level " << lvl;
-            (*it)->updateCubes();
-            ++lvl;
-        }
+
+        m_builtTreeCost = computeTreeCost(levels);
     }
     dmsg_info() << "<CubeCollisionModel::computeBoundingTree(" << maxDepth << ")";
 }
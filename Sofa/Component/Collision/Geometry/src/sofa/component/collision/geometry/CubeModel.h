@@ -25,6 +25,8 @@
 #include <sofa/core/CollisionModel.h>
 #include <sofa/defaulttype/VecTypes.h>
 
+#include <list>
+
 namespace sofa::component::collision::geometry
 {
 
@@ -81,6 +83,14 @@ protected:
     sofa::type::vector<CubeData> elems;
     sofa::type::vector<sofa::Index> parentOf; ///< Given the index of a child leaf element, store the index of the parent cube
 
+    /// Sum of the areas of the cubes of the hierarchy, relative to the area of the root, when it was last built
+    SReal m_builtTreeCost { 0 };
+
+public:
+    Data<bool> d_parallelBuild; ///< If true, the cells of a same level of the hierarchy are split, and updated, in parallel
+    Data<bool> d_surfaceAreaHeuristic; ///< If true, the cells are split using a binned surface area heuristic instead of at the median of their largest dimension
+    Data<SReal> d_rebuildThreshold; ///< The hierarchy is rebuilt when its cost increased by this factor since it was built. 0 to never rebuild
+
 public:
     typedef core::CollisionElementIterator ChildIterator;
     typedef sofa::defaulttype::Vec3Types DataTypes;
@@ -143,6 +153,18 @@ public:
     sofa::Index addCube(Cube subcellsBegin, Cube subcellsEnd);
     void updateCube(sofa::Index index);
     void updateCubes();
+
+protected:
+
+    /// Bounding box and normal cone of the cubes in [subcellsBegin, subcellsEnd), which must not be empty
+    static void computeCubeData(Cube subcellsBegin, Cube subcellsEnd, CubeData& data);
+
+    /// Sorts the leaf cubes of the cell and returns the index of the first leaf cube of its second half,
+    /// or the end of the cell if it must not be split
+    sofa::Index splitCell(const CubeData& cell, bool surfaceAreaHeuristic);
+
+    /// Sum of the areas of the cubes of the levels, relative to the area of the root
+    static SReal computeTreeCost(const std::list<CubeCollisionModel*>& levels);
 };
 
 inline Cube::Cube(CubeCollisionModel* model, Index index)
@@ -28,6 +28,7 @@
 #include <sofa/simulation/Node.h>
 #include <sofa/simulation/Node.h>
 #include <sofa/core/topology/TopologyChange.h>
+#include <algorithm>
 #include <vector>
 
 namespace sofa::component::collision::geometry
@@ -329,7 +330,7 @@ void TriangleCollisionModel<DataTypes>::computeContinuousBoundingTree(SReal dt,
             t.n().normalize();
 
             if(d_useCurvature.getValue())
-                cubeModel->setParentOf(i, minElem, maxElem, t.n(), acos(cross(pt2v-pt1v,pt3v-pt1v).normalized() * t.n()));
+                cubeModel->setParentOf(i, minElem, maxElem, t.n(), std::acos(std::clamp<SReal>(cross(pt2v-pt1v,pt3v-pt1v).normalized() * t.n(), -1, 1)));
             else
                 cubeModel->setParentOf(i, minElem, maxElem);
         }
@@ -0,0 +1,387 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/collision/geometry/CubeModel.h>
+using sofa::component::collision::geometry::CubeCollisionModel;
+using sofa::component::collision::geometry::Cube;
+
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+
+using sofa::type::Vec3;
+using BoundingTree = sofa::type::vector<std::pair<Vec3, Vec3> >;
+
+void initTaskScheduler()
+{
+    sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::MainTaskSchedulerFactory::createInRegistry();
+    if (taskScheduler->getThreadCount() < 1)
+    {
+        taskScheduler->init(0);
+    }
+}
+
+/// Bounding boxes of the triangles of a torus, each triangle being slightly enlarged
+sofa::type::vector<std::pair<Vec3, Vec3> > torusTriangles(unsigned int nbU, unsigned int nbV, SReal twist)
+{
+    const auto point = [nbU, nbV, twist](unsigned int u, unsigned int v)
+    {
+        const SReal a = 2 * M_PI * u / nbU;
+        const SReal b = 2 * M_PI * v / nbV + twist * std::sin(a);
+        return Vec3((2 + std::cos(b)) * std::cos(a), (2 + std::cos(b)) * std::sin(a), std::sin(b));
+    };
+
+    sofa::type::vector<std::pair<Vec3, Vec3> > boxes;
+    boxes.reserve(2 * nbU * nbV);
+    for (unsigned int u = 0; u < nbU; ++u)
+    {
+        for (unsigned int v = 0; v < nbV; ++v)
+        {
+            const Vec3 p[4] = { point(u, v), point(u + 1, v), point(u + 1, v + 1), point(u, v + 1) };
+            for (unsigned int t = 0; t < 2; ++t)
+            {
+                Vec3 minBBox = p[0], maxBBox = p[0];
+                for (const auto& q : { p[1 + t], p[2 + t] })
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        minBBox[c] = std::min(minBBox[c], q[c]);
+                        maxBBox[c] = std::max(maxBBox[c], q[c]);
+                    }
+                }
+                boxes.emplace_back(minBBox - Vec3(1e-3, 1e-3, 1e-3), maxBBox + Vec3(1e-3, 1e-3, 1e-3));
+            }
+        }
+    }
+    return boxes;
+}
+
+/// Sets the leaf cubes. The boxes are indexed by element, whatever the order of the leaf cubes.
+void setLeaves(CubeCollisionModel& model, const sofa::type::vector<std::pair<Vec3, Vec3> >& boxes)
+{
+    model.resize(static_cast<sofa::Size>(boxes.size()));
+    for (sofa::Index i = 0; i < boxes.size(); ++i)
+    {
+        model.setParentOf(i, boxes[i].first, boxes[i].second);
+    }
+}
+
+/// Bounding boxes of all the levels, from the root to the leaves
+sofa::type::vector<BoundingTree> getLevels(CubeCollisionModel& model)
+{
+    sofa::type::vector<BoundingTree> levels;
+    for (sofa::core::CollisionModel* m = &model; m != nullptr; m = m->getPrevious())
+    {
+        levels.emplace(levels.begin());
+        static_cast<CubeCollisionModel*>(m)->getBoundingTree(levels.front());
+    }
+    return levels;
+}
+
+SReal treeCost(CubeCollisionModel& model)
+{
+    const auto levels = getLevels(model);
+    const auto area = [](const std::pair<Vec3, Vec3>& box)
+    {
+        const Vec3 l = box.second - box.first;
+        return 2 * (l[0] * l[1] + l[1] * l[2] + l[2] * l[0]);
+    };
+    SReal cost = 0;
+    for (std::size_t l = 0; l + 1 < levels.size(); ++l)
+    {
+        for (const auto& box : levels[l])
+        {
+            cost += area(box);
+        }
+    }
+    return cost / area(levels.front().front());
+}
+
+/// Checks that each cube contains its subcells, and that the leaves are a permutation of the elements
+void checkTree(CubeCollisionModel& model)
+{
+    sofa::type::vector<bool> visited(model.getSize(), false);
+    for (sofa::Index i = 0; i < model.getSize(); ++i)
+    {
+        const sofa::Index element = model.getLeafIndex(i);
+        ASSERT_LT(element, model.getSize());
+        EXPECT_FALSE(visited[element]);
+        visited[element] = true;
+    }
+
+    for (sofa::core::CollisionModel* m = model.getPrevious(); m != nullptr; m = m->getPrevious())
+    {
+        auto* level = static_cast<CubeCollisionModel*>(m);
+        for (sofa::Index i = 0; i < level->getSize(); ++i)
+        {
+            const auto& cube = level->getCubeData(i);
+            for (auto c = cube.subcells.first; c != cube.subcells.second; ++c)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    EXPECT_LE(cube.minBBox[j], c.minVect()[j]);
+                    EXPECT_GE(cube.maxBBox[j], c.maxVect()[j]);
+                }
+            }
+        }
+    }
+}
+
+/// Bounding boxes and normals of the triangles of a spherical cap of unit radius, centered on the z axis
+std::pair<BoundingTree, sofa::type::vector<Vec3> > sphericalCapTriangles(unsigned int nbU, unsigned int nbV, SReal maxPolarAngle)
+{
+    const auto point = [nbU, nbV, maxPolarAngle](unsigned int u, unsigned int v)
+    {
+        const SReal a = 2 * M_PI * u / nbU;
+        const SReal b = maxPolarAngle * (v + 1) / (nbV + 1);
+        return Vec3(std::sin(b) * std::cos(a), std::sin(b) * std::sin(a), std::cos(b));
+    };
+
+    BoundingTree boxes;
+    sofa::type::vector<Vec3> normals;
+    for (unsigned int u = 0; u < nbU; ++u)
+    {
+        for (unsigned int v = 0; v + 1 < nbV; ++v)
+        {
+            const Vec3 p[4] = { point(u, v), point(u + 1, v), point(u + 1, v + 1), point(u, v + 1) };
+            for (unsigned int t = 0; t < 2; ++t)
+            {
+                const Vec3& p0 = p[0];
+                const Vec3& p1 = p[1 + t];
+                const Vec3& p2 = p[2 + t];
+                Vec3 normal = sofa::type::cross(p1 - p0, p2 - p0).normalized();
+                if (normal * (p0 + p1 + p2) < 0)
+                {
+                    normal = -normal;
+                }
+
+                Vec3 minBBox = p0, maxBBox = p0;
+                for (const auto& q : { p1, p2 })
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        minBBox[c] = std::min(minBBox[c], q[c]);
+                        maxBBox[c] = std::max(maxBBox[c], q[c]);
+                    }
+                }
+                boxes.emplace_back(minBBox, maxBBox);
+                normals.push_back(normal);
+            }
+        }
+    }
+    return { boxes, normals };
+}
+
+/// Checks that the normal cone of each cube contains the normals of all the leaves below it
+void checkNormalCones(CubeCollisionModel& model)
+{
+    const auto leafNormals = [](const Cube& cube)
+    {
+        sofa::type::vector<Vec3> normals;
+        sofa::type::vector<Cube> stack { cube };
+        while (!stack.empty())
+        {
+            const Cube c = stack.back();
+            stack.pop_back();
+            if (c.subcells().first == c.subcells().second)
+            {
+                normals.push_back(c.getConeAxis());
+            }
+            for (Cube s = c.subcells().first; s != c.subcells().second; ++s)
+            {
+                stack.push_back(s);
+            }
+        }
+        return normals;
+    };
+
+    for (sofa::core::CollisionModel* m = &model; m != nullptr; m = m->getPrevious())
+    {
+        auto* level = static_cast<CubeCollisionModel*>(m);
+        for (sofa::Index i = 0; i < level->getSize(); ++i)
+        {
+            const Cube cube(level, i);
+            if (cube.getConeAngle() > M_PI / 2)
+            {
+                continue;
+            }
+            EXPECT_NEAR(cube.getConeAxis().norm(), 1, 1e-6);
+            for (const auto& normal : leafNormals(cube))
+            {
+                const SReal angle = std::acos(std::clamp<SReal>(normal * cube.getConeAxis(), -1, 1));
+                EXPECT_LE(angle, cube.getConeAngle() + 1e-6);
+            }
+        }
+    }
+}
+
+TEST(CubeCollisionModel, parallelBuild)
+{
+    initTaskScheduler();
+
+    const auto boxes = torusTriangles(60, 40, 0.5);
+
+    const auto sequential = sofa::core::objectmodel::New<CubeCollisionModel>();
+    setLeaves(*sequential, boxes);
+    sequential->computeBoundingTree(8);
+
+    const auto parallel = sofa::core::objectmodel::New<CubeCollisionModel>();
+    parallel->d_parallelBuild.setValue(true);
+    setLeaves(*parallel, boxes);
+    parallel->computeBoundingTree(8);
+
+    checkTree(*parallel);
+
+    const auto sequentialLevels = getLevels(*sequential);
+    const auto parallelLevels = getLevels(*parallel);
+    ASSERT_EQ(sequentialLevels.size(), parallelLevels.size());
+    for (std::size_t l = 0; l < sequentialLevels.size(); ++l)
+    {
+        EXPECT_EQ(sequentialLevels[l], parallelLevels[l]);
+    }
+    for (sofa::Index i = 0; i < boxes.size(); ++i)
+    {
+        EXPECT_EQ(sequential->getLeafIndex(i), parallel->getLeafIndex(i));
+    }
+}
+
+TEST(CubeCollisionModel, surfaceAreaHeuristic)
+{
+    initTaskScheduler();
+
+    const auto boxes = torusTriangles(60, 40, 0.5);
+
+    const auto median = sofa::core::objectmodel::New<CubeCollisionModel>();
+    setLeaves(*median, boxes);
+    median->computeBoundingTree(8);
+
+    const auto sah = sofa::core::objectmodel::New<CubeCollisionModel>();
+    sah->d_surfaceAreaHeuristic.setValue(true);
+    sah->d_parallelBuild.setValue(true);
+    setLeaves(*sah, boxes);
+    sah->computeBoundingTree(8);
+
+    checkTree(*sah);
+    EXPECT_LT(treeCost(*sah), treeCost(*median));
+}
+
+TEST(CubeCollisionModel, rebuildThreshold)
+{
+    const auto initialBoxes = torusTriangles(60, 40, 0);
+    const auto deformedBoxes = torusTriangles(60, 40, 2);
+
+    const auto refitted = sofa::core::objectmodel::New<CubeCollisionModel>();
+    setLeaves(*refitted, initialBoxes);
+    refitted->computeBoundingTree(8);
+    setLeaves(*refitted, deformedBoxes);
+    refitted->computeBoundingTree(8);
+    checkTree(*refitted);
+
+    const auto rebuilt = sofa::core::objectmodel::New<CubeCollisionModel>();
+    rebuilt->d_rebuildThreshold.setValue(1.2);
+    setLeaves(*rebuilt, initialBoxes);
+    rebuilt->computeBoundingTree(8);
+    setLeaves(*rebuilt, deformedBoxes);
+    rebuilt->computeBoundingTree(8);
+    checkTree(*rebuilt);
+
+    const auto built = sofa::core::objectmodel::New<CubeCollisionModel>();
+    setLeaves(*built, deformedBoxes);
+    built->computeBoundingTree(8);
+
+    EXPECT_GT(treeCost(*refitted), 1.2 * treeCost(*built));
+    EXPECT_EQ(getLevels(*rebuilt), getLevels(*built));
+}
+
+TEST(CubeCollisionModel, normalCones)
+{
+    for (const SReal maxPolarAngle : { M_PI / 6, M_PI / 3, M_PI / 2, M_PI })
+    {
+        const auto [boxes, normals] = sphericalCapTriangles(40, 20, maxPolarAngle);
+
+        const auto model = sofa::core::objectmodel::New<CubeCollisionModel>();
+        model->resize(static_cast<sofa::Size>(boxes.size()));
+        for (sofa::Index i = 0; i < boxes.size(); ++i)
+        {
+            model->setParentOf(i, boxes[i].first, boxes[i].second, normals[i]);
+        }
+        model->computeBoundingTree(8);
+        checkNormalCones(*model);
+
+        // a cap narrower than a half-sphere cannot fold back onto itself: the self-collision of its root is pruned
+        const Cube root(static_cast<CubeCollisionModel*>(model->getFirst()), 0);
+        if (maxPolarAngle < M_PI / 2 - 0.1)
+        {
+            EXPECT_GE(root.getConeAngle(), maxPolarAngle * 20 / 21);
+            EXPECT_LT(root.getConeAngle(), M_PI / 2);
+        }
+        else
+        {
+            EXPECT_GT(root.getConeAngle(), M_PI / 2);
+        }
+    }
+}
+
+/// Time to build and to update the hierarchy of 500k triangles
+TEST(CubeCollisionModel, DISABLED_buildAndRefitPerformance)
+{
+    initTaskScheduler();
+
+    const auto boxes = torusTriangles(500, 500, 0.5);
+    const auto deformedBoxes = torusTriangles(500, 500, 0.6);
+    static constexpr int Depth = 17;
+    static constexpr int NbRefits = 10;
+
+    for (const bool surfaceAreaHeuristic : { false, true })
+    {
+        for (const bool parallel : { false, true })
+        {
+            const auto model = sofa::core::objectmodel::New<CubeCollisionModel>();
+            model->d_surfaceAreaHeuristic.setValue(surfaceAreaHeuristic);
+            model->d_parallelBuild.setValue(parallel);
+            setLeaves(*model, boxes);
+
+            const auto start = std::chrono::steady_clock::now();
+            model->computeBoundingTree(Depth);
+            const auto built = std::chrono::steady_clock::now();
+            for (int i = 0; i < NbRefits; ++i)
+            {
+                setLeaves(*model, (i % 2) ? boxes : deformedBoxes);
+                model->computeBoundingTree(Depth);
+            }
+            const auto refitted = std::chrono::steady_clock::now();
+
+            std::cout << (surfaceAreaHeuristic ? "SAH" : "median") << (parallel ? " parallel" : " sequential")
+                << ": build " << std::chrono::duration<double, std::milli>(built - start).count() << " ms"
+                << ", leaves update and refit " << std::chrono::duration<double, std::milli>(refitted - built).count() / NbRefits << " ms"
+                << ", cost " << treeCost(*model) << std::endl;
+        }
+    }
+}
+
+} // namespace
@@ -26,6 +26,8 @@
 #include <sofa/core/objectmodel/Tag.h>
 #include <sofa/simulation/Node.h>
 #include <sofa/core/collision/Pipeline.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/ParallelForEach.h>
 
 namespace sofa::component::collision::response::contact
 {
@@ -39,9 +41,35 @@ void registerCollisionResponse(sofa::core::ObjectFactory* factory)
 CollisionResponse::CollisionResponse()
     : d_response(initData(&d_response, "response", "contact response class"))
     , d_responseParams(initData(&d_responseParams, "responseParams", "contact response parameters (syntax: name1=value1&name2=value2&...)"))
+    , d_parallelContactUpdate(initData(&d_parallelContactUpdate, false, "parallelContactUpdate", "If true, the responses of the contacts already created are updated in parallel, one task per pair of collision models. Only the contacts supporting it are concerned (e.g. FrictionContactConstraint)"))
+    , d_reuseInactiveContacts(initData(&d_reuseInactiveContacts, false, "reuseInactiveContacts", "If true, the contacts which are no longer active are kept, with their mappings and constraints, and reused when the same pair of collision models collides again"))
+    , d_inactiveContactLifetime(initData(&d_inactiveContactLifetime, 100u, "inactiveContactLifetime", "Number of time steps an inactive contact is kept for reuse before being released (0 to keep it as long as its collision models are in the scene graph)"))
 {
     response.setOriginalData(&d_response);
     responseParams.setOriginalData(&d_responseParams);
+
+    this->addUpdateCallback("parallelContactUpdate", {&d_parallelContactUpdate},
+    [this](const core::DataTracker& tracker) -> sofa::core::objectmodel::ComponentState
+    {
+        SOFA_UNUSED(tracker);
+        if (d_parallelContactUpdate.getValue())
+        {
+            simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+            assert(taskScheduler);
+
+            if (taskScheduler->getThreadCount() < 1)
+            {
+                taskScheduler->init(0);
+                msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+            else
+            {
+                msg_info() << "Task scheduler already initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+        }
+        return this->d_componentState.getValue();
+    },
+    {});
 }
 
 sofa::helper::OptionsGroup CollisionResponse::initializeResponseOptions(sofa::core::objectmodel::BaseContext *context)
@@ -90,6 +118,45 @@ void CollisionResponse::cleanup()
     }
     contacts.clear();
     contactMap.clear();
+    clearInactiveContacts();
+}
+
+void CollisionResponse::clearInactiveContacts()
+{
+    for (auto& [models, inactiveContact] : inactiveContactMap)
+    {
+        // the response has already been removed when the contact became inactive
+        inactiveContact.contact->cleanup();
+        inactiveContact.contact.reset();
+    }
+    inactiveContactMap.clear();
+}
+
+bool CollisionResponse::isInGraph(const core::CollisionModel* model) const
+{
+    // a removed object has no context anymore, and a removed node is the root of its own graph
+    const core::objectmodel::BaseContext* modelContext = model->getContext();
+    return modelContext != nullptr && modelContext->getRootContext() == getContext()->getRootContext();
+}
+
+void CollisionResponse::releaseExpiredInactiveContacts()
+{
+    const unsigned int lifetime = d_inactiveContactLifetime.getValue();
+    for (auto it = inactiveContactMap.begin(); it != inactiveContactMap.end();)
+    {
+        InactiveContact& inactiveContact = it->second;
+        ++inactiveContact.nbInactiveSteps;
+        if ((lifetime > 0 && inactiveContact.nbInactiveSteps > lifetime)
+            || !isInGraph(inactiveContact.model1.get()) || !isInGraph(inactiveContact.model2.get()))
+        {
+            inactiveContact.contact->cleanup();
+            it = inactiveContactMap.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
 }
 
 void CollisionResponse::reset()
@@ -119,6 +186,7 @@ void CollisionResponse::changeInstance(Instance inst)
     core::collision::ContactManager::changeInstance(inst);
     storedContactMap[instance].swap(contactMap);
     contactMap.swap(storedContactMap[inst]);
+    clearInactiveContacts();
 }
 
 void CollisionResponse::createContacts(const DetectionOutputMap& outputsMap)
@@ -147,6 +215,17 @@ void CollisionResponse::createNewContacts(const core::collision::ContactManager:
 {
     std::stringstream errorStream;
 
+    if (!d_reuseInactiveContacts.getValue() && !inactiveContactMap.empty())
+    {
+        clearInactiveContacts();
+    }
+    else
+    {
+        releaseExpiredInactiveContacts();
+    }
+
+    concurrentContactUpdates.clear();
+
     for (const auto& [models, output] : outputsMap)
     {
         const auto contactInsert = contactMap.insert(ContactMap::value_type(models, core::collision::Contact::SPtr()));
@@ -168,7 +247,35 @@ void CollisionResponse::createNewContacts(const core::collision::ContactManager:
             }
             else
             {
-                auto contact = core::collision::Contact::Create(responseUsed, model1, model2, intersectionMethod,notMuted());
+                core::collision::Contact::SPtr contact;
+
+                // a contact kept from a previous time step is reused if the response did not change
+                const auto inactiveIt = inactiveContactMap.find(models);
+                if (inactiveIt != inactiveContactMap.end())
+                {
+                    if (inactiveIt->second.response == responseUsed)
+                    {
+                        contact = inactiveIt->second.contact;
+                    }
+                    else
+                    {
+                        inactiveIt->second.contact->cleanup();
+                    }
+                    inactiveContactMap.erase(inactiveIt);
+                }
+
+                if (contact == nullptr)
+                {
+                    contact = core::collision::Contact::Create(responseUsed, model1, model2, intersectionMethod,notMuted());
+
+                    if (contact != nullptr)
+                    {
+                        contact->setName(model1->getName() + std::string("-") + model2->getName());
+                        setContactTags(model1, model2, contact);
+                        contact->f_printLog.setValue(notMuted());
+                        contact->init();
+                    }
+                }
 
                 if (contact == nullptr)
                 {
@@ -178,13 +285,9 @@ void CollisionResponse::createNewContacts(const core::collision::ContactManager:
                 }
                 else
                 {
-                    //add the contact to the list of contacts and setup some data
+                    //add the contact to the list of contacts
                     contactIt->second = contact;
-                    contact->setName(model1->getName() + std::string("-") + model2->getName());
-                    setContactTags(model1, model2, contact);
-                    contact->f_printLog.setValue(notMuted());
-                    contact->init();
-                    contact->setDetectionOutputs(output);
+                    setDetectionOutputs(contact.get(), output);
                     ++nbContact;
                 }
             }
@@ -192,14 +295,57 @@ void CollisionResponse::createNewContacts(const core::collision::ContactManager:
         else
         {
             // pre-existing and still active contact
-            contactIt->second->setDetectionOutputs(output);
+            setDetectionOutputs(contactIt->second.get(), output);
             ++nbContact;
         }
     }
 
+    updateConcurrentContacts();
+
     msg_error_when(!errorStream.str().empty()) << errorStream.str();
 }
 
+void CollisionResponse::setDetectionOutputs(core::collision::Contact* contact, core::collision::DetectionOutputVector* outputs)
+{
+    if (d_parallelContactUpdate.getValue())
+    {
+        if (auto* concurrentContact = dynamic_cast<ConcurrentContact*>(contact))
+        {
+            concurrentContactUpdates.push_back({contact, concurrentContact, outputs, false});
+            return;
+        }
+    }
+    contact->setDetectionOutputs(outputs);
+}
+
+void CollisionResponse::updateConcurrentContacts()
+{
+    if (concurrentContactUpdates.empty())
+        return;
+
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+    assert(taskScheduler);
+
+    simulation::forEachRange(simulation::ForEachExecutionPolicy::PARALLEL, *taskScheduler,
+        concurrentContactUpdates.begin(), concurrentContactUpdates.end(),
+        [](const auto& range)
+        {
+            for (auto it = range.start; it != range.end; ++it)
+            {
+                it->isUpdated = it->concurrentContact->updateResponse(it->outputs);
+            }
+        });
+
+    // The contacts which could not be updated concurrently (e.g. their response is not created yet)
+    for (const auto& update : concurrentContactUpdates)
+    {
+        if (!update.isUpdated)
+        {
+            update.contact->setDetectionOutputs(update.outputs);
+        }
+    }
+}
+
 void
 CollisionResponse::removeInactiveContacts(const core::collision::ContactManager::DetectionOutputMap &outputsMap,
                                               Size& nbContact)
@@ -224,7 +370,18 @@ CollisionResponse::removeInactiveContacts(const core::collision::ContactManager:
             else
             {
                 contact->removeResponse();
-                contact->cleanup();
+                if (d_reuseInactiveContacts.getValue())
+                {
+                    // the contact keeps its mappings and constraints for a next collision between the same models
+                    core::CollisionModel* model1 = contactIt->first.first;
+                    core::CollisionModel* model2 = contactIt->first.second;
+                    inactiveContactMap.emplace(contactIt->first,
+                        InactiveContact{getContactResponse(model1, model2), contact, model1, model2});
+                }
+                else
+                {
+                    contact->cleanup();
+                }
                 contact.reset();
                 contactIt = contactMap.erase(contactIt);
             }
@@ -372,6 +529,20 @@ void CollisionResponse::removeContacts(const ContactVector &c)
             }
         }
 
+        // Contacts kept for reuse
+        for (auto inactive_it = inactiveContactMap.begin(); inactive_it != inactiveContactMap.end();)
+        {
+            if (inactive_it->second.contact == *remove_it)
+            {
+                inactive_it->second.contact->cleanup();
+                inactive_it = inactiveContactMap.erase(inactive_it);
+            }
+            else
+            {
+                ++inactive_it;
+            }
+        }
+
         ++remove_it;
     }
 }
@@ -26,6 +26,7 @@
 #include <sofa/simulation/fwd.h>
 #include <sofa/helper/OptionsGroup.h>
 #include <sofa/helper/map_ptr_stable_compare.h>
+#include <sofa/component/collision/response/contact/ConcurrentContact.h>
 
 #include <sofa/core/objectmodel/RenamedData.h>
 
@@ -46,6 +47,9 @@ public :
 
     Data<sofa::helper::OptionsGroup> d_response; ///< contact response class
     Data<std::string> d_responseParams; ///< contact response parameters (syntax: name1=value1&name2=value2&...)
+    Data<bool> d_parallelContactUpdate; ///< If true, the responses of the contacts already created are updated in parallel, one task per pair of collision models
+    Data<bool> d_reuseInactiveContacts; ///< If true, the contacts which are no longer active are kept, with their mappings and constraints, and reused when the same pair of collision models collides again
+    Data<unsigned int> d_inactiveContactLifetime; ///< Number of time steps an inactive contact is kept for reuse before being released (0 to keep it as long as its collision models are in the scene graph)
 
     /// outputsVec fixes the reproducibility problems by storing contacts in the collision detection saved order
     /// if not given, it is still working but with eventual reproducibility problems
@@ -108,6 +112,9 @@ public :
 
     std::string getDefaultResponseType() const { return d_response.getValue().getSelectedItem(); }
 
+    /// Number of contacts no longer active, kept for reuse
+    std::size_t getNbInactiveContacts() const { return inactiveContactMap.size(); }
+
 protected:
     typedef sofa::helper::map_ptr_stable_compare<
                 /* key */  std::pair<core::CollisionModel*, core::CollisionModel*>,
@@ -120,8 +127,35 @@ protected:
     static void setContactTags(core::CollisionModel* model1, core::CollisionModel* model2,
                         core::collision::Contact::SPtr contact);
 
+    /// Contact no longer active, kept for reuse
+    struct InactiveContact
+    {
+        std::string response; ///< Response the contact was created for
+        core::collision::Contact::SPtr contact;
+        /// The collision models are kept alive as long as the contact, so that their addresses cannot be reused
+        core::CollisionModel::SPtr model1;
+        core::CollisionModel::SPtr model2;
+        unsigned int nbInactiveSteps { 0 };
+    };
+
+    typedef std::map<
+                /* key */  std::pair<core::CollisionModel*, core::CollisionModel*>,
+                /* value */InactiveContact
+            > InactiveContactMap;
+
+    /// Contact whose detection outputs are set, and whose response is updated, in a task
+    struct ConcurrentContactUpdate
+    {
+        core::collision::Contact* contact { nullptr };
+        ConcurrentContact* concurrentContact { nullptr };
+        core::collision::DetectionOutputVector* outputs { nullptr };
+        bool isUpdated { false };
+    };
+
     ContactMap contactMap;
     std::map<Instance,ContactMap> storedContactMap;
+    InactiveContactMap inactiveContactMap;
+    sofa::type::vector<ConcurrentContactUpdate> concurrentContactUpdates;
 
     void changeInstance(Instance inst) override ;
 
@@ -139,6 +173,21 @@ protected:
 
     void removeInactiveContacts(const DetectionOutputMap &outputsMap, Size& nbContact);
 
+    /// Set the detection outputs of a contact, or defer it to the parallel update of the contacts
+    void setDetectionOutputs(core::collision::Contact* contact, core::collision::DetectionOutputVector* outputs);
+
+    /// Set the detection outputs of the contacts deferred by setDetectionOutputs
+    void updateConcurrentContacts();
+
+    /// Cleanup and release the contacts kept for reuse
+    void clearInactiveContacts();
+
+    /// Cleanup and release the inactive contacts whose lifetime is over, or whose collision models left the scene graph
+    void releaseExpiredInactiveContacts();
+
+    /// Is the collision model still in the same scene graph as this component
+    bool isInGraph(const core::CollisionModel* model) const;
+
     /// compute and set the number of contacts attached to each collision model
     /// The number of contacts corresponds to the number of collision models
     /// currently in contact with a collision model.
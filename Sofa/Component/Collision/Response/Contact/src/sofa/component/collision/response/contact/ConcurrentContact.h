@@ -0,0 +1,50 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/collision/response/contact/config.h>
+
+#include <sofa/core/collision/DetectionOutput.h>
+
+namespace sofa::component::collision::response::contact
+{
+
+/**
+ * Interface for the contacts whose response can be updated from a worker thread.
+ *
+ * Once a contact has created its response (mappings and constraints), the following steps
+ * only change the content of the objects it owns. Such contacts can be updated concurrently
+ * for the different pairs of collision models, while the creation of new responses, which
+ * modifies the scene graph, remains sequential.
+ */
+class SOFA_COMPONENT_COLLISION_RESPONSE_CONTACT_API ConcurrentContact
+{
+public:
+    virtual ~ConcurrentContact() = default;
+
+    /// Set the detection outputs and update the response already created by this contact.
+    /// The method must only write in the objects owned by this contact.
+    /// @return false if the response cannot be updated concurrently (for instance if it has
+    /// not been created yet). In that case, the contact is left untouched.
+    virtual bool updateResponse(core::collision::DetectionOutputVector* outputs) = 0;
+};
+
+} // namespace sofa::component::collision::response::contact
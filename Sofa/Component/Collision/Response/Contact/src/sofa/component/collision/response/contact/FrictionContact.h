@@ -29,13 +29,14 @@
 #include <sofa/component/constraint/lagrangian/model/UnilateralLagrangianConstraint.h>
 #include <sofa/component/collision/response/mapper/BaseContactMapper.h>
 #include <sofa/component/collision/response/contact/ContactIdentifier.h>
+#include <sofa/component/collision/response/contact/ConcurrentContact.h>
 
 #include <sofa/core/objectmodel/RenamedData.h>
 
 namespace sofa::component::collision::response::contact
 {
 template <class TCollisionModel1, class TCollisionModel2, class ResponseDataTypes = sofa::defaulttype::Vec3Types >
-class FrictionContact : public core::collision::Contact, public ContactIdentifier
+class FrictionContact : public core::collision::Contact, public ContactIdentifier, public ConcurrentContact
 {
 public:
     SOFA_CLASS(SOFA_TEMPLATE3(FrictionContact, TCollisionModel1, TCollisionModel2, ResponseDataTypes), core::collision::Contact);
@@ -75,9 +76,13 @@ protected:
     Data<double> d_tol; ///< tolerance for the constraints resolution (0 for default tolerance)
     std::vector< sofa::core::collision::DetectionOutput* > contacts;
     std::vector< std::pair< std::pair<int, int>, double > > mappedContacts;
+    bool m_isResponseUpdated { false }; ///< true if the response has already been computed by updateResponse
 
     virtual void activateMappers();
 
+    /// Update the mappers and fill the constraint with the current contacts
+    void computeResponse();
+
     void setInteractionTags(MechanicalState1* mstate1, MechanicalState2* mstate2);
 
     FrictionContact();
@@ -91,6 +96,8 @@ public:
 
     void setDetectionOutputs(OutputVector* outputs) override;
 
+    bool updateResponse(OutputVector* outputs) override;
+
     void createResponse(core::objectmodel::BaseContext* group) override;
 
     void removeResponse() override;
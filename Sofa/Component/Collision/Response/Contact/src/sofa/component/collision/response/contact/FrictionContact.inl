@@ -86,6 +86,7 @@ void FrictionContact<TCollisionModel1,TCollisionModel2,ResponseDataTypes>::clean
 
     contacts.clear();
     mappedContacts.clear();
+    m_isResponseUpdated = false;
 }
 
 
@@ -203,44 +204,69 @@ void FrictionContact<TCollisionModel1,TCollisionModel2,ResponseDataTypes>::activ
 }
 
 template < class TCollisionModel1, class TCollisionModel2, class ResponseDataTypes  >
-void FrictionContact<TCollisionModel1,TCollisionModel2,ResponseDataTypes>::createResponse(core::objectmodel::BaseContext* group)
+void FrictionContact<TCollisionModel1,TCollisionModel2,ResponseDataTypes>::computeResponse()
 {
-
     activateMappers();
-    const double mu_ = this->d_mu.getValue();
-    // Checks if friction is considered
-    if ( mu_ < 0.0 )
-        msg_error() << "mu has to take positive values";
 
-    if (m_constraint)
+    const double mu_ = this->d_mu.getValue();
+    int i=0;
+    for (std::vector<sofa::core::collision::DetectionOutput*>::const_iterator it = contacts.begin(); it!=contacts.end(); it++, i++)
     {
-        int i=0;
-        for (std::vector<sofa::core::collision::DetectionOutput*>::const_iterator it = contacts.begin(); it!=contacts.end(); it++, i++)
-        {
-            const sofa::core::collision::DetectionOutput* o = *it;
-            const int index1 = mappedContacts[i].first.first;
-            const int index2 = mappedContacts[i].first.second;
-            const double distance = mappedContacts[i].second;
+        const sofa::core::collision::DetectionOutput* o = *it;
+        const int index1 = mappedContacts[i].first.first;
+        const int index2 = mappedContacts[i].first.second;
+        const double distance = mappedContacts[i].second;
 
-            // Polynome de Cantor de NxN sur N bijectif f(x,y)=((x+y)^2+3x+y)/2
-            const long index = cantorPolynomia(o->id /*cantorPolynomia(index1, index2)*/,id);
+        // Polynome de Cantor de NxN sur N bijectif f(x,y)=((x+y)^2+3x+y)/2
+        const long index = cantorPolynomia(o->id /*cantorPolynomia(index1, index2)*/,id);
 
-            // Add contact in unilateral constraint
-            m_constraint->addContact(mu_, o->normal, distance, index1, index2, index, o->id);
-        }
+        // Add contact in unilateral constraint
+        m_constraint->addContact(mu_, o->normal, distance, index1, index2, index, o->id);
+    }
+}
 
-        if (parent!=nullptr)
-        {
-            parent->removeObject(this);
-            parent->removeObject(m_constraint);
-        }
+template < class TCollisionModel1, class TCollisionModel2, class ResponseDataTypes  >
+bool FrictionContact<TCollisionModel1,TCollisionModel2,ResponseDataTypes>::updateResponse(OutputVector* outputs)
+{
+    // The creation of the mappings and of the constraint modifies the scene graph:
+    // it is left to the sequential call to createResponse
+    if (!m_constraint || outputs == nullptr)
+        return false;
+
+    setDetectionOutputs(outputs);
+    computeResponse();
+    m_isResponseUpdated = true;
+    return true;
+}
 
-        parent = group;
-        if (parent!=nullptr)
-        {
-            parent->addObject(this);
-            parent->addObject(m_constraint);
-        }
+template < class TCollisionModel1, class TCollisionModel2, class ResponseDataTypes  >
+void FrictionContact<TCollisionModel1,TCollisionModel2,ResponseDataTypes>::createResponse(core::objectmodel::BaseContext* group)
+{
+    const bool isResponseUpdated = m_isResponseUpdated;
+    m_isResponseUpdated = false;
+
+    if (!isResponseUpdated)
+        computeResponse();
+
+    // Checks if friction is considered
+    if ( this->d_mu.getValue() < 0.0 )
+        msg_error() << "mu has to take positive values";
+
+    // A response updated by updateResponse is already in the right group
+    if (isResponseUpdated && parent == group)
+        return;
+
+    if (parent!=nullptr)
+    {
+        parent->removeObject(this);
+        parent->removeObject(m_constraint);
+    }
+
+    parent = group;
+    if (parent!=nullptr)
+    {
+        parent->addObject(this);
+        parent->addObject(m_constraint);
     }
 }
 
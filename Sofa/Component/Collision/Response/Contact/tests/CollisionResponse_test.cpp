@@ -0,0 +1,255 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/collision/response/contact/CollisionResponse.h>
+#include <sofa/component/statecontainer/MechanicalObject.h>
+#include <sofa/testing/BaseTest.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simulation/Simulation.h>
+#include <sofa/simulation/common/SceneLoaderXML.h>
+
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+using sofa::component::collision::response::contact::CollisionResponse;
+using sofa::component::statecontainer::MechanicalObject;
+using sofa::simulation::SceneLoaderXML;
+using sofa::defaulttype::Vec3Types;
+
+/// Spheres of radius 0.5 over a fixed layer of spheres of the same radius, in contact as soon as the simulation starts.
+/// Each body is a collision model of nbSpheresPerBody spheres, so that there is one contact per body.
+std::string createScene(unsigned int nbBodies, unsigned int nbSpheresPerBody, const std::string& gravity,
+                        const std::string& responseAttributes)
+{
+    std::ostringstream scene;
+    scene << R"(
+    <Node name="root" gravity=")" << gravity << R"(" dt="0.01">
+        <RequiredPlugin name="Sofa.Component.AnimationLoop"/>
+        <RequiredPlugin name="Sofa.Component.Collision.Detection.Algorithm"/>
+        <RequiredPlugin name="Sofa.Component.Collision.Detection.Intersection"/>
+        <RequiredPlugin name="Sofa.Component.Collision.Geometry"/>
+        <RequiredPlugin name="Sofa.Component.Collision.Response.Contact"/>
+        <RequiredPlugin name="Sofa.Component.Constraint.Lagrangian.Correction"/>
+        <RequiredPlugin name="Sofa.Component.Constraint.Lagrangian.Solver"/>
+        <RequiredPlugin name="Sofa.Component.LinearSolver.Iterative"/>
+        <RequiredPlugin name="Sofa.Component.Mass"/>
+        <RequiredPlugin name="Sofa.Component.ODESolver.Backward"/>
+        <RequiredPlugin name="Sofa.Component.StateContainer"/>
+
+        <FreeMotionAnimationLoop/>
+        <GenericConstraintSolver maxIterations="1000" tolerance="1e-10"/>
+        <CollisionPipeline/>
+        <BruteForceBroadPhase/>
+        <BVHNarrowPhase/>
+        <MinProximityIntersection alarmDistance="0.3" contactDistance="0.05"/>
+        <CollisionResponse name="response" response="FrictionContactConstraint" responseParams="mu=0.3" )"
+          << responseAttributes << R"(/>
+
+        <Node name="Obstacle">
+            <MechanicalObject name="dofs" position=")";
+    for (unsigned int b = 0; b < nbBodies; ++b)
+    {
+        for (unsigned int s = 0; s < nbSpheresPerBody; ++s)
+        {
+            scene << 2 * s << " " << 2 * b << " 0 ";
+        }
+    }
+    scene << R"("/>
+            <SphereCollisionModel radius="0.5" simulated="0" moving="0"/>
+        </Node>)";
+
+    for (unsigned int b = 0; b < nbBodies; ++b)
+    {
+        scene << R"(
+        <Node name="Body)" << b << R"(">
+            <EulerImplicitSolver rayleighStiffness="0" rayleighMass="0"/>
+            <CGLinearSolver iterations="25" tolerance="1e-10" threshold="1e-10"/>
+            <MechanicalObject name="dofs" position=")";
+        for (unsigned int s = 0; s < nbSpheresPerBody; ++s)
+        {
+            // slightly shifted, so that the contact normals are not all vertical
+            scene << 2 * s + 0.1 * s / nbSpheresPerBody << " " << 2 * b - 0.05 * b << " 1.2 ";
+        }
+        scene << R"("/>
+            <UniformMass totalMass="1"/>
+            <UncoupledConstraintCorrection/>
+            <SphereCollisionModel radius="0.5"/>
+        </Node>)";
+    }
+    scene << R"(
+    </Node>)";
+    return scene.str();
+}
+
+MechanicalObject<Vec3Types>* getBodyState(sofa::simulation::Node* root, unsigned int body)
+{
+    return dynamic_cast<MechanicalObject<Vec3Types>*>(root->getChild("Body" + std::to_string(body))->getMechanicalState());
+}
+
+/// The constraint matrix and the positions of all the bodies, written with all their digits
+std::string writeBodies(sofa::simulation::Node* root, unsigned int nbBodies)
+{
+    std::ostringstream out;
+    out << std::setprecision(17);
+    for (unsigned int b = 0; b < nbBodies; ++b)
+    {
+        const auto* state = getBodyState(root, b);
+        out << "Body" << b << " constraints: " << state->read(sofa::core::ConstMatrixDerivId::constraintJacobian())->getValue()
+            << " positions: " << state->read(sofa::core::ConstVecCoordId::position())->getValue() << "\n";
+    }
+    return out.str();
+}
+
+/// Place the single sphere of the body 0 at the given height, at rest
+void moveBody(sofa::simulation::Node* root, SReal height)
+{
+    auto* state = getBodyState(root, 0);
+    for (const auto& vecId : { sofa::core::VecCoordId::position(), sofa::core::VecCoordId::freePosition() })
+    {
+        auto positions = sofa::helper::getWriteAccessor(*state->write(vecId));
+        positions[0] = sofa::type::Vec3(0, 0, height);
+    }
+    for (const auto& vecId : { sofa::core::VecDerivId::velocity(), sofa::core::VecDerivId::freeVelocity() })
+    {
+        auto velocities = sofa::helper::getWriteAccessor(*state->write(vecId));
+        velocities[0] = sofa::type::Vec3();
+    }
+}
+
+}
+
+struct CollisionResponse_test : public sofa::testing::BaseTest
+{
+    sofa::simulation::Node::SPtr loadScene(const std::string& scene)
+    {
+        auto root = SceneLoaderXML::loadFromMemory("testscene", scene.c_str());
+        EXPECT_NE(root, nullptr);
+        if (root)
+        {
+            sofa::simulation::node::initRoot(root.get());
+        }
+        return root;
+    }
+
+    static const sofa::core::collision::ContactManager::ContactVector& getContacts(sofa::simulation::Node* root)
+    {
+        return root->get<CollisionResponse>()->getContacts();
+    }
+};
+
+TEST_F(CollisionResponse_test, parallelContactUpdate)
+{
+    constexpr unsigned int nbBodies = 6;
+    constexpr unsigned int nbSpheresPerBody = 4;
+    constexpr unsigned int nbSteps = 20;
+
+    const auto sequential = loadScene(createScene(nbBodies, nbSpheresPerBody, "0 0 -9.81", R"(parallelContactUpdate="false")"));
+    const auto parallel = loadScene(createScene(nbBodies, nbSpheresPerBody, "0 0 -9.81", R"(parallelContactUpdate="true")"));
+    ASSERT_NE(sequential, nullptr);
+    ASSERT_NE(parallel, nullptr);
+
+    for (unsigned int step = 0; step < nbSteps; ++step)
+    {
+        sofa::simulation::node::animate(sequential.get());
+        sofa::simulation::node::animate(parallel.get());
+
+        ASSERT_EQ(getContacts(sequential.get()).size(), nbBodies) << "step " << step;
+        ASSERT_EQ(getContacts(parallel.get()).size(), nbBodies) << "step " << step;
+
+        // the contacts are updated independently, then the constraints are built in the same order
+        ASSERT_EQ(writeBodies(sequential.get(), nbBodies), writeBodies(parallel.get(), nbBodies)) << "step " << step;
+    }
+
+    sofa::simulation::node::unload(sequential);
+    sofa::simulation::node::unload(parallel);
+}
+
+TEST_F(CollisionResponse_test, reuseInactiveContact)
+{
+    const auto root = loadScene(createScene(1, 1, "0 0 0", R"(reuseInactiveContacts="true" inactiveContactLifetime="5")"));
+    ASSERT_NE(root, nullptr);
+
+    moveBody(root.get(), 1.2);
+    sofa::simulation::node::animate(root.get());
+    ASSERT_EQ(getContacts(root.get()).size(), 1u);
+    const sofa::core::collision::Contact::SPtr contact = getContacts(root.get()).front();
+
+    // the bodies separate for fewer steps than the lifetime of the inactive contacts
+    for (unsigned int step = 0; step < 3; ++step)
+    {
+        moveBody(root.get(), 3);
+        sofa::simulation::node::animate(root.get());
+        EXPECT_TRUE(getContacts(root.get()).empty());
+    }
+
+    moveBody(root.get(), 1.2);
+    sofa::simulation::node::animate(root.get());
+    ASSERT_EQ(getContacts(root.get()).size(), 1u);
+    EXPECT_EQ(getContacts(root.get()).front(), contact);
+    EXPECT_EQ(root->get<CollisionResponse>()->getNbInactiveContacts(), 0u);
+
+    // the bodies separate for longer than the lifetime: the inactive contact is released
+    // (it is kept alive by the test, so that a new contact cannot have the same address)
+    for (unsigned int step = 0; step < 7; ++step)
+    {
+        moveBody(root.get(), 3);
+        sofa::simulation::node::animate(root.get());
+        EXPECT_TRUE(getContacts(root.get()).empty());
+    }
+    EXPECT_EQ(root->get<CollisionResponse>()->getNbInactiveContacts(), 0u);
+
+    moveBody(root.get(), 1.2);
+    sofa::simulation::node::animate(root.get());
+    ASSERT_EQ(getContacts(root.get()).size(), 1u);
+    EXPECT_NE(getContacts(root.get()).front(), contact);
+
+    sofa::simulation::node::unload(root);
+}
+
+TEST_F(CollisionResponse_test, releaseInactiveContactOfRemovedModel)
+{
+    const auto root = loadScene(createScene(1, 1, "0 0 0", R"(reuseInactiveContacts="true" inactiveContactLifetime="0")"));
+    ASSERT_NE(root, nullptr);
+    auto* response = root->get<CollisionResponse>();
+
+    moveBody(root.get(), 1.2);
+    sofa::simulation::node::animate(root.get());
+    ASSERT_EQ(getContacts(root.get()).size(), 1u);
+
+    // without lifetime, the inactive contact is kept as long as both collision models are in the scene graph
+    for (unsigned int step = 0; step < 3; ++step)
+    {
+        moveBody(root.get(), 3);
+        sofa::simulation::node::animate(root.get());
+        EXPECT_TRUE(getContacts(root.get()).empty());
+        EXPECT_EQ(response->getNbInactiveContacts(), 1u);
+    }
+
+    // the body leaves the scene graph while its contact is inactive
+    const sofa::simulation::Node::SPtr body = root->getChild("Body0");
+    root->removeChild(body);
+    sofa::simulation::node::animate(root.get());
+    EXPECT_EQ(response->getNbInactiveContacts(), 0u);
+
+    sofa::simulation::node::unload(root);
+}
@@ -0,0 +1,399 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/constraint/lagrangian/correction/ComplianceFile.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef WIN32
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace sofa::component::constraint::lagrangian::correction
+{
+
+namespace
+{
+
+constexpr char Magic[8] = { 'S', 'O', 'F', 'A', 'C', 'O', 'M', 'P' };
+
+static_assert(sizeof(ComplianceFile::Header) == 48, "The header of the compliance files must not be padded");
+
+/// Convert n values stored with the given scalar size into the given precision
+template<class Real>
+void convert(const char* in, std::size_t n, std::uint32_t scalarSize, Real* out)
+{
+    if (scalarSize == sizeof(float))
+    {
+        const float* values = reinterpret_cast<const float*>(in);
+        std::copy(values, values + n, out);
+    }
+    else
+    {
+        const double* values = reinterpret_cast<const double*>(in);
+        std::copy(values, values + n, out);
+    }
+}
+
+/// Convert n values into the given scalar size
+template<class Real>
+void convert(const Real* in, std::size_t n, std::uint32_t scalarSize, char* out)
+{
+    if (scalarSize == sizeof(float))
+        std::copy(in, in + n, reinterpret_cast<float*>(out));
+    else
+        std::copy(in, in + n, reinterpret_cast<double*>(out));
+}
+
+#if SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_HAVE_ZLIB
+std::uint64_t getNbBlocks(const ComplianceFile::Header& header)
+{
+    return (header.nbRows + header.nbRowsPerBlock - 1) / header.nbRowsPerBlock;
+}
+#endif
+
+} // namespace
+
+ComplianceFile::~ComplianceFile()
+{
+    close();
+}
+
+bool ComplianceFile::open(const std::string& path)
+{
+    close();
+    m_path = path;
+
+    std::ifstream file(path, std::ifstream::binary);
+    if (!file.is_open())
+        return false;
+
+    if (!file.read(reinterpret_cast<char*>(&m_header), sizeof(Header))
+        || std::memcmp(m_header.magic, Magic, sizeof(Magic)) != 0)
+    {
+        return false;
+    }
+
+    if (m_header.version > Version)
+    {
+        msg_error("ComplianceFile") << "The compliance file " << path << " has the version " << m_header.version
+            << " which is not supported (up to version " << Version << ")";
+        return false;
+    }
+
+    if (m_header.scalarSize != sizeof(float) && m_header.scalarSize != sizeof(double))
+    {
+        msg_error("ComplianceFile") << "Invalid scalar size " << m_header.scalarSize << " in " << path;
+        return false;
+    }
+
+    if (m_header.compression == static_cast<std::uint32_t>(Compression::ZlibBlocks))
+    {
+        if (m_header.nbRowsPerBlock == 0)
+        {
+            msg_error("ComplianceFile") << "Invalid number of rows per block in " << path;
+            return false;
+        }
+    }
+    else if (m_header.compression != static_cast<std::uint32_t>(Compression::None))
+    {
+        msg_error("ComplianceFile") << "Unknown compression " << m_header.compression << " in " << path;
+        return false;
+    }
+
+    return true;
+}
+
+const void* ComplianceFile::map()
+{
+    if (m_mapping)
+        return m_mapping + m_header.dataOffset;
+
+    if (m_header.compression != static_cast<std::uint32_t>(Compression::None))
+        return nullptr;
+
+    const std::uint64_t dataSize = m_header.nbRows * m_header.nbCols * m_header.scalarSize;
+
+#ifdef WIN32
+    m_fileHandle = CreateFileA(m_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        m_fileHandle = nullptr;
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_fileHandle, &fileSize) || static_cast<std::uint64_t>(fileSize.QuadPart) < m_header.dataOffset + dataSize)
+    {
+        close();
+        return nullptr;
+    }
+
+    m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mappingHandle == nullptr)
+    {
+        close();
+        return nullptr;
+    }
+
+    m_mapping = static_cast<const char*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (m_mapping == nullptr)
+    {
+        close();
+        return nullptr;
+    }
+    m_mappingSize = static_cast<std::uint64_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(m_path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || static_cast<std::uint64_t>(fileStat.st_size) < m_header.dataOffset + dataSize)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // The mapping stays valid after closing the file descriptor
+    void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    m_mapping = static_cast<const char*>(mapping);
+    m_mappingSize = static_cast<std::uint64_t>(fileStat.st_size);
+#endif
+
+    return m_mapping + m_header.dataOffset;
+}
+
+void ComplianceFile::close()
+{
+#ifdef WIN32
+    if (m_mapping)
+        UnmapViewOfFile(m_mapping);
+    if (m_mappingHandle)
+        CloseHandle(m_mappingHandle);
+    if (m_fileHandle)
+        CloseHandle(m_fileHandle);
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    if (m_mapping)
+        munmap(const_cast<char*>(m_mapping), m_mappingSize);
+#endif
+    m_mapping = nullptr;
+    m_mappingSize = 0;
+}
+
+template<class Real>
+bool ComplianceFile::read(Real* matrix)
+{
+    std::ifstream file(m_path, std::ifstream::binary);
+    if (!file.is_open())
+        return false;
+    file.seekg(static_cast<std::streamoff>(m_header.dataOffset));
+
+    const std::uint64_t rowSize = m_header.nbCols * m_header.scalarSize;
+
+    if (m_header.compression == static_cast<std::uint32_t>(Compression::None))
+    {
+        if (m_header.scalarSize == sizeof(Real))
+        {
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(matrix), m_header.nbRows * rowSize));
+        }
+
+        std::vector<char> row(rowSize);
+        for (std::uint64_t i = 0; i < m_header.nbRows; ++i)
+        {
+            if (!file.read(row.data(), rowSize))
+                return false;
+            convert(row.data(), m_header.nbCols, m_header.scalarSize, matrix + i * m_header.nbCols);
+        }
+        return true;
+    }
+
+#if SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_HAVE_ZLIB
+    std::vector<std::uint64_t> blockSizes(getNbBlocks(m_header));
+    if (!file.read(reinterpret_cast<char*>(blockSizes.data()), blockSizes.size() * sizeof(std::uint64_t)))
+        return false;
+
+    std::vector<char> compressed, block(m_header.nbRowsPerBlock * rowSize);
+    for (std::uint64_t b = 0; b < blockSizes.size(); ++b)
+    {
+        const std::uint64_t firstRow = b * m_header.nbRowsPerBlock;
+        const std::uint64_t nbRows = std::min<std::uint64_t>(m_header.nbRowsPerBlock, m_header.nbRows - firstRow);
+
+        compressed.resize(blockSizes[b]);
+        if (!file.read(compressed.data(), blockSizes[b]))
+            return false;
+
+        uLongf blockSize = static_cast<uLongf>(nbRows * rowSize);
+        if (uncompress(reinterpret_cast<Bytef*>(block.data()), &blockSize,
+                       reinterpret_cast<const Bytef*>(compressed.data()), static_cast<uLong>(compressed.size())) != Z_OK
+            || blockSize != nbRows * rowSize)
+        {
+            msg_error("ComplianceFile") << "Cannot uncompress the block " << b << " of " << m_path;
+            return false;
+        }
+
+        convert(block.data(), nbRows * m_header.nbCols, m_header.scalarSize, matrix + firstRow * m_header.nbCols);
+    }
+    return true;
+#else
+    msg_error("ComplianceFile") << "The compliance file " << m_path << " is compressed, but zlib is not available";
+    return false;
+#endif
+}
+
+template<class Real>
+bool ComplianceFile::readLegacy(const std::string& path, Real* matrix, std::uint64_t nbRows, std::uint64_t nbCols)
+{
+    std::ifstream file(path, std::ifstream::binary | std::ifstream::ate);
+    if (!file.is_open())
+        return false;
+
+    if (static_cast<std::uint64_t>(file.tellg()) != nbRows * nbCols * sizeof(Real))
+    {
+        msg_error("ComplianceFile") << "File " << path << " does not store a " << nbRows << "x" << nbCols << " compliance";
+        return false;
+    }
+    file.seekg(0);
+
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(matrix), nbRows * nbCols * sizeof(Real)));
+}
+
+template<class Real>
+bool ComplianceFile::write(const std::string& path, const Real* matrix, std::uint64_t nbRows, std::uint64_t nbCols,
+                           bool singlePrecision, bool compress, std::uint32_t nbRowsPerBlock)
+{
+    Header header {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.scalarSize = singlePrecision ? sizeof(float) : sizeof(Real);
+    header.nbRows = nbRows;
+    header.nbCols = nbCols;
+
+    if (compress && !isCompressionSupported())
+    {
+        msg_warning("ComplianceFile") << "zlib is not available: the compliance file " << path << " is not compressed";
+        compress = false;
+    }
+
+    std::ofstream file(path, std::ofstream::binary);
+    if (!file.is_open())
+        return false;
+
+    const std::uint64_t rowSize = nbCols * header.scalarSize;
+
+    if (!compress)
+    {
+        header.compression = static_cast<std::uint32_t>(Compression::None);
+        header.dataOffset = DataAlignment;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+        const std::vector<char> padding(DataAlignment - sizeof(Header), 0);
+        file.write(padding.data(), padding.size());
+
+        if (header.scalarSize == sizeof(Real))
+        {
+            file.write(reinterpret_cast<const char*>(matrix), nbRows * rowSize);
+        }
+        else
+        {
+            std::vector<char> row(rowSize);
+            for (std::uint64_t i = 0; i < nbRows; ++i)
+            {
+                convert(matrix + i * nbCols, nbCols, header.scalarSize, row.data());
+                file.write(row.data(), rowSize);
+            }
+        }
+        return static_cast<bool>(file);
+    }
+
+#if SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_HAVE_ZLIB
+    header.compression = static_cast<std::uint32_t>(Compression::ZlibBlocks);
+    header.nbRowsPerBlock = std::max<std::uint32_t>(nbRowsPerBlock, 1);
+    header.dataOffset = sizeof(Header);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+    // the table of the compressed sizes is written once all the blocks are compressed
+    std::vector<std::uint64_t> blockSizes(getNbBlocks(header), 0);
+    file.write(reinterpret_cast<const char*>(blockSizes.data()), blockSizes.size() * sizeof(std::uint64_t));
+
+    std::vector<char> block(header.nbRowsPerBlock * rowSize), compressed;
+    for (std::uint64_t b = 0; b < blockSizes.size(); ++b)
+    {
+        const std::uint64_t firstRow = b * header.nbRowsPerBlock;
+        const std::uint64_t blockNbRows = std::min<std::uint64_t>(header.nbRowsPerBlock, nbRows - firstRow);
+        const uLong blockSize = static_cast<uLong>(blockNbRows * rowSize);
+
+        convert(matrix + firstRow * nbCols, blockNbRows * nbCols, header.scalarSize, block.data());
+
+        uLongf compressedSize = compressBound(blockSize);
+        compressed.resize(compressedSize);
+        if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressedSize,
+                      reinterpret_cast<const Bytef*>(block.data()), blockSize, Z_DEFAULT_COMPRESSION) != Z_OK)
+        {
+            msg_error("ComplianceFile") << "Cannot compress the block " << b << " of " << path;
+            return false;
+        }
+
+        file.write(compressed.data(), compressedSize);
+        blockSizes[b] = compressedSize;
+    }
+
+    file.seekp(static_cast<std::streamoff>(header.dataOffset));
+    file.write(reinterpret_cast<const char*>(blockSizes.data()), blockSizes.size() * sizeof(std::uint64_t));
+    return static_cast<bool>(file);
+#else
+    SOFA_UNUSED(nbRowsPerBlock);
+    return false;
+#endif
+}
+
+bool ComplianceFile::isCompressionSupported()
+{
+    return SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_HAVE_ZLIB;
+}
+
+template SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_API bool ComplianceFile::read<float>(float*);
+template SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_API bool ComplianceFile::read<double>(double*);
+template SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_API bool ComplianceFile::readLegacy<float>(const std::string&, float*, std::uint64_t, std::uint64_t);
+template SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_API bool ComplianceFile::readLegacy<double>(const std::string&, double*, std::uint64_t, std::uint64_t);
+template SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_API bool ComplianceFile::write<float>(const std::string&, const float*, std::uint64_t, std::uint64_t, bool, bool, std::uint32_t);
+template SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_API bool ComplianceFile::write<double>(const std::string&, const double*, std::uint64_t, std::uint64_t, bool, bool, std::uint32_t);
+
+} //namespace sofa::component::constraint::lagrangian::correction
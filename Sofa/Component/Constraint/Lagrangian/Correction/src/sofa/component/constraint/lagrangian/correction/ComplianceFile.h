@@ -0,0 +1,121 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/constraint/lagrangian/correction/config.h>
+
+#include <cstdint>
+#include <string>
+
+namespace sofa::component::constraint::lagrangian::correction
+{
+
+/**
+ *  \brief Versioned binary file storing a dense precomputed compliance matrix.
+ *
+ *  The header is followed by the matrix stored row by row, in single or double precision. When the matrix is not
+ *  compressed, it starts on a page boundary so that the file can be mapped in memory read-only: the pages are then
+ *  loaded on demand and shared between all the processes mapping the same file.
+ *  Otherwise, the matrix is split in blocks of rows compressed separately with zlib, preceded by the table of their
+ *  compressed sizes.
+ */
+class SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_CORRECTION_API ComplianceFile
+{
+public:
+    static constexpr std::uint32_t Version = 1;
+
+    /// Alignment of an uncompressed matrix in the file, multiple of the memory page sizes
+    static constexpr std::uint64_t DataAlignment = 4096;
+
+    enum class Compression : std::uint32_t
+    {
+        None = 0,
+        ZlibBlocks = 1
+    };
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t scalarSize; ///< 4 for single precision, 8 for double precision
+        std::uint64_t nbRows;
+        std::uint64_t nbCols;
+        std::uint32_t compression;
+        std::uint32_t nbRowsPerBlock; ///< Number of rows in a compressed block
+        std::uint64_t dataOffset; ///< Position of the matrix, or of the table of the compressed blocks, in the file
+    };
+
+    ComplianceFile() = default;
+    ~ComplianceFile();
+
+    ComplianceFile(const ComplianceFile&) = delete;
+    ComplianceFile& operator=(const ComplianceFile&) = delete;
+
+    /// Open the file and read its header.
+    /// Return false if the file cannot be opened or is not a versioned compliance file (e.g. a raw legacy file).
+    bool open(const std::string& path);
+
+    const Header& getHeader() const { return m_header; }
+
+    /// Can the matrix be used directly from the memory mapping of the file, with the given precision
+    template<class Real>
+    bool isMappable() const
+    {
+        return m_header.compression == static_cast<std::uint32_t>(Compression::None) && m_header.scalarSize == sizeof(Real);
+    }
+
+    /// Map the whole file in memory, read-only and shared between the processes.
+    /// Return a pointer on the matrix, or nullptr if the file cannot be mapped. The mapping is released by close().
+    const void* map();
+
+    /// Read the matrix into a buffer of nbRows * nbCols values, converting it to the given precision if needed
+    template<class Real>
+    bool read(Real* matrix);
+
+    /// Read a legacy compliance file, storing only the raw matrix of nbRows * nbCols values in the given precision.
+    /// Return false if the file cannot be opened or does not have the size of such a matrix
+    template<class Real>
+    static bool readLegacy(const std::string& path, Real* matrix, std::uint64_t nbRows, std::uint64_t nbCols);
+
+    /// Release the mapping of the file, if any
+    void close();
+
+    /// Write a compliance file, optionally in single precision and compressed by blocks of rows
+    template<class Real>
+    static bool write(const std::string& path, const Real* matrix, std::uint64_t nbRows, std::uint64_t nbCols,
+                      bool singlePrecision, bool compress, std::uint32_t nbRowsPerBlock = 64);
+
+    /// Are the compressed files supported, i.e. was the module built with zlib
+    static bool isCompressionSupported();
+
+protected:
+    std::string m_path;
+    Header m_header {};
+
+    const char* m_mapping { nullptr };
+    std::uint64_t m_mappingSize { 0 };
+#ifdef WIN32
+    void* m_fileHandle { nullptr };
+    void* m_mappingHandle { nullptr };
+#endif
+};
+
+} //namespace sofa::component::constraint::lagrangian::correction
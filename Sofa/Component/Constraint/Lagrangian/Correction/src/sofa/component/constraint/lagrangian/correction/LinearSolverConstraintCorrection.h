@@ -33,6 +33,8 @@
 #include <sofa/linearalgebra/SparseMatrix.h>
 #include <sofa/linearalgebra/FullMatrix.h>
 
+#include <map>
+
 namespace sofa::component::constraint::lagrangian::correction
 {
 
@@ -94,6 +96,7 @@ public:
     /// @{
 
     Data< bool > wire_optimization; ///< constraints are reordered along a wire-like topology (from tip to base)
+    Data< bool > d_cacheCompliance; ///< Reuse the compliance between the constraints whose Jacobian rows did not change since the previous time step. Only for a system matrix which is not updated between the time steps (e.g. frozen): the cache is dropped each time the system matrix is inverted again, and disabled if it happens at every time step
     SingleLink<LinearSolverConstraintCorrection, sofa::core::behavior::LinearSolver, BaseLink::FLAG_STOREPATH | BaseLink::FLAG_STRONGLINK> l_linearSolver; ///< Link towards the linear solver used to compute the compliance matrix, requiring the inverse of the linear system matrix
     SingleLink<LinearSolverConstraintCorrection, sofa::core::behavior::OdeSolver, BaseLink::FLAG_STOREPATH | BaseLink::FLAG_STRONGLINK> l_ODESolver; ///< Link towards the ODE solver used to recover the integration factors
 
@@ -127,6 +130,33 @@ protected:
         convertConstraintMatrix(W->rowSize(), j);
     }
 
+    /**
+    * @brief Add the compliance in the constraint space, computing only the columns of the constraints which are not in the cache
+    * @return false if the linear solver does not support it
+    */
+    bool addCachedComplianceInConstraintSpace(const MatrixDeriv& constraintMatrix, linearalgebra::BaseMatrix* W, SReal factor);
+
+    /// Contents of a row of the constraint Jacobian: pairs of column and value
+    typedef type::vector< std::pair<linearalgebra::BaseMatrix::Index, Real> > JacobianRowContents;
+
+    /// Compliance of the constraints of the previous time step, between the rows of the constraint Jacobian
+    struct ComplianceCache
+    {
+        std::map<JacobianRowContents, int> rowIndices; ///< Index of each row in the compliance, from its contents
+        type::vector<SReal> compliance; ///< Dense compliance between the rows
+        int nbRows { 0 }; ///< Number of rows of the compliance
+        std::size_t inversionCount { 0 }; ///< Number of inversions of the system matrix when the compliance was computed
+        SReal factor { 0 }; ///< Integration factor of the compliance
+        unsigned int nbConsecutiveInversions { 0 }; ///< Number of consecutive time steps at which the cache was dropped because of a new inversion
+    };
+    ComplianceCache m_complianceCache;
+
+    /// Number of consecutive time steps at which the system matrix is inverted again before the cache is disabled
+    static constexpr unsigned int MaxConsecutiveInversions = 3;
+
+    linearalgebra::SparseMatrix<Real> m_compactConstraintJacobian; ///< Rows of the constraint Jacobian acting on this object
+    linearalgebra::FullMatrix<SReal> m_compactCompliance; ///< Compliance between the rows of the compact constraint Jacobian
+
 
     ////////////////////////// Inherited attributes ////////////////////////////
     /// https://gcc.gnu.org/onlinedocs/gcc/Name-lookup.html
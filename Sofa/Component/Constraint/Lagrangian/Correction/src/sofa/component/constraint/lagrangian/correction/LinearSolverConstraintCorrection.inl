@@ -47,6 +47,7 @@ template<class DataTypes>
 LinearSolverConstraintCorrection<DataTypes>::LinearSolverConstraintCorrection(sofa::core::behavior::MechanicalState<DataTypes> *mm)
 : Inherit(mm)
 , wire_optimization(initData(&wire_optimization, false, "wire_optimization", "constraints are reordered along a wire-like topology (from tip to base)"))
+, d_cacheCompliance(initData(&d_cacheCompliance, false, "cacheCompliance", "Reuse the compliance between the constraints whose Jacobian rows did not change since the previous time step. Only for a system matrix which is not updated between the time steps (e.g. frozen): the cache is dropped each time the system matrix is inverted again, and disabled if it happens at every time step"))
 , l_linearSolver(initLink("linearSolver", "Link towards the linear solver used to compute the compliance matrix, requiring the inverse of the linear system matrix"))
 , l_ODESolver(initLink("ODESolver", "Link towards the ODE solver used to recover the integration factors"))
 {
@@ -193,17 +194,160 @@ void LinearSolverConstraintCorrection<DataTypes>::addComplianceInConstraintSpace
         break;
     }
 
+    helper::ReadAccessor inputConstraintMatrix ( *cparams->readJ(this->mstate) );
     {
-        helper::ReadAccessor inputConstraintMatrix ( *cparams->readJ(this->mstate) );
         const sofa::SignedIndex numberOfConstraints = W->rowSize();
         convertConstraintMatrix(numberOfConstraints, inputConstraintMatrix.ref());
     }
 
-    // use the Linear solver to compute J*inv(M)*Jt, where M is the mechanical linear system matrix
     l_linearSolver->setSystemLHVector(sofa::core::MultiVecDerivId::null());
+
+    if (d_cacheCompliance.getValue() && addCachedComplianceInConstraintSpace(inputConstraintMatrix.ref(), W, factor))
+    {
+        return;
+    }
+
+    // use the Linear solver to compute J*inv(M)*Jt, where M is the mechanical linear system matrix
     l_linearSolver->addJMInvJt(W, &m_constraintJacobian, factor);
 }
 
+template<class DataTypes>
+bool LinearSolverConstraintCorrection<DataTypes>::addCachedComplianceInConstraintSpace(const MatrixDeriv& constraintMatrix, sofa::linearalgebra::BaseMatrix* W, SReal factor)
+{
+    SCOPED_TIMER("addCachedComplianceInConstraintSpace");
+
+    // the cached compliance is valid as long as the system matrix is not inverted again
+    l_linearSolver->invertSystem();
+    const std::size_t inversionCount = l_linearSolver->getSystemInversionCount();
+    if (inversionCount == 0)
+    {
+        msg_warning() << "The linear solver " << l_linearSolver->getName() << " does not keep track of the inversions of the system matrix: the compliance is not cached";
+        d_cacheCompliance.setValue(false);
+        return false;
+    }
+    if (m_complianceCache.inversionCount != 0 && inversionCount != m_complianceCache.inversionCount)
+    {
+        // the system matrix is updated between the time steps: the cache never hits and only costs
+        if (++m_complianceCache.nbConsecutiveInversions >= MaxConsecutiveInversions)
+        {
+            msg_warning() << "The system matrix of the linear solver " << l_linearSolver->getName() << " has been inverted again at each of the last "
+                          << m_complianceCache.nbConsecutiveInversions << " time steps: the compliance cannot be reused and is no longer cached. "
+                          << "The cache is meant for a system matrix which is not updated between the time steps (e.g. frozen).";
+            d_cacheCompliance.setValue(false);
+            m_complianceCache = ComplianceCache();
+            return false;
+        }
+    }
+    else
+    {
+        m_complianceCache.nbConsecutiveInversions = 0;
+    }
+    if (inversionCount != m_complianceCache.inversionCount || factor != m_complianceCache.factor)
+    {
+        m_complianceCache.rowIndices.clear();
+    }
+
+    static constexpr unsigned int N = Deriv::size();
+    const unsigned int numDOFReals = mstate->getSize() * N;
+
+    // the rows of the constraint Jacobian are identified by their contents
+    type::vector<linearalgebra::BaseMatrix::Index> rows; // index of each compact row in the constraint Jacobian
+    type::vector<int> cachedRows; // index of each compact row in the cache, -1 if it is not in the cache
+    type::vector<linearalgebra::BaseMatrix::Index> newRows; // compact rows which are not in the cache
+    std::map<JacobianRowContents, int> rowIndices;
+
+    m_compactConstraintJacobian.resize(W->rowSize(), numDOFReals);
+    JacobianRowContents contents;
+    for (MatrixDerivRowConstIterator rowIt = constraintMatrix.begin(); rowIt != constraintMatrix.end(); ++rowIt)
+    {
+        const int row = static_cast<int>(rows.size());
+        contents.clear();
+        for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != rowIt.end(); ++colIt)
+        {
+            for (unsigned int r = 0; r < N; ++r)
+            {
+                const linearalgebra::BaseMatrix::Index col = colIt.index() * N + r;
+                contents.emplace_back(col, colIt.val()[r]);
+                m_compactConstraintJacobian.add(row, col, colIt.val()[r]);
+            }
+        }
+
+        rows.push_back(rowIt.index());
+        const auto cached = m_complianceCache.rowIndices.find(contents);
+        if (cached != m_complianceCache.rowIndices.end())
+        {
+            cachedRows.push_back(cached->second);
+        }
+        else
+        {
+            cachedRows.push_back(-1);
+            newRows.push_back(row);
+        }
+        rowIndices.emplace(contents, row);
+    }
+
+    const int nbRows = static_cast<int>(rows.size());
+    const int nbCachedRows = m_complianceCache.nbRows;
+    m_compactCompliance.resize(nbRows, nbRows);
+    m_compactCompliance.clear();
+
+    // the compliance between the rows in the cache is reused
+    for (int i = 0; i < nbRows; ++i)
+    {
+        if (cachedRows[i] < 0) continue;
+        for (int j = 0; j < nbRows; ++j)
+        {
+            if (cachedRows[j] < 0) continue;
+            m_compactCompliance.set(i, j, m_complianceCache.compliance[cachedRows[i] * nbCachedRows + cachedRows[j]]);
+        }
+    }
+
+    // the columns of the new rows are computed, the compliance being symmetric
+    if (!l_linearSolver->addJMInvJtColumns(&m_compactCompliance, &m_compactConstraintJacobian, newRows, factor))
+    {
+        msg_warning() << "The linear solver " << l_linearSolver->getName() << " cannot compute the columns of the compliance: the compliance is not cached";
+        d_cacheCompliance.setValue(false);
+        m_complianceCache.rowIndices.clear();
+        return false;
+    }
+    for (const auto i : newRows)
+    {
+        for (int j = 0; j < nbRows; ++j)
+        {
+            if (cachedRows[j] >= 0)
+            {
+                m_compactCompliance.set(i, j, m_compactCompliance.element(j, i));
+            }
+        }
+    }
+
+    for (int i = 0; i < nbRows; ++i)
+    {
+        for (int j = 0; j < nbRows; ++j)
+        {
+            W->add(rows[i], rows[j], m_compactCompliance.element(i, j));
+        }
+    }
+
+    sofa::helper::AdvancedTimer::valSet("cachedComplianceRows", nbRows - static_cast<int>(newRows.size()));
+
+    // the compliance of this time step is kept for the next one
+    m_complianceCache.rowIndices = std::move(rowIndices);
+    m_complianceCache.nbRows = nbRows;
+    m_complianceCache.compliance.resize(nbRows * nbRows);
+    for (int i = 0; i < nbRows; ++i)
+    {
+        for (int j = 0; j < nbRows; ++j)
+        {
+            m_complianceCache.compliance[i * nbRows + j] = m_compactCompliance.element(i, j);
+        }
+    }
+    m_complianceCache.inversionCount = inversionCount;
+    m_complianceCache.factor = factor;
+
+    return true;
+}
+
 
 template<class DataTypes>
 void LinearSolverConstraintCorrection<DataTypes>::rebuildSystem(SReal massFactor, SReal forceFactor)
@@ -21,6 +21,7 @@
 ******************************************************************************/
 #pragma once
 #include <sofa/component/constraint/lagrangian/correction/config.h>
+#include <sofa/component/constraint/lagrangian/correction/ComplianceFile.h>
 
 #include <sofa/core/behavior/ConstraintCorrection.h>
 #include <sofa/core/objectmodel/DataFileName.h>
@@ -32,6 +33,8 @@
 
 #include <sofa/core/objectmodel/RenamedData.h>
 
+#include <memory>
+
 namespace sofa::component::constraint::lagrangian::correction
 {
 
@@ -85,6 +88,9 @@ public:
     Data<SReal> d_debugViewFrameScale; ///< Scale on computed node's frame
     sofa::core::objectmodel::DataFileName d_fileCompliance; ///< Precomputed compliance matrix data file
     Data<std::string> d_fileDir; ///< If not empty, the compliance will be saved in this repertory
+    Data<bool> d_memoryMapping; ///< Map the compliance file in memory, read-only and shared between the processes, instead of reading it
+    Data<bool> d_singlePrecisionFile; ///< Save the compliance file in single precision
+    Data<bool> d_compressFile; ///< Save the compliance file compressed by blocks of rows (requires zlib)
     
 protected:
     PrecomputedConstraintCorrection(sofa::core::behavior::MechanicalState<DataTypes> *mm = nullptr);
@@ -141,6 +147,7 @@ public:
     {
         Real* data;
         int nbref;
+        std::unique_ptr<ComplianceFile> file; ///< If not null, data points on the read-only memory mapping of this file
         InverseStorage() : data(nullptr), nbref(0) {}
     };
 
@@ -178,6 +185,7 @@ public:
     std::list<int> constraint_dofs;		// list of indices of each point which is involve with constraint
 
 public:
+    /// The returned compliance is read-only when its file is mapped in memory
     Real* getInverse()
     {
         if (invM->data)
@@ -195,6 +203,13 @@ protected:
      */
     bool loadCompliance(std::string fileName);
 
+    /**
+     * @brief Read or map the compliance matrix from a versioned or a legacy raw compliance file.
+     *
+     * @return Reading success.
+     */
+    bool readComplianceFile(const std::string& path);
+
     /**
      * @brief Save compliance matrix into a file.
      */
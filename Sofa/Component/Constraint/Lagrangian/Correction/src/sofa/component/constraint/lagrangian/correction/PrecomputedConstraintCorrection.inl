@@ -59,6 +59,9 @@ PrecomputedConstraintCorrection<DataTypes>::PrecomputedConstraintCorrection(sofa
     , d_debugViewFrameScale(initData(&d_debugViewFrameScale, 1.0_sreal, "debugViewFrameScale", "Scale on computed node's frame"))
     , d_fileCompliance(initData(&d_fileCompliance, "fileCompliance", "Precomputed compliance matrix data file"))
     , d_fileDir(initData(&d_fileDir, "fileDir", "If not empty, the compliance will be saved in this repertory"))
+    , d_memoryMapping(initData(&d_memoryMapping, true, "memoryMapping", "Map the compliance file in memory, read-only and shared between the processes, instead of reading it (only for uncompressed files stored in the precision of the simulation)"))
+    , d_singlePrecisionFile(initData(&d_singlePrecisionFile, false, "singlePrecisionFile", "Save the compliance file in single precision"))
+    , d_compressFile(initData(&d_compressFile, false, "compressFile", "Save the compliance file compressed by blocks of rows (requires zlib). A compressed file cannot be mapped in memory"))
     , invM(nullptr)
     , appCompliance(nullptr)
     , nbRows(0), nbCols(0), dof_on_node(0), nbNodes(0)
@@ -101,7 +104,8 @@ void PrecomputedConstraintCorrection<DataTypes>::releaseInverse(std::string name
     std::map< std::string, InverseStorage >& registry = getInverseMap();
     if (--inv->nbref == 0)
     {
-        if (inv->data) delete[] inv->data;
+        // a mapped compliance is released with its file
+        if (inv->data && !inv->file) delete[] inv->data;
         registry.erase(name);
     }
 }
@@ -142,36 +146,14 @@ bool PrecomputedConstraintCorrection<DataTypes>::loadCompliance(std::string file
         if (!dir.empty())
         {
             const std::string path = helper::system::FileSystem::append(dir, fileName);
-            std::ifstream compFileIn(path, std::ifstream::binary);
-            if (compFileIn.is_open())
-            {
-                invM->data = new Real[nbRows * nbCols];
-
-                msg_info() << "File " << path << " found. Loading..." ;
-
-                compFileIn.read((char*)invM->data, nbCols * nbRows * sizeof(Real));
-                compFileIn.close();
-
-                return true;
-            }
-            else
-                return false;
+            return readComplianceFile(path);
         }
         else if (d_recompute.getValue() == false)
         {
             std::stringstream ss;
             if (sofa::helper::system::DataRepository.findFile(fileName, "", &ss))
             {
-                invM->data = new Real[nbRows * nbCols];
-
-                std::ifstream compFileIn(fileName.c_str(), std::ifstream::binary);
-
-                msg_info() << "File " << fileName << " found. Loading..." ;
-
-                compFileIn.read((char*)invM->data, nbCols * nbRows * sizeof(Real));
-                compFileIn.close();
-
-                return true;
+                return readComplianceFile(fileName);
             }
             else
             {
@@ -187,6 +169,61 @@ bool PrecomputedConstraintCorrection<DataTypes>::loadCompliance(std::string file
 }
 
 
+template<class DataTypes>
+bool PrecomputedConstraintCorrection<DataTypes>::readComplianceFile(const std::string& path)
+{
+    auto file = std::make_unique<ComplianceFile>();
+    if (file->open(path))
+    {
+        const auto& header = file->getHeader();
+        if (header.nbRows != nbRows || header.nbCols != nbCols)
+        {
+            msg_error() << "File " << path << " stores a " << header.nbRows << "x" << header.nbCols
+                << " compliance, but a " << nbRows << "x" << nbCols << " compliance is expected";
+            return false;
+        }
+
+        if (d_memoryMapping.getValue() && file->template isMappable<Real>())
+        {
+            if (const void* data = file->map())
+            {
+                msg_info() << "File " << path << " found. Mapped in memory";
+
+                invM->data = const_cast<Real*>(static_cast<const Real*>(data));
+                invM->file = std::move(file);
+                return true;
+            }
+            msg_warning() << "File " << path << " cannot be mapped in memory, it is read instead";
+        }
+
+        msg_info() << "File " << path << " found. Loading..." ;
+
+        invM->data = new Real[nbRows * nbCols];
+        if (!file->read(invM->data))
+        {
+            msg_error() << "File " << path << " cannot be read";
+            delete[] invM->data;
+            invM->data = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // Legacy file: raw compliance stored in the precision of the simulation
+    invM->data = new Real[nbRows * nbCols];
+    if (!ComplianceFile::readLegacy(path, invM->data, nbRows, nbCols))
+    {
+        delete[] invM->data;
+        invM->data = nullptr;
+        return false;
+    }
+
+    msg_info() << "File " << path << " found. Loaded as a legacy compliance file";
+
+    return true;
+}
+
+
 
 template<class DataTypes>
 void PrecomputedConstraintCorrection<DataTypes>::saveCompliance(const std::string& fileName)
@@ -208,9 +245,11 @@ void PrecomputedConstraintCorrection<DataTypes>::saveCompliance(const std::strin
     msg_info() << "Compliance file has been saved in " << filePathInSofaShare << ". Load this file using fileCompliance if you don't want to recompute the compliance matrice at next start.";
     this->f_printLog.setValue(printLog);
 
-    std::ofstream compFileOut(filePathInSofaShare.c_str(), std::fstream::out | std::fstream::binary);
-    compFileOut.write((char*)invM->data, nbCols * nbRows * sizeof(Real));
-    compFileOut.close();
+    if (!ComplianceFile::write(filePathInSofaShare, invM->data, nbRows, nbCols,
+                               d_singlePrecisionFile.getValue(), d_compressFile.getValue()))
+    {
+        msg_error() << "Compliance file " << filePathInSofaShare << " cannot be written";
+    }
 }
 
 
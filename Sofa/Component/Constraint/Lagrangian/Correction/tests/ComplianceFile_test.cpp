@@ -0,0 +1,223 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/constraint/lagrangian/correction/ComplianceFile.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+using sofa::component::constraint::lagrangian::correction::ComplianceFile;
+
+struct ComplianceFile_test : public sofa::testing::BaseTest
+{
+    /// Number of rows, not a multiple of the number of rows per block so that the last block is partial
+    static constexpr std::uint64_t NbRows = 150;
+    static constexpr std::uint64_t NbCols = 130;
+    static constexpr std::uint32_t NbRowsPerBlock = 64;
+
+    std::vector<double> matrix;
+    std::string path;
+
+    void onSetUp() override
+    {
+        // sparse enough to be compressed
+        matrix.resize(NbRows * NbCols);
+        for (std::size_t i = 0; i < matrix.size(); ++i)
+        {
+            matrix[i] = (i % 7 == 0) ? std::sin(0.01 * i) : 0;
+        }
+        path = (std::filesystem::temp_directory_path() / "ComplianceFile_test.comp").string();
+    }
+
+    void onTearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    /// Write the matrix, read it back in both precisions and compare it with the original
+    void roundTrip(bool singlePrecision, bool compress)
+    {
+        ASSERT_TRUE(ComplianceFile::write(path, matrix.data(), NbRows, NbCols, singlePrecision, compress, NbRowsPerBlock));
+
+        ComplianceFile file;
+        ASSERT_TRUE(file.open(path));
+        const auto& header = file.getHeader();
+        EXPECT_EQ(header.version, ComplianceFile::Version);
+        EXPECT_EQ(header.nbRows, NbRows);
+        EXPECT_EQ(header.nbCols, NbCols);
+        EXPECT_EQ(header.scalarSize, singlePrecision ? sizeof(float) : sizeof(double));
+        EXPECT_EQ(file.isMappable<double>(), !singlePrecision && !compress);
+        EXPECT_EQ(file.isMappable<float>(), singlePrecision && !compress);
+
+        std::vector<double> doubleMatrix(NbRows * NbCols);
+        std::vector<float> floatMatrix(NbRows * NbCols);
+        ASSERT_TRUE(file.read(doubleMatrix.data()));
+        ASSERT_TRUE(file.read(floatMatrix.data()));
+        for (std::size_t i = 0; i < matrix.size(); ++i)
+        {
+            if (singlePrecision)
+            {
+                EXPECT_EQ(doubleMatrix[i], static_cast<double>(static_cast<float>(matrix[i]))) << i;
+            }
+            else
+            {
+                EXPECT_EQ(doubleMatrix[i], matrix[i]) << i;
+            }
+            EXPECT_EQ(floatMatrix[i], static_cast<float>(matrix[i])) << i;
+        }
+    }
+
+    std::uintmax_t fileSize() const
+    {
+        return std::filesystem::file_size(path);
+    }
+};
+
+TEST_F(ComplianceFile_test, roundTripDouble)
+{
+    roundTrip(false, false);
+}
+
+TEST_F(ComplianceFile_test, roundTripFloat)
+{
+    roundTrip(true, false);
+}
+
+TEST_F(ComplianceFile_test, roundTripCompressed)
+{
+    if (!ComplianceFile::isCompressionSupported())
+    {
+        GTEST_SKIP() << "zlib is not available";
+    }
+
+    // the last of the 3 blocks has only 22 rows
+    roundTrip(false, true);
+    EXPECT_LT(fileSize(), NbRows * NbCols * sizeof(double));
+
+    roundTrip(true, true);
+}
+
+TEST_F(ComplianceFile_test, mappedRead)
+{
+    ASSERT_TRUE(ComplianceFile::write(path, matrix.data(), NbRows, NbCols, false, false));
+
+    ComplianceFile file;
+    ASSERT_TRUE(file.open(path));
+    const void* mapping = file.map();
+    ASSERT_NE(mapping, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mapping) % ComplianceFile::DataAlignment, 0u);
+    EXPECT_EQ(std::memcmp(mapping, matrix.data(), matrix.size() * sizeof(double)), 0);
+    file.close();
+
+    ASSERT_TRUE(ComplianceFile::write(path, matrix.data(), NbRows, NbCols, true, false));
+    ASSERT_TRUE(file.open(path));
+    const float* floatMapping = static_cast<const float*>(file.map());
+    ASSERT_NE(floatMapping, nullptr);
+    for (std::size_t i = 0; i < matrix.size(); ++i)
+    {
+        EXPECT_EQ(floatMapping[i], static_cast<float>(matrix[i])) << i;
+    }
+    file.close();
+
+    if (ComplianceFile::isCompressionSupported())
+    {
+        ASSERT_TRUE(ComplianceFile::write(path, matrix.data(), NbRows, NbCols, false, true));
+        ASSERT_TRUE(file.open(path));
+        EXPECT_EQ(file.map(), nullptr);
+    }
+}
+
+TEST_F(ComplianceFile_test, legacyFile)
+{
+    {
+        std::ofstream legacy(path, std::ofstream::binary);
+        legacy.write(reinterpret_cast<const char*>(matrix.data()), matrix.size() * sizeof(double));
+    }
+
+    // no header
+    ComplianceFile file;
+    EXPECT_FALSE(file.open(path));
+
+    std::vector<double> read(NbRows * NbCols);
+    ASSERT_TRUE(ComplianceFile::readLegacy(path, read.data(), NbRows, NbCols));
+    EXPECT_EQ(read, matrix);
+
+    // the size of the file does not match the expected matrix
+    {
+        EXPECT_MSG_EMIT(Error);
+        EXPECT_FALSE(ComplianceFile::readLegacy(path, read.data(), NbRows + 1, NbCols));
+    }
+    {
+        EXPECT_MSG_EMIT(Error);
+        std::vector<float> floatRead(NbRows * NbCols);
+        EXPECT_FALSE(ComplianceFile::readLegacy(path, floatRead.data(), NbRows, NbCols));
+    }
+
+    EXPECT_FALSE(ComplianceFile::readLegacy(path + ".missing", read.data(), NbRows, NbCols));
+}
+
+TEST_F(ComplianceFile_test, truncatedFile)
+{
+    std::vector<bool> compressions { false };
+    if (ComplianceFile::isCompressionSupported())
+    {
+        compressions.push_back(true);
+    }
+
+    for (const bool compress : compressions)
+    {
+        ASSERT_TRUE(ComplianceFile::write(path, matrix.data(), NbRows, NbCols, false, compress, NbRowsPerBlock));
+        std::filesystem::resize_file(path, fileSize() - 100);
+
+        // the header is complete, but the matrix is not
+        ComplianceFile file;
+        ASSERT_TRUE(file.open(path));
+        std::vector<double> read(NbRows * NbCols);
+        EXPECT_FALSE(file.read(read.data())) << "compressed: " << compress;
+        EXPECT_EQ(file.map(), nullptr) << "compressed: " << compress;
+        file.close();
+
+        // the header is not complete
+        std::filesystem::resize_file(path, sizeof(ComplianceFile::Header) - 1);
+        EXPECT_FALSE(file.open(path)) << "compressed: " << compress;
+    }
+}
+
+TEST_F(ComplianceFile_test, wrongMagic)
+{
+    ASSERT_TRUE(ComplianceFile::write(path, matrix.data(), NbRows, NbCols, false, false));
+    {
+        std::fstream file(path, std::fstream::binary | std::fstream::in | std::fstream::out);
+        file.write("SOFAXXXX", 8);
+    }
+
+    ComplianceFile file;
+    EXPECT_FALSE(file.open(path));
+}
+
+}
@@ -0,0 +1,287 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/constraint/lagrangian/correction/LinearSolverConstraintCorrection.h>
+#include <sofa/component/statecontainer/MechanicalObject.h>
+#include <sofa/core/behavior/LinearSolver.h>
+#include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/core/ConstraintParams.h>
+#include <sofa/linearalgebra/FullMatrix.h>
+#include <sofa/simulation/graph/DAGNode.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+using sofa::defaulttype::Vec3Types;
+using sofa::linearalgebra::BaseMatrix;
+using sofa::linearalgebra::FullMatrix;
+using Correction = sofa::component::constraint::lagrangian::correction::LinearSolverConstraintCorrection<Vec3Types>;
+
+/// Linear solver storing the inverse of its system matrix, counting the solves
+class MockLinearSolver : public sofa::core::behavior::LinearSolver
+{
+public:
+    SOFA_CLASS(MockLinearSolver, sofa::core::behavior::LinearSolver);
+
+    FullMatrix<SReal> inverse; ///< Inverse of the system matrix
+    std::size_t inversionCount { 1 };
+    unsigned int nbSolves { 0 };
+
+    void resetSystem() override {}
+    void setSystemMBKMatrix(const sofa::core::MechanicalParams*) override {}
+    void setSystemRHVector(sofa::core::MultiVecDerivId) override {}
+    void setSystemLHVector(sofa::core::MultiVecDerivId) override {}
+    void solveSystem() override {}
+
+    bool addJMInvJt(BaseMatrix* result, BaseMatrix* J, SReal fact) override
+    {
+        for (BaseMatrix::Index r = 0; r < J->rowSize(); ++r)
+        {
+            addColumn(result, J, J->rowSize(), r, fact);
+        }
+        return true;
+    }
+
+    bool addJMInvJtColumns(BaseMatrix* result, BaseMatrix* J, const sofa::type::vector<BaseMatrix::Index>& rows, SReal fact) override
+    {
+        for (const auto r : rows)
+        {
+            addColumn(result, J, result->rowSize(), r, fact);
+        }
+        return true;
+    }
+
+    std::size_t getSystemInversionCount() const override { return inversionCount; }
+
+protected:
+    /// result(i, r) += fact * J_i A^-1 J_r^T for each of the nbRows first rows i of J
+    void addColumn(BaseMatrix* result, BaseMatrix* J, BaseMatrix::Index nbRows, BaseMatrix::Index r, SReal fact)
+    {
+        ++nbSolves;
+        sofa::type::vector<SReal> x(J->colSize(), 0);
+        for (BaseMatrix::Index a = 0; a < J->colSize(); ++a)
+        {
+            for (BaseMatrix::Index b = 0; b < J->colSize(); ++b)
+            {
+                x[a] += inverse.element(a, b) * J->element(r, b);
+            }
+        }
+        for (BaseMatrix::Index i = 0; i < nbRows; ++i)
+        {
+            SReal value = 0;
+            for (BaseMatrix::Index a = 0; a < J->colSize(); ++a)
+            {
+                value += J->element(i, a) * x[a];
+            }
+            result->add(i, r, fact * value);
+        }
+    }
+};
+
+class MockOdeSolver : public sofa::core::behavior::OdeSolver
+{
+public:
+    SOFA_CLASS(MockOdeSolver, sofa::core::behavior::OdeSolver);
+
+    void solve(const sofa::core::ExecParams*, SReal, sofa::core::MultiVecCoordId, sofa::core::MultiVecDerivId) override {}
+    SReal getPositionIntegrationFactor() const override { return 0.5; }
+};
+
+/// A constraint row between two nodes, along a direction
+struct ConstraintRow
+{
+    unsigned int node1, node2;
+    sofa::type::Vec3 direction;
+};
+
+struct LinearSolverConstraintCorrection_test : public sofa::testing::BaseTest
+{
+    static constexpr unsigned int NbNodes = 10;
+
+    sofa::simulation::Node::SPtr root;
+    sofa::component::statecontainer::MechanicalObject<Vec3Types>::SPtr mstate;
+    MockLinearSolver::SPtr linearSolver;
+    MockOdeSolver::SPtr odeSolver;
+
+    void onSetUp() override
+    {
+        root = sofa::core::objectmodel::New<sofa::simulation::graph::DAGNode>("root");
+        mstate = sofa::core::objectmodel::New<sofa::component::statecontainer::MechanicalObject<Vec3Types> >();
+        mstate->resize(NbNodes);
+        root->addObject(mstate);
+
+        // symmetric positive definite inverse of the system matrix
+        linearSolver = sofa::core::objectmodel::New<MockLinearSolver>();
+        const unsigned int size = 3 * NbNodes;
+        linearSolver->inverse.resize(size, size);
+        for (unsigned int i = 0; i < size; ++i)
+        {
+            for (unsigned int j = 0; j < size; ++j)
+            {
+                linearSolver->inverse.set(i, j, (i == j ? 2 : 0) + 0.1 * std::cos(0.7 * (i + 1) * (j + 1)) / (1 + std::abs(SReal(i) - SReal(j))));
+            }
+        }
+        root->addObject(linearSolver);
+
+        odeSolver = sofa::core::objectmodel::New<MockOdeSolver>();
+        root->addObject(odeSolver);
+    }
+
+    Correction::SPtr createCorrection(bool cacheCompliance)
+    {
+        auto correction = sofa::core::objectmodel::New<Correction>(mstate.get());
+        correction->l_linearSolver.set(linearSolver.get());
+        correction->l_ODESolver.set(odeSolver.get());
+        correction->d_cacheCompliance.setValue(cacheCompliance);
+        root->addObject(correction);
+        correction->init();
+        return correction;
+    }
+
+    /// The rows of the constraint Jacobian start at 1, the first row acting on another object
+    void setConstraintRows(const sofa::type::vector<ConstraintRow>& rows)
+    {
+        auto jacobian = sofa::helper::getWriteAccessor(*mstate->write(sofa::core::MatrixDerivId::constraintJacobian()));
+        jacobian->clear();
+        for (std::size_t r = 0; r < rows.size(); ++r)
+        {
+            auto rowIt = jacobian->writeLine(r + 1);
+            rowIt.addCol(rows[r].node1, rows[r].direction);
+            rowIt.addCol(rows[r].node2, -rows[r].direction);
+        }
+    }
+
+    /// Compute the compliance W of the constraint rows, and return the number of solves of the linear solver to compute it
+    unsigned int computeCompliance(Correction* correction, std::size_t nbRows, FullMatrix<SReal>& W)
+    {
+        const auto size = static_cast<BaseMatrix::Index>(nbRows + 1);
+        W.resize(size, size);
+        W.clear();
+        linearSolver->nbSolves = 0;
+        sofa::core::ConstraintParams cparams;
+        correction->addComplianceInConstraintSpace(&cparams, &W);
+        return linearSolver->nbSolves;
+    }
+
+    static ConstraintRow generateRow(unsigned int seed)
+    {
+        return { seed % NbNodes, (seed * 7 + 3) % NbNodes,
+                 sofa::type::Vec3(std::sin(1.1 * seed), std::cos(1.7 * seed), std::sin(2.3 * seed + 0.5)) };
+    }
+
+    static void expectSameMatrix(const FullMatrix<SReal>& expected, const FullMatrix<SReal>& actual, int step)
+    {
+        ASSERT_EQ(expected.rowSize(), actual.rowSize());
+        for (BaseMatrix::Index i = 0; i < expected.rowSize(); ++i)
+        {
+            for (BaseMatrix::Index j = 0; j < expected.colSize(); ++j)
+            {
+                EXPECT_NEAR(expected.element(i, j), actual.element(i, j), 1e-12) << "step " << step << " (" << i << ", " << j << ")";
+            }
+        }
+    }
+};
+
+TEST_F(LinearSolverConstraintCorrection_test, cacheCompliance)
+{
+    const auto full = createCorrection(false);
+    const auto cached = createCorrection(true);
+
+    sofa::type::vector<ConstraintRow> rows;
+    for (unsigned int r = 0; r < 8; ++r)
+    {
+        rows.push_back(generateRow(r));
+    }
+
+    static constexpr int InversionStep = 3;
+    for (int step = 0; step < 6; ++step)
+    {
+        if (step == InversionStep)
+        {
+            ++linearSolver->inversionCount;
+        }
+        if (step > 0)
+        {
+            // the rows are reordered, one of them is removed and a new one is added
+            std::rotate(rows.begin(), rows.begin() + 3, rows.end());
+            rows.back() = generateRow(100 + step);
+        }
+        setConstraintRows(rows);
+
+        FullMatrix<SReal> fullCompliance, cachedCompliance;
+        const unsigned int nbFullSolves = computeCompliance(full.get(), rows.size(), fullCompliance);
+        const unsigned int nbCachedSolves = computeCompliance(cached.get(), rows.size(), cachedCompliance);
+
+        expectSameMatrix(fullCompliance, cachedCompliance, step);
+        EXPECT_EQ(nbFullSolves, rows.size() + 1) << "step " << step;
+        if (step == 0 || step == InversionStep)
+        {
+            // nothing to reuse: one solve per row
+            EXPECT_EQ(nbCachedSolves, rows.size()) << "step " << step;
+        }
+        else
+        {
+            // one solve for the new row only
+            EXPECT_EQ(nbCachedSolves, 1u) << "step " << step;
+        }
+    }
+    EXPECT_TRUE(cached->d_cacheCompliance.getValue());
+}
+
+TEST_F(LinearSolverConstraintCorrection_test, cacheDisabledWhenInvertedAtEachStep)
+{
+    const auto full = createCorrection(false);
+    const auto cached = createCorrection(true);
+
+    sofa::type::vector<ConstraintRow> rows;
+    for (unsigned int r = 0; r < 5; ++r)
+    {
+        rows.push_back(generateRow(r));
+    }
+    setConstraintRows(rows);
+
+    // the system matrix is inverted again at each time step, as when it is not frozen
+    static constexpr int DisabledStep = 3;
+    for (int step = 0; step < 5; ++step)
+    {
+        ++linearSolver->inversionCount;
+
+        FullMatrix<SReal> fullCompliance, cachedCompliance;
+        computeCompliance(full.get(), rows.size(), fullCompliance);
+        if (step == DisabledStep)
+        {
+            EXPECT_MSG_EMIT(Warning);
+            computeCompliance(cached.get(), rows.size(), cachedCompliance);
+        }
+        else
+        {
+            computeCompliance(cached.get(), rows.size(), cachedCompliance);
+        }
+
+        expectSameMatrix(fullCompliance, cachedCompliance, step);
+        EXPECT_EQ(cached->d_cacheCompliance.getValue(), step < DisabledStep) << "step " << step;
+    }
+}
+
+}
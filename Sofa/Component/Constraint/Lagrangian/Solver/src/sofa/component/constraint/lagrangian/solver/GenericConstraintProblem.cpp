@@ -24,10 +24,69 @@
 
 #include <sofa/component/constraint/lagrangian/solver/GenericConstraintSolver.h>
 #include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/ParallelForEach.h>
 
 namespace sofa::component::constraint::lagrangian::solver
 {
 
+namespace
+{
+
+/// Below this number of constraints, a color is swept sequentially: the synchronization of the threads would cost more
+/// than the updates of the constraints
+constexpr int MinParallelColorSize = 32;
+
+/// Error of the constraint starting at the line j, i.e. the displacement due to the change of its force since
+/// previousForce. constraintsAreVerified is set to false if the error is above the tolerance.
+SReal constraintError(const core::behavior::ConstraintResolution* resolution, int j, unsigned int nb, SReal** w,
+                      const SReal* force, const SReal* previousForce, SReal tol, bool& constraintsAreVerified)
+{
+    SReal contraintError = 0.0;
+    if(nb > 1)
+    {
+        for(unsigned int l=0; l<nb; l++)
+        {
+            SReal lineError = 0.0;
+            for (unsigned int m=0; m<nb; m++)
+            {
+                const SReal dofError = w[j+l][j+m] * (force[j+m] - previousForce[m]);
+                lineError += dofError * dofError;
+            }
+            lineError = sqrt(lineError);
+            if(lineError > tol)
+            {
+                constraintsAreVerified = false;
+            }
+
+            contraintError += lineError;
+        }
+    }
+    else
+    {
+        contraintError = fabs(w[j][j] * (force[j] - previousForce[0]));
+        if(contraintError > tol)
+        {
+            constraintsAreVerified = false;
+        }
+    }
+
+    const bool givenTolerance = (bool)resolution->getTolerance();
+
+    if(givenTolerance)
+    {
+        if(contraintError > resolution->getTolerance())
+        {
+            constraintsAreVerified = false;
+        }
+        contraintError *= tol / resolution->getTolerance();
+    }
+
+    return contraintError;
+}
+
+} // namespace
+
 void GenericConstraintProblem::clear(int nbC)
 {
     ConstraintProblem::clear(nbC);
@@ -35,6 +94,9 @@ void GenericConstraintProblem::clear(int nbC)
     freeConstraintResolutions();
     constraintsResolutions.resize(nbC);
     _d.resize(nbC);
+    previousIslands.clear();
+    m_lineIslands.clear();
+    m_islandNbLines.clear();
 }
 
 void GenericConstraintProblem::freeConstraintResolutions()
@@ -80,8 +142,18 @@ void GenericConstraintProblem::solveTimed(SReal tol, int maxIt, SReal timeout)
     maxIterations = tempMaxIt;
 }
 
-// Debug is only available when called directly by the solver (not in haptic thread)
 void GenericConstraintProblem::gaussSeidel(SReal timeout, GenericConstraintSolver* solver)
+{
+    projectedGaussSeidel(timeout, solver, false);
+}
+
+void GenericConstraintProblem::parallelGaussSeidel(SReal timeout, GenericConstraintSolver* solver)
+{
+    projectedGaussSeidel(timeout, solver, true);
+}
+
+// Debug is only available when called directly by the solver (not in haptic thread)
+void GenericConstraintProblem::projectedGaussSeidel(SReal timeout, GenericConstraintSolver* solver, bool parallel)
 {
     if(!solver)
         return;
@@ -129,6 +201,11 @@ void GenericConstraintProblem::gaussSeidel(SReal timeout, GenericConstraintSolve
         i += constraintsResolutions[i]->getNbLines();
     }
 
+    if(parallel)
+    {
+        computeConstraintColoring();
+    }
+
     bool showGraphs = false;
     sofa::type::vector<SReal>* graph_residuals = nullptr;
     std::map < std::string, sofa::type::vector<SReal> > *graph_forces = nullptr, *graph_violations = nullptr;
@@ -162,7 +239,14 @@ void GenericConstraintProblem::gaussSeidel(SReal timeout, GenericConstraintSolve
         }
 
         error=0.0;
-        gaussSeidel_increment(true, dfree, force, w, tol, d, dimension, constraintsAreVerified, error, tabErrors);
+        if(parallel)
+        {
+            parallelGaussSeidel_increment(dfree, force, w, tol, d, constraintsAreVerified, error, tabErrors);
+        }
+        else
+        {
+            gaussSeidel_increment(true, dfree, force, w, tol, d, dimension, constraintsAreVerified, error, tabErrors);
+        }
 
         if(showGraphs)
         {
@@ -662,55 +746,393 @@ void GenericConstraintProblem::gaussSeidel_increment(bool measureError, SReal *d
         //4. the error is measured (displacement due to the new resolution (i.e. due to the new force))
         if(measureError)
         {
-            SReal contraintError = 0.0;
-            if(nb > 1)
+            const SReal contraintError = constraintError(constraintsResolutions[j], j, nb, w, force, errF.data(), tol, constraintsAreVerified);
+            error += contraintError;
+            tabErrors[j] = contraintError;
+        }
+        else
+        {
+            constraintsAreVerified = true;
+        }
+
+        j += nb;
+    }
+}
+
+void GenericConstraintProblem::computeConstraintCoupling()
+{
+    SReal **w = getW();
+
+    m_constraintBlocks.clear();
+    int nbLines = 0;
+    while(nbLines < dimension && constraintsResolutions[nbLines])
+    {
+        m_constraintBlocks.push_back(nbLines);
+        nbLines += constraintsResolutions[nbLines]->getNbLines();
+    }
+    const int nbBlocks = static_cast<int>(m_constraintBlocks.size());
+    m_constraintBlocks.push_back(nbLines);
+
+    m_lineBlock.resize(nbLines);
+    for(int b=0; b<nbBlocks; b++)
+    {
+        std::fill(m_lineBlock.begin() + m_constraintBlocks[b], m_lineBlock.begin() + m_constraintBlocks[b+1], b);
+    }
+
+    // 1. the constraints coupled with each constraint are found in its rows of the compliance matrix
+    m_blockNeighbors.resize(nbBlocks);
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+    const auto execution = nbBlocks >= MinParallelColorSize ? simulation::ForEachExecutionPolicy::PARALLEL : simulation::ForEachExecutionPolicy::SEQUENTIAL;
+    simulation::forEach(execution, *taskScheduler, 0, nbBlocks, [this, w, nbLines](int b)
+    {
+        auto& neighbors = m_blockNeighbors[b];
+        neighbors.clear();
+        neighbors.push_back(b);
+        for(int l=m_constraintBlocks[b]; l<m_constraintBlocks[b+1]; l++)
+        {
+            for(int k=0; k<nbLines; k++)
             {
-                for(unsigned int l=0; l<nb; l++)
+                if(w[l][k] != 0)
                 {
-                    SReal lineError = 0.0;
-                    for (unsigned int m=0; m<nb; m++)
+                    neighbors.push_back(m_lineBlock[k]);
+                    k = m_constraintBlocks[m_lineBlock[k]+1] - 1; // the other lines of this constraint are skipped
+                }
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    });
+
+    // 2. the coupling is made symmetric, in case the compliance matrix is not
+    sofa::type::vector<std::size_t> nbOwnNeighbors(nbBlocks);
+    for(int b=0; b<nbBlocks; b++)
+    {
+        nbOwnNeighbors[b] = m_blockNeighbors[b].size();
+    }
+    for(int b=0; b<nbBlocks; b++)
+    {
+        for(std::size_t n=0; n<nbOwnNeighbors[b]; n++)
+        {
+            const int neighbor = m_blockNeighbors[b][n];
+            if(neighbor != b && !std::binary_search(m_blockNeighbors[neighbor].begin(), m_blockNeighbors[neighbor].begin() + nbOwnNeighbors[neighbor], b))
+            {
+                m_blockNeighbors[neighbor].push_back(b);
+            }
+        }
+    }
+}
+
+void GenericConstraintProblem::computeConstraintColoring()
+{
+    computeConstraintCoupling();
+    const int nbBlocks = static_cast<int>(m_constraintBlocks.size()) - 1;
+    const int nbLines = m_constraintBlocks.back();
+
+    // greedy coloring, in the order of the constraints
+    sofa::type::vector<int> blockColor(nbBlocks, -1);
+    sofa::type::vector<int> usedBy; // usedBy[c] == b if the color c is used by a constraint coupled with b
+    for(int b=0; b<nbBlocks; b++)
+    {
+        for(const int neighbor : m_blockNeighbors[b])
+        {
+            if(blockColor[neighbor] >= 0)
+            {
+                usedBy[blockColor[neighbor]] = b;
+            }
+        }
+        int color = 0;
+        while(color < static_cast<int>(usedBy.size()) && usedBy[color] == b)
+        {
+            color++;
+        }
+        if(color == static_cast<int>(usedBy.size()))
+        {
+            usedBy.push_back(-1);
+        }
+        blockColor[b] = color;
+    }
+
+    // the constraints are sorted by color
+    const int nbColors = static_cast<int>(usedBy.size());
+    m_colorBegin.assign(nbColors + 1, 0);
+    for(const int color : blockColor)
+    {
+        m_colorBegin[color + 1]++;
+    }
+    for(int c=0; c<nbColors; c++)
+    {
+        m_colorBegin[c + 1] += m_colorBegin[c];
+    }
+    m_coloredBlocks.resize(nbBlocks);
+    sofa::type::vector<int> next(m_colorBegin.begin(), m_colorBegin.end() - 1);
+    for(int b=0; b<nbBlocks; b++)
+    {
+        m_coloredBlocks[next[blockColor[b]]++] = b;
+    }
+
+    m_previousForce.resize(nbLines);
+    m_blockVerified.resize(nbBlocks);
+
+    sofa::helper::AdvancedTimer::valSet("GS colors", nbColors);
+}
+
+void GenericConstraintProblem::computeConstraintIslands()
+{
+    computeConstraintCoupling();
+    const int nbBlocks = static_cast<int>(m_constraintBlocks.size()) - 1;
+
+    // the connected components of the coupling graph are found by a depth-first traversal
+    m_islandBlocks.clear();
+    m_islandBegin.assign(1, 0);
+    sofa::type::vector<bool> visited(nbBlocks, false);
+    sofa::type::vector<int> stack;
+    for(int b=0; b<nbBlocks; b++)
+    {
+        if(visited[b])
+        {
+            continue;
+        }
+        visited[b] = true;
+        stack.push_back(b);
+        while(!stack.empty())
+        {
+            const int current = stack.back();
+            stack.pop_back();
+            m_islandBlocks.push_back(current);
+            for(const int neighbor : m_blockNeighbors[current])
+            {
+                if(!visited[neighbor])
+                {
+                    visited[neighbor] = true;
+                    stack.push_back(neighbor);
+                }
+            }
+        }
+        // the constraints of an island are solved in their global order
+        std::sort(m_islandBlocks.begin() + m_islandBegin.back(), m_islandBlocks.end());
+        m_islandBegin.push_back(static_cast<int>(m_islandBlocks.size()));
+    }
+
+    const int nbIslands = static_cast<int>(m_islandBegin.size()) - 1;
+    m_lineIslands.assign(m_constraintBlocks.back(), -1);
+    m_islandNbLines.assign(nbIslands, 0);
+    for(int island=0; island<nbIslands; island++)
+    {
+        for(int i=m_islandBegin[island]; i<m_islandBegin[island + 1]; i++)
+        {
+            const int b = m_islandBlocks[i];
+            std::fill(m_lineIslands.begin() + m_constraintBlocks[b], m_lineIslands.begin() + m_constraintBlocks[b + 1], island);
+            m_islandNbLines[island] += m_constraintBlocks[b + 1] - m_constraintBlocks[b];
+        }
+    }
+
+    m_previousForce.resize(m_constraintBlocks.back());
+}
+
+void GenericConstraintProblem::islandsGaussSeidel(SReal timeout, GenericConstraintSolver* solver)
+{
+    if(!solver)
+        return;
+
+    const int dimension = getDimension();
+
+    if(!dimension)
+    {
+        currentError = 0.0;
+        currentIterations = 0;
+        return;
+    }
+
+    const SReal t0 = (SReal)sofa::helper::system::thread::CTime::getTime() ;
+    const SReal timeScale = 1.0 / (SReal)sofa::helper::system::thread::CTime::getTicksPerSec();
+
+    SReal *dfree = getDfree();
+    SReal *force = getF();
+    SReal **w = getW();
+    SReal *d = _d.ptr();
+
+    for(int i=0; i<dimension; )
+    {
+        if(!constraintsResolutions[i])
+        {
+            msg_error(solver) << "Bad size of constraintsResolutions in GenericConstraintProblem" ;
+            break;
+        }
+        constraintsResolutions[i]->init(i, w, force);
+        i += constraintsResolutions[i]->getNbLines();
+    }
+
+    computeConstraintIslands();
+    const int nbIslands = static_cast<int>(m_islandBegin.size()) - 1;
+
+    struct IslandResult
+    {
+        SReal error { 0 };
+        int iterations { 0 };
+        bool convergence { true };
+        bool sleeping { false };
+    };
+    sofa::type::vector<IslandResult> islandResults(nbIslands);
+    sofa::type::vector<SReal> tabErrors(dimension);
+
+    const auto solveIsland = [&](int island)
+    {
+        const int islandBegin = m_islandBegin[island];
+        const int islandEnd = m_islandBegin[island + 1];
+        IslandResult& result = islandResults[island];
+
+        // an island made of the same unchanged constraints as at the previous time step keeps its forces
+        if(!previousIslands.empty())
+        {
+            const int previous = previousIslands[m_constraintBlocks[m_islandBlocks[islandBegin]]];
+            result.sleeping = previous >= 0 && previous < static_cast<int>(previousIslandNbLines.size()) && previousIslandNbLines[previous] == m_islandNbLines[island]
+                && std::all_of(m_islandBlocks.begin() + islandBegin, m_islandBlocks.begin() + islandEnd,
+                    [this, previous](int b){ return previousIslands[m_constraintBlocks[b]] == previous; });
+            if(result.sleeping)
+            {
+                return;
+            }
+        }
+
+        SReal tol = tolerance;
+        if(scaleTolerance && !allVerified)
+        {
+            tol *= m_islandNbLines[island];
+        }
+
+        sofa::type::vector<SReal> tempForces;
+        result.convergence = false;
+        for(int it=0; it<maxIterations; it++)
+        {
+            result.iterations++;
+            bool constraintsAreVerified = true;
+            result.error = 0.0;
+
+            for(int i=islandBegin; i<islandEnd; i++)
+            {
+                const int b = m_islandBlocks[i];
+                const int j = m_constraintBlocks[b];
+                const unsigned int nb = m_constraintBlocks[b + 1] - j;
+
+                std::copy_n(&force[j], nb, &m_previousForce[j]);
+                std::copy_n(&dfree[j], nb, &d[j]);
+                for(const int neighbor : m_blockNeighbors[b])
+                {
+                    for(int k=m_constraintBlocks[neighbor]; k<m_constraintBlocks[neighbor + 1]; k++)
                     {
-                        const SReal dofError = w[j+l][j+m] * (force[j+m] - errF[m]);
-                        lineError += dofError * dofError;
+                        for(unsigned int l=0; l<nb; l++)
+                        {
+                            d[j+l] += w[j+l][k] * force[k];
+                        }
                     }
-                    lineError = sqrt(lineError);
-                    if(lineError > tol)
+                }
+
+                constraintsResolutions[j]->resolution(j, w, d, force, dfree);
+
+                tabErrors[j] = constraintError(constraintsResolutions[j], j, nb, w, force, &m_previousForce[j], tol, constraintsAreVerified);
+                result.error += tabErrors[j];
+
+                if(sor != 1.0)
+                {
+                    for(unsigned int l=0; l<nb; l++)
                     {
-                        constraintsAreVerified = false;
+                        force[j+l] = sor * force[j+l] + (1-sor) * m_previousForce[j+l];
                     }
-
-                    contraintError += lineError;
                 }
             }
-            else
+
+            if(timeout && ((SReal)sofa::helper::system::thread::CTime::getTime() - t0) * timeScale > timeout)
             {
-                contraintError = fabs(w[j][j] * (force[j] - errF[0]));
-                if(contraintError > tol)
+                break;
+            }
+            else if(allVerified)
+            {
+                if(constraintsAreVerified)
                 {
-                    constraintsAreVerified = false;
+                    result.convergence = true;
+                    break;
                 }
             }
+            else if(result.error < tol)
+            {
+                result.convergence = true;
+                break;
+            }
+        }
+    };
 
-            const bool givenTolerance = (bool)constraintsResolutions[j]->getTolerance();
+    // the islands are not coupled: they are solved concurrently
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+    const auto execution = nbIslands > 1 ? simulation::ForEachExecutionPolicy::PARALLEL : simulation::ForEachExecutionPolicy::SEQUENTIAL;
+    simulation::forEach(execution, *taskScheduler, 0, nbIslands, solveIsland);
+
+    SReal error = 0.0;
+    int iterCount = 0;
+    int nbSleepingIslands = 0;
+    bool convergence = true;
+    for(const IslandResult& result : islandResults)
+    {
+        error += result.error;
+        iterCount = std::max(iterCount, result.iterations);
+        nbSleepingIslands += result.sleeping;
+        convergence &= result.convergence;
+    }
 
-            if(givenTolerance)
+    sofa::helper::AdvancedTimer::valSet("GS islands", nbIslands);
+    sofa::helper::AdvancedTimer::valSet("GS sleeping islands", nbSleepingIslands);
+    msg_info(solver) << nbIslands << " islands of constraints, " << nbSleepingIslands << " sleeping";
+
+    result_output(solver, force, error, iterCount, convergence);
+}
+
+void GenericConstraintProblem::parallelGaussSeidel_increment(SReal *dfree, SReal *force, SReal **w, SReal tol, SReal *d, bool& constraintsAreVerified, SReal& error, sofa::type::vector<SReal>& tabErrors)
+{
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+
+    // The constraints of a same color are not coupled: each of them only reads the forces of the other colors
+    for(std::size_t c=0; c+1<m_colorBegin.size(); c++)
+    {
+        const int colorBegin = m_colorBegin[c];
+        const int colorEnd = m_colorBegin[c + 1];
+        const auto execution = colorEnd - colorBegin >= MinParallelColorSize ? simulation::ForEachExecutionPolicy::PARALLEL : simulation::ForEachExecutionPolicy::SEQUENTIAL;
+
+        simulation::forEach(execution, *taskScheduler, colorBegin, colorEnd, [this, dfree, force, w, tol, d, &tabErrors](int i)
+        {
+            const int b = m_coloredBlocks[i];
+            const int j = m_constraintBlocks[b];
+            const unsigned int nb = m_constraintBlocks[b + 1] - j;
+
+            std::copy_n(&force[j], nb, &m_previousForce[j]);
+            std::copy_n(&dfree[j], nb, &d[j]);
+
+            // only the forces of the coupled constraints contribute to d
+            for(const int neighbor : m_blockNeighbors[b])
             {
-                if(contraintError > constraintsResolutions[j]->getTolerance())
+                for(int k=m_constraintBlocks[neighbor]; k<m_constraintBlocks[neighbor + 1]; k++)
                 {
-                    constraintsAreVerified = false;
+                    for(unsigned int l=0; l<nb; l++)
+                    {
+                        d[j+l] += w[j+l][k] * force[k];
+                    }
                 }
-                contraintError *= tol / constraintsResolutions[j]->getTolerance();
             }
 
-            error += contraintError;
-            tabErrors[j] = contraintError;
-        }
-        else
+            constraintsResolutions[j]->resolution(j, w, d, force, dfree);
+
+            bool verified = true;
+            tabErrors[j] = constraintError(constraintsResolutions[j], j, nb, w, force, &m_previousForce[j], tol, verified);
+            m_blockVerified[b] = verified;
+        });
+    }
+
+    // the errors are summed in the order of the constraints, for the result not to depend on the threads
+    for(std::size_t b=0; b+1<m_constraintBlocks.size(); b++)
+    {
+        error += tabErrors[m_constraintBlocks[b]];
+        if(!m_blockVerified[b])
         {
-            constraintsAreVerified = true;
+            constraintsAreVerified = false;
         }
-
-        j += nb;
     }
 }
 
@@ -51,6 +51,16 @@ public:
 
     std::vector< ConstraintCorrections > cclist_elems;
 
+    /// For each line, the island of the previous time step if the constraint is unchanged, -1 otherwise (see islandsGaussSeidel)
+    sofa::type::vector<int> previousIslands;
+    /// Number of lines of each island of the previous time step
+    sofa::type::vector<int> previousIslandNbLines;
+
+    /// Island of each line, computed by islandsGaussSeidel
+    const sofa::type::vector<int>& getLineIslands() const { return m_lineIslands; }
+    /// Number of lines of each island, computed by islandsGaussSeidel
+    const sofa::type::vector<int>& getIslandNbLines() const { return m_islandNbLines; }
+
 
     GenericConstraintProblem() : scaleTolerance(true), allVerified(false), sor(1.0)
       , sceneTime(0.0), currentError(0.0), currentIterations(0)
@@ -63,6 +73,15 @@ public:
 
     /// Projective Gauss Seidel method building the compliance matrix
     void gaussSeidel(SReal timeout=0, GenericConstraintSolver* solver = nullptr);
+    /// Projective Gauss Seidel method building the compliance matrix, where the constraints are colored so that two
+    /// coupled constraints (nonzero block of the compliance matrix) have different colors. The constraints of a same
+    /// color are updated concurrently on the task scheduler, the colors are swept in sequence.
+    void parallelGaussSeidel(SReal timeout=0, GenericConstraintSolver* solver = nullptr);
+    /// Projective Gauss Seidel method building the compliance matrix, where the groups of constraints which are not
+    /// coupled by the compliance matrix (islands) are solved separately and concurrently on the task scheduler. The
+    /// islands made of the same unchanged constraints as at the previous time step (see previousIslands) are not
+    /// solved: they keep the forces of the initial guess.
+    void islandsGaussSeidel(SReal timeout=0, GenericConstraintSolver* solver = nullptr);
     /// Projective Gauss Seidel unbuilt method
     void unbuiltGaussSeidel(SReal timeout=0, GenericConstraintSolver* solver = nullptr);
     /// Method from:
@@ -77,6 +96,32 @@ public:
     int getNumConstraintGroups();
 
 protected:
+    void projectedGaussSeidel(SReal timeout, GenericConstraintSolver* solver, bool parallel);
+
+    /// Finds the constraints coupled with each constraint by the compliance matrix
+    void computeConstraintCoupling();
+
+    /// Colors the graph of the constraints coupled by the compliance matrix
+    void computeConstraintColoring();
+
+    /// Finds the connected components of the graph of the constraints coupled by the compliance matrix
+    void computeConstraintIslands();
+
+    /// Parallel version of gaussSeidel_increment, sweeping the colors of computeConstraintColoring in sequence
+    void parallelGaussSeidel_increment(SReal *dfree, SReal *force, SReal **w, SReal tol, SReal *d, bool& constraintsAreVerified, SReal& error, sofa::type::vector<SReal>& tabErrors);
+
+    sofa::type::vector<int> m_constraintBlocks; ///< First line of each constraint
+    sofa::type::vector<int> m_lineBlock; ///< Index of the constraint of each line
+    sofa::type::vector<sofa::type::vector<int> > m_blockNeighbors; ///< Constraints coupled with each constraint, including itself
+    sofa::type::vector<int> m_coloredBlocks; ///< Constraints sorted by color
+    sofa::type::vector<int> m_colorBegin; ///< Range of each color in m_coloredBlocks
+    sofa::type::vector<int> m_islandBlocks; ///< Constraints sorted by island
+    sofa::type::vector<int> m_islandBegin; ///< Range of each island in m_islandBlocks
+    sofa::type::vector<int> m_lineIslands; ///< Island of each line
+    sofa::type::vector<int> m_islandNbLines; ///< Number of lines of each island
+    sofa::type::vector<SReal> m_previousForce;
+    sofa::type::vector<char> m_blockVerified;
+
     sofa::linearalgebra::FullVector<SReal> m_lam;
     sofa::linearalgebra::FullVector<SReal> m_deltaF;
     sofa::linearalgebra::FullVector<SReal> m_deltaF_new;
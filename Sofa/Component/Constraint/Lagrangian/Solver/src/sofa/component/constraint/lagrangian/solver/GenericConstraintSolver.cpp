@@ -40,6 +40,9 @@ using sofa::simulation::mechanicalvisitor::MechanicalVOpVisitor;
 #include <sofa/simulation/mechanicalvisitor/MechanicalProjectJacobianMatrixVisitor.h>
 using sofa::simulation::mechanicalvisitor::MechanicalProjectJacobianMatrixVisitor;
 
+#include <sofa/simulation/mechanicalvisitor/MechanicalGetConstraintInfoVisitor.h>
+using sofa::simulation::mechanicalvisitor::MechanicalGetConstraintInfoVisitor;
+
 namespace sofa::component::constraint::lagrangian::solver
 {
 
@@ -61,7 +64,7 @@ void clearMultiVecId(sofa::core::objectmodel::BaseContext* ctx, const sofa::core
 }
 
 GenericConstraintSolver::GenericConstraintSolver()
-    : d_resolutionMethod( initData(&d_resolutionMethod, "resolutionMethod", "Method used to solve the constraint problem, among: \"ProjectedGaussSeidel\", \"UnbuiltGaussSeidel\" or \"for NonsmoothNonlinearConjugateGradient\""))
+    : d_resolutionMethod( initData(&d_resolutionMethod, "resolutionMethod", "Method used to solve the constraint problem, among: \"ProjectedGaussSeidel\", \"UnbuiltGaussSeidel\", \"for NonsmoothNonlinearConjugateGradient\" or \"ParallelProjectedGaussSeidel\""))
     , d_maxIt(initData(&d_maxIt, 1000, "maxIterations", "maximal number of iterations of the Gauss-Seidel algorithm"))
     , d_tolerance(initData(&d_tolerance, 0.001_sreal, "tolerance", "residual error threshold for termination of the Gauss-Seidel algorithm"))
     , d_sor(initData(&d_sor, 1.0_sreal, "sor", "Successive Over Relaxation parameter (0-2)"))
@@ -69,6 +72,9 @@ GenericConstraintSolver::GenericConstraintSolver()
     , d_allVerified(initData(&d_allVerified, false, "allVerified", "All constraints must be verified (each constraint's error < tolerance)"))
     , d_newtonIterations(initData(&d_newtonIterations, 100, "newtonIterations", "Maximum iteration number of Newton (for the NonsmoothNonlinearConjugateGradient solver only)"))
     , d_multithreading(initData(&d_multithreading, false, "multithreading", "Build compliances concurrently"))
+    , d_warmStart(initData(&d_warmStart, false, "warmStart", "Start the resolution from the forces of the previous time step, matched with the persistent ids of the constraints (not available with UnbuiltGaussSeidel)"))
+    , d_solveIslands(initData(&d_solveIslands, false, "solveIslands", "Solve separately and concurrently the groups of constraints which are not coupled (for the ProjectedGaussSeidel solver only)"))
+    , d_sleepingThreshold(initData(&d_sleepingThreshold, 0.0_sreal, "sleepingThreshold", "Islands whose constraint violations changed less than this threshold since the previous time step keep their forces (requires solveIslands and warmStart, 0 to disable)"))
     , d_computeGraphs(initData(&d_computeGraphs, false, "computeGraphs", "Compute graphs of errors and forces during resolution"))
     , d_graphErrors(initData(&d_graphErrors, "graphErrors", "Sum of the constraints' errors at each iteration"))
     , d_graphConstraints(initData(&d_graphConstraints, "graphConstraints", "Graph of each constraint's error at the end of the resolution"))
@@ -86,7 +92,7 @@ GenericConstraintSolver::GenericConstraintSolver()
     , current_cp(&m_cpBuffer[0])
     , last_cp(nullptr)
 {
-    sofa::helper::OptionsGroup m_newoptiongroup{"ProjectedGaussSeidel","UnbuiltGaussSeidel", "NonsmoothNonlinearConjugateGradient"};
+    sofa::helper::OptionsGroup m_newoptiongroup{"ProjectedGaussSeidel","UnbuiltGaussSeidel", "NonsmoothNonlinearConjugateGradient", "ParallelProjectedGaussSeidel"};
     m_newoptiongroup.setSelectedItem("ProjectedGaussSeidel");
     d_resolutionMethod.setValue(m_newoptiongroup);
 
@@ -152,7 +158,8 @@ void GenericConstraintSolver::init()
         m_dxId = dx.id();
     }
 
-    if(d_multithreading.getValue())
+    // the parallel Gauss-Seidel methods use the task scheduler, whether the compliances are built concurrently or not
+    if(d_multithreading.getValue() || d_resolutionMethod.getValue().getSelectedId() == 3 || d_solveIslands.getValue())
     {
         simulation::MainTaskSchedulerFactory::createInRegistry()->init();
     }
@@ -164,6 +171,21 @@ void GenericConstraintSolver::init()
             msg_warning() << "data \"newtonIterations\" is not only taken into account when using the NonsmoothNonlinearConjugateGradient solver";
         }
     }
+
+    if(d_warmStart.getValue() && d_resolutionMethod.getValue().getSelectedId() == 1)
+    {
+        msg_warning() << "data \"warmStart\" is not taken into account when using the UnbuiltGaussSeidel solver";
+    }
+
+    if(d_solveIslands.getValue() && d_resolutionMethod.getValue().getSelectedId() != 0)
+    {
+        msg_warning() << "data \"solveIslands\" is only taken into account when using the ProjectedGaussSeidel solver";
+    }
+
+    if(d_sleepingThreshold.getValue() > 0 && !(d_solveIslands.getValue() && d_warmStart.getValue()))
+    {
+        msg_warning() << "data \"sleepingThreshold\" is only taken into account when \"solveIslands\" and \"warmStart\" are enabled";
+    }
 }
 
 void GenericConstraintSolver::cleanup()
@@ -229,8 +251,13 @@ bool GenericConstraintSolver::buildSystem(const core::ConstraintParams *cParams,
     {
         case 0: // ProjectedGaussSeidel
         case 2: // NonsmoothNonlinearConjugateGradient
+        case 3: // ParallelProjectedGaussSeidel
         {
             buildSystem_matrixAssembly(cParams);
+            if(d_warmStart.getValue())
+            {
+                computeInitialGuess(cParams);
+            }
             break;
         }
         case 1: // UnbuiltGaussSeidel
@@ -441,8 +468,16 @@ bool GenericConstraintSolver::solveSystem(const core::ConstraintParams * /*cPara
 
                 msg_info() << tmp.str() ;
             }
-            SCOPED_TIMER_VARNAME(gaussSeidelTimer, "ConstraintsGaussSeidel");
-            current_cp->gaussSeidel(0, this);
+            if(d_solveIslands.getValue())
+            {
+                SCOPED_TIMER_VARNAME(islandsGaussSeidelTimer, "ConstraintsIslandsGaussSeidel");
+                current_cp->islandsGaussSeidel(0, this);
+            }
+            else
+            {
+                SCOPED_TIMER_VARNAME(gaussSeidelTimer, "ConstraintsGaussSeidel");
+                current_cp->gaussSeidel(0, this);
+            }
             break;
         }
         // UnbuiltGaussSeidel
@@ -456,6 +491,12 @@ bool GenericConstraintSolver::solveSystem(const core::ConstraintParams * /*cPara
             current_cp->NNCG(this, d_newtonIterations.getValue());
             break;
         }
+        // ParallelProjectedGaussSeidel
+        case 3: {
+            SCOPED_TIMER_VARNAME(parallelGaussSeidelTimer, "ConstraintsParallelGaussSeidel");
+            current_cp->parallelGaussSeidel(0, this);
+            break;
+        }
         default:
             msg_error() << "Wrong \"resolutionMethod\" given";
     }
@@ -474,6 +515,11 @@ bool GenericConstraintSolver::solveSystem(const core::ConstraintParams * /*cPara
         msg_info() << tmp.str() ;
     }
 
+    if(d_warmStart.getValue())
+    {
+        keepContactForcesValue();
+    }
+
     if(d_computeConstraintForces.getValue())
     {
         WriteOnlyAccessor<Data<type::vector<SReal>>> constraints = d_constraintForces;
@@ -487,6 +533,57 @@ bool GenericConstraintSolver::solveSystem(const core::ConstraintParams * /*cPara
     return true;
 }
 
+void GenericConstraintSolver::computeInitialGuess(const core::ConstraintParams* cParams)
+{
+    SCOPED_TIMER("InitialGuess");
+
+    {
+        SCOPED_TIMER("Get Constraint Info");
+        m_constraintBlockInfo.clear();
+        m_constraintIds.clear();
+        m_constraintPositions.clear();
+        m_constraintDirections.clear();
+        m_constraintAreas.clear();
+        MechanicalGetConstraintInfoVisitor(cParams, m_constraintBlockInfo, m_constraintIds, m_constraintPositions, m_constraintDirections, m_constraintAreas).execute(getContext());
+    }
+
+    const SReal* dfree = current_cp->getDfree();
+    const int dimension = current_cp->getDimension();
+
+    // the constraints whose violation did not change are candidates for sleeping islands
+    const SReal sleepingThreshold = d_sleepingThreshold.getValue();
+    PersistentConstraintForces::RestoredConstraintCallback findUnchangedConstraint;
+    if (sleepingThreshold > 0 && d_solveIslands.getValue() && !m_previousIslands.empty())
+    {
+        current_cp->previousIslands.assign(dimension, -1);
+        current_cp->previousIslandNbLines = m_previousIslandNbLines;
+        findUnchangedConstraint = [&](int index, int prevIndex, int nbl, bool sameNbLines)
+        {
+            if (!sameNbLines || prevIndex+nbl > (int) m_previousIslands.size()) return;
+            bool unchanged = true;
+            for (int l=0; l<nbl; ++l)
+                unchanged &= std::abs(dfree[index + l] - m_previousViolations[prevIndex + l]) < sleepingThreshold;
+            if (unchanged)
+                std::fill_n(current_cp->previousIslands.begin() + index, nbl, m_previousIslands[prevIndex]);
+        };
+    }
+
+    m_previousForces.restore(m_constraintBlockInfo, m_constraintIds, current_cp->getF(), dimension, findUnchangedConstraint);
+}
+
+void GenericConstraintSolver::keepContactForcesValue()
+{
+    SCOPED_TIMER("KeepForces");
+
+    m_previousForces.store(m_constraintBlockInfo, m_constraintIds, current_cp->getF(), current_cp->getDimension());
+
+    // store the violations and islands, to find the islands which did not change at the next time step
+    const SReal* dfree = current_cp->getDfree();
+    m_previousViolations.assign(dfree, dfree + current_cp->getDimension());
+    m_previousIslands = current_cp->getLineIslands();
+    m_previousIslandNbLines = current_cp->getIslandNbLines();
+}
+
 void GenericConstraintSolver::computeResidual(const core::ExecParams* eparam)
 {
     for (const auto& cc : l_constraintCorrections)
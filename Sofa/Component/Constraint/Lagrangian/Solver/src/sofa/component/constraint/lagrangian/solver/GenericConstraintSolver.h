@@ -24,6 +24,7 @@
 #include <sofa/component/constraint/lagrangian/solver/GenericConstraintProblem.h>
 
 #include <sofa/component/constraint/lagrangian/solver/ConstraintSolverImpl.h>
+#include <sofa/component/constraint/lagrangian/solver/PersistentConstraintForces.h>
 #include <sofa/core/behavior/BaseConstraintCorrection.h>
 #include <sofa/core/behavior/BaseConstraint.h>
 #include <sofa/helper/map.h>
@@ -60,7 +61,7 @@ public:
     ConstraintProblem* getConstraintProblem() override;
     void lockConstraintProblem(sofa::core::objectmodel::BaseObject* from, ConstraintProblem* p1, ConstraintProblem* p2 = nullptr) override;
 
-    Data< sofa::helper::OptionsGroup > d_resolutionMethod; ///< Method used to solve the constraint problem, among: "ProjectedGaussSeidel", "UnbuiltGaussSeidel" or "for NonsmoothNonlinearConjugateGradient"
+    Data< sofa::helper::OptionsGroup > d_resolutionMethod; ///< Method used to solve the constraint problem, among: "ProjectedGaussSeidel", "UnbuiltGaussSeidel", "for NonsmoothNonlinearConjugateGradient" or "ParallelProjectedGaussSeidel"
 
     SOFA_ATTRIBUTE_DEPRECATED__RENAME_DATA_IN_CONSTRAINT_LAGRANGIAN_SOLVER()
     sofa::core::objectmodel::RenamedData<int> maxIt;
@@ -114,6 +115,9 @@ public:
     Data<bool> d_allVerified; ///< All constraints must be verified (each constraint's error < tolerance)
     Data<int> d_newtonIterations; ///< Maximum iteration number of Newton (for the NonsmoothNonlinearConjugateGradient solver only)
     Data<bool> d_multithreading; ///< Build compliances concurrently
+    Data<bool> d_warmStart; ///< Start the resolution from the forces of the previous time step, matched with the persistent ids of the constraints (not available with UnbuiltGaussSeidel)
+    Data<bool> d_solveIslands; ///< Solve separately and concurrently the groups of constraints which are not coupled (for the ProjectedGaussSeidel solver only)
+    Data<SReal> d_sleepingThreshold; ///< Islands whose constraint violations changed less than this threshold since the previous time step keep their forces (requires solveIslands and warmStart, 0 to disable)
     Data<bool> d_computeGraphs; ///< Compute graphs of errors and forces during resolution
     Data<std::map < std::string, sofa::type::vector<SReal> > > d_graphErrors; ///< Sum of the constraints' errors at each iteration
     Data<std::map < std::string, sofa::type::vector<SReal> > > d_graphConstraints; ///< Graph of each constraint's error at the end of the resolution
@@ -149,6 +153,22 @@ protected:
     // Explicitly compute the compliance matrix projected in the constraint space
     void buildSystem_matrixAssembly(const core::ConstraintParams *cParams);
 
+    /// Initial forces of the constraints which already existed at the previous time step
+    void computeInitialGuess(const core::ConstraintParams *cParams);
+    /// Store the forces of the constraints by persistent id, for the initial guess of the next time step
+    void keepContactForcesValue();
+
+    PersistentConstraintForces m_previousForces; ///< Forces of the previous time step, for the warm start
+    type::vector< SReal > m_previousViolations;
+    type::vector< int > m_previousIslands;
+    type::vector< int > m_previousIslandNbLines;
+
+    core::behavior::BaseConstraint::VecConstraintBlockInfo m_constraintBlockInfo;
+    core::behavior::BaseConstraint::VecPersistentID m_constraintIds;
+    core::behavior::BaseConstraint::VecConstCoord m_constraintPositions;
+    core::behavior::BaseConstraint::VecConstDeriv m_constraintDirections;
+    core::behavior::BaseConstraint::VecConstArea m_constraintAreas;
+
 private:
 
     struct ComplianceWrapper
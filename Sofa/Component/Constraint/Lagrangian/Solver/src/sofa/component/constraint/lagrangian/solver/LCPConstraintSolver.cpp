@@ -677,26 +677,7 @@ void LCPConstraintSolver::computeInitialGuess()
             (*_result)[c] =  0.0;
         }
     }
-    for (const ConstraintBlockInfo& info : constraintBlockInfo)
-    {
-        if (!info.hasId) continue;
-        std::map<core::behavior::BaseConstraint*, ConstraintBlockBuf>::const_iterator previt = _previousConstraints.find(info.parent);
-        if (previt == _previousConstraints.end()) continue;
-        const ConstraintBlockBuf& buf = previt->second;
-        const int c0 = info.const0;
-        const int nbl = (info.nbLines < buf.nbLines) ? info.nbLines : buf.nbLines;
-        for (int c = 0; c < info.nbGroups; ++c)
-        {
-            std::map<PersistentID,int>::const_iterator it = buf.persistentToConstraintIdMap.find(constraintIds[info.offsetId + c]);
-            if (it == buf.persistentToConstraintIdMap.end()) continue;
-            const int prevIndex = it->second;
-            if (prevIndex >= 0 && prevIndex+nbl <= (int) _previousForces.size())
-            {
-                for (int l=0; l<nbl; ++l)
-                    (*_result)[c0 + c*nbl + l] = _previousForces[prevIndex + l];
-            }
-        }
-    }
+    m_previousForces.restore(constraintBlockInfo, constraintIds, _result->ptr(), _numConstraints);
 }
 
 void LCPConstraintSolver::keepContactForcesValue()
@@ -704,31 +685,7 @@ void LCPConstraintSolver::keepContactForcesValue()
     sofa::helper::AdvancedTimer::StepVar vtimer("KeepForces");
     const VecConstraintBlockInfo& constraintBlockInfo = hierarchy_constraintBlockInfo[0];
     const VecPersistentID& constraintIds = hierarchy_constraintIds[0];
-    // store current force
-    _previousForces.resize(_numConstraints);
-    for (unsigned int c=0; c<_numConstraints; ++c)
-        _previousForces[c] = (*_result)[c];
-    // clear previous history
-    for (auto& previousConstraint : _previousConstraints)
-    {
-        ConstraintBlockBuf& buf = previousConstraint.second;
-        for (auto& it2 : buf.persistentToConstraintIdMap)
-            it2.second = -1;
-    }
-    // fill info from current ids
-    for (const ConstraintBlockInfo& info : constraintBlockInfo)
-    {
-        if (!info.parent) continue;
-        if (!info.hasId) continue;
-        ConstraintBlockBuf& buf = _previousConstraints[info.parent];
-        const int c0 = info.const0;
-        const int nbl = info.nbLines;
-        buf.nbLines = nbl;
-        for (int c = 0; c < info.nbGroups; ++c)
-        {
-            buf.persistentToConstraintIdMap[constraintIds[info.offsetId + c]] = c0 + c*nbl;
-        }
-    }
+    m_previousForces.store(constraintBlockInfo, constraintIds, _result->ptr(), _numConstraints);
 }
 
 
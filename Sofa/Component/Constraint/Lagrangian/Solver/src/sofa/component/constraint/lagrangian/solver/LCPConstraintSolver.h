@@ -23,6 +23,7 @@
 #include <sofa/component/constraint/lagrangian/solver/config.h>
 
 #include <sofa/component/constraint/lagrangian/solver/ConstraintSolverImpl.h>
+#include <sofa/component/constraint/lagrangian/solver/PersistentConstraintForces.h>
 #include <sofa/core/behavior/BaseConstraintCorrection.h>
 #include <sofa/core/behavior/BaseConstraint.h>
 
@@ -218,15 +219,7 @@ private:
     typedef core::behavior::BaseConstraint::VecConstDeriv VecConstDeriv;
     typedef core::behavior::BaseConstraint::VecConstArea VecConstArea;
 
-    class ConstraintBlockBuf
-    {
-    public:
-        std::map<PersistentID,int> persistentToConstraintIdMap;
-        int nbLines; ///< how many dofs (i.e. lines in the matrix) are used by each constraint
-    };
-
-    std::map<core::behavior::BaseConstraint*, ConstraintBlockBuf> _previousConstraints;
-    type::vector< SReal > _previousForces;
+    PersistentConstraintForces m_previousForces; ///< Forces of the previous time step, for the initial guess
 
     type::vector< VecConstraintBlockInfo > hierarchy_constraintBlockInfo;
     type::vector< VecPersistentID > hierarchy_constraintIds;
@@ -0,0 +1,83 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/constraint/lagrangian/solver/PersistentConstraintForces.h>
+
+namespace sofa::component::constraint::lagrangian::solver
+{
+
+void PersistentConstraintForces::restore(const VecConstraintBlockInfo& constraintBlockInfo, const VecPersistentID& constraintIds, SReal* forces, int dimension,
+                                         const RestoredConstraintCallback& onRestored) const
+{
+    for (const auto& info : constraintBlockInfo)
+    {
+        if (!info.hasId) continue;
+        const auto previt = m_previousConstraints.find(info.parent);
+        if (previt == m_previousConstraints.end()) continue;
+        const ConstraintBlockBuf& buf = previt->second;
+        const int c0 = info.const0;
+        const int nbl = (info.nbLines < buf.nbLines) ? info.nbLines : buf.nbLines;
+        for (int c = 0; c < info.nbGroups; ++c)
+        {
+            const auto it = buf.persistentToConstraintIdMap.find(constraintIds[info.offsetId + c]);
+            if (it == buf.persistentToConstraintIdMap.end()) continue;
+            const int prevIndex = it->second;
+            const int index = c0 + c*info.nbLines;
+            if (prevIndex >= 0 && prevIndex+nbl <= (int) m_previousForces.size() && index+nbl <= dimension)
+            {
+                for (int l=0; l<nbl; ++l)
+                    forces[index + l] = m_previousForces[prevIndex + l];
+                if (onRestored)
+                    onRestored(index, prevIndex, nbl, info.nbLines == buf.nbLines);
+            }
+        }
+    }
+}
+
+void PersistentConstraintForces::store(const VecConstraintBlockInfo& constraintBlockInfo, const VecPersistentID& constraintIds, const SReal* forces, int dimension)
+{
+    m_previousForces.assign(forces, forces + dimension);
+
+    // the ids of the constraints which disappeared are forgotten
+    m_previousConstraints.clear();
+
+    for (const auto& info : constraintBlockInfo)
+    {
+        if (!info.parent) continue;
+        if (!info.hasId) continue;
+        ConstraintBlockBuf& buf = m_previousConstraints[info.parent];
+        const int c0 = info.const0;
+        const int nbl = info.nbLines;
+        buf.nbLines = nbl;
+        for (int c = 0; c < info.nbGroups; ++c)
+        {
+            buf.persistentToConstraintIdMap[constraintIds[info.offsetId + c]] = c0 + c*nbl;
+        }
+    }
+}
+
+void PersistentConstraintForces::clear()
+{
+    m_previousConstraints.clear();
+    m_previousForces.clear();
+}
+
+} //namespace sofa::component::constraint::lagrangian::solver
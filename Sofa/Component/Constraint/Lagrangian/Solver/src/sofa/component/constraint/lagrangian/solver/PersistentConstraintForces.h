@@ -0,0 +1,70 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/constraint/lagrangian/solver/config.h>
+
+#include <sofa/core/behavior/BaseConstraint.h>
+#include <sofa/type/vector.h>
+
+#include <functional>
+#include <map>
+
+namespace sofa::component::constraint::lagrangian::solver
+{
+
+/**
+ *  \brief Forces of the constraints of the previous time step, indexed by the persistent ids of the constraints
+ *
+ *  Used by the constraint solvers to start the resolution from the forces of the constraints which already existed at
+ *  the previous time step (e.g. the contacts identified by ContactIdentifier).
+ */
+class SOFA_COMPONENT_CONSTRAINT_LAGRANGIAN_SOLVER_API PersistentConstraintForces
+{
+public:
+    typedef core::behavior::BaseConstraint::VecConstraintBlockInfo VecConstraintBlockInfo;
+    typedef core::behavior::BaseConstraint::VecPersistentID VecPersistentID;
+
+    /// Called for each restored constraint with its first line, its first line at the previous time step, the number
+    /// of restored lines and whether the constraint had the same number of lines at the previous time step
+    typedef std::function<void(int index, int previousIndex, int nbLines, bool sameNbLines)> RestoredConstraintCallback;
+
+    /// Copy the stored forces into the lines of the constraints having the same persistent ids. The other lines are unchanged.
+    void restore(const VecConstraintBlockInfo& constraintBlockInfo, const VecPersistentID& constraintIds, SReal* forces, int dimension,
+                 const RestoredConstraintCallback& onRestored = {}) const;
+
+    /// Store the forces of the constraints by persistent id. The constraints which disappeared are forgotten.
+    void store(const VecConstraintBlockInfo& constraintBlockInfo, const VecPersistentID& constraintIds, const SReal* forces, int dimension);
+
+    void clear();
+
+protected:
+    struct ConstraintBlockBuf
+    {
+        std::map<core::behavior::BaseConstraint::PersistentID, int> persistentToConstraintIdMap;
+        int nbLines { 0 }; ///< how many dofs (i.e. lines in the matrix) are used by each constraint
+    };
+
+    std::map<core::behavior::BaseConstraint*, ConstraintBlockBuf> m_previousConstraints;
+    type::vector<SReal> m_previousForces;
+};
+
+} //namespace sofa::component::constraint::lagrangian::solver
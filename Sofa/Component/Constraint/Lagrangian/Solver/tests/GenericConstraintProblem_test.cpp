@@ -0,0 +1,403 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/constraint/lagrangian/solver/GenericConstraintProblem.h>
+#include <sofa/component/constraint/lagrangian/solver/GenericConstraintSolver.h>
+#include <sofa/core/behavior/ConstraintResolution.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/testing/BaseTest.h>
+#include <sofa/type/Vec.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+using sofa::component::constraint::lagrangian::solver::GenericConstraintProblem;
+using sofa::component::constraint::lagrangian::solver::GenericConstraintSolver;
+using sofa::type::Vec3;
+
+/// Frictionless unilateral contact
+class UnilateralResolution : public sofa::core::behavior::ConstraintResolution
+{
+public:
+    UnilateralResolution() : ConstraintResolution(1) {}
+
+    void resolution(int line, SReal** w, SReal* d, SReal* force, SReal*) override
+    {
+        force[line] -= d[line] / w[line][line];
+        if (force[line] < 0)
+        {
+            force[line] = 0;
+        }
+    }
+};
+
+/// Unilateral contact with Coulomb friction, solved as UnilateralConstraintResolutionWithFriction
+class FrictionResolution : public sofa::core::behavior::ConstraintResolution
+{
+public:
+    explicit FrictionResolution(SReal mu) : ConstraintResolution(3), m_mu(mu) {}
+
+    void init(int line, SReal** w, SReal*) override
+    {
+        m_W[0] = w[line][line];
+        m_W[1] = w[line][line + 1];
+        m_W[2] = w[line][line + 2];
+        m_W[3] = w[line + 1][line + 1];
+        m_W[4] = w[line + 1][line + 2];
+        m_W[5] = w[line + 2][line + 2];
+    }
+
+    void resolution(int line, SReal**, SReal* d, SReal* force, SReal*) override
+    {
+        const SReal normalForce = force[line];
+        force[line] -= d[line] / m_W[0];
+        if (force[line] < 0)
+        {
+            force[line] = force[line + 1] = force[line + 2] = 0;
+            return;
+        }
+
+        d[line + 1] += m_W[1] * (force[line] - normalForce);
+        d[line + 2] += m_W[2] * (force[line] - normalForce);
+        force[line + 1] -= 2 * d[line + 1] / (m_W[3] + m_W[5]);
+        force[line + 2] -= 2 * d[line + 2] / (m_W[3] + m_W[5]);
+
+        const SReal tangentForce = std::sqrt(force[line + 1] * force[line + 1] + force[line + 2] * force[line + 2]);
+        if (tangentForce > m_mu * force[line])
+        {
+            const SReal factor = m_mu * force[line] / tangentForce;
+            force[line + 1] *= factor;
+            force[line + 2] *= factor;
+        }
+    }
+
+private:
+    SReal m_mu;
+    SReal m_W[6] {};
+};
+
+/// Contact between two bodies of unit mass, or between the ground (index -1) and a body
+struct Contact
+{
+    int body1;
+    int body2;
+    Vec3 normal;
+};
+
+/// Columns of nbBodies bodies stacked on the ground: the constraints of a column are coupled,
+/// the columns are independent
+std::vector<Contact> createColumns(int nbColumns, int nbBodies)
+{
+    std::vector<Contact> contacts;
+    for (int c = 0; c < nbColumns; ++c)
+    {
+        for (int b = 0; b < nbBodies; ++b)
+        {
+            const int body = c * nbBodies + b;
+            contacts.push_back({ b == 0 ? -1 : body - 1, body, Vec3(0, 0, 1) });
+        }
+    }
+    return contacts;
+}
+
+/// Cubic lattice of n*n*n bodies in contact with their neighbors, the bottom layer lying on the ground
+std::vector<Contact> createLattice(int n)
+{
+    const auto index = [n](int x, int y, int z) { return x + n * (y + n * z); };
+    std::vector<Contact> contacts;
+    for (int z = 0; z < n; ++z)
+    {
+        for (int y = 0; y < n; ++y)
+        {
+            for (int x = 0; x < n; ++x)
+            {
+                const int body = index(x, y, z);
+                if (z == 0) contacts.push_back({ -1, body, Vec3(0, 0, 1) });
+                if (x + 1 < n) contacts.push_back({ body, index(x + 1, y, z), Vec3(1, 0, 0) });
+                if (y + 1 < n) contacts.push_back({ body, index(x, y + 1, z), Vec3(0, 1, 0) });
+                if (z + 1 < n) contacts.push_back({ body, index(x, y, z + 1), Vec3(0, 0, 1) });
+            }
+        }
+    }
+    return contacts;
+}
+
+/// Build the compliance matrix and the violations of the contacts, with friction if mu > 0.
+/// The violations are shifted by the offset.
+void fillProblem(GenericConstraintProblem& problem, const std::vector<Contact>& contacts, SReal mu, SReal offset = 0)
+{
+    const int nbLines = mu > 0 ? 3 : 1;
+    const int dimension = static_cast<int>(contacts.size()) * nbLines;
+    problem.clear(dimension);
+
+    // normal and tangent directions of each contact
+    std::vector<std::array<Vec3, 3> > frames;
+    for (const auto& contact : contacts)
+    {
+        const Vec3 t1 = sofa::type::cross(contact.normal, Vec3(0.3, 0.5, 0.8)).normalized();
+        frames.push_back({ contact.normal, t1, sofa::type::cross(contact.normal, t1) });
+    }
+
+    // W = J M^-1 J^T with unit masses: the constraints of two contacts are coupled through their common bodies
+    SReal** w = problem.getW();
+    for (int i = 0; i < dimension; ++i)
+    {
+        std::fill(w[i], w[i] + dimension, 0);
+    }
+    const auto sign = [](const Contact& contact, int body)
+    {
+        return body == contact.body2 ? 1 : (body == contact.body1 ? -1 : 0);
+    };
+    for (std::size_t a = 0; a < contacts.size(); ++a)
+    {
+        for (std::size_t b = 0; b < contacts.size(); ++b)
+        {
+            for (const int body : { contacts[a].body1, contacts[a].body2 })
+            {
+                const int s = sign(contacts[a], body) * sign(contacts[b], body);
+                if (body < 0 || s == 0)
+                {
+                    continue;
+                }
+                for (int l = 0; l < nbLines; ++l)
+                {
+                    for (int m = 0; m < nbLines; ++m)
+                    {
+                        w[a * nbLines + l][b * nbLines + m] += s * (frames[a][l] * frames[b][m]);
+                    }
+                }
+            }
+        }
+    }
+
+    for (std::size_t a = 0; a < contacts.size(); ++a)
+    {
+        problem.getDfree()[a * nbLines] = -0.01 + 0.005 * std::sin(1.3 * a) + offset;
+        for (int l = 1; l < nbLines; ++l)
+        {
+            problem.getDfree()[a * nbLines + l] = 0.005 * std::sin(2.1 * a + l);
+        }
+        if (mu > 0)
+        {
+            problem.constraintsResolutions[a * nbLines] = new FrictionResolution(mu);
+        }
+        else
+        {
+            problem.constraintsResolutions[a * nbLines] = new UnilateralResolution();
+        }
+    }
+
+    problem.scaleTolerance = false;
+    problem.allVerified = false;
+    problem.sor = 1.0;
+}
+
+sofa::simulation::TaskScheduler& initTaskScheduler(unsigned int nbThreads)
+{
+    sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::MainTaskSchedulerFactory::createInRegistry();
+    taskScheduler->init(nbThreads);
+    return *taskScheduler;
+}
+
+/// Gives access to the coloring of the constraints
+class ColoredConstraintProblem : public GenericConstraintProblem
+{
+public:
+    using GenericConstraintProblem::m_constraintBlocks;
+    using GenericConstraintProblem::m_coloredBlocks;
+    using GenericConstraintProblem::m_colorBegin;
+};
+
+}
+
+TEST(GenericConstraintProblem, parallelGaussSeidelConvergesToGaussSeidel)
+{
+    initTaskScheduler(4);
+    const auto solver = sofa::core::objectmodel::New<GenericConstraintSolver>();
+    const auto contacts = createColumns(16, 8);
+
+    GenericConstraintProblem sequential, parallel;
+    for (auto* problem : { &sequential, &parallel })
+    {
+        fillProblem(*problem, contacts, 0.5);
+        problem->tolerance = 1e-14;
+        problem->maxIterations = 100000;
+    }
+    sequential.gaussSeidel(0, solver.get());
+    parallel.parallelGaussSeidel(0, solver.get());
+
+    ASSERT_LT(sequential.currentIterations, sequential.maxIterations);
+    ASSERT_LT(parallel.currentIterations, parallel.maxIterations);
+    for (int i = 0; i < sequential.getDimension(); ++i)
+    {
+        EXPECT_NEAR(parallel.getF()[i], sequential.getF()[i], 1e-9) << "line " << i;
+    }
+}
+
+TEST(GenericConstraintProblem, parallelGaussSeidelThreadCountIndependent)
+{
+    const auto solver = sofa::core::objectmodel::New<GenericConstraintSolver>();
+    const auto contacts = createLattice(5);
+
+    std::vector<std::vector<SReal> > forces;
+    for (const unsigned int nbThreads : { 1u, 4u })
+    {
+        initTaskScheduler(nbThreads);
+
+        GenericConstraintProblem problem;
+        fillProblem(problem, contacts, 0.5);
+        problem.tolerance = 0;
+        problem.maxIterations = 50;
+        problem.parallelGaussSeidel(0, solver.get());
+        forces.emplace_back(problem.getF(), problem.getF() + problem.getDimension());
+    }
+
+    // the constraints of a color are independent: the forces do not depend on the scheduling
+    ASSERT_EQ(forces[0].size(), forces[1].size());
+    for (std::size_t i = 0; i < forces[0].size(); ++i)
+    {
+        EXPECT_EQ(forces[0][i], forces[1][i]) << "line " << i;
+    }
+}
+
+TEST(GenericConstraintProblem, parallelGaussSeidelColoring)
+{
+    initTaskScheduler(4);
+    const auto solver = sofa::core::objectmodel::New<GenericConstraintSolver>();
+
+    ColoredConstraintProblem problem;
+    fillProblem(problem, createLattice(5), 0.5);
+    problem.tolerance = 0;
+    problem.maxIterations = 1;
+    problem.parallelGaussSeidel(0, solver.get());
+
+    const auto& blocks = problem.m_constraintBlocks;
+    const auto& coloredBlocks = problem.m_coloredBlocks;
+    const auto& colorBegin = problem.m_colorBegin;
+    ASSERT_GT(colorBegin.size(), 2u);
+    ASSERT_EQ(static_cast<std::size_t>(colorBegin.back()), coloredBlocks.size());
+    ASSERT_EQ(coloredBlocks.size() + 1, blocks.size());
+
+    // each constraint has exactly one color
+    std::vector<int> nbColors(coloredBlocks.size(), 0);
+    for (const int block : coloredBlocks)
+    {
+        ++nbColors[block];
+    }
+    EXPECT_EQ(std::count(nbColors.begin(), nbColors.end(), 1), static_cast<long>(nbColors.size()));
+
+    // two constraints of a same color are not coupled by the compliance matrix
+    SReal** w = problem.getW();
+    for (std::size_t color = 0; color + 1 < colorBegin.size(); ++color)
+    {
+        for (int i = colorBegin[color]; i < colorBegin[color + 1]; ++i)
+        {
+            for (int j = i + 1; j < colorBegin[color + 1]; ++j)
+            {
+                const int a = coloredBlocks[i], b = coloredBlocks[j];
+                for (int l = blocks[a]; l < blocks[a + 1]; ++l)
+                {
+                    for (int m = blocks[b]; m < blocks[b + 1]; ++m)
+                    {
+                        ASSERT_EQ(w[l][m], 0) << "constraints " << a << " and " << b << " of color " << color;
+                        ASSERT_EQ(w[m][l], 0) << "constraints " << a << " and " << b << " of color " << color;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(GenericConstraintProblem, islandsGaussSeidelConvergesToGaussSeidel)
+{
+    initTaskScheduler(4);
+    const auto solver = sofa::core::objectmodel::New<GenericConstraintSolver>();
+    constexpr int nbColumns = 8;
+    const auto contacts = createColumns(nbColumns, 6);
+
+    GenericConstraintProblem global, islands;
+    for (auto* problem : { &global, &islands })
+    {
+        fillProblem(*problem, contacts, 0.5);
+        problem->tolerance = 1e-14;
+        problem->maxIterations = 100000;
+    }
+    global.gaussSeidel(0, solver.get());
+    islands.islandsGaussSeidel(0, solver.get());
+
+    // one island per column
+    ASSERT_EQ(islands.getIslandNbLines().size(), static_cast<std::size_t>(nbColumns));
+    ASSERT_LT(global.currentIterations, global.maxIterations);
+    ASSERT_LT(islands.currentIterations, islands.maxIterations);
+    for (int i = 0; i < global.getDimension(); ++i)
+    {
+        EXPECT_NEAR(islands.getF()[i], global.getF()[i], 1e-9) << "line " << i;
+    }
+}
+
+TEST(GenericConstraintProblem, islandsGaussSeidelSleepingIslands)
+{
+    initTaskScheduler(4);
+    const auto solver = sofa::core::objectmodel::New<GenericConstraintSolver>();
+    const auto contacts = createColumns(8, 6);
+
+    GenericConstraintProblem previous;
+    fillProblem(previous, contacts, 0.5);
+    previous.tolerance = 1e-14;
+    previous.maxIterations = 100000;
+    previous.islandsGaussSeidel(0, solver.get());
+    const int dimension = previous.getDimension();
+    const auto& lineIslands = previous.getLineIslands();
+    ASSERT_EQ(lineIslands.size(), static_cast<std::size_t>(dimension));
+
+    // same constraints, starting from the half of the previous forces; only the first constraint changed
+    GenericConstraintProblem current;
+    fillProblem(current, contacts, 0.5);
+    current.tolerance = 1e-14;
+    current.maxIterations = 100000;
+    for (int i = 0; i < dimension; ++i)
+    {
+        current.getF()[i] = previous.getF()[i] / 2;
+    }
+    current.previousIslands.assign(lineIslands.begin(), lineIslands.end());
+    current.previousIslandNbLines.assign(previous.getIslandNbLines().begin(), previous.getIslandNbLines().end());
+    std::fill_n(current.previousIslands.begin(), 3, -1);
+    current.islandsGaussSeidel(0, solver.get());
+
+    // the island of the changed constraint wakes and is solved again, the others sleep and keep their initial guess
+    const int awakeIsland = lineIslands[0];
+    for (int i = 0; i < dimension; ++i)
+    {
+        if (lineIslands[i] == awakeIsland)
+        {
+            EXPECT_NEAR(current.getF()[i], previous.getF()[i], 1e-9) << "line " << i;
+        }
+        else
+        {
+            EXPECT_EQ(current.getF()[i], previous.getF()[i] / 2) << "line " << i;
+        }
+    }
+}
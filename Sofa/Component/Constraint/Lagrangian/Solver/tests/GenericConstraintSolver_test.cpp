@@ -0,0 +1,118 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/constraint/lagrangian/solver/GenericConstraintSolver.h>
+#include <sofa/core/behavior/BaseConstraint.h>
+#include <sofa/simulation/graph/DAGNode.h>
+#include <sofa/testing/BaseTest.h>
+
+namespace
+{
+using sofa::component::constraint::lagrangian::solver::GenericConstraintSolver;
+using sofa::component::constraint::lagrangian::solver::GenericConstraintProblem;
+
+/// Constraint made of groups of 3 lines, whose persistent ids are given by the test
+class PersistentConstraint : public sofa::core::behavior::BaseConstraint
+{
+public:
+    SOFA_CLASS(PersistentConstraint, sofa::core::behavior::BaseConstraint);
+
+    sofa::type::vector<PersistentID> persistentIds;
+
+    void buildConstraintMatrix(const sofa::core::ConstraintParams*, sofa::core::MultiMatrixDerivId, unsigned int&) override {}
+    void storeLambda(const sofa::core::ConstraintParams*, sofa::core::MultiVecDerivId, const sofa::linearalgebra::BaseVector*) override {}
+    sofa::type::vector<std::string> getBaseConstraintIdentifiers() override { return {}; }
+
+    void getConstraintInfo(const sofa::core::ConstraintParams*, VecConstraintBlockInfo& blocks, VecPersistentID& ids,
+                           VecConstCoord&, VecConstDeriv&, VecConstArea&) override
+    {
+        ConstraintBlockInfo info;
+        info.parent = this;
+        info.const0 = 0;
+        info.nbLines = 3;
+        info.hasId = true;
+        info.offsetId = static_cast<int>(ids.size());
+        info.nbGroups = static_cast<int>(persistentIds.size());
+        ids.insert(ids.end(), persistentIds.begin(), persistentIds.end());
+        blocks.push_back(info);
+    }
+};
+
+/// Gives access to the initial guess of the forces
+class WarmStartConstraintSolver : public GenericConstraintSolver
+{
+public:
+    SOFA_CLASS(WarmStartConstraintSolver, GenericConstraintSolver);
+
+    GenericConstraintProblem* getProblem() const { return current_cp; }
+    using GenericConstraintSolver::computeInitialGuess;
+    using GenericConstraintSolver::keepContactForcesValue;
+};
+
+}
+
+TEST(GenericConstraintSolver, warmStart)
+{
+    const auto root = sofa::core::objectmodel::New<sofa::simulation::graph::DAGNode>("root");
+    const auto constraint = sofa::core::objectmodel::New<PersistentConstraint>();
+    const auto solver = sofa::core::objectmodel::New<WarmStartConstraintSolver>();
+    root->addObject(solver);
+    root->addObject(constraint);
+    solver->d_warmStart.setValue(true);
+    const sofa::core::ConstraintParams* cParams = sofa::core::constraintparams::defaultInstance();
+
+    // first time step: no previous forces
+    constraint->persistentIds.assign({ 10, 11 });
+    GenericConstraintProblem* problem = solver->getProblem();
+    problem->clear(6);
+    solver->computeInitialGuess(cParams);
+    for (int i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(problem->getF()[i], 0) << "line " << i;
+        problem->getF()[i] = i + 1;
+    }
+    solver->keepContactForcesValue();
+
+    // second time step: the constraint 10 disappeared, 11 moved to the first lines, and 12 is new
+    constraint->persistentIds.assign({ 11, 12 });
+    problem->clear(6);
+    solver->computeInitialGuess(cParams);
+    EXPECT_EQ(problem->getF()[0], 4);
+    EXPECT_EQ(problem->getF()[1], 5);
+    EXPECT_EQ(problem->getF()[2], 6);
+    for (int i = 3; i < 6; ++i)
+    {
+        EXPECT_EQ(problem->getF()[i], 0) << "line " << i;
+    }
+    solver->keepContactForcesValue();
+
+    // third time step: the forces of the constraint 10 are forgotten
+    constraint->persistentIds.assign({ 10, 11 });
+    problem->clear(6);
+    solver->computeInitialGuess(cParams);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(problem->getF()[i], 0) << "line " << i;
+    }
+    EXPECT_EQ(problem->getF()[3], 4);
+    EXPECT_EQ(problem->getF()[4], 5);
+    EXPECT_EQ(problem->getF()[5], 6);
+}
@@ -72,6 +72,9 @@ public:
     bool hasUpdatedMatrix() override;
     void updateSystemMatrix() override;
 
+    /// The factorization used by the products with the inverse of the system matrix is replaced asynchronously
+    std::size_t getSystemInversionCount() const override { return 0; }
+
     ~AsyncSparseLDLSolver() override;
 
 protected:
@@ -32,6 +32,14 @@ template <class TMatrix, class TVector, class TThreadManager>
 void AsyncSparseLDLSolver<TMatrix, TVector, TThreadManager>::init()
 {
     Inherit1::init();
+
+    if (this->d_parallelFactorization.getValue())
+    {
+        msg_warning() << "The factorization is performed in a separate thread, which cannot "
+                         "run parallel tasks: " << this->d_parallelFactorization.getName() << " is ignored.";
+        this->d_parallelFactorization.setValue(false);
+    }
+
     waitForAsyncTask = true;
     m_asyncThreadInvertData = &m_secondInvertData;
     m_mainThreadInvertData = static_cast<InvertData*>(this->invertData.get());
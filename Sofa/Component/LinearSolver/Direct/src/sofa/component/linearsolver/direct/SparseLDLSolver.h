@@ -73,6 +73,38 @@ protected :
 
     type::vector<sofa::SignedIndex> Jlocal2global;
     sofa::linearalgebra::FullMatrix<Real> JLinvDinv, JLinv;
+
+    /// For each row of J, the first non-zero column in the permuted ordering
+    type::vector<int> JlocalFirstNonZero;
+    /// Rows of J sorted by their first non-zero column, solved by blocks of RHSBlockSize
+    type::vector<unsigned int> JlocalSolveOrder;
+
+    static constexpr unsigned int RHSBlockSize = 8;
+    /// Below this number of rows, a level of L is solved sequentially
+    static constexpr std::ptrdiff_t MinRowsPerParallelLevel = 128;
+
+    /// Forward substitution of the row i of L for several right-hand sides
+    static void solveLowerSystemRow(int i, Real* const* lines, unsigned int nbRHS, const InvertData* data)
+    {
+        Real x[RHSBlockSize];
+        for (unsigned int r = 0; r < nbRHS; ++r)
+        {
+            x[r] = lines[r][i];
+        }
+        for (int p = data->LT_colptr[i]; p < data->LT_colptr[i + 1]; ++p)
+        {
+            const int j = data->LT_rowind[p];
+            const Real v = data->LT_values[p];
+            for (unsigned int r = 0; r < nbRHS; ++r)
+            {
+                x[r] -= v * lines[r][j];
+            }
+        }
+        for (unsigned int r = 0; r < nbRHS; ++r)
+        {
+            lines[r][i] = x[r];
+        }
+    }
     sofa::linearalgebra::CompressedRowSparseMatrix<Real> Mfiltered;
 
     bool factorize(Matrix& M, InvertData * invertData);
@@ -33,6 +33,7 @@
 #include <string>
 #include <sofa/simulation/MainTaskSchedulerFactory.h>
 #include <sofa/simulation/ParallelForEach.h>
+#include <numeric>
 
 
 namespace sofa::component::linearsolver::direct 
@@ -186,6 +187,9 @@ bool SparseLDLSolver<TMatrix, TVector, TThreadManager>::doAddJMInvJtLocal(ResMat
     JLinvDinv.resize(J->rowSize(), data->n);
 
     // copy J in to JLinv taking into account the permutation
+    // The solution of L y = b is zero before the first non-zero of b: it is not computed.
+    JlocalFirstNonZero.clear();
+    JlocalFirstNonZero.resize(JlocalRowSize, data->n);
     unsigned int localRow = 0;
     for (auto jit = J->begin(), jitend = J->end(); jit != jitend; ++jit, ++localRow)
     {
@@ -196,21 +200,76 @@ bool SparseLDLSolver<TMatrix, TVector, TThreadManager>::doAddJMInvJtLocal(ResMat
             Real val = it->second;
 
             line[col] = val;
+            JlocalFirstNonZero[localRow] = std::min(JlocalFirstNonZero[localRow], col);
         }
     }
 
+    // the right-hand sides are solved by blocks, grouping the rows of J with close first non-zeros
+    JlocalSolveOrder.resize(JlocalRowSize);
+    std::iota(JlocalSolveOrder.begin(), JlocalSolveOrder.end(), 0u);
+    std::stable_sort(JlocalSolveOrder.begin(), JlocalSolveOrder.end(),
+        [this](unsigned int a, unsigned int b) { return JlocalFirstNonZero[a] < JlocalFirstNonZero[b]; });
+    const unsigned int nbBlocks = (JlocalRowSize + RHSBlockSize - 1) / RHSBlockSize;
+
+    const auto getBlock = [this, JlocalRowSize](unsigned int blockId, Real** lines)
+    {
+        const unsigned int first = blockId * RHSBlockSize;
+        const unsigned int nbRHS = std::min(RHSBlockSize, JlocalRowSize - first);
+        for (unsigned int r = 0; r < nbRHS; ++r)
+        {
+            lines[r] = JLinv[JlocalSolveOrder[first + r]];
+        }
+        return std::make_pair(nbRHS, JlocalFirstNonZero[JlocalSolveOrder[first]]);
+    };
+
     {
         SCOPED_TIMER("LowerSystem");
-        simulation::forEachRange(execution, *taskScheduler, 0u, JlocalRowSize,
-            [&data, this](const auto& range)
+
+        // With less blocks than threads, the rows of a same level of L are solved in parallel.
+        // Otherwise, the blocks are solved in parallel.
+        if (execution == simulation::ForEachExecutionPolicy::PARALLEL && nbBlocks < taskScheduler->getThreadCount())
+        {
+            for (unsigned int blockId = 0; blockId < nbBlocks; ++blockId)
             {
-                SCOPED_TIMER("Lower");
-                for (auto i = range.start; i != range.end; ++i)
+                Real* lines[RHSBlockSize];
+                const auto [nbRHS, firstRow] = getBlock(blockId, lines);
+
+                for (std::size_t level = 0; level + 1 < data->levelBegin.size(); ++level)
                 {
-                    Real* line = JLinv[i];
-                    sofa::linearalgebra::solveLowerUnitriangularSystemCSR(data->n, line, line, data->LT_colptr.data(), data->LT_rowind.data(), data->LT_values.data());
+                    const int* levelBegin = std::lower_bound(data->levelRows.data() + data->levelBegin[level],
+                        data->levelRows.data() + data->levelBegin[level + 1], firstRow);
+                    const int* levelEnd = data->levelRows.data() + data->levelBegin[level + 1];
+
+                    simulation::forEachRange(levelEnd - levelBegin < MinRowsPerParallelLevel ?
+                            simulation::ForEachExecutionPolicy::SEQUENTIAL : execution,
+                        *taskScheduler, levelBegin, levelEnd,
+                        [&data, &lines, nbRHS = nbRHS](const auto& range)
+                        {
+                            for (auto row = range.start; row != range.end; ++row)
+                            {
+                                solveLowerSystemRow(*row, lines, nbRHS, data);
+                            }
+                        });
                 }
-            });
+            }
+        }
+        else
+        {
+            simulation::forEachRange(execution, *taskScheduler, 0u, nbBlocks,
+                [&data, &getBlock](const auto& range)
+                {
+                    SCOPED_TIMER("Lower");
+                    for (auto blockId = range.start; blockId != range.end; ++blockId)
+                    {
+                        Real* lines[RHSBlockSize];
+                        const auto [nbRHS, firstRow] = getBlock(blockId, lines);
+                        for (int row = firstRow; row < data->n; ++row)
+                        {
+                            solveLowerSystemRow(row, lines, nbRHS, data);
+                        }
+                    }
+                });
+        }
     }
 
     {
@@ -220,9 +279,10 @@ bool SparseLDLSolver<TMatrix, TVector, TThreadManager>::doAddJMInvJtLocal(ResMat
            {
                for (auto i = range.start; i != range.end; ++i)
                {
-                   Real* lineD = JLinv[i];
-                   Real* lineM = JLinvDinv[i];
-                   sofa::linearalgebra::solveDiagonalSystemUsingInvertedValues(data->n, lineD, lineM, data->invD.data());
+                   const int first = JlocalFirstNonZero[i];
+                   Real* lineD = JLinv[i] + first;
+                   Real* lineM = JLinvDinv[i] + first;
+                   sofa::linearalgebra::solveDiagonalSystemUsingInvertedValues(data->n - first, lineD, lineM, data->invD.data() + first);
                }
            });
     }
@@ -253,8 +313,9 @@ bool SparseLDLSolver<TMatrix, TVector, TThreadManager>::doAddJMInvJtLocal(ResMat
                     Real* lineI = JLinv[i];
                     Real* lineJ = JLinvDinv[j];
 
+                    // both lines are zero before their first non-zero
                     value = 0;
-                    for (int k = 0; k < data->n; ++k)
+                    for (int k = std::max(JlocalFirstNonZero[i], JlocalFirstNonZero[j]); k < data->n; ++k)
                     {
                         value += lineJ[k] * lineI[k];
                     }
@@ -25,10 +25,13 @@
 #include <sofa/helper/ScopedAdvancedTimer.h>
 #include <sofa/component/linearsolver/iterative/MatrixLinearSolver.h>
 #include <sofa/component/linearsolver/direct/SparseCommon.h>
+#include <sofa/component/linearsolver/direct/SupernodalLDL.h>
 #include <sofa/helper/OptionsGroup.h>
 #include <sofa/linearalgebra/DiagonalSystemSolver.h>
 #include <sofa/linearalgebra/TriangularSystemSolver.h>
 #include <sofa/component/linearsolver/ordering/OrderingMethodAccessor.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <tuple>
 
 
 namespace sofa::component::linearsolver::direct
@@ -61,6 +64,13 @@ public :
     VecReal invD;
 
     type::vector<int> Parent;
+
+    //supernodes of L, only computed for the supernodal factorization
+    SupernodalLDLStructure supernodal;
+
+    //level sets of the rows of L: the rows of a level only depend on the rows of the previous levels
+    VecInt levelBegin, levelRows;
+
     bool new_factorization_needed;
 };
 
@@ -148,6 +158,39 @@ inline void CSPARSE_numeric(int n,int * M_colptr,int * M_rowind,Real * M_values,
     }
 }
 
+/// Rank-1 modification L D L^T + sigma w w^T of a LDL^T factorization, stored with the inverse of D
+/// (method C1 of Gill, Golub, Murray and Saunders, 1974).
+/// The non-zeros of w must be on the path of the elimination tree starting at k, and in the pattern of L,
+/// so that the pattern of L does not change. w is cleared on output.
+/// Returns false if a zero pivot appears.
+template<class Real>
+inline bool LDL_rank1Update(int k, Real sigma, Real * w, const int * colptr, const int * rowind, Real * values, Real * invD, const int * Parent)
+{
+    Real alpha = sigma;
+    for (int j = k ; j != -1 ; j = Parent[j])
+    {
+        const Real p = w[j];
+        w[j] = 0;
+        if (p == 0) continue;
+
+        const Real d = 1 / invD[j];
+        const Real dbar = d + alpha * p * p;
+        if (dbar == 0) return false;
+
+        const Real beta = p * alpha / dbar;
+        alpha *= d / dbar;
+        invD[j] = 1 / dbar;
+
+        for (int q = colptr[j] ; q < colptr[j+1] ; q++)
+        {
+            const int r = rowind[q];
+            w[r] -= p * values[q];
+            values[q] += beta * w[r];
+        }
+    }
+    return true;
+}
+
 template<class TMatrix, class TVector, class TThreadManager>
 class SparseLDLSolverImpl : public ordering::OrderingMethodAccessor<sofa::component::linearsolver::MatrixLinearSolver<TMatrix,TVector,TThreadManager> >
 {
@@ -168,13 +211,46 @@ protected :
     Data<bool> d_precomputeSymbolicDecomposition; ///< If true the solver will reuse the precomputed symbolic decomposition. Otherwise it will recompute it at each step.
     core::objectmodel::lifecycle::DeprecatedData d_applyPermutation{this, "v24.06", "v24.12", "applyPermutation", "Ordering method is now defined using ordering components"};
     Data<int> d_L_nnz; ///< Number of non-zero values in the lower triangular matrix of the factorization. The lower, the faster the system is solved.
+    Data<bool> d_supernodal; ///< If true, the numeric factorization processes the columns of the factor by supernodes, i.e. groups of columns sharing the same structure, factorized as dense blocks.
+    Data<bool> d_parallelFactorization; ///< If true, the independent subtrees of the elimination tree are factorized in parallel. Only used by the supernodal factorization.
+    Data<bool> d_lowRankUpdate; ///< If true, when only a few columns of the matrix changed since the last factorization, the factorization is updated with low-rank modifications instead of being recomputed.
+    Data<SReal> d_lowRankUpdateThreshold; ///< Ratio of changed columns above which the factorization is fully recomputed. Only used with lowRankUpdate.
+    Data<unsigned int> d_nbLowRankUpdates; ///< Number of factorizations updated with low-rank modifications instead of being recomputed
 
 
     SparseLDLSolverImpl()
     : d_precomputeSymbolicDecomposition(initData(&d_precomputeSymbolicDecomposition, true ,"precomputeSymbolicDecomposition", "If true, the solver will reuse the precomputed symbolic decomposition, meaning that it will store the shape of [factor matrix] on the first step, or when its shape changes, and then it will only update its coefficients. When the shape of the matrix changes, a new factorization is computed."
                                                                                                                               "If false, the solver will compute the entire decomposition at each step"))
     , d_L_nnz(initData(&d_L_nnz, 0, "L_nnz", "Number of non-zero values in the lower triangular matrix of the factorization. The lower, the faster the system is solved.", true, true))
-    {}
+    , d_supernodal(initData(&d_supernodal, false, "supernodal", "If true, the numeric factorization processes the columns of the factor by supernodes, i.e. groups of columns sharing the same structure, factorized as dense blocks. It is faster on large systems with a fill-reducing ordering."))
+    , d_parallelFactorization(initData(&d_parallelFactorization, false, "parallelFactorization", "If true, the independent subtrees of the elimination tree are factorized in parallel. Only used by the supernodal factorization."))
+    , d_lowRankUpdate(initData(&d_lowRankUpdate, false, "lowRankUpdate", "If true, when only a few columns of the matrix changed since the last factorization (cutting, plasticity...), the factorization is updated with low-rank modifications instead of being recomputed. The structure of the matrix must not change."))
+    , d_lowRankUpdateThreshold(initData(&d_lowRankUpdateThreshold, 0.05_sreal, "lowRankUpdateThreshold", "Ratio of changed columns above which the factorization is fully recomputed. Only used with lowRankUpdate."))
+    , d_nbLowRankUpdates(initData(&d_nbLowRankUpdates, 0u, "nbLowRankUpdates", "Number of factorizations updated with low-rank modifications instead of being recomputed", true, true))
+    {
+        this->addUpdateCallback("parallelFactorization", {&d_parallelFactorization},
+        [this](const core::DataTracker& tracker) -> sofa::core::objectmodel::ComponentState
+        {
+            SOFA_UNUSED(tracker);
+            if (d_parallelFactorization.getValue())
+            {
+                simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+                assert(taskScheduler);
+
+                if (taskScheduler->getThreadCount() < 1)
+                {
+                    taskScheduler->init(0);
+                    msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+                }
+                else
+                {
+                    msg_info() << "Task scheduler already initialized on " << taskScheduler->getThreadCount() << " threads";
+                }
+            }
+            return this->d_componentState.getValue();
+        },
+        {});
+    }
 
     template<class VecInt,class VecReal>
     void solve_cpu(Real * x,const Real * b,SparseLDLImplInvertData<VecInt,VecReal> * data)
@@ -262,13 +338,39 @@ protected :
         CSPARSE_numeric<Real>(n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,perm,invperm,Parent,Flag.data(),Lnz.data(),Pattern.data(),Y.data());
     }
 
+    void LDL_numeric_supernodal(Real* M_values, int* colptr, int* rowind, Real* values, Real* D,
+                                const SupernodalLDLStructure& structure)
+    {
+        const simulation::ForEachExecutionPolicy execution = d_parallelFactorization.getValue() ?
+            simulation::ForEachExecutionPolicy::PARALLEL :
+            simulation::ForEachExecutionPolicy::SEQUENTIAL;
+
+        simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+        assert(taskScheduler);
+
+        if (!supernodalLDLNumeric<Real>(structure, M_values, colptr, rowind, values, D, execution, *taskScheduler))
+        {
+            msg_error() << "Failed to factorize, D(k,k) is zero";
+        }
+    }
+
     template<class VecInt,class VecReal>
     void factorize(int n,int * M_colptr, int * M_rowind, Real * M_values, SparseLDLImplInvertData<VecInt,VecReal> * data)
     {
         data->new_factorization_needed =
             data->P_colptr.size() == 0 ||
             data->P_rowind.size() == 0 ||
-            compareMatrixShape(n, M_colptr, M_rowind, data->n, (int*)data->P_colptr.data(), (int*)data->P_rowind.data());
+            compareMatrixShape(n, M_colptr, M_rowind, data->n, (int*)data->P_colptr.data(), (int*)data->P_rowind.data()) ||
+            (d_supernodal.getValue() && data->supernodal.n != n);
+
+        const bool updated = !data->new_factorization_needed
+            && d_lowRankUpdate.getValue()
+            && d_precomputeSymbolicDecomposition.getValue()
+            && LDL_lowRankUpdate(M_colptr, M_rowind, M_values, data);
+        if (updated)
+        {
+            d_nbLowRankUpdates.setValue(d_nbLowRankUpdates.getValue() + 1);
+        }
 
         data->n = n;
         data->P_nnz = M_colptr[data->n];
@@ -310,6 +412,18 @@ protected :
             data->L_values.clear();data->L_values.fastResize(data->L_nnz);
             data->LT_rowind.clear();data->LT_rowind.fastResize(data->L_nnz);
             data->LT_values.clear();data->LT_values.fastResize(data->L_nnz);
+
+            if (d_supernodal.getValue())
+            {
+                const unsigned int nbPartitions = d_parallelFactorization.getValue() ?
+                    simulation::MainTaskSchedulerFactory::createInRegistry()->getThreadCount() : 1;
+                supernodalLDLSymbolic(data->n, M_colptr, M_rowind, data->L_colptr.data(), data->L_rowind.data(),
+                                      data->perm.data(), data->invperm.data(), data->Parent.data(), nbPartitions, data->supernodal);
+            }
+            else
+            {
+                data->supernodal.clear();
+            }
         }
 
         Real * D = data->invD.data();
@@ -321,10 +435,18 @@ protected :
         Real * tran_values = data->LT_values.data();
 
         //Numeric Factorization
+        if (!updated)
         {
             SCOPED_TIMER_VARNAME(factorizationTimer, "numeric_factorization");
-            LDL_numeric(data->n, M_colptr, M_rowind, M_values, colptr, rowind, values, D,
-                        data->perm.data(), data->invperm.data(), data->Parent.data());
+            if (d_supernodal.getValue())
+            {
+                LDL_numeric_supernodal(M_values, colptr, rowind, values, D, data->supernodal);
+            }
+            else
+            {
+                LDL_numeric(data->n, M_colptr, M_rowind, M_values, colptr, rowind, values, D,
+                            data->perm.data(), data->invperm.data(), data->Parent.data());
+            }
 
             //inverse the diagonal
             for (int i = 0; i < data->n; i++)
@@ -363,6 +485,161 @@ protected :
                 tran_countvec[line]++;
             }
         }
+
+        if (data->new_factorization_needed  || !d_precomputeSymbolicDecomposition.getValue() )
+        {
+            computeLevelSets(data);
+        }
+    }
+
+    /// Updates the factorization of the previous matrix, stored in P_values, with the columns of the new matrix M
+    /// whose values changed. The change of the permuted column k, restricted to its lower part l (rows > k) and to
+    /// its diagonal delta, is e_k l^T + l e_k^T + delta e_k e_k^T = w+ w+^T - w- w-^T, with w+ = a e_k + l/s and
+    /// w- = b e_k - l/s, where a + b = s and a - b = delta/s.
+    /// Returns false if the number of changed columns is above the threshold, or if an update failed: in this case,
+    /// the factorization must be recomputed.
+    template<class VecInt,class VecReal>
+    bool LDL_lowRankUpdate(const int * M_colptr, const int * M_rowind, const Real * M_values, SparseLDLImplInvertData<VecInt,VecReal> * data)
+    {
+        SCOPED_TIMER_VARNAME(updateTimer, "low_rank_update");
+
+        const int n = data->n;
+        const Real* previousValues = data->P_values.data();
+
+        changedColumns.clear();
+        for (int c = 0; c < n; c++)
+        {
+            for (int p = M_colptr[c]; p < M_colptr[c + 1]; p++)
+            {
+                if (M_values[p] != previousValues[p])
+                {
+                    changedColumns.push_back(c);
+                    break;
+                }
+            }
+        }
+
+        if (changedColumns.size() > d_lowRankUpdateThreshold.getValue() * n)
+        {
+            return false;
+        }
+
+        // the updates are applied before the downdates, so that the intermediate matrix remains positive definite
+        // if both the previous and the new matrices are
+        Y.clear();
+        Y.resize(n);
+        downdates.clear();
+        for (const int c : changedColumns)
+        {
+            const int k = data->invperm[c];
+            Real delta = 0, lmax = 0;
+            for (int p = M_colptr[c]; p < M_colptr[c + 1]; p++)
+            {
+                const int i = data->invperm[M_rowind[p]];
+                const Real change = M_values[p] - previousValues[p];
+                if (i == k)
+                {
+                    delta += change;
+                }
+                else if (i > k)
+                {
+                    lmax = std::max(lmax, std::abs(change));
+                }
+            }
+
+            // only the diagonal changed: the change is a single rank-1 modification
+            if (lmax == 0)
+            {
+                if (delta < 0)
+                {
+                    downdates.push_back({c, std::sqrt(-delta), 0});
+                }
+                else if (delta > 0)
+                {
+                    Y[k] = std::sqrt(delta);
+                    if (!LDL_rank1Update<Real>(k, 1, Y.data(), data->L_colptr.data(), data->L_rowind.data(), data->L_values.data(), data->invD.data(), data->Parent.data()))
+                    {
+                        return false;
+                    }
+                }
+                continue;
+            }
+
+            const Real s = std::sqrt(std::max(lmax, std::abs(delta)));
+            const Real a = (s + delta / s) / 2;
+            downdates.push_back({c, (s - delta / s) / 2, s});
+
+            Y[k] = a;
+            for (int p = M_colptr[c]; p < M_colptr[c + 1]; p++)
+            {
+                const int i = data->invperm[M_rowind[p]];
+                if (i > k)
+                {
+                    Y[i] += (M_values[p] - previousValues[p]) / s;
+                }
+            }
+            if (!LDL_rank1Update<Real>(k, 1, Y.data(), data->L_colptr.data(), data->L_rowind.data(), data->L_values.data(), data->invD.data(), data->Parent.data()))
+            {
+                return false;
+            }
+        }
+
+        for (const auto& [c, b, s] : downdates)
+        {
+            const int k = data->invperm[c];
+            Y[k] = b;
+            for (int p = M_colptr[c]; s != 0 && p < M_colptr[c + 1]; p++)
+            {
+                const int i = data->invperm[M_rowind[p]];
+                if (i > k)
+                {
+                    Y[i] -= (M_values[p] - previousValues[p]) / s;
+                }
+            }
+            if (!LDL_rank1Update<Real>(k, -1, Y.data(), data->L_colptr.data(), data->L_rowind.data(), data->L_values.data(), data->invD.data(), data->Parent.data()))
+            {
+                return false;
+            }
+        }
+
+        msg_info() << "Factorization updated for " << changedColumns.size() << " changed columns";
+        return true;
+    }
+
+    /// Level sets of the rows of L, used to solve a triangular system in parallel:
+    /// the level of a row is one more than the highest level of the rows it depends on
+    template<class VecInt,class VecReal>
+    void computeLevelSets(SparseLDLImplInvertData<VecInt,VecReal> * data)
+    {
+        const int n = data->n;
+        tran_countvec.clear();
+        tran_countvec.resize(n);
+        int nbLevels = 0;
+        for (int i = 0; i < n; i++)
+        {
+            int level = 0;
+            for (int p = data->LT_colptr[i]; p < data->LT_colptr[i + 1]; p++)
+            {
+                level = std::max(level, tran_countvec[data->LT_rowind[p]] + 1);
+            }
+            tran_countvec[i] = level;
+            nbLevels = std::max(nbLevels, level + 1);
+        }
+
+        data->levelBegin.clear();
+        data->levelBegin.resize(nbLevels + 1);
+        for (int i = 0; i < n; i++) data->levelBegin[tran_countvec[i] + 1]++;
+        for (int l = 0; l < nbLevels; l++) data->levelBegin[l + 1] += data->levelBegin[l];
+
+        // rows are sorted in each level
+        data->levelRows.clear();
+        data->levelRows.resize(n);
+        type::vector<int> levelCount(nbLevels, 0);
+        for (int i = 0; i < n; i++)
+        {
+            const int level = tran_countvec[i];
+            data->levelRows[data->levelBegin[level] + levelCount[level]++] = i;
+        }
     }
 
     type::vector<Real> Tmp;
@@ -371,6 +648,10 @@ protected : //the following variables are used during the factorization they can
     type::vector<Real> Y;
     type::vector<int> Lnz,Flag,Pattern;
     type::vector<int> tran_countvec;
+
+    // columns of the matrix which changed since the last factorization, and the downdates to apply
+    type::vector<int> changedColumns;
+    type::vector<std::tuple<int, Real, Real> > downdates;
 };
 
 } // namespace sofa::component::linearsolver::direct
@@ -0,0 +1,343 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/linearsolver/direct/SupernodalLDL.h>
+
+#include <functional>
+#include <queue>
+
+namespace sofa::component::linearsolver::direct
+{
+
+void SupernodalLDLStructure::clear()
+{
+    n = 0;
+    supernodeBegin.clear();
+    updaterBegin.clear();
+    updaters.clear();
+    lowerBegin.clear();
+    lowerRow.clear();
+    lowerPosition.clear();
+    partitionBegin.clear();
+    partitionSupernodes.clear();
+    topSupernodes.clear();
+}
+
+namespace
+{
+
+/// Convert a list of counts into the beginning of each bucket
+void countsToBegins(type::vector<int>& begin)
+{
+    int sum = 0;
+    for (auto& b : begin)
+    {
+        const int count = b;
+        b = sum;
+        sum += count;
+    }
+}
+
+/// Lower triangle of the permuted matrix, using the same entries as CSPARSE_numeric: the entry
+/// A(i,k), i <= k, of the column k is the entry (k,i) of the lower triangle
+void computeLowerTriangle(int n, const int* M_colptr, const int* M_rowind, const int* perm, const int* invperm,
+                          SupernodalLDLStructure& structure)
+{
+    auto& lowerBegin = structure.lowerBegin;
+    lowerBegin.assign(n + 1, 0);
+    for (int k = 0; k < n; ++k)
+    {
+        const int kk = perm[k];
+        for (int p = M_colptr[kk]; p < M_colptr[kk + 1]; ++p)
+        {
+            const int i = invperm[M_rowind[p]];
+            if (i <= k)
+            {
+                ++lowerBegin[i];
+            }
+        }
+    }
+    countsToBegins(lowerBegin);
+
+    structure.lowerRow.resize(lowerBegin[n]);
+    structure.lowerPosition.resize(lowerBegin[n]);
+    type::vector<int> next(lowerBegin.begin(), lowerBegin.end() - 1);
+    for (int k = 0; k < n; ++k)
+    {
+        const int kk = perm[k];
+        for (int p = M_colptr[kk]; p < M_colptr[kk + 1]; ++p)
+        {
+            const int i = invperm[M_rowind[p]];
+            if (i <= k)
+            {
+                structure.lowerRow[next[i]] = k;
+                structure.lowerPosition[next[i]] = p;
+                ++next[i];
+            }
+        }
+    }
+}
+
+/// Row indices of L, obtained by following the paths of the elimination tree like CSPARSE_numeric
+void computeRowIndices(int n, const int* M_colptr, const int* M_rowind, const int* colptr, int* rowind,
+                       const int* perm, const int* invperm, const int* Parent)
+{
+    type::vector<int> flag(n);
+    type::vector<int> next(n);
+    std::copy(colptr, colptr + n, next.begin());
+    for (int k = 0; k < n; ++k)
+    {
+        flag[k] = k;
+        const int kk = perm[k];
+        for (int p = M_colptr[kk]; p < M_colptr[kk + 1]; ++p)
+        {
+            int i = invperm[M_rowind[p]];
+            if (i < k)
+            {
+                for ( ; flag[i] != k; i = Parent[i])
+                {
+                    rowind[next[i]++] = k;
+                    flag[i] = k;
+                }
+            }
+        }
+    }
+}
+
+void computeSupernodes(int n, const int* colptr, const int* Parent, SupernodalLDLStructure& structure)
+{
+    auto& supernodeBegin = structure.supernodeBegin;
+    supernodeBegin.clear();
+    supernodeBegin.push_back(0);
+    for (int j = 1; j < n; ++j)
+    {
+        const bool sameStructure = Parent[j - 1] == j && colptr[j] - colptr[j - 1] == colptr[j + 1] - colptr[j] + 1;
+        if (!sameStructure)
+        {
+            supernodeBegin.push_back(j);
+        }
+    }
+    supernodeBegin.push_back(n);
+}
+
+/// The supernode d updates all the supernodes containing a row below its diagonal block
+void computeUpdaters(const int* colptr, const int* rowind, const type::vector<int>& columnSupernode,
+                     SupernodalLDLStructure& structure)
+{
+    const int nbSupernodes = int(structure.nbSupernodes());
+    type::vector<int> last(nbSupernodes, -1);
+
+    const auto forEachUpdate = [&](const auto& f)
+    {
+        std::fill(last.begin(), last.end(), -1);
+        for (int d = 0; d < nbSupernodes; ++d)
+        {
+            const int lastColumn = structure.supernodeBegin[d + 1] - 1;
+            for (int p = colptr[lastColumn]; p < colptr[lastColumn + 1]; ++p)
+            {
+                const int s = columnSupernode[rowind[p]];
+                if (last[s] != d)
+                {
+                    last[s] = d;
+                    f(s, d);
+                }
+            }
+        }
+    };
+
+    auto& updaterBegin = structure.updaterBegin;
+    updaterBegin.assign(nbSupernodes + 1, 0);
+    forEachUpdate([&updaterBegin](int s, int) { ++updaterBegin[s]; });
+    countsToBegins(updaterBegin);
+
+    structure.updaters.resize(updaterBegin[nbSupernodes]);
+    type::vector<int> next(updaterBegin.begin(), updaterBegin.end() - 1);
+    forEachUpdate([&structure, &next](int s, int d) { structure.updaters[next[s]++] = d; });
+}
+
+/// Split the supernodal elimination tree into independent subtrees, distributed over the partitions
+/// so that they have a similar amount of work
+void computePartitions(const int* colptr, const int* Parent, const type::vector<int>& columnSupernode,
+                       unsigned int nbPartitions, SupernodalLDLStructure& structure)
+{
+    const int nbSupernodes = int(structure.nbSupernodes());
+
+    type::vector<int> parent(nbSupernodes);
+    type::vector<double> subtreeWork(nbSupernodes, 0.);
+    for (int s = 0; s < nbSupernodes; ++s)
+    {
+        const int lastColumn = structure.supernodeBegin[s + 1] - 1;
+        parent[s] = Parent[lastColumn] < 0 ? -1 : columnSupernode[Parent[lastColumn]];
+
+        // the number of operations of a column is proportional to its number of non-zeros squared
+        for (int j = structure.supernodeBegin[s]; j <= lastColumn; ++j)
+        {
+            const double nnz = colptr[j + 1] - colptr[j] + 1;
+            subtreeWork[s] += nnz * nnz;
+        }
+    }
+
+    // children are always numbered before their parent
+    double totalWork = 0;
+    for (int s = 0; s < nbSupernodes; ++s)
+    {
+        if (parent[s] >= 0)
+        {
+            subtreeWork[parent[s]] += subtreeWork[s];
+        }
+        else
+        {
+            totalWork += subtreeWork[s];
+        }
+    }
+
+    type::vector<int> childBegin(nbSupernodes + 1, 0);
+    for (int s = 0; s < nbSupernodes; ++s)
+    {
+        if (parent[s] >= 0)
+        {
+            ++childBegin[parent[s]];
+        }
+    }
+    countsToBegins(childBegin);
+    type::vector<int> children(childBegin[nbSupernodes]);
+    {
+        type::vector<int> next(childBegin.begin(), childBegin.end() - 1);
+        for (int s = 0; s < nbSupernodes; ++s)
+        {
+            if (parent[s] >= 0)
+            {
+                children[next[parent[s]]++] = s;
+            }
+        }
+    }
+
+    // Split the subtrees which are too large, starting from the roots. Several subtrees per
+    // partition allow to balance the work between the partitions.
+    type::vector<int> owner(nbSupernodes, -1);
+    type::vector<int> subtrees;
+    if (nbPartitions > 1)
+    {
+        const double maxSubtreeWork = totalWork / (4. * nbPartitions);
+        type::vector<int> stack;
+        for (int s = 0; s < nbSupernodes; ++s)
+        {
+            if (parent[s] < 0)
+            {
+                stack.push_back(s);
+            }
+        }
+        while (!stack.empty())
+        {
+            const int s = stack.back();
+            stack.pop_back();
+            if (subtreeWork[s] <= maxSubtreeWork)
+            {
+                subtrees.push_back(s);
+            }
+            else
+            {
+                stack.insert(stack.end(), children.begin() + childBegin[s], children.begin() + childBegin[s + 1]);
+            }
+        }
+    }
+
+    // assign the largest subtrees first, each to the partition with the least work
+    std::sort(subtrees.begin(), subtrees.end(), [&subtreeWork](int a, int b) { return subtreeWork[a] > subtreeWork[b]; });
+    using PartitionWork = std::pair<double, int>;
+    std::priority_queue<PartitionWork, std::vector<PartitionWork>, std::greater<> > partitionWork;
+    for (unsigned int p = 0; p < nbPartitions && !subtrees.empty(); ++p)
+    {
+        partitionWork.emplace(0., int(p));
+    }
+    for (const int root : subtrees)
+    {
+        auto [work, p] = partitionWork.top();
+        partitionWork.pop();
+        owner[root] = p;
+        partitionWork.emplace(work + subtreeWork[root], p);
+    }
+
+    // the descendants of a subtree root belong to the same partition
+    for (int s = nbSupernodes - 1; s >= 0; --s)
+    {
+        if (owner[s] < 0 && parent[s] >= 0)
+        {
+            owner[s] = owner[parent[s]];
+        }
+    }
+
+    const int nbUsedPartitions = int(partitionWork.size());
+    auto& partitionBegin = structure.partitionBegin;
+    partitionBegin.assign(nbUsedPartitions + 1, 0);
+    structure.topSupernodes.clear();
+    for (int s = 0; s < nbSupernodes; ++s)
+    {
+        if (owner[s] >= 0)
+        {
+            ++partitionBegin[owner[s]];
+        }
+        else
+        {
+            structure.topSupernodes.push_back(s);
+        }
+    }
+    countsToBegins(partitionBegin);
+    structure.partitionSupernodes.resize(partitionBegin[nbUsedPartitions]);
+    type::vector<int> next(partitionBegin.begin(), partitionBegin.end() - 1);
+    for (int s = 0; s < nbSupernodes; ++s)
+    {
+        if (owner[s] >= 0)
+        {
+            structure.partitionSupernodes[next[owner[s]]++] = s;
+        }
+    }
+}
+
+} // namespace
+
+void supernodalLDLSymbolic(int n, const int* M_colptr, const int* M_rowind,
+                           const int* colptr, int* rowind,
+                           const int* perm, const int* invperm, const int* Parent,
+                           unsigned int nbPartitions, SupernodalLDLStructure& structure)
+{
+    structure.clear();
+    structure.n = n;
+    if (n == 0)
+    {
+        return;
+    }
+
+    computeLowerTriangle(n, M_colptr, M_rowind, perm, invperm, structure);
+    computeRowIndices(n, M_colptr, M_rowind, colptr, rowind, perm, invperm, Parent);
+    computeSupernodes(n, colptr, Parent, structure);
+
+    type::vector<int> columnSupernode(n);
+    for (std::size_t s = 0; s < structure.nbSupernodes(); ++s)
+    {
+        std::fill(columnSupernode.begin() + structure.supernodeBegin[s], columnSupernode.begin() + structure.supernodeBegin[s + 1], int(s));
+    }
+
+    computeUpdaters(colptr, rowind, columnSupernode, structure);
+    computePartitions(colptr, Parent, columnSupernode, nbPartitions, structure);
+}
+
+} // namespace sofa::component::linearsolver::direct
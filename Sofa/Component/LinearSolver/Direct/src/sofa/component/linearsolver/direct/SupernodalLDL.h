@@ -0,0 +1,289 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/linearsolver/direct/config.h>
+
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/type/vector.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace sofa::component::linearsolver::direct
+{
+
+/**
+ * Symbolic data of a supernodal LDL^T factorization.
+ *
+ * A supernode is a set of contiguous columns of L such that each column is the parent of the
+ * previous one in the elimination tree, and has one less non-zero. All the columns of a supernode
+ * share the same structure below the diagonal block of the supernode, so that the supernode is
+ * stored and factorized as a dense block.
+ * The factor itself is stored in the same CSC arrays as the column-by-column factorization.
+ */
+struct SOFA_COMPONENT_LINEARSOLVER_DIRECT_API SupernodalLDLStructure
+{
+    int n { 0 };
+
+    /// The columns of the supernode s are [supernodeBegin[s], supernodeBegin[s+1])
+    type::vector<int> supernodeBegin;
+
+    /// The supernodes updating the supernode s, i.e. having non-zeros in the rows of s, are
+    /// updaters[updaterBegin[s]] to updaters[updaterBegin[s+1]-1]
+    type::vector<int> updaterBegin, updaters;
+
+    /// Lower triangle of the permuted matrix in CSC: for each entry, its row and its position in
+    /// the values of the input matrix
+    type::vector<int> lowerBegin, lowerRow, lowerPosition;
+
+    /// The supernodes are split into partitions of independent subtrees of the supernodal
+    /// elimination tree, which can be factorized in parallel. The supernodes of the partition p are
+    /// partitionSupernodes[partitionBegin[p]] to partitionSupernodes[partitionBegin[p+1]-1].
+    type::vector<int> partitionBegin, partitionSupernodes;
+
+    /// Supernodes above the partitioned subtrees, factorized once all the partitions are done
+    type::vector<int> topSupernodes;
+
+    std::size_t nbSupernodes() const { return supernodeBegin.empty() ? 0 : supernodeBegin.size() - 1; }
+    std::size_t nbPartitions() const { return partitionBegin.empty() ? 0 : partitionBegin.size() - 1; }
+
+    void clear();
+};
+
+/**
+ * Compute the structure of a supernodal LDL^T factorization, from the elimination tree and the
+ * column pointers computed by CSPARSE_symbolic. The row indices of L are also computed, as they
+ * are needed before the numeric factorization.
+ *
+ * @param nbPartitions The number of partitions of the elimination tree to build, typically the
+ * number of threads which will perform the numeric factorization.
+ */
+SOFA_COMPONENT_LINEARSOLVER_DIRECT_API
+void supernodalLDLSymbolic(int n, const int* M_colptr, const int* M_rowind,
+                           const int* colptr, int* rowind,
+                           const int* perm, const int* invperm, const int* Parent,
+                           unsigned int nbPartitions, SupernodalLDLStructure& structure);
+
+/// Temporary buffers used to factorize supernodes. A workspace cannot be shared between threads.
+template<class Real>
+struct SupernodalLDLWorkspace
+{
+    /// dense block of the supernode, stored by columns
+    type::vector<Real> block;
+    /// dense update of a descendant supernode, stored by columns
+    type::vector<Real> update;
+    /// row of the block corresponding to each row of the matrix below the diagonal block
+    type::vector<int> relativeMap;
+    /// rows of the block receiving an update
+    type::vector<int> relativeRows;
+};
+
+/**
+ * Factorize the supernode s: assemble its columns of the permuted matrix in a dense block,
+ * subtract the updates from its descendants, factorize the block and store it in L and D.
+ * All the descendants of s must already be factorized.
+ *
+ * @return false if a zero pivot has been found
+ */
+template<class Real>
+bool factorizeSupernode(const SupernodalLDLStructure& structure, int s, const Real* M_values,
+                        const int* colptr, const int* rowind, Real* values, Real* D,
+                        SupernodalLDLWorkspace<Real>& workspace)
+{
+    const int first = structure.supernodeBegin[s];
+    const int end = structure.supernodeBegin[s + 1];
+    const int nbColumns = end - first;
+
+    // rows below the diagonal block, shared by all the columns of the supernode
+    const int* const rows = rowind + colptr[end - 1];
+    const int nbRowsBelow = colptr[end] - colptr[end - 1];
+    const int nbRows = nbColumns + nbRowsBelow;
+
+    auto& relativeMap = workspace.relativeMap;
+    relativeMap.resize(structure.n);
+    for (int r = 0; r < nbRowsBelow; ++r)
+    {
+        relativeMap[rows[r]] = nbColumns + r;
+    }
+    const auto localRow = [&](int row)
+    {
+        return row < end ? row - first : relativeMap[row];
+    };
+
+    auto& block = workspace.block;
+    block.assign(std::size_t(nbRows) * nbColumns, 0);
+
+    // scatter the lower triangle of the permuted matrix (duplicates are summed)
+    for (int j = 0; j < nbColumns; ++j)
+    {
+        Real* const column = block.data() + std::size_t(j) * nbRows;
+        for (int p = structure.lowerBegin[first + j]; p < structure.lowerBegin[first + j + 1]; ++p)
+        {
+            column[localRow(structure.lowerRow[p])] += M_values[structure.lowerPosition[p]];
+        }
+    }
+
+    // subtract the updates L_d * D_d * L_d^T of the descendant supernodes
+    for (int u = structure.updaterBegin[s]; u < structure.updaterBegin[s + 1]; ++u)
+    {
+        const int d = structure.updaters[u];
+        const int dFirst = structure.supernodeBegin[d];
+        const int dEnd = structure.supernodeBegin[d + 1];
+        const int* const dRows = rowind + colptr[dEnd - 1];
+        const int dNbRowsBelow = colptr[dEnd] - colptr[dEnd - 1];
+
+        // rows of d in the supernode s are [a, b), rows of d below them are [b, dNbRowsBelow)
+        const int a = int(std::lower_bound(dRows, dRows + dNbRowsBelow, first) - dRows);
+        const int b = int(std::lower_bound(dRows + a, dRows + dNbRowsBelow, end) - dRows);
+        const int m = dNbRowsBelow - a;
+        const int mColumns = b - a;
+
+        // values of the column j of d at the rows dRows[a..]
+        const auto column = [&](int j) { return values + colptr[j] + (dEnd - 1 - j) + a; };
+
+        auto& update = workspace.update;
+        update.assign(std::size_t(m) * mColumns, 0);
+        int j = dFirst;
+        // the columns of d are applied by groups of 4 to reduce the passes over the update
+        for (; j + 4 <= dEnd; j += 4)
+        {
+            const Real* const L0 = column(j);
+            const Real* const L1 = column(j + 1);
+            const Real* const L2 = column(j + 2);
+            const Real* const L3 = column(j + 3);
+            for (int c = 0; c < mColumns; ++c)
+            {
+                const Real w0 = L0[c] * D[j];
+                const Real w1 = L1[c] * D[j + 1];
+                const Real w2 = L2[c] * D[j + 2];
+                const Real w3 = L3[c] * D[j + 3];
+                Real* const updateColumn = update.data() + std::size_t(c) * m;
+                for (int r = c; r < m; ++r)
+                {
+                    updateColumn[r] += L0[r] * w0 + L1[r] * w1 + L2[r] * w2 + L3[r] * w3;
+                }
+            }
+        }
+        for (; j < dEnd; ++j)
+        {
+            const Real* const Lj = column(j);
+            for (int c = 0; c < mColumns; ++c)
+            {
+                const Real w = Lj[c] * D[j];
+                Real* const updateColumn = update.data() + std::size_t(c) * m;
+                for (int r = c; r < m; ++r)
+                {
+                    updateColumn[r] += Lj[r] * w;
+                }
+            }
+        }
+
+        // the rows of d from a are a subset of the rows of s
+        auto& relativeRows = workspace.relativeRows;
+        relativeRows.resize(m);
+        for (int r = 0; r < m; ++r)
+        {
+            relativeRows[r] = localRow(dRows[a + r]);
+        }
+
+        for (int c = 0; c < mColumns; ++c)
+        {
+            Real* const column = block.data() + std::size_t(relativeRows[c]) * nbRows;
+            const Real* const updateColumn = update.data() + std::size_t(c) * m;
+            for (int r = c; r < m; ++r)
+            {
+                column[relativeRows[r]] -= updateColumn[r];
+            }
+        }
+    }
+
+    // dense LDL^T factorization of the block
+    for (int j = 0; j < nbColumns; ++j)
+    {
+        Real* const column = block.data() + std::size_t(j) * nbRows;
+        const Real Djj = column[j];
+        if (Djj == 0)
+        {
+            return false;
+        }
+
+        for (int c = j + 1; c < nbColumns; ++c)
+        {
+            const Real l = column[c] / Djj;
+            Real* const updatedColumn = block.data() + std::size_t(c) * nbRows;
+            for (int r = c; r < nbRows; ++r)
+            {
+                updatedColumn[r] -= column[r] * l;
+            }
+        }
+
+        D[first + j] = Djj;
+        Real* const L = values + colptr[first + j];
+        for (int r = j + 1; r < nbRows; ++r)
+        {
+            L[r - j - 1] = column[r] / Djj;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Numeric supernodal LDL^T factorization. The partitions of the elimination tree are factorized
+ * according to the execution policy, then the supernodes above them are factorized sequentially.
+ *
+ * @return false if a zero pivot has been found
+ */
+template<class Real>
+bool supernodalLDLNumeric(const SupernodalLDLStructure& structure, const Real* M_values,
+                          const int* colptr, const int* rowind, Real* values, Real* D,
+                          simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler)
+{
+    std::atomic<bool> success { true };
+
+    const auto factorizeSupernodes = [&](const int* s, const int* last)
+    {
+        SupernodalLDLWorkspace<Real> workspace;
+        for (; s != last && success.load(std::memory_order_relaxed); ++s)
+        {
+            if (!factorizeSupernode(structure, *s, M_values, colptr, rowind, values, D, workspace))
+            {
+                success = false;
+            }
+        }
+    };
+
+    const int* const partitionSupernodes = structure.partitionSupernodes.data();
+    simulation::forEach(execution, taskScheduler, std::size_t(0), structure.nbPartitions(),
+        [&](std::size_t p)
+        {
+            factorizeSupernodes(partitionSupernodes + structure.partitionBegin[p],
+                                partitionSupernodes + structure.partitionBegin[p + 1]);
+        });
+
+    factorizeSupernodes(structure.topSupernodes.data(),
+                        structure.topSupernodes.data() + structure.topSupernodes.size());
+
+    return success;
+}
+
+} // namespace sofa::component::linearsolver::direct
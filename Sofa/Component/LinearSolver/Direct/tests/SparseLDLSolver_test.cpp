@@ -26,6 +26,7 @@
 #include <sofa/simulation/Node.h>
 #include <sofa/simulation/graph/DAGSimulation.h>
 #include <sofa/simpleapi/SimpleApi.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
 
 #include <sofa/testing/NumericTest.h>
 
@@ -138,3 +139,259 @@ TEST(SparseLDLSolver, AssociatedLinearSystem)
 
     EXPECT_EQ(MatrixSystem::GetCustomTemplateName(), MatrixType::Name());
 }
+
+namespace
+{
+using SupernodalMatrixType = sofa::linearalgebra::CompressedRowSparseMatrix<SReal>;
+using SupernodalVectorType = sofa::linearalgebra::FullVector<SReal>;
+using SupernodalSolver = sofa::component::linearsolver::direct::SparseLDLSolver<SupernodalMatrixType, SupernodalVectorType>;
+
+// symmetric positive definite matrix of a 3D grid, with 3 DOFs per node
+void buildGridMatrix(SupernodalMatrixType& matrix, int nx, int ny, int nz)
+{
+    const int nbNodes = nx * ny * nz;
+    matrix.resize(3 * nbNodes, 3 * nbNodes);
+    const auto index = [nx, ny](int x, int y, int z) { return x + nx * (y + ny * z); };
+
+    for (int z = 0; z < nz; ++z)
+    {
+        for (int y = 0; y < ny; ++y)
+        {
+            for (int x = 0; x < nx; ++x)
+            {
+                const int i = index(x, y, z);
+                for (const auto& [dx, dy, dz] : { std::tuple{1, 0, 0}, std::tuple{0, 1, 0}, std::tuple{0, 0, 1}, std::tuple{1, 1, 0} })
+                {
+                    if (x + dx >= nx || y + dy >= ny || z + dz >= nz)
+                        continue;
+                    const int j = index(x + dx, y + dy, z + dz);
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        for (int b = 0; b < 3; ++b)
+                        {
+                            const SReal v = (a == b ? -1. : -0.1) * (1. + 0.01 * (i % 7));
+                            matrix.add(3 * i + a, 3 * j + b, v);
+                            matrix.add(3 * j + b, 3 * i + a, v);
+                            matrix.add(3 * i + a, 3 * i + b, -v);
+                            matrix.add(3 * j + a, 3 * j + b, -v);
+                        }
+                    }
+                }
+                for (int a = 0; a < 3; ++a)
+                {
+                    matrix.add(3 * i + a, 3 * i + a, 0.1);
+                }
+            }
+        }
+    }
+    matrix.compress();
+}
+
+SupernodalVectorType solveGridSystem(SupernodalMatrixType& matrix, bool supernodal, bool parallel)
+{
+    const SupernodalSolver::SPtr solver = sofa::core::objectmodel::New<SupernodalSolver>();
+    solver->findData("supernodal")->read(supernodal ? "true" : "false");
+    solver->findData("parallelFactorization")->read(parallel ? "true" : "false");
+    solver->init();
+
+    SupernodalVectorType b(matrix.rowSize()), x(matrix.rowSize());
+    for (SupernodalVectorType::Index i = 0; i < b.size(); ++i)
+    {
+        b[i] = std::sin(SReal(i));
+    }
+
+    solver->invert(matrix);
+    solver->solve(matrix, x, b);
+
+    // residual
+    SupernodalVectorType r(matrix.rowSize());
+    matrix.mul(r, x);
+    for (SupernodalVectorType::Index i = 0; i < b.size(); ++i)
+    {
+        EXPECT_NEAR(r[i], b[i], 1e-8);
+    }
+    return x;
+}
+}
+
+TEST(SparseLDLSolver, SupernodalFactorization)
+{
+    SupernodalMatrixType matrix;
+    buildGridMatrix(matrix, 6, 5, 4);
+
+    const SupernodalVectorType x = solveGridSystem(matrix, false, false);
+    const SupernodalVectorType xSupernodal = solveGridSystem(matrix, true, false);
+
+    ASSERT_EQ(x.size(), xSupernodal.size());
+    for (SupernodalVectorType::Index i = 0; i < x.size(); ++i)
+    {
+        EXPECT_NEAR(x[i], xSupernodal[i], 1e-10);
+    }
+}
+
+TEST(SparseLDLSolver, ParallelSupernodalFactorization)
+{
+    sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::MainTaskSchedulerFactory::createInRegistry();
+    if (taskScheduler->getThreadCount() < 1)
+    {
+        taskScheduler->init(0);
+    }
+
+    SupernodalMatrixType matrix;
+    buildGridMatrix(matrix, 8, 6, 5);
+
+    const SupernodalVectorType x = solveGridSystem(matrix, false, false);
+    const SupernodalVectorType xParallel = solveGridSystem(matrix, true, true);
+
+    ASSERT_EQ(x.size(), xParallel.size());
+    for (SupernodalVectorType::Index i = 0; i < x.size(); ++i)
+    {
+        EXPECT_NEAR(x[i], xParallel[i], 1e-10);
+    }
+}
+
+namespace
+{
+// J*A^-1*J^T, where J is a sparse matrix with a few non-zeros per row, as in a constraint matrix
+sofa::linearalgebra::FullMatrix<SReal> computeGridCompliance(SupernodalMatrixType& matrix, bool parallel)
+{
+    const SupernodalSolver::SPtr solver = sofa::core::objectmodel::New<SupernodalSolver>();
+    solver->findData("parallelInverseProduct")->read(parallel ? "true" : "false");
+    solver->init();
+    solver->invert(matrix);
+
+    const sofa::Index nbConstraints = 37;
+    SupernodalSolver::JMatrixType J;
+    J.resize(nbConstraints, matrix.rowSize());
+    for (sofa::Index c = 0; c < nbConstraints; ++c)
+    {
+        const sofa::Index col = (c * 17) % matrix.rowSize();
+        J.set(c, col, 1. + 0.1 * c);
+        J.set(c, (col + 4) % matrix.rowSize(), -0.5);
+    }
+
+    sofa::linearalgebra::FullMatrix<SReal> W;
+    W.resize(nbConstraints, nbConstraints);
+    solver->addJMInvJtLocal(&matrix, &W, &J, 1.);
+
+    // reference computed with a solve per constraint
+    for (sofa::Index c = 0; c < nbConstraints; ++c)
+    {
+        SupernodalVectorType b(matrix.rowSize()), x(matrix.rowSize());
+        b.clear(); // the constructor does not initialize the values
+        for (const auto& [col, value] : J[c])
+        {
+            b[col] = value;
+        }
+        solver->solve(matrix, x, b);
+        for (sofa::Index d = 0; d < nbConstraints; ++d)
+        {
+            SReal expected = 0;
+            for (const auto& [col, value] : J[d])
+            {
+                expected += value * x[col];
+            }
+            EXPECT_NEAR(W.element(d, c), expected, 1e-8);
+        }
+    }
+    return W;
+}
+}
+
+TEST(SparseLDLSolver, ConstraintCompliance)
+{
+    SupernodalMatrixType matrix;
+    buildGridMatrix(matrix, 6, 5, 4);
+
+    const auto W = computeGridCompliance(matrix, false);
+    const auto Wparallel = computeGridCompliance(matrix, true);
+
+    // the parallel triangular solves perform the same operations in the same order
+    for (decltype(W.rowSize()) i = 0; i < W.rowSize(); ++i)
+    {
+        for (decltype(W.colSize()) j = 0; j < W.colSize(); ++j)
+        {
+            EXPECT_EQ(W.element(i, j), Wparallel.element(i, j));
+        }
+    }
+}
+
+namespace
+{
+/// Stiffen the connections of a node of the grid matrix, as a local change of material would do
+SupernodalMatrixType stiffenGridNode(const SupernodalMatrixType& matrix, sofa::SignedIndex node)
+{
+    SupernodalMatrixType modified = matrix;
+    const auto scale = [&modified](sofa::SignedIndex row, sofa::SignedIndex col, SReal factor)
+    {
+        for (auto p = modified.rowBegin[row]; p < modified.rowBegin[row + 1]; ++p)
+        {
+            if (modified.colsIndex[p] == col)
+            {
+                modified.colsValue[p] *= factor;
+            }
+        }
+    };
+    for (sofa::SignedIndex row = 3 * node; row < 3 * node + 3; ++row)
+    {
+        for (auto p = matrix.rowBegin[row]; p < matrix.rowBegin[row + 1]; ++p)
+        {
+            const auto col = matrix.colsIndex[p];
+            scale(row, col, 1.5);
+            if (col / 3 != node)
+            {
+                scale(col, row, 1.5);
+                scale(col, col, 1.5);
+            }
+        }
+    }
+    return modified;
+}
+
+/// Factorize the grid matrix, then its stiffened version with the low-rank update enabled, and compare the solution
+/// with a factorization from scratch. Return the number of low-rank updates performed by the solver.
+unsigned int solveStiffenedGridSystem(const std::string& lowRankUpdateThreshold)
+{
+    SupernodalMatrixType matrix;
+    buildGridMatrix(matrix, 6, 5, 4);
+    SupernodalMatrixType modified = stiffenGridNode(matrix, 17);
+
+    const SupernodalVectorType x = solveGridSystem(modified, false, false);
+
+    const SupernodalSolver::SPtr solver = sofa::core::objectmodel::New<SupernodalSolver>();
+    solver->findData("lowRankUpdate")->read("true");
+    solver->findData("lowRankUpdateThreshold")->read(lowRankUpdateThreshold);
+    solver->init();
+    solver->invert(matrix);
+    solver->invert(modified);
+
+    SupernodalVectorType b(modified.rowSize()), xUpdated(modified.rowSize());
+    for (SupernodalVectorType::Index i = 0; i < b.size(); ++i)
+    {
+        b[i] = std::sin(SReal(i));
+    }
+    solver->solve(modified, xUpdated, b);
+
+    EXPECT_EQ(x.size(), xUpdated.size());
+    for (SupernodalVectorType::Index i = 0; i < x.size() && i < xUpdated.size(); ++i)
+    {
+        EXPECT_NEAR(x[i], xUpdated[i], 1e-10);
+    }
+
+    const auto* nbLowRankUpdates = dynamic_cast<const sofa::Data<unsigned int>*>(solver->findData("nbLowRankUpdates"));
+    EXPECT_NE(nbLowRankUpdates, nullptr);
+    return nbLowRankUpdates ? nbLowRankUpdates->getValue() : 0;
+}
+}
+
+TEST(SparseLDLSolver, LowRankUpdate)
+{
+    // the columns of the node and of its neighbors changed, below the threshold: the factorization is updated
+    EXPECT_EQ(solveStiffenedGridSystem("0.2"), 1u);
+}
+
+TEST(SparseLDLSolver, LowRankUpdateAboveThreshold)
+{
+    // the same change is above the threshold: the factorization is recomputed
+    EXPECT_EQ(solveStiffenedGridSystem("0.01"), 0u);
+}
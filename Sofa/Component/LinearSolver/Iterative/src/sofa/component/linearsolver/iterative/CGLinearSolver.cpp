@@ -27,9 +27,6 @@
 #include <sofa/linearalgebra/CompressedRowSparseMatrix.h>
 #include <sofa/core/ObjectFactory.h>
 
-#include <sofa/simulation/mechanicalvisitor/MechanicalVMultiOpVisitor.h>
-using sofa::simulation::mechanicalvisitor::MechanicalVMultiOpVisitor;
-
 namespace sofa::component::linearsolver::iterative
 {
 
@@ -44,12 +41,14 @@ inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,compone
 }
 
 template<> SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API
-inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, Real alpha)
+inline SReal CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, Real alpha)
 {
+    SOFA_UNUSED(params);
 #ifdef SOFA_NO_VMULTIOP // unoptimized version
     x.peq(p,alpha);                 // x = x + alpha p
     r.peq(q,-alpha);                // r = r - alpha q
-#else // single-operation optimization
+    return r.dot(r);
+#else // single-operation optimization, also computing r.r in the same pass
     typedef sofa::core::behavior::BaseMechanicalState::VMultiOp VMultiOp;
     VMultiOp ops;
     ops.resize(2);
@@ -59,7 +58,8 @@ inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,compone
     ops[1].first = (MultiVecDerivId)r;
     ops[1].second.push_back(std::make_pair((MultiVecDerivId)r,1.0));
     ops[1].second.push_back(std::make_pair((MultiVecDerivId)q,-alpha));
-    this->executeVisitor(MechanicalVMultiOpVisitor(params, ops));
+    r.ops()->v_multiop_dot(ops, (MultiVecDerivId)r, (MultiVecDerivId)r);
+    return r.ops()->finish();
 #endif
 }
 using namespace sofa::linearalgebra;
@@ -54,8 +54,8 @@ protected:
     /// It computes: p = p*beta + r
     inline void cgstep_beta(const core::ExecParams* params, Vector& p, Vector& r, Real beta);
     /// This method is separated from the rest to be able to use custom/optimized versions depending on the types of vectors.
-    /// It computes: x += p*alpha, r -= q*alpha
-    inline void cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, Real alpha);
+    /// It computes: x += p*alpha, r -= q*alpha, and returns the new squared norm of the residual r.r
+    inline Real cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, Real alpha);
 
     int timeStepCount{0};
     bool equilibriumReached{false};
@@ -76,7 +76,7 @@ template<>
 inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_beta(const core::ExecParams* /*params*/, Vector& p, Vector& r, Real beta);
 
 template<>
-inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, Real alpha);
+inline SReal CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, Real alpha);
 
 #if !defined(SOFA_COMPONENT_LINEARSOLVER_CGLINEARSOLVER_CPP)
 extern template class SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API CGLinearSolver< GraphScatteredMatrix, GraphScatteredVector >;
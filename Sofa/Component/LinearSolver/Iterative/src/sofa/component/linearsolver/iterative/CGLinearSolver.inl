@@ -148,6 +148,10 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
     // Check if forces in the Left Hand Side (LHS) vector are non-zero
     if(normb != 0.0)
     {
+        /// Compute ρ = r²
+        /// For the following iterations, ρ is updated at the end of the CG step
+        rho = r.dot(r);
+
         for( nb_iter = 1; nb_iter <= d_maxIter.getValue(); nb_iter++ )
         {
 #ifdef SOFA_DUMP_VISITOR_INFO
@@ -159,9 +163,6 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
             }
 #endif
 
-            /// Compute ρ = r²
-            rho = r.dot(r);
-
             /// Compute the error from the norm of ρ and b
             const auto normr = sqrt(rho);
             const auto err = normr/normb;
@@ -274,7 +275,9 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
                 /// End of the CG step by updating x and r
                 /// x = x + alpha p
                 /// r = r - alpha p
-                cgstep_alpha(params, x,r,p,q,alpha);
+                /// and computing the new ρ = r²
+                rho_1 = rho;
+                rho = cgstep_alpha(params, x,r,p,q,alpha);
 
                 msg_info() << "den = " << den << ", alpha = " << alpha << ", x = " << x << ", r = " << r;
             }
@@ -284,8 +287,6 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
                 break;
             }
 
-            rho_1 = rho;
-
 #ifdef SOFA_DUMP_VISITOR_INFO
             if (simulation::Visitor::isPrintActivated())
                 simulation::Visitor::printCloseNode(comment.str());
@@ -344,13 +345,15 @@ inline void CGLinearSolver<TMatrix,TVector>::cgstep_beta(const core::ExecParams*
 }
 
 template<class TMatrix, class TVector>
-inline void CGLinearSolver<TMatrix,TVector>::cgstep_alpha(const core::ExecParams* /*params*/, Vector& x, Vector& r, Vector& p, Vector& q, Real alpha)
+inline typename CGLinearSolver<TMatrix,TVector>::Real CGLinearSolver<TMatrix,TVector>::cgstep_alpha(const core::ExecParams* /*params*/, Vector& x, Vector& r, Vector& p, Vector& q, Real alpha)
 {
     // x = x + alpha p
     x.peq(p,alpha);
 
     // r = r - alpha q
     r.peq(q,-alpha);
+
+    return r.dot(r);
 }
 
 } // namespace sofa::component::linearsolver::iterative
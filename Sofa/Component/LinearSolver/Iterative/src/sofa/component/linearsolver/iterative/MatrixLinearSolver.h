@@ -298,6 +298,10 @@ public:
 
     bool addMInvJt(linearalgebra::BaseMatrix* result, linearalgebra::BaseMatrix* J, SReal fact) override;
 
+    bool addJMInvJtColumns(linearalgebra::BaseMatrix* result, linearalgebra::BaseMatrix* J, const sofa::type::vector<linearalgebra::BaseMatrix::Index>& rows, SReal fact) override;
+
+    std::size_t getSystemInversionCount() const override { return linearSystem.inversionCount; }
+
     bool buildComplianceMatrix(const core::ConstraintParams* cparams, linearalgebra::BaseMatrix* result, SReal fact) override;
 
     void applyConstraintForce(const sofa::core::ConstraintParams* cparams, sofa::core::MultiVecDerivId dx, const linearalgebra::BaseVector* f) override;
@@ -361,6 +365,7 @@ protected:
     struct LinearSystemData
     {
         bool needInvert;
+        std::size_t inversionCount; ///< Number of times the system matrix has been inverted
         Matrix* systemMatrix;
         Vector* systemRHVector;
         Vector* systemLHVector;
@@ -373,7 +378,7 @@ protected:
 #endif // SOFA_CORE_ENABLE_CRSMULTIMATRIXACCESSOR
 
         LinearSystemData()
-                : needInvert(true), systemMatrix(nullptr), systemRHVector(nullptr), systemLHVector(nullptr),
+                : needInvert(true), inversionCount(0), systemMatrix(nullptr), systemRHVector(nullptr), systemLHVector(nullptr),
                   solutionVecId(core::MultiVecDerivId::null())
         {}
         ~LinearSystemData()
@@ -471,6 +476,7 @@ extern template SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API MatrixLinearSolver<Gra
 extern template SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API void MatrixLinearSolver<GraphScatteredMatrix,GraphScatteredVector,NoThreadManager>::invertSystem();
 extern template SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API bool MatrixLinearSolver<GraphScatteredMatrix,GraphScatteredVector,NoThreadManager>::addJMInvJt(linearalgebra::BaseMatrix*, linearalgebra::BaseMatrix*, SReal);
 extern template SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API bool MatrixLinearSolver<GraphScatteredMatrix,GraphScatteredVector,NoThreadManager>::addMInvJt(linearalgebra::BaseMatrix*, linearalgebra::BaseMatrix*, SReal);
+extern template SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API bool MatrixLinearSolver<GraphScatteredMatrix,GraphScatteredVector,NoThreadManager>::addJMInvJtColumns(linearalgebra::BaseMatrix*, linearalgebra::BaseMatrix*, const sofa::type::vector<linearalgebra::BaseMatrix::Index>&, SReal);
 extern template SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API bool MatrixLinearSolver<GraphScatteredMatrix,GraphScatteredVector,NoThreadManager>::addJMInvJtLocal(GraphScatteredMatrix*, ResMatrixType*, const JMatrixType*, SReal);
 extern template SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API bool MatrixLinearSolver<GraphScatteredMatrix,GraphScatteredVector,NoThreadManager>::addMInvJtLocal(GraphScatteredMatrix*, ResMatrixType*, const  JMatrixType*, SReal);
 extern template SOFA_COMPONENT_LINEARSOLVER_ITERATIVE_API bool MatrixLinearSolver<GraphScatteredMatrix,GraphScatteredVector,NoThreadManager>::buildComplianceMatrix(const core::ConstraintParams*, linearalgebra::BaseMatrix*, SReal);
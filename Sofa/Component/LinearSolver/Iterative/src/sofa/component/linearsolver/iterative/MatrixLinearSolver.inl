@@ -346,6 +346,7 @@ void MatrixLinearSolver<Matrix,Vector>::solveSystem()
     {
         this->invert(*systemMatrix);
         linearSystem.needInvert = false;
+        ++linearSystem.inversionCount;
     }
 
     // Step 2: Solve the system based on the system inversion
@@ -398,6 +399,7 @@ void MatrixLinearSolver<Matrix,Vector>::invertSystem()
     {
         this->invert(*l_linearSystem->getSystemMatrix());
         linearSystem.needInvert = false;
+        ++linearSystem.inversionCount;
     }
 }
 
@@ -427,6 +429,7 @@ bool MatrixLinearSolver<Matrix, Vector>::addJMInvJtLocal(Matrix* M, ResMatrixTyp
     {
         this->invert(*systemMatrix);
         linearSystem.needInvert = false;
+        ++linearSystem.inversionCount;
     }
 
     simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
@@ -496,6 +499,7 @@ bool MatrixLinearSolver<Matrix, Vector>::singleThreadAddJMInvJtLocal(Matrix* M,
     {
         this->invert(*systemMatrix);
         linearSystem.needInvert = false;
+        ++linearSystem.inversionCount;
     }
 
     for (typename JMatrixType::Index row = 0; row < J->rowSize(); ++row)
@@ -549,6 +553,58 @@ bool MatrixLinearSolver<Matrix,Vector>::addMInvJtLocal(Matrix * /*M*/,ResMatrixT
     return true;
 }
 
+template<class Matrix, class Vector>
+bool MatrixLinearSolver<Matrix,Vector>::addJMInvJtColumns(linearalgebra::BaseMatrix* result, linearalgebra::BaseMatrix* J, const sofa::type::vector<linearalgebra::BaseMatrix::Index>& rows, SReal fact)
+{
+    if (rows.empty())
+    {
+        return true;
+    }
+
+    auto* systemMatrix = getSystemMatrix();
+    if (!systemMatrix)
+    {
+        msg_error() << "System matrix is not setup properly";
+        return false;
+    }
+
+    if (linearSystem.needInvert)
+    {
+        this->invert(*systemMatrix);
+        linearSystem.needInvert = false;
+        ++linearSystem.inversionCount;
+    }
+
+    const JMatrixType * j_local = internalData.getLocalJ(J);
+    ResMatrixType * res_local = internalData.getLocalRes(result);
+
+    for (const auto row : rows)
+    {
+        // STEP 1 : put the line of matrix Jt in the right hand term of the system
+        for (typename JMatrixType::Index i = 0; i < j_local->colSize(); ++i)
+        {
+            this->getSystemRHVector()->set(i, j_local->element(row, i));
+        }
+
+        // STEP 2 : solve the system :
+        this->solve(*systemMatrix, *this->getSystemLHVector(), *this->getSystemRHVector());
+
+        // STEP 3 : project the result using matrix J
+        for (const auto& [row2, line] : *j_local)
+        {
+            Real acc = 0;
+            for (const auto& [col2, val2] : line)
+            {
+                acc += val2 * getSystemLHVector()->element(col2);
+            }
+            res_local->add(row2, row, acc * fact);
+        }
+    }
+
+    internalData.addLocalRes(result);
+    return true;
+}
+
 template<class Matrix, class Vector>
 bool MatrixLinearSolver<Matrix,Vector>::addJMInvJt(linearalgebra::BaseMatrix* result, linearalgebra::BaseMatrix* J, SReal fact)
 {
@@ -0,0 +1,745 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/linearsolver/preconditioner/AMGHierarchy.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sofa::component::linearsolver::preconditioner
+{
+
+namespace
+{
+
+/// Below this number of rows, the operations of a level are not worth being distributed among threads
+constexpr sofa::Index MinRowsPerParallelLevel = 2048;
+
+simulation::ForEachExecutionPolicy levelPolicy(simulation::ForEachExecutionPolicy execution, sofa::Index nbRows)
+{
+    return nbRows < MinRowsPerParallelLevel ? simulation::ForEachExecutionPolicy::SEQUENTIAL : execution;
+}
+
+/// Pattern of the product C = A * B (Gustavson's algorithm)
+void multiplySymbolic(const AMGMatrix& A, const AMGMatrix& B, AMGMatrix& C)
+{
+    C.nbRows = A.nbRows;
+    C.nbCols = B.nbCols;
+    C.rowBegin.resize(A.nbRows + 1);
+    C.colsIndex.clear();
+
+    type::vector<sofa::Index> marker(B.nbCols, std::numeric_limits<sofa::Index>::max());
+    C.rowBegin[0] = 0;
+    for (sofa::Index i = 0; i < A.nbRows; ++i)
+    {
+        for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+        {
+            const sofa::Index k = A.colsIndex[a];
+            for (sofa::Index b = B.rowBegin[k]; b < B.rowBegin[k + 1]; ++b)
+            {
+                const sofa::Index j = B.colsIndex[b];
+                if (marker[j] != i)
+                {
+                    marker[j] = i;
+                    C.colsIndex.push_back(j);
+                }
+            }
+        }
+        std::sort(C.colsIndex.begin() + C.rowBegin[i], C.colsIndex.end());
+        C.rowBegin[i + 1] = static_cast<sofa::Index>(C.colsIndex.size());
+    }
+    C.values.resize(C.colsIndex.size());
+}
+
+/// Values of the product C = A * B, the pattern of C being already computed
+void multiplyNumeric(const AMGMatrix& A, const AMGMatrix& B, AMGMatrix& C, type::vector<sofa::SignedIndex>& position)
+{
+    position.resize(std::max<std::size_t>(position.size(), C.nbCols));
+    for (sofa::Index i = 0; i < A.nbRows; ++i)
+    {
+        for (sofa::Index c = C.rowBegin[i]; c < C.rowBegin[i + 1]; ++c)
+        {
+            position[C.colsIndex[c]] = static_cast<sofa::SignedIndex>(c);
+            C.values[c] = 0;
+        }
+        for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+        {
+            const sofa::Index k = A.colsIndex[a];
+            const SReal Aik = A.values[a];
+            for (sofa::Index b = B.rowBegin[k]; b < B.rowBegin[k + 1]; ++b)
+            {
+                C.values[position[B.colsIndex[b]]] += Aik * B.values[b];
+            }
+        }
+    }
+}
+
+/// Pattern of AT = A^T, and position in A of each entry of AT
+void transposeSymbolic(const AMGMatrix& A, AMGMatrix& AT, type::vector<sofa::Index>& transposePosition)
+{
+    AT.nbRows = A.nbCols;
+    AT.nbCols = A.nbRows;
+    AT.rowBegin.assign(A.nbCols + 1, 0);
+    for (const auto j : A.colsIndex)
+    {
+        ++AT.rowBegin[j + 1];
+    }
+    for (sofa::Index j = 0; j < A.nbCols; ++j)
+    {
+        AT.rowBegin[j + 1] += AT.rowBegin[j];
+    }
+
+    AT.colsIndex.resize(A.colsIndex.size());
+    AT.values.resize(A.colsIndex.size());
+    transposePosition.resize(A.colsIndex.size());
+
+    type::vector<sofa::Index> next(AT.rowBegin.begin(), AT.rowBegin.end() - 1);
+    for (sofa::Index i = 0; i < A.nbRows; ++i)
+    {
+        for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+        {
+            const sofa::Index t = next[A.colsIndex[a]]++;
+            AT.colsIndex[t] = i;
+            transposePosition[t] = a;
+        }
+    }
+}
+
+void transposeNumeric(const AMGMatrix& A, AMGMatrix& AT, const type::vector<sofa::Index>& transposePosition)
+{
+    for (std::size_t t = 0; t < transposePosition.size(); ++t)
+    {
+        AT.values[t] = A.values[transposePosition[t]];
+    }
+}
+
+/// Pattern of the Jacobi smoother I - w D^-1 A, i.e. the pattern of A with all its diagonal entries
+void smootherSymbolic(const AMGMatrix& A, AMGMatrix& S)
+{
+    S.nbRows = A.nbRows;
+    S.nbCols = A.nbCols;
+    S.rowBegin.resize(A.nbRows + 1);
+    S.colsIndex.clear();
+    S.rowBegin[0] = 0;
+    for (sofa::Index i = 0; i < A.nbRows; ++i)
+    {
+        bool hasDiagonal = false;
+        for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+        {
+            const sofa::Index j = A.colsIndex[a];
+            if (!hasDiagonal && j > i)
+            {
+                S.colsIndex.push_back(i);
+            }
+            hasDiagonal |= j >= i;
+            S.colsIndex.push_back(j);
+        }
+        if (!hasDiagonal)
+        {
+            S.colsIndex.push_back(i);
+        }
+        S.rowBegin[i + 1] = static_cast<sofa::Index>(S.colsIndex.size());
+    }
+    S.values.resize(S.colsIndex.size());
+}
+
+void smootherNumeric(const AMGMatrix& A, const type::vector<SReal>& invDiagonal, SReal weight, AMGMatrix& S)
+{
+    for (sofa::Index i = 0; i < A.nbRows; ++i)
+    {
+        const SReal factor = weight * invDiagonal[i];
+        sofa::Index a = A.rowBegin[i];
+        for (sofa::Index s = S.rowBegin[i]; s < S.rowBegin[i + 1]; ++s)
+        {
+            const sofa::Index j = S.colsIndex[s];
+            SReal value = (j == i) ? 1 : 0;
+            if (a < A.rowBegin[i + 1] && A.colsIndex[a] == j)
+            {
+                value -= factor * A.values[a++];
+            }
+            S.values[s] = value;
+        }
+    }
+}
+
+/**
+ * Groups the nodes into aggregates, based on the strength of the connections between nodes.
+ * Returns the number of aggregates. The nodes without any strong connection are not aggregated:
+ * their aggregate is -1.
+ */
+sofa::Index aggregate(const AMGMatrix& A, sofa::Index blockSize, SReal strengthThreshold,
+                      type::vector<sofa::SignedIndex>& nodeAggregate)
+{
+    const sofa::Index nbNodes = A.nbRows / blockSize;
+
+    type::vector<SReal> diagonalNorm2(nbNodes, 0);
+    for (sofa::Index i = 0; i < A.nbRows; ++i)
+    {
+        for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+        {
+            if (A.colsIndex[a] / blockSize == i / blockSize)
+            {
+                diagonalNorm2[i / blockSize] += A.values[a] * A.values[a];
+            }
+        }
+    }
+
+    // squared Frobenius norms of the off-diagonal blocks of each node, then strong connections
+    type::vector<sofa::Index> strongBegin(nbNodes + 1, 0);
+    type::vector<sofa::Index> strongNodes;
+    type::vector<SReal> blockNorm2(nbNodes, 0);
+    type::vector<sofa::Index> neighbors;
+    const SReal theta2 = strengthThreshold * strengthThreshold;
+    for (sofa::Index I = 0; I < nbNodes; ++I)
+    {
+        neighbors.clear();
+        for (sofa::Index i = I * blockSize; i < (I + 1) * blockSize; ++i)
+        {
+            for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+            {
+                const sofa::Index J = A.colsIndex[a] / blockSize;
+                if (J == I)
+                {
+                    continue;
+                }
+                if (blockNorm2[J] == 0)
+                {
+                    neighbors.push_back(J);
+                }
+                blockNorm2[J] += A.values[a] * A.values[a];
+            }
+        }
+        for (const auto J : neighbors)
+        {
+            if (blockNorm2[J] > 0 && blockNorm2[J] >= theta2 * std::sqrt(diagonalNorm2[I] * diagonalNorm2[J]))
+            {
+                strongNodes.push_back(J);
+            }
+            blockNorm2[J] = 0;
+        }
+        strongBegin[I + 1] = static_cast<sofa::Index>(strongNodes.size());
+    }
+
+    static constexpr sofa::SignedIndex Unassigned = -2;
+    static constexpr sofa::SignedIndex Isolated = -1;
+
+    nodeAggregate.assign(nbNodes, Unassigned);
+    for (sofa::Index I = 0; I < nbNodes; ++I)
+    {
+        if (strongBegin[I] == strongBegin[I + 1])
+        {
+            nodeAggregate[I] = Isolated;
+        }
+    }
+
+    sofa::SignedIndex nbAggregates = 0;
+
+    // 1) aggregates made of a node and all its strong neighbors, if none of them is already aggregated
+    for (sofa::Index I = 0; I < nbNodes; ++I)
+    {
+        if (nodeAggregate[I] != Unassigned)
+        {
+            continue;
+        }
+        const bool isFree = std::all_of(strongNodes.begin() + strongBegin[I], strongNodes.begin() + strongBegin[I + 1],
+            [&nodeAggregate](sofa::Index J){ return nodeAggregate[J] == Unassigned; });
+        if (isFree)
+        {
+            nodeAggregate[I] = nbAggregates;
+            for (sofa::Index s = strongBegin[I]; s < strongBegin[I + 1]; ++s)
+            {
+                nodeAggregate[strongNodes[s]] = nbAggregates;
+            }
+            ++nbAggregates;
+        }
+    }
+
+    // 2) the remaining nodes join an aggregate of the first pass of one of their strong neighbors
+    const type::vector<sofa::SignedIndex> firstPass = nodeAggregate;
+    for (sofa::Index I = 0; I < nbNodes; ++I)
+    {
+        if (nodeAggregate[I] != Unassigned)
+        {
+            continue;
+        }
+        for (sofa::Index s = strongBegin[I]; s < strongBegin[I + 1]; ++s)
+        {
+            if (firstPass[strongNodes[s]] >= 0)
+            {
+                nodeAggregate[I] = firstPass[strongNodes[s]];
+                break;
+            }
+        }
+    }
+
+    // 3) the nodes still left form new aggregates with their free strong neighbors
+    for (sofa::Index I = 0; I < nbNodes; ++I)
+    {
+        if (nodeAggregate[I] != Unassigned)
+        {
+            continue;
+        }
+        nodeAggregate[I] = nbAggregates;
+        for (sofa::Index s = strongBegin[I]; s < strongBegin[I + 1]; ++s)
+        {
+            if (nodeAggregate[strongNodes[s]] == Unassigned)
+            {
+                nodeAggregate[strongNodes[s]] = nbAggregates;
+            }
+        }
+        ++nbAggregates;
+    }
+
+    return static_cast<sofa::Index>(nbAggregates);
+}
+
+/// Piecewise constant interpolation of each unknown of a node from the same unknown of its aggregate,
+/// with columns of unit norm
+void tentativeProlongator(const type::vector<sofa::SignedIndex>& nodeAggregate, sofa::Index nbAggregates,
+                          sofa::Index blockSize, AMGMatrix& P)
+{
+    type::vector<sofa::Index> aggregateSize(nbAggregates, 0);
+    for (const auto aggregate : nodeAggregate)
+    {
+        if (aggregate >= 0)
+        {
+            ++aggregateSize[aggregate];
+        }
+    }
+
+    const auto nbNodes = static_cast<sofa::Index>(nodeAggregate.size());
+    P.nbRows = nbNodes * blockSize;
+    P.nbCols = nbAggregates * blockSize;
+    P.rowBegin.resize(P.nbRows + 1);
+    P.colsIndex.clear();
+    P.values.clear();
+    P.rowBegin[0] = 0;
+    for (sofa::Index I = 0; I < nbNodes; ++I)
+    {
+        for (sofa::Index c = 0; c < blockSize; ++c)
+        {
+            const sofa::Index i = I * blockSize + c;
+            if (nodeAggregate[I] >= 0)
+            {
+                P.colsIndex.push_back(nodeAggregate[I] * blockSize + c);
+                P.values.push_back(1 / std::sqrt(static_cast<SReal>(aggregateSize[nodeAggregate[I]])));
+            }
+            P.rowBegin[i + 1] = static_cast<sofa::Index>(P.colsIndex.size());
+        }
+    }
+}
+
+/// Estimation of the spectral radius of D^-1 A with a few power iterations
+SReal estimateSpectralRadius(const AMGMatrix& A, const type::vector<SReal>& invDiagonal)
+{
+    static constexpr unsigned int NbIterations = 20;
+
+    // deterministic pseudo-random starting vector, so that the estimation does not depend on the run
+    type::vector<SReal> v(A.nbRows), w(A.nbRows);
+    unsigned int seed = 12345u;
+    for (auto& vi : v)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        vi = static_cast<SReal>(seed >> 8) / static_cast<SReal>(1u << 24) - static_cast<SReal>(0.5);
+    }
+
+    SReal radius = 0;
+    for (unsigned int it = 0; it < NbIterations; ++it)
+    {
+        SReal norm2 = 0;
+        for (const auto vi : v)
+        {
+            norm2 += vi * vi;
+        }
+        if (norm2 == 0)
+        {
+            break;
+        }
+        const SReal invNorm = 1 / std::sqrt(norm2);
+
+        SReal wNorm2 = 0;
+        for (sofa::Index i = 0; i < A.nbRows; ++i)
+        {
+            SReal sum = 0;
+            for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+            {
+                sum += A.values[a] * v[A.colsIndex[a]];
+            }
+            w[i] = invDiagonal[i] * sum * invNorm;
+            wNorm2 += w[i] * w[i];
+        }
+        radius = std::sqrt(wNorm2);
+        std::swap(v, w);
+    }
+    return radius;
+}
+
+} // namespace
+
+bool AMGMatrix::hasSamePattern(const AMGMatrix& other) const
+{
+    return nbRows == other.nbRows && nbCols == other.nbCols
+        && rowBegin == other.rowBegin && colsIndex == other.colsIndex;
+}
+
+void AMGMatrix::mul(const SReal* x, SReal* y,
+                    simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler) const
+{
+    simulation::forEachRange(levelPolicy(execution, nbRows), taskScheduler, 0u, nbRows,
+        [this, x, y](const auto& range)
+        {
+            for (auto i = range.start; i != range.end; ++i)
+            {
+                SReal sum = 0;
+                for (sofa::Index a = rowBegin[i]; a < rowBegin[i + 1]; ++a)
+                {
+                    sum += values[a] * x[colsIndex[a]];
+                }
+                y[i] = sum;
+            }
+        });
+}
+
+void AMGMatrix::addMul(const SReal* x, SReal* y,
+                       simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler) const
+{
+    simulation::forEachRange(levelPolicy(execution, nbRows), taskScheduler, 0u, nbRows,
+        [this, x, y](const auto& range)
+        {
+            for (auto i = range.start; i != range.end; ++i)
+            {
+                SReal sum = 0;
+                for (sofa::Index a = rowBegin[i]; a < rowBegin[i + 1]; ++a)
+                {
+                    sum += values[a] * x[colsIndex[a]];
+                }
+                y[i] += sum;
+            }
+        });
+}
+
+bool AMGHierarchy::Parameters::operator==(const Parameters& other) const
+{
+    return strengthThreshold == other.strengthThreshold
+        && blockSize == other.blockSize
+        && coarsestSize == other.coarsestSize
+        && maxLevels == other.maxLevels
+        && nbSmoothingSteps == other.nbSmoothingSteps;
+}
+
+void AMGHierarchy::clear()
+{
+    m_levels.clear();
+    m_coarsestL.clear();
+    m_coarsestInvD.clear();
+    m_hasCoarsestFactorization = false;
+}
+
+bool AMGHierarchy::build(const AMGMatrix& A, const Parameters& parameters)
+{
+    const bool symbolic = m_levels.empty() || !(parameters == m_parameters) || !A.hasSamePattern(m_levels[0].A);
+
+    m_parameters = parameters;
+    if (m_parameters.blockSize == 0 || A.nbRows % m_parameters.blockSize != 0)
+    {
+        m_parameters.blockSize = 1;
+    }
+
+    if (symbolic)
+    {
+        clear();
+        m_levels.emplace_back();
+        m_levels[0].A = A;
+    }
+    else
+    {
+        m_levels[0].A.values = A.values;
+    }
+
+    for (std::size_t l = 0; l < m_levels.size(); ++l)
+    {
+        buildLevel(l, symbolic);
+    }
+
+    factorizeCoarsest();
+
+    // the comparison of the parameters, at the next call, must be done with the parameters as provided
+    m_parameters.blockSize = parameters.blockSize;
+
+    return symbolic;
+}
+
+void AMGHierarchy::buildLevel(std::size_t l, bool symbolic)
+{
+    {
+        Level& level = m_levels[l];
+        const AMGMatrix& A = level.A;
+
+        level.invDiagonal.assign(A.nbRows, 0);
+        for (sofa::Index i = 0; i < A.nbRows; ++i)
+        {
+            for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+            {
+                if (A.colsIndex[a] == i && A.values[a] != 0)
+                {
+                    level.invDiagonal[i] = 1 / A.values[a];
+                }
+            }
+        }
+
+        // damping of the Jacobi iteration minimizing the amplification of the highest frequencies
+        const SReal radius = estimateSpectralRadius(A, level.invDiagonal);
+        level.smootherWeight = radius > 0 ? static_cast<SReal>(4) / (3 * radius) : 1;
+
+        if (symbolic)
+        {
+            level.x.resize(A.nbRows);
+            level.b.resize(A.nbRows);
+            level.r.resize(A.nbRows);
+
+            if (A.nbRows <= m_parameters.coarsestSize || l + 1 >= m_parameters.maxLevels)
+            {
+                return;
+            }
+
+            type::vector<sofa::SignedIndex> nodeAggregate;
+            const sofa::Index nbAggregates = aggregate(A, m_parameters.blockSize, m_parameters.strengthThreshold, nodeAggregate);
+            if (nbAggregates == 0 || nbAggregates * m_parameters.blockSize >= A.nbRows)
+            {
+                // no coarsening: this level is the coarsest one
+                return;
+            }
+
+            tentativeProlongator(nodeAggregate, nbAggregates, m_parameters.blockSize, level.tentativeProlongator);
+            smootherSymbolic(A, level.prolongatorSmoother);
+            multiplySymbolic(level.prolongatorSmoother, level.tentativeProlongator, level.P);
+            transposeSymbolic(level.P, level.R, level.transposePosition);
+            multiplySymbolic(A, level.P, level.AP);
+
+            m_levels.emplace_back();
+        }
+        else if (l + 1 == m_levels.size())
+        {
+            return;
+        }
+    }
+
+    // m_levels may have been reallocated
+    Level& level = m_levels[l];
+    Level& next = m_levels[l + 1];
+
+    smootherNumeric(level.A, level.invDiagonal, level.smootherWeight, level.prolongatorSmoother);
+    multiplyNumeric(level.prolongatorSmoother, level.tentativeProlongator, level.P, m_position);
+    transposeNumeric(level.P, level.R, level.transposePosition);
+    multiplyNumeric(level.A, level.P, level.AP, m_position);
+
+    if (symbolic)
+    {
+        multiplySymbolic(level.R, level.AP, next.A);
+    }
+    multiplyNumeric(level.R, level.AP, next.A, m_position);
+}
+
+void AMGHierarchy::factorizeCoarsest()
+{
+    const AMGMatrix& A = m_levels.back().A;
+    const sofa::Index n = A.nbRows;
+
+    m_hasCoarsestFactorization = n <= m_parameters.coarsestSize;
+    if (!m_hasCoarsestFactorization)
+    {
+        m_coarsestL.clear();
+        m_coarsestInvD.clear();
+        return;
+    }
+
+    auto& L = m_coarsestL;
+    L.assign(static_cast<std::size_t>(n) * n, 0);
+    SReal maxDiagonal = 0;
+    for (sofa::Index i = 0; i < n; ++i)
+    {
+        for (sofa::Index a = A.rowBegin[i]; a < A.rowBegin[i + 1]; ++a)
+        {
+            L[i * n + A.colsIndex[a]] = A.values[a];
+        }
+        maxDiagonal = std::max(maxDiagonal, std::abs(L[i * n + i]));
+    }
+
+    // pivots negligible compared to the diagonal correspond to the null space of the coarse operator
+    // (e.g. an object without any boundary condition): they are skipped
+    const SReal tolerance = maxDiagonal * std::numeric_limits<SReal>::epsilon() * n;
+
+    m_coarsestInvD.resize(n);
+    type::vector<SReal> LD(n);
+    for (sofa::Index j = 0; j < n; ++j)
+    {
+        SReal* Lj = &L[j * n];
+        for (sofa::Index k = 0; k < j; ++k)
+        {
+            LD[k] = Lj[k] * m_coarsestL[k * n + k];
+        }
+        SReal d = Lj[j];
+        for (sofa::Index k = 0; k < j; ++k)
+        {
+            d -= Lj[k] * LD[k];
+        }
+
+        const bool isPivot = std::abs(d) > tolerance;
+        m_coarsestInvD[j] = isPivot ? 1 / d : 0;
+        // the diagonal of L is not needed: it is used to store D during the factorization
+        Lj[j] = isPivot ? d : 0;
+
+        for (sofa::Index i = j + 1; i < n; ++i)
+        {
+            SReal* Li = &L[i * n];
+            SReal value = Li[j];
+            for (sofa::Index k = 0; k < j; ++k)
+            {
+                value -= Li[k] * LD[k];
+            }
+            Li[j] = value * m_coarsestInvD[j];
+        }
+    }
+}
+
+void AMGHierarchy::vcycle(const SReal* b, SReal* x,
+                          simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler)
+{
+    if (m_levels.empty())
+    {
+        return;
+    }
+    cycle(0, b, x, execution, taskScheduler);
+}
+
+void AMGHierarchy::cycle(std::size_t l, const SReal* b, SReal* x,
+                         simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler)
+{
+    if (l + 1 == m_levels.size())
+    {
+        solveCoarsest(b, x, execution, taskScheduler);
+        return;
+    }
+
+    Level& level = m_levels[l];
+    Level& next = m_levels[l + 1];
+    const sofa::Index n = level.A.nbRows;
+    const auto policy = levelPolicy(execution, n);
+
+    // pre-smoothing, starting from x = 0
+    simulation::forEachRange(policy, taskScheduler, 0u, n,
+        [&level, b, x](const auto& range)
+        {
+            for (auto i = range.start; i != range.end; ++i)
+            {
+                x[i] = level.smootherWeight * level.invDiagonal[i] * b[i];
+            }
+        });
+    for (unsigned int s = 1; s < m_parameters.nbSmoothingSteps; ++s)
+    {
+        smooth(level, b, x, execution, taskScheduler);
+    }
+
+    // coarse grid correction
+    level.A.mul(x, level.r.data(), execution, taskScheduler);
+    simulation::forEachRange(policy, taskScheduler, 0u, n,
+        [&level, b](const auto& range)
+        {
+            for (auto i = range.start; i != range.end; ++i)
+            {
+                level.r[i] = b[i] - level.r[i];
+            }
+        });
+    level.R.mul(level.r.data(), next.b.data(), execution, taskScheduler);
+
+    cycle(l + 1, next.b.data(), next.x.data(), execution, taskScheduler);
+
+    level.P.addMul(next.x.data(), x, execution, taskScheduler);
+
+    // post-smoothing, as many steps as the pre-smoothing so that the cycle is symmetric
+    for (unsigned int s = 0; s < m_parameters.nbSmoothingSteps; ++s)
+    {
+        smooth(level, b, x, execution, taskScheduler);
+    }
+}
+
+void AMGHierarchy::smooth(Level& level, const SReal* b, SReal* x,
+                          simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler)
+{
+    const sofa::Index n = level.A.nbRows;
+    level.A.mul(x, level.r.data(), execution, taskScheduler);
+    simulation::forEachRange(levelPolicy(execution, n), taskScheduler, 0u, n,
+        [&level, b, x](const auto& range)
+        {
+            for (auto i = range.start; i != range.end; ++i)
+            {
+                x[i] += level.smootherWeight * level.invDiagonal[i] * (b[i] - level.r[i]);
+            }
+        });
+}
+
+void AMGHierarchy::solveCoarsest(const SReal* b, SReal* x,
+                                 simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler)
+{
+    Level& level = m_levels.back();
+    const sofa::Index n = level.A.nbRows;
+
+    if (!m_hasCoarsestFactorization)
+    {
+        // the coarsening stopped before reaching a size small enough for a direct solver
+        for (sofa::Index i = 0; i < n; ++i)
+        {
+            x[i] = level.smootherWeight * level.invDiagonal[i] * b[i];
+        }
+        for (unsigned int s = 1; s < 2 * m_parameters.nbSmoothingSteps; ++s)
+        {
+            smooth(level, b, x, execution, taskScheduler);
+        }
+        return;
+    }
+
+    const auto& L = m_coarsestL;
+    for (sofa::Index i = 0; i < n; ++i)
+    {
+        SReal value = b[i];
+        for (sofa::Index k = 0; k < i; ++k)
+        {
+            value -= L[i * n + k] * x[k];
+        }
+        x[i] = value;
+    }
+    for (sofa::Index i = 0; i < n; ++i)
+    {
+        x[i] *= m_coarsestInvD[i];
+    }
+    for (sofa::Index i = n; i-- > 0;)
+    {
+        SReal value = x[i];
+        for (sofa::Index k = i + 1; k < n; ++k)
+        {
+            value -= L[k * n + i] * x[k];
+        }
+        x[i] = value;
+    }
+}
+
+} // namespace sofa::component::linearsolver::preconditioner
@@ -0,0 +1,145 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/linearsolver/preconditioner/config.h>
+
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/type/vector.h>
+
+namespace sofa::component::linearsolver::preconditioner
+{
+
+/// Scalar sparse matrix in compressed row format, with sorted column indices in each row.
+/// It is the storage of the operators of the algebraic multigrid hierarchy.
+struct SOFA_COMPONENT_LINEARSOLVER_PRECONDITIONER_API AMGMatrix
+{
+    sofa::Index nbRows { 0 };
+    sofa::Index nbCols { 0 };
+
+    /// The entries of the row i are [rowBegin[i], rowBegin[i+1])
+    type::vector<sofa::Index> rowBegin;
+    type::vector<sofa::Index> colsIndex;
+    type::vector<SReal> values;
+
+    bool hasSamePattern(const AMGMatrix& other) const;
+
+    /// y = this * x
+    void mul(const SReal* x, SReal* y,
+             simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler) const;
+
+    /// y += this * x
+    void addMul(const SReal* x, SReal* y,
+                simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler) const;
+};
+
+/**
+ * Hierarchy of a smoothed aggregation algebraic multigrid, applied as a V-cycle.
+ *
+ * The unknowns are grouped by nodes of blockSize unknowns (3 for 3D mechanics). Nodes connected by
+ * blocks of large norm relative to their diagonal blocks are grouped into aggregates. The tentative
+ * prolongator interpolates each unknown of a node from the same unknown of its aggregate, i.e. the
+ * translations are represented exactly on the coarse level. It is then smoothed by a Jacobi
+ * iteration, and the coarse operator is the Galerkin product P^T A P.
+ *
+ * Jacobi is used as smoother, with the same number of steps before and after the coarse correction,
+ * so that the V-cycle is a symmetric operator and can precondition a conjugate gradient.
+ * The coarsest level is solved with a dense LDL^T factorization.
+ */
+class SOFA_COMPONENT_LINEARSOLVER_PRECONDITIONER_API AMGHierarchy
+{
+public:
+
+    struct Parameters
+    {
+        /// Two nodes are strongly connected if the norm of their block is larger than this threshold
+        /// times the geometric mean of the norms of their diagonal blocks
+        SReal strengthThreshold { 0.08 };
+        /// Number of unknowns of a node
+        sofa::Index blockSize { 1 };
+        /// Number of unknowns below which a level is the coarsest level
+        sofa::Index coarsestSize { 300 };
+        unsigned int maxLevels { 10 };
+        unsigned int nbSmoothingSteps { 1 };
+
+        bool operator==(const Parameters& other) const;
+    };
+
+    /**
+     * Builds the hierarchy of the matrix A.
+     * If the pattern of A and the parameters are the same as in the previous call, the aggregates
+     * and the patterns of all the operators are reused: only their values are recomputed.
+     *
+     * @return true if the hierarchy has been built, false if it has only been updated
+     */
+    bool build(const AMGMatrix& A, const Parameters& parameters);
+
+    /// x = B^-1 b, where B^-1 is one V-cycle starting from x = 0
+    void vcycle(const SReal* b, SReal* x,
+                simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler);
+
+    std::size_t nbLevels() const { return m_levels.size(); }
+
+    /// Operator of the level l, the level 0 being the input matrix
+    const AMGMatrix& getMatrix(std::size_t l) const { return m_levels[l].A; }
+
+    void clear();
+
+protected:
+
+    struct Level
+    {
+        AMGMatrix A;
+
+        AMGMatrix tentativeProlongator;
+        AMGMatrix prolongatorSmoother; ///< I - w D^-1 A
+        AMGMatrix P; ///< prolongator from the next level
+        AMGMatrix R; ///< restriction to the next level, i.e. P^T
+        AMGMatrix AP; ///< A * P
+        type::vector<sofa::Index> transposePosition; ///< position in P of each entry of R
+
+        type::vector<SReal> invDiagonal;
+        SReal smootherWeight { 0 };
+
+        type::vector<SReal> x, b, r;
+    };
+
+    void buildLevel(std::size_t l, bool symbolic);
+    void factorizeCoarsest();
+
+    void cycle(std::size_t l, const SReal* b, SReal* x,
+               simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler);
+    void smooth(Level& level, const SReal* b, SReal* x,
+                simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler);
+    void solveCoarsest(const SReal* b, SReal* x,
+                       simulation::ForEachExecutionPolicy execution, simulation::TaskScheduler& taskScheduler);
+
+    Parameters m_parameters;
+    type::vector<Level> m_levels;
+
+    /// dense LDL^T factorization of the coarsest level: L stored by rows, and the inverse of D
+    type::vector<SReal> m_coarsestL, m_coarsestInvD;
+    bool m_hasCoarsestFactorization { false };
+
+    type::vector<sofa::SignedIndex> m_position;
+};
+
+} // namespace sofa::component::linearsolver::preconditioner
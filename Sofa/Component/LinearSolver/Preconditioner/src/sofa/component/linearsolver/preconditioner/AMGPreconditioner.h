@@ -0,0 +1,85 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/linearsolver/preconditioner/config.h>
+
+#include <sofa/component/linearsolver/iterative/MatrixLinearSolver.h>
+#include <sofa/component/linearsolver/preconditioner/AMGHierarchy.h>
+#include <sofa/linearalgebra/CompressedRowSparseMatrix.h>
+
+namespace sofa::component::linearsolver::preconditioner
+{
+
+/// Linear system solver / preconditioner based on a smoothed aggregation algebraic multigrid.
+///
+/// One application of the preconditioner is one V-cycle of the hierarchy built from the matrix.
+/// As long as the pattern of the matrix does not change, the hierarchy is only updated numerically.
+template<class TMatrix, class TVector, class TThreadManager = NoThreadManager>
+class AMGPreconditioner : public sofa::component::linearsolver::MatrixLinearSolver<TMatrix,TVector,TThreadManager>
+{
+public:
+    SOFA_CLASS(SOFA_TEMPLATE3(AMGPreconditioner,TMatrix,TVector,TThreadManager),SOFA_TEMPLATE3(sofa::component::linearsolver::MatrixLinearSolver,TMatrix,TVector,TThreadManager));
+
+    typedef TMatrix Matrix;
+    typedef TVector Vector;
+    typedef typename Matrix::Index Index;
+    typedef TThreadManager ThreadManager;
+    typedef SReal Real;
+    typedef sofa::component::linearsolver::MatrixLinearSolver<TMatrix,TVector,TThreadManager> Inherit;
+
+    Data<SReal> d_strengthThreshold; ///< Threshold on the relative norm of the block between two nodes for them to be aggregated
+    Data<unsigned int> d_blockSize; ///< Number of consecutive unknowns forming a node
+    Data<unsigned int> d_coarsestSize; ///< Number of unknowns below which the coarsest level is solved with a direct solver
+    Data<unsigned int> d_maxLevels; ///< Maximum number of levels of the hierarchy
+    Data<unsigned int> d_nbSmoothingSteps; ///< Number of Jacobi steps before and after the coarse grid correction
+    Data<bool> d_parallelCycle; ///< If true, the operations of the V-cycle are distributed among threads
+    Data<unsigned int> d_nbLevels; ///< Output: number of levels of the hierarchy
+
+protected:
+    AMGPreconditioner();
+
+public:
+    void solve (Matrix& M, Vector& x, Vector& b) override;
+    void invert(Matrix& M) override;
+
+    MatrixInvertData * createInvertData() override
+    {
+        return new AMGPreconditionerInvertData();
+    }
+
+protected :
+
+    class AMGPreconditionerInvertData : public MatrixInvertData
+    {
+    public :
+        AMGMatrix matrix;
+        AMGHierarchy hierarchy;
+    };
+
+};
+
+#if !defined(SOFA_COMPONENT_LINEARSOLVER_PRECONDITIONER_AMGPRECONDITIONER_CPP)
+extern template class SOFA_COMPONENT_LINEARSOLVER_PRECONDITIONER_API AMGPreconditioner< linearalgebra::CompressedRowSparseMatrix<SReal>, linearalgebra::FullVector<SReal> >;
+extern template class SOFA_COMPONENT_LINEARSOLVER_PRECONDITIONER_API AMGPreconditioner< linearalgebra::CompressedRowSparseMatrix< type::Mat<3, 3, SReal> >, linearalgebra::FullVector<SReal> >;
+#endif // !defined(SOFA_COMPONENT_LINEARSOLVER_PRECONDITIONER_AMGPRECONDITIONER_CPP)
+
+} // namespace sofa::component::linearsolver::preconditioner
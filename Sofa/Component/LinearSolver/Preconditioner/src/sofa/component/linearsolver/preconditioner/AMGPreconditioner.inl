@@ -0,0 +1,149 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <sofa/component/linearsolver/preconditioner/AMGPreconditioner.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/helper/ScopedAdvancedTimer.h>
+
+namespace sofa::component::linearsolver::preconditioner
+{
+
+template<class TMatrix, class TVector, class TThreadManager>
+AMGPreconditioner<TMatrix,TVector,TThreadManager>::AMGPreconditioner()
+    : d_strengthThreshold(initData(&d_strengthThreshold, 0.08_sreal, "strengthThreshold", "Two nodes are aggregated if the norm of the block between them is larger than this threshold times the geometric mean of the norms of their diagonal blocks"))
+    , d_blockSize(initData(&d_blockSize, 3u, "blockSize", "Number of consecutive unknowns forming a node (3 for a 3D mechanical object). The unknowns of a node are always aggregated together. If the size of the system is not a multiple, each unknown is a node."))
+    , d_coarsestSize(initData(&d_coarsestSize, 300u, "coarsestSize", "Number of unknowns below which the coarsening stops, the coarsest level being solved with a direct solver"))
+    , d_maxLevels(initData(&d_maxLevels, 10u, "maxLevels", "Maximum number of levels of the hierarchy"))
+    , d_nbSmoothingSteps(initData(&d_nbSmoothingSteps, 1u, "nbSmoothingSteps", "Number of Jacobi steps before and after the coarse grid correction"))
+    , d_parallelCycle(initData(&d_parallelCycle, false, "parallelCycle", "If true, the operations of the V-cycle on the large levels are distributed among threads"))
+    , d_nbLevels(initData(&d_nbLevels, 0u, "nbLevels", "Number of levels of the hierarchy", true, true))
+{
+    this->addUpdateCallback("parallelCycle", {&d_parallelCycle},
+    [this](const core::DataTracker& tracker) -> sofa::core::objectmodel::ComponentState
+    {
+        SOFA_UNUSED(tracker);
+        if (d_parallelCycle.getValue())
+        {
+            simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+            assert(taskScheduler);
+
+            if (taskScheduler->getThreadCount() < 1)
+            {
+                taskScheduler->init(0);
+                msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+            else
+            {
+                msg_info() << "Task scheduler already initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+        }
+        return this->d_componentState.getValue();
+    },
+    {});
+}
+
+template<class TMatrix, class TVector, class TThreadManager>
+void AMGPreconditioner<TMatrix,TVector,TThreadManager>::solve (Matrix& M, Vector& z, Vector& r)
+{
+    SCOPED_TIMER_VARNAME(vcycleTimer, "AMGVCycle");
+
+    AMGPreconditionerInvertData * data = (AMGPreconditionerInvertData *) this->getMatrixInvertData(&M);
+
+    const simulation::ForEachExecutionPolicy execution = d_parallelCycle.getValue() ?
+        simulation::ForEachExecutionPolicy::PARALLEL :
+        simulation::ForEachExecutionPolicy::SEQUENTIAL;
+
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+    assert(taskScheduler);
+
+    data->hierarchy.vcycle(r.ptr(), z.ptr(), execution, *taskScheduler);
+}
+
+template<class TMatrix, class TVector, class TThreadManager>
+void AMGPreconditioner<TMatrix,TVector,TThreadManager>::invert(Matrix& M)
+{
+    SCOPED_TIMER_VARNAME(invertTimer, "AMGSetup");
+
+    AMGPreconditionerInvertData * data = (AMGPreconditionerInvertData *) this->getMatrixInvertData(&M);
+
+    M.compress();
+
+    // scalar copy of the (block) compressed row matrix
+    static constexpr sofa::Index NL = Matrix::NL;
+    static constexpr sofa::Index NC = Matrix::NC;
+
+    const auto& rowIndex = M.getRowIndex();
+    const auto& rowBegin = M.getRowBegin();
+    const auto& colsIndex = M.getColsIndex();
+    const auto& colsValue = M.getColsValue();
+
+    AMGMatrix& A = data->matrix;
+    A.nbRows = static_cast<sofa::Index>(M.rowSize());
+    A.nbCols = static_cast<sofa::Index>(M.colSize());
+    A.rowBegin.assign(A.nbRows + 1, 0);
+    for (std::size_t xi = 0; xi < rowIndex.size(); ++xi)
+    {
+        const sofa::Index nbBlocks = rowBegin[xi + 1] - rowBegin[xi];
+        for (sofa::Index i = 0; i < NL; ++i)
+        {
+            A.rowBegin[rowIndex[xi] * NL + i + 1] = nbBlocks * NC;
+        }
+    }
+    for (sofa::Index i = 0; i < A.nbRows; ++i)
+    {
+        A.rowBegin[i + 1] += A.rowBegin[i];
+    }
+
+    A.colsIndex.resize(A.rowBegin.back());
+    A.values.resize(A.rowBegin.back());
+    for (std::size_t xi = 0; xi < rowIndex.size(); ++xi)
+    {
+        for (sofa::Index i = 0; i < NL; ++i)
+        {
+            sofa::Index position = A.rowBegin[rowIndex[xi] * NL + i];
+            for (auto bi = rowBegin[xi]; bi < rowBegin[xi + 1]; ++bi)
+            {
+                for (sofa::Index j = 0; j < NC; ++j)
+                {
+                    A.colsIndex[position] = colsIndex[bi] * NC + j;
+                    A.values[position] = Matrix::traits::v(colsValue[bi], i, j);
+                    ++position;
+                }
+            }
+        }
+    }
+
+    AMGHierarchy::Parameters parameters;
+    parameters.strengthThreshold = d_strengthThreshold.getValue();
+    parameters.blockSize = d_blockSize.getValue();
+    parameters.coarsestSize = d_coarsestSize.getValue();
+    parameters.maxLevels = std::max(1u, d_maxLevels.getValue());
+    parameters.nbSmoothingSteps = std::max(1u, d_nbSmoothingSteps.getValue());
+
+    if (data->hierarchy.build(A, parameters))
+    {
+        msg_info() << "Hierarchy built with " << data->hierarchy.nbLevels() << " levels";
+    }
+    d_nbLevels.setValue(static_cast<unsigned int>(data->hierarchy.nbLevels()));
+}
+
+} // namespace sofa::component::linearsolver::preconditioner
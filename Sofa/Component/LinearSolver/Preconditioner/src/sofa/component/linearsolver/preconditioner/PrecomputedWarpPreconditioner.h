@@ -152,6 +152,11 @@ public:
 
     bool hasUpdatedMatrix() override {return false;}
 
+    bool addJMInvJtColumns(linearalgebra::BaseMatrix*, linearalgebra::BaseMatrix*, const sofa::type::vector<linearalgebra::BaseMatrix::Index>&, SReal) override { return false; }
+
+    /// The rotations change the products with the inverse of the system matrix without inverting it again
+    std::size_t getSystemInversionCount() const override { return 0; }
+
     TBaseMatrix * getSystemMatrixInv()
     {
         return internalData.MinvPtr;
@@ -80,6 +80,11 @@ public:
 
     bool addMInvJt(linearalgebra::BaseMatrix* result, linearalgebra::BaseMatrix* J, SReal fact) override;
 
+    bool addJMInvJtColumns(linearalgebra::BaseMatrix*, linearalgebra::BaseMatrix*, const sofa::type::vector<linearalgebra::BaseMatrix::Index>&, SReal) override { return false; }
+
+    /// The rotations change the products with the inverse of the system matrix without inverting it again
+    std::size_t getSystemInversionCount() const override { return 0; }
+
     Index getSystemDimention(const sofa::core::MechanicalParams* mparams);
 
     void computeResidual(const core::ExecParams* params, linearalgebra::BaseVector* /*f*/) override;
@@ -26,6 +26,7 @@
 namespace sofa::component::linearsolver::preconditioner
 {
 
+extern void registerAMGPreconditioner(sofa::core::ObjectFactory* factory);
 extern void registerBlockJacobiPreconditioner(sofa::core::ObjectFactory* factory);
 extern void registerJacobiPreconditioner(sofa::core::ObjectFactory* factory);
 extern void registerPrecomputedMatrixSystem(sofa::core::ObjectFactory* factory);
@@ -58,6 +59,7 @@ const char* getModuleVersion()
 
 void registerObjects(sofa::core::ObjectFactory* factory)
 {
+    registerAMGPreconditioner(factory);
     registerBlockJacobiPreconditioner(factory);
     registerJacobiPreconditioner(factory);
     registerPrecomputedMatrixSystem(factory);
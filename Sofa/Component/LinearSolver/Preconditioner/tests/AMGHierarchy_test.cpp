@@ -0,0 +1,298 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/component/linearsolver/preconditioner/AMGHierarchy.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/type/Mat.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <map>
+
+namespace
+{
+using sofa::component::linearsolver::preconditioner::AMGMatrix;
+using sofa::component::linearsolver::preconditioner::AMGHierarchy;
+using sofa::simulation::ForEachExecutionPolicy;
+
+/// Stiffness matrix of a linear elastic cube of nx*ny*nz nodes, meshed with 6 tetrahedra per hexahedron.
+/// The nodes of the face z = 0 are fixed: their rows and columns are replaced by the identity.
+/// The mass matrix, lumped and scaled by massFactor, is added to the stiffness.
+AMGMatrix buildElasticityMatrix(int nx, int ny, int nz, SReal massFactor = 0)
+{
+    const auto index = [nx, ny](int x, int y, int z) { return x + nx * (y + ny * z); };
+    const int nbNodes = nx * ny * nz;
+    std::vector<std::map<sofa::Index, SReal> > rows(3 * nbNodes);
+
+    const SReal youngModulus = 1, poissonRatio = 0.3;
+    const SReal lambda = youngModulus * poissonRatio / ((1 + poissonRatio) * (1 - 2 * poissonRatio));
+    const SReal mu = youngModulus / (2 * (1 + poissonRatio));
+
+    const auto addTetrahedron = [&](const std::array<int, 4>& nodes, const std::array<sofa::type::Vec3, 4>& p)
+    {
+        sofa::type::Mat3x3 J;
+        for (int c = 0; c < 3; ++c)
+        {
+            for (int r = 0; r < 3; ++r)
+            {
+                J(r, c) = p[c + 1][r] - p[0][r];
+            }
+        }
+        const SReal volume = std::abs(sofa::type::determinant(J)) / 6;
+        const sofa::type::Mat3x3 invJ = J.inverted();
+
+        std::array<sofa::type::Vec3, 4> gradients;
+        gradients[0] = sofa::type::Vec3();
+        for (int a = 1; a < 4; ++a)
+        {
+            gradients[a] = invJ[a - 1];
+            gradients[0] -= gradients[a];
+        }
+
+        // K_ab = V (lambda g_a g_b^T + mu g_b g_a^T + mu (g_a . g_b) I)
+        for (int a = 0; a < 4; ++a)
+        {
+            for (int b = 0; b < 4; ++b)
+            {
+                const auto& ga = gradients[a];
+                const auto& gb = gradients[b];
+                for (int i = 0; i < 3; ++i)
+                {
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        SReal k = lambda * ga[i] * gb[j] + mu * gb[i] * ga[j];
+                        if (i == j)
+                        {
+                            k += mu * (ga * gb);
+                        }
+                        rows[3 * nodes[a] + i][3 * nodes[b] + j] += volume * k;
+                    }
+                }
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                rows[3 * nodes[a] + i][3 * nodes[a] + i] += massFactor * volume / 4;
+            }
+        }
+    };
+
+    for (int z = 0; z + 1 < nz; ++z)
+    {
+        for (int y = 0; y + 1 < ny; ++y)
+        {
+            for (int x = 0; x + 1 < nx; ++x)
+            {
+                // the 6 tetrahedra of the cube along its diagonal, one per order of the axes
+                std::array<int, 3> axes { 0, 1, 2 };
+                do
+                {
+                    std::array<int, 3> corner { x, y, z };
+                    std::array<int, 4> nodes;
+                    std::array<sofa::type::Vec3, 4> positions;
+                    for (int v = 0; v < 4; ++v)
+                    {
+                        if (v > 0)
+                        {
+                            ++corner[axes[v - 1]];
+                        }
+                        nodes[v] = index(corner[0], corner[1], corner[2]);
+                        positions[v] = sofa::type::Vec3(corner[0], corner[1], corner[2]);
+                    }
+                    addTetrahedron(nodes, positions);
+                } while (std::next_permutation(axes.begin(), axes.end()));
+            }
+        }
+    }
+
+    const auto isFixed = [nx, ny](sofa::Index dof) { return dof / 3 < static_cast<sofa::Index>(nx * ny); };
+
+    AMGMatrix A;
+    A.nbRows = A.nbCols = static_cast<sofa::Index>(rows.size());
+    A.rowBegin.push_back(0);
+    for (sofa::Index i = 0; i < A.nbRows; ++i)
+    {
+        for (const auto& [j, value] : rows[i])
+        {
+            A.colsIndex.push_back(j);
+            if (isFixed(i) || isFixed(j))
+            {
+                A.values.push_back(i == j ? 1 : 0);
+            }
+            else
+            {
+                A.values.push_back(value);
+            }
+        }
+        A.rowBegin.push_back(static_cast<sofa::Index>(A.colsIndex.size()));
+    }
+    return A;
+}
+
+std::vector<SReal> generateVector(sofa::Index size, SReal seed)
+{
+    std::vector<SReal> v(size);
+    for (sofa::Index i = 0; i < size; ++i)
+    {
+        v[i] = std::sin(seed * (i + 1));
+    }
+    return v;
+}
+
+SReal dot(const std::vector<SReal>& a, const std::vector<SReal>& b)
+{
+    SReal d = 0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        d += a[i] * b[i];
+    }
+    return d;
+}
+
+sofa::simulation::TaskScheduler& getTaskScheduler()
+{
+    sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::MainTaskSchedulerFactory::createInRegistry();
+    return *taskScheduler;
+}
+
+AMGHierarchy::Parameters elasticityParameters()
+{
+    AMGHierarchy::Parameters parameters;
+    parameters.blockSize = 3;
+    parameters.coarsestSize = 30;
+    return parameters;
+}
+
+/// Number of iterations of a preconditioned conjugate gradient to reduce the residual by the tolerance
+unsigned int solveWithPCG(const AMGMatrix& A, const std::vector<SReal>& b,
+                          const std::function<void(const SReal*, SReal*)>& preconditioner)
+{
+    auto& taskScheduler = getTaskScheduler();
+    const sofa::Index n = A.nbRows;
+    std::vector<SReal> x(n, 0), r = b, z(n), p(n), q(n);
+
+    preconditioner(r.data(), z.data());
+    p = z;
+    SReal rz = dot(r, z);
+    const SReal tolerance = 1e-8 * std::sqrt(dot(b, b));
+
+    unsigned int iteration = 0;
+    while (std::sqrt(dot(r, r)) > tolerance && iteration < 10 * n)
+    {
+        A.mul(p.data(), q.data(), ForEachExecutionPolicy::SEQUENTIAL, taskScheduler);
+        const SReal alpha = rz / dot(p, q);
+        for (sofa::Index i = 0; i < n; ++i)
+        {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+        }
+        preconditioner(r.data(), z.data());
+        const SReal rzNew = dot(r, z);
+        for (sofa::Index i = 0; i < n; ++i)
+        {
+            p[i] = z[i] + rzNew / rz * p[i];
+        }
+        rz = rzNew;
+        ++iteration;
+    }
+    return iteration;
+}
+
+}
+
+TEST(AMGHierarchy, symmetricVCycle)
+{
+    const AMGMatrix A = buildElasticityMatrix(7, 6, 8);
+    AMGHierarchy hierarchy;
+    hierarchy.build(A, elasticityParameters());
+    ASSERT_GT(hierarchy.nbLevels(), 2u);
+
+    const auto x = generateVector(A.nbRows, 0.37);
+    const auto y = generateVector(A.nbRows, 1.91);
+    std::vector<SReal> Mx(A.nbRows), My(A.nbRows);
+    hierarchy.vcycle(x.data(), Mx.data(), ForEachExecutionPolicy::SEQUENTIAL, getTaskScheduler());
+    hierarchy.vcycle(y.data(), My.data(), ForEachExecutionPolicy::SEQUENTIAL, getTaskScheduler());
+
+    // <Mx, y> = <x, My>, and <Mx, x> > 0: the V-cycle can precondition a conjugate gradient
+    const SReal MxY = dot(Mx, y), xMy = dot(x, My);
+    EXPECT_NEAR(MxY, xMy, 1e-10 * std::max(std::abs(MxY), SReal(1)));
+    EXPECT_GT(dot(Mx, x), 0);
+}
+
+TEST(AMGHierarchy, conjugateGradientIterations)
+{
+    const AMGMatrix A = buildElasticityMatrix(7, 6, 8);
+    const auto b = generateVector(A.nbRows, 0.73);
+
+    AMGHierarchy hierarchy;
+    hierarchy.build(A, elasticityParameters());
+
+    const unsigned int nbIterationsWithoutPreconditioner = solveWithPCG(A, b,
+        [n = A.nbRows](const SReal* r, SReal* z) { std::copy(r, r + n, z); });
+    const unsigned int nbIterationsWithAMG = solveWithPCG(A, b,
+        [&hierarchy](const SReal* r, SReal* z)
+        {
+            hierarchy.vcycle(r, z, ForEachExecutionPolicy::SEQUENTIAL, getTaskScheduler());
+        });
+
+    EXPECT_LT(2 * nbIterationsWithAMG, nbIterationsWithoutPreconditioner)
+        << nbIterationsWithAMG << " iterations with AMG, " << nbIterationsWithoutPreconditioner << " without";
+}
+
+TEST(AMGHierarchy, numericRebuild)
+{
+    const AMGMatrix A = buildElasticityMatrix(7, 6, 8);
+    const AMGMatrix B = buildElasticityMatrix(7, 6, 8, 1e-3);
+    ASSERT_TRUE(A.hasSamePattern(B));
+
+    // a small mass term does not change the aggregates, so that both hierarchies have the same patterns
+    // the hierarchy of A updated with the values of B
+    AMGHierarchy updated;
+    EXPECT_TRUE(updated.build(A, elasticityParameters()));
+    EXPECT_FALSE(updated.build(B, elasticityParameters()));
+
+    // the hierarchy built from B
+    AMGHierarchy rebuilt;
+    EXPECT_TRUE(rebuilt.build(B, elasticityParameters()));
+
+    ASSERT_EQ(updated.nbLevels(), rebuilt.nbLevels());
+    for (std::size_t l = 0; l < updated.nbLevels(); ++l)
+    {
+        const AMGMatrix& Au = updated.getMatrix(l);
+        const AMGMatrix& Ar = rebuilt.getMatrix(l);
+        ASSERT_TRUE(Au.hasSamePattern(Ar)) << "level " << l;
+        for (std::size_t k = 0; k < Au.values.size(); ++k)
+        {
+            EXPECT_NEAR(Au.values[k], Ar.values[k], 1e-12 * std::max(std::abs(Ar.values[k]), SReal(1))) << "level " << l;
+        }
+    }
+
+    const auto b = generateVector(B.nbRows, 0.53);
+    std::vector<SReal> xUpdated(B.nbRows), xRebuilt(B.nbRows);
+    updated.vcycle(b.data(), xUpdated.data(), ForEachExecutionPolicy::SEQUENTIAL, getTaskScheduler());
+    rebuilt.vcycle(b.data(), xRebuilt.data(), ForEachExecutionPolicy::SEQUENTIAL, getTaskScheduler());
+    for (sofa::Index i = 0; i < B.nbRows; ++i)
+    {
+        EXPECT_NEAR(xUpdated[i], xRebuilt[i], 1e-10 * std::max(std::abs(xRebuilt[i]), SReal(1)));
+    }
+}
@@ -35,6 +35,8 @@
 #include <sofa/simulation/ParallelForEach.h>
 #include <sofa/core/objectmodel/RenamedData.h>
 
+#include <array>
+
 // corotational tetrahedron from
 // @InProceedings{NPF05,
 //   author       = "Nesme, Matthieu and Payan, Yohan and Faure, Fran\c{c}ois",
@@ -306,6 +308,8 @@ public:
 
     Data<bool>  d_updateStiffness; ///< update structures (precomputed in init) using stiffness parameters in each iteration (set listening=1)
 
+    Data<bool> d_batched; ///< Process the elements in batches to vectorize the corotational computations across elements (forces with the large method, force derivatives with large, polar and svd methods)
+
     using Inherit1::l_topology;
 
     type::vector<type::Vec<6,Real> > elemDisplacements;
@@ -397,6 +401,17 @@ protected:
 
     void applyStiffnessCorotational( Vector& f, const Vector& x, Index i=0, Index a=0,Index b=1,Index c=2,Index d=3, SReal fact=1.0  );
 
+    ////////////// batched corotational methods
+    /// Elements are processed by batches of BatchSize. Each quantity of an element is stored in one lane
+    /// of a Lanes array, so that the computations are written once for all the elements of a batch.
+    static constexpr Size BatchSize = 8;
+    using Lanes = std::array<Real, BatchSize>;
+    void gatherStiffnessBatched( Lanes K[12], Lanes J[12][6], Index firstElement, Size nbElements ) const;
+    static void computeForceBatched( Lanes F[12], const Lanes D[12], const Lanes K[12], const Lanes J[12][6], Real fact );
+    void accumulateForceLargeBatched( Vector& f, const Vector& p, Index firstElement, Size nbElements );
+    void applyStiffnessCorotationalBatched( Vector& f, const Vector& x, Index firstElement, Size nbElements, Real fact );
+    bool canAccumulateForceBatched() const;
+
     void handleTopologyChange() override { needUpdateTopology = true; }
 
     void computeVonMisesStress();
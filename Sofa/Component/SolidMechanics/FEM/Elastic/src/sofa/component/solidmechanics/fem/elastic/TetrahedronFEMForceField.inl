@@ -65,6 +65,7 @@ TetrahedronFEMForceField<DataTypes>::TetrahedronFEMForceField()
     , d_showVonMisesStressPerElement(initData(&d_showVonMisesStressPerElement, false, "showVonMisesStressPerElement", "draw triangles showing vonMises stress interpolated in elements"))
     , d_showElementGapScale(initData(&d_showElementGapScale, (Real)0.333, "showElementGapScale", "draw gap between elements (when showWireFrame is disabled) [0,1]: 0: no gap, 1: no element"))
     , d_updateStiffness(initData(&d_updateStiffness, false, "updateStiffness", "update structures (precomputed in init) using stiffness parameters in each iteration (set listening=1)"))
+    , d_batched(initData(&d_batched, false, "batched", "Process the elements in batches to vectorize the corotational computations across elements (forces with the large method, force derivatives with large, polar and svd methods)"))
 {
     data.initPtrData(this);
     this->addAlias(&d_assembling, "assembling");
@@ -1269,6 +1270,293 @@ inline void TetrahedronFEMForceField<DataTypes>::applyStiffnessCorotational( Vec
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////  batched corotational methods  ///////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////
+
+template<class DataTypes>
+bool TetrahedronFEMForceField<DataTypes>::canAccumulateForceBatched() const
+{
+    return d_batched.getValue() && method == LARGE && !d_assembling.getValue() && d_plasticMaxThreshold.getValue() <= 0;
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::gatherStiffnessBatched( Lanes K[12], Lanes J[12][6], Index firstElement, Size nbElements ) const
+{
+    // the lanes beyond nbElements duplicate the last element, so that all lanes hold valid values
+    for (Size l = 0; l < BatchSize; ++l)
+    {
+        const Index e = firstElement + std::min<Size>(l, nbElements - 1);
+        const MaterialStiffness& Ke = materialsStiffnesses[e];
+        const StrainDisplacement& Je = strainDisplacements[e];
+
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                K[i * 3 + j][l] = Ke[i][j];
+        K[9][l] = Ke[3][3];
+        K[10][l] = Ke[4][4];
+        K[11][l] = Ke[5][5];
+
+        // only the non-zero pattern used by computeForce is gathered
+        for (int n = 0; n < 12; n += 3)
+        {
+            J[n  ][0][l] = Je[n  ][0]; J[n  ][3][l] = Je[n  ][3]; J[n  ][5][l] = Je[n  ][5];
+            J[n+1][1][l] = Je[n+1][1]; J[n+1][3][l] = Je[n+1][3]; J[n+1][4][l] = Je[n+1][4];
+            J[n+2][2][l] = Je[n+2][2]; J[n+2][4][l] = Je[n+2][4]; J[n+2][5][l] = Je[n+2][5];
+        }
+    }
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::computeForceBatched( Lanes F[12], const Lanes D[12], const Lanes K[12], const Lanes J[12][6], Real fact )
+{
+    // Same computation as computeForce, F = J*(K*(Jt*D))*fact, with the same zero pattern.
+    // The innermost loops run over the lanes so that they are vectorized.
+    Lanes JtD[6] = {};
+    for (int n = 0; n < 12; n += 3)
+    {
+        for (Size l = 0; l < BatchSize; ++l)
+        {
+            JtD[0][l] += J[n  ][0][l] * D[n  ][l];
+            JtD[1][l] += J[n+1][1][l] * D[n+1][l];
+            JtD[2][l] += J[n+2][2][l] * D[n+2][l];
+            JtD[3][l] += J[n  ][3][l] * D[n  ][l] + J[n+1][3][l] * D[n+1][l];
+            JtD[4][l] += J[n+1][4][l] * D[n+1][l] + J[n+2][4][l] * D[n+2][l];
+            JtD[5][l] += J[n  ][5][l] * D[n  ][l] + J[n+2][5][l] * D[n+2][l];
+        }
+    }
+
+    Lanes KJtD[6];
+    for (Size l = 0; l < BatchSize; ++l)
+    {
+        KJtD[0][l] = (K[0][l] * JtD[0][l] + K[1][l] * JtD[1][l] + K[2][l] * JtD[2][l]) * fact;
+        KJtD[1][l] = (K[3][l] * JtD[0][l] + K[4][l] * JtD[1][l] + K[5][l] * JtD[2][l]) * fact;
+        KJtD[2][l] = (K[6][l] * JtD[0][l] + K[7][l] * JtD[1][l] + K[8][l] * JtD[2][l]) * fact;
+        KJtD[3][l] = K[ 9][l] * JtD[3][l] * fact;
+        KJtD[4][l] = K[10][l] * JtD[4][l] * fact;
+        KJtD[5][l] = K[11][l] * JtD[5][l] * fact;
+    }
+
+    for (int n = 0; n < 12; n += 3)
+    {
+        for (Size l = 0; l < BatchSize; ++l)
+        {
+            F[n  ][l] = J[n  ][0][l] * KJtD[0][l] + J[n  ][3][l] * KJtD[3][l] + J[n  ][5][l] * KJtD[5][l];
+            F[n+1][l] = J[n+1][1][l] * KJtD[1][l] + J[n+1][3][l] * KJtD[3][l] + J[n+1][4][l] * KJtD[4][l];
+            F[n+2][l] = J[n+2][2][l] * KJtD[2][l] + J[n+2][4][l] * KJtD[4][l] + J[n+2][5][l] * KJtD[5][l];
+        }
+    }
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::accumulateForceLargeBatched( Vector& f, const Vector& p, Index firstElement, Size nbElements )
+{
+    const VecElement& elements = *_indexedElements;
+
+    // gather
+    Lanes P[4][3];
+    Lanes initial[4][3];
+    for (Size l = 0; l < BatchSize; ++l)
+    {
+        const Index e = firstElement + std::min<Size>(l, nbElements - 1);
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                P[i][k][l] = p[elements[e][i]][k];
+                initial[i][k][l] = _rotatedInitialElements[e][i][k];
+            }
+        }
+    }
+    Lanes K[12];
+    Lanes J[12][6];
+    gatherStiffnessBatched(K, J, firstElement, nbElements);
+
+    // rotation (see computeRotationLarge): the square roots are computed in separate loops,
+    // as their error handling prevents the vectorization of the surrounding computations
+    constexpr Real epsilon = std::numeric_limits<Real>::epsilon();
+    Lanes R[3][3];
+    Lanes edgey[3];
+    Lanes norm;
+    for (Size l = 0; l < BatchSize; ++l)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            R[0][k][l] = P[1][k][l] - P[0][k][l];
+            edgey[k][l] = P[2][k][l] - P[0][k][l];
+        }
+        norm[l] = R[0][0][l] * R[0][0][l] + R[0][1][l] * R[0][1][l] + R[0][2][l] * R[0][2][l];
+    }
+    for (Size l = 0; l < BatchSize; ++l)
+        norm[l] = std::sqrt(norm[l]);
+    for (Size l = 0; l < BatchSize; ++l)
+    {
+        const Real n = norm[l] > epsilon ? norm[l] : 1;
+        R[0][0][l] /= n;
+        R[0][1][l] /= n;
+        R[0][2][l] /= n;
+        R[2][0][l] = R[0][1][l] * edgey[2][l] - R[0][2][l] * edgey[1][l];
+        R[2][1][l] = R[0][2][l] * edgey[0][l] - R[0][0][l] * edgey[2][l];
+        R[2][2][l] = R[0][0][l] * edgey[1][l] - R[0][1][l] * edgey[0][l];
+        norm[l] = R[2][0][l] * R[2][0][l] + R[2][1][l] * R[2][1][l] + R[2][2][l] * R[2][2][l];
+    }
+    for (Size l = 0; l < BatchSize; ++l)
+        norm[l] = std::sqrt(norm[l]);
+    for (Size l = 0; l < BatchSize; ++l)
+    {
+        const Real n = norm[l] > epsilon ? norm[l] : 1;
+        R[2][0][l] /= n;
+        R[2][1][l] /= n;
+        R[2][2][l] /= n;
+        R[1][0][l] = R[2][1][l] * R[0][2][l] - R[2][2][l] * R[0][1][l];
+        R[1][1][l] = R[2][2][l] * R[0][0][l] - R[2][0][l] * R[0][2][l];
+        R[1][2][l] = R[2][0][l] * R[0][1][l] - R[2][1][l] * R[0][0][l];
+    }
+
+    // positions of the deformed and displaced tetrahedra in their frame, and displacements (see accumulateForceLarge)
+    Lanes deforme[4][3];
+    for (int i = 0; i < 4; ++i)
+        for (int k = 0; k < 3; ++k)
+            for (Size l = 0; l < BatchSize; ++l)
+                deforme[i][k][l] = R[k][0][l] * P[i][0][l] + R[k][1][l] * P[i][1][l] + R[k][2][l] * P[i][2][l];
+
+    Lanes D[12];
+    for (Size l = 0; l < BatchSize; ++l)
+    {
+        deforme[1][0][l] -= deforme[0][0][l];
+        deforme[2][0][l] -= deforme[0][0][l];
+        deforme[2][1][l] -= deforme[0][1][l];
+        deforme[3][0][l] -= deforme[0][0][l];
+        deforme[3][1][l] -= deforme[0][1][l];
+        deforme[3][2][l] -= deforme[0][2][l];
+
+        D[0][l] = 0;
+        D[1][l] = 0;
+        D[2][l] = 0;
+        D[3][l] = initial[1][0][l] - deforme[1][0][l];
+        D[4][l] = 0;
+        D[5][l] = 0;
+        D[6][l] = initial[2][0][l] - deforme[2][0][l];
+        D[7][l] = initial[2][1][l] - deforme[2][1][l];
+        D[8][l] = 0;
+        D[9][l] = initial[3][0][l] - deforme[3][0][l];
+        D[10][l] = initial[3][1][l] - deforme[3][1][l];
+        D[11][l] = initial[3][2][l] - deforme[3][2][l];
+    }
+
+    if (d_updateStiffnessMatrix.getValue())
+    {
+        for (Size l = 0; l < BatchSize; ++l)
+        {
+            const Real d10 = deforme[1][0][l];
+            const Real d20 = deforme[2][0][l], d21 = deforme[2][1][l];
+            const Real d30 = deforme[3][0][l], d31 = deforme[3][1][l], d32 = deforme[3][2][l];
+            J[0][0][l]  = - d21 * d32;
+            J[1][1][l]  = d20 * d32 - d10 * d32;
+            J[2][2][l]  = d21 * d30 - d20 * d31 + d10 * d31 - d10 * d21;
+            J[3][0][l]  = d21 * d32;
+            J[4][1][l]  = - d20 * d32;
+            J[5][2][l]  = - d21 * d30 + d20 * d31;
+            J[7][1][l]  = d10 * d32;
+            J[8][2][l]  = - d10 * d31;
+            J[11][2][l] = d10 * d21;
+        }
+        for (Size l = 0; l < nbElements; ++l)
+        {
+            StrainDisplacement& Je = strainDisplacements[firstElement + l];
+            Je[0][0] = J[0][0][l];
+            Je[1][1] = J[1][1][l];
+            Je[2][2] = J[2][2][l];
+            Je[3][0] = J[3][0][l];
+            Je[4][1] = J[4][1][l];
+            Je[5][2] = J[5][2][l];
+            Je[7][1] = J[7][1][l];
+            Je[8][2] = J[8][2][l];
+            Je[11][2] = J[11][2][l];
+        }
+    }
+
+    Lanes F[12];
+    computeForceBatched(F, D, K, J, 1);
+
+    // back to world frame
+    Lanes Fw[12];
+    for (int i = 0; i < 12; i += 3)
+        for (int k = 0; k < 3; ++k)
+            for (Size l = 0; l < BatchSize; ++l)
+                Fw[i+k][l] = R[0][k][l] * F[i][l] + R[1][k][l] * F[i+1][l] + R[2][k][l] * F[i+2][l];
+
+    // scatter
+    for (Size l = 0; l < nbElements; ++l)
+    {
+        const Index e = firstElement + l;
+        Transformation& rotation = rotations[e];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                rotation[i][j] = R[j][i][l];
+
+        for (int i = 0; i < 4; ++i)
+        {
+            Deriv& fi = f[elements[e][i]];
+            for (int k = 0; k < 3; ++k)
+                fi[k] += Fw[3*i+k][l];
+        }
+    }
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::applyStiffnessCorotationalBatched( Vector& f, const Vector& x, Index firstElement, Size nbElements, Real fact )
+{
+    const VecElement& elements = *_indexedElements;
+
+    // gather
+    Lanes X[12];
+    Lanes Rot[3][3];
+    for (Size l = 0; l < BatchSize; ++l)
+    {
+        const Index e = firstElement + std::min<Size>(l, nbElements - 1);
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                Rot[i][j][l] = rotations[e][i][j];
+        for (int i = 0; i < 4; ++i)
+            for (int k = 0; k < 3; ++k)
+                X[3*i+k][l] = x[elements[e][i]][k];
+    }
+    Lanes K[12];
+    Lanes J[12][6];
+    gatherStiffnessBatched(K, J, firstElement, nbElements);
+
+    // rotate by rotations[i] transposed
+    Lanes D[12];
+    for (int i = 0; i < 12; i += 3)
+        for (int k = 0; k < 3; ++k)
+            for (Size l = 0; l < BatchSize; ++l)
+                D[i+k][l] = Rot[0][k][l] * X[i][l] + Rot[1][k][l] * X[i+1][l] + Rot[2][k][l] * X[i+2][l];
+
+    Lanes F[12];
+    computeForceBatched(F, D, K, J, fact);
+
+    // rotate by rotations[i]
+    Lanes Fw[12];
+    for (int i = 0; i < 12; i += 3)
+        for (int k = 0; k < 3; ++k)
+            for (Size l = 0; l < BatchSize; ++l)
+                Fw[i+k][l] = Rot[k][0][l] * F[i][l] + Rot[k][1][l] * F[i+1][l] + Rot[k][2][l] * F[i+2][l];
+
+    // scatter
+    for (Size l = 0; l < nbElements; ++l)
+    {
+        const Index e = firstElement + l;
+        for (int i = 0; i < 4; ++i)
+        {
+            Deriv& fi = f[elements[e][i]];
+            for (int k = 0; k < 3; ++k)
+                fi[k] -= Fw[3*i+k][l];
+        }
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////
 ////////////////  generic main computations methods  /////////////////
 //////////////////////////////////////////////////////////////////////
@@ -1607,6 +1895,15 @@ inline void TetrahedronFEMForceField<DataTypes>::addForce (const core::Mechanica
     }
     case LARGE :
     {
+        if (canAccumulateForceBatched())
+        {
+            const Size nbElements = _indexedElements->size();
+            for (Index first = 0; first < nbElements; first += BatchSize)
+            {
+                accumulateForceLargeBatched( f, p, first, std::min<Size>(BatchSize, nbElements - first) );
+            }
+            break;
+        }
         for(it=_indexedElements->begin(), i = 0 ; it!=_indexedElements->end(); ++it,++i)
         {
 
@@ -1658,6 +1955,14 @@ inline void TetrahedronFEMForceField<DataTypes>::addDForce(const core::Mechanica
             applyStiffnessSmall(df, dx, i, a, b, c, d, kFactor);
         }
     }
+    else if (d_batched.getValue())
+    {
+        const Size nbElements = _indexedElements->size();
+        for (Index first = 0; first < nbElements; first += BatchSize)
+        {
+            applyStiffnessCorotationalBatched(df, dx, first, std::min<Size>(BatchSize, nbElements - first), kFactor);
+        }
+    }
     else
     {
         for(it = _indexedElements->begin(), i = 0 ; it != _indexedElements->end() ; ++it, ++i)
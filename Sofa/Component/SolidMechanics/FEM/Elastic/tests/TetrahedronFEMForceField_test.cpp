@@ -20,6 +20,7 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <sofa/component/solidmechanics/fem/elastic/TetrahedronFEMForceField.h>
+#include <sofa/core/MechanicalParams.h>
 #include <sofa/simulation/common/SceneLoaderXML.h>
 
 #include "BaseTetrahedronFEMForceField_test.h"
@@ -38,6 +39,9 @@ INSTANTIATE_TYPED_TEST_SUITE_P(
 class TetrahedronFEMForceField_test : public BaseTetrahedronFEMForceField_test<TetrahedronFEMForceField3>
 {
 public:
+    using VecDeriv = TetrahedronFEMForceField3::VecDeriv;
+    using Deriv = TetrahedronFEMForceField3::Deriv;
+
     void computeMatricesCheckInit(Transformation& initRot, Transformation& curRot, MaterialStiffness& stiffnessMat, StrainDisplacement& strainD, TetraCoord& initPosition, sofa::Size elementId) override
     {
         typename TetrahedronFEMForceField3::SPtr tetraFEM = m_root->getTreeObject<TetrahedronFEMForceField3>();
@@ -79,6 +83,131 @@ public:
 
         EXPECT_EQ(fem->getComponentState(), core::objectmodel::ComponentState::Invalid) ;
     }
+
+    TetrahedronFEMForceField3::SPtr createBatchedGridScene(type::Vec3 nbrGrid, const std::string& method, bool batched)
+    {
+        m_root = sofa::simpleapi::createRootNode(m_simulation, "root");
+
+        sofa::simpleapi::importPlugin("Sofa.Component.StateContainer");
+        sofa::simpleapi::importPlugin("Sofa.Component.Topology.Container.Dynamic");
+        sofa::simpleapi::importPlugin("Sofa.Component.Topology.Container.Grid");
+        sofa::simpleapi::importPlugin("Sofa.Component.Topology.Mapping");
+        sofa::simpleapi::importPlugin("Sofa.Component.SolidMechanics.FEM.Elastic");
+
+        simpleapi::createObject(m_root, "RegularGridTopology", { {"name", "grid"},
+                    {"n", sofa::simpleapi::str(nbrGrid)}, {"min", "0 0 0"}, {"max", "1 2 3"} });
+
+        simulation::Node::SPtr FEMNode = sofa::simpleapi::createChild(m_root, "FEM");
+        simpleapi::createObject(FEMNode, "MechanicalObject", {
+            {"name","dof"}, {"template",dataTypeName}, {"position", "@../grid.position"} });
+        simpleapi::createObject(FEMNode, "TetrahedronSetTopologyContainer", { {"name","topo"} });
+        simpleapi::createObject(FEMNode, "TetrahedronSetTopologyModifier", { {"name","Modifier"} });
+        simpleapi::createObject(FEMNode, "Hexa2TetraTopologicalMapping", {
+            {"input","@../grid"}, {"output","@topo"} });
+        simpleapi::createObject(FEMNode, className, {
+            {"name","FEM"}, {"youngModulus", "1000"}, {"poissonRatio", "0.3"},
+            {"method", method}, {"batched", sofa::simpleapi::str(batched)} });
+
+        sofa::simulation::node::initRoot(m_root.get());
+
+        return m_root->getTreeObject<TetrahedronFEMForceField3>();
+    }
+
+    /// Compute the force and the force derivative of a deformed grid, using the batched kernels or not
+    void computeGridForces(const std::string& method, bool batched, VecDeriv& force, VecDeriv& dforce)
+    {
+        const TetrahedronFEMForceField3::SPtr tetraFEM = createBatchedGridScene(type::Vec3(3, 4, 5), method, batched);
+        ASSERT_TRUE(tetraFEM.get() != nullptr);
+        // 6 tetrahedra per hexahedron: the last batch is not full
+        ASSERT_NE(tetraFEM->l_topology->getNbTetrahedra() % 8, 0);
+
+        const typename MState::SPtr dofs = m_root->getTreeObject<MState>();
+        ASSERT_TRUE(dofs.get() != nullptr);
+
+        VecCoord x = dofs->read(core::ConstVecCoordId::position())->getValue();
+        VecDeriv dx(x.size());
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            x[i] += Coord(0.1 * std::sin(i), 0.05 * std::cos(2. * i), 0.07 * std::sin(3. * i));
+            dx[i] = Deriv(0.01 * std::cos(i), 0.02 * std::sin(5. * i), -0.01 * std::cos(7. * i));
+        }
+
+        core::MechanicalParams mparams;
+        mparams.setKFactor(1.0);
+
+        core::objectmodel::Data<VecCoord> dataX;
+        core::objectmodel::Data<VecDeriv> dataV, dataF, dataDx, dataDf;
+        dataX.setValue(x);
+        dataV.setValue(VecDeriv(x.size()));
+        dataF.setValue(VecDeriv(x.size()));
+        dataDx.setValue(dx);
+        dataDf.setValue(VecDeriv(x.size()));
+
+        tetraFEM->addForce(&mparams, dataF, dataX, dataV);
+        tetraFEM->addDForce(&mparams, dataDf, dataDx);
+
+        force = dataF.getValue();
+        dforce = dataDf.getValue();
+    }
+
+    void checkBatchedForces(const std::string& method)
+    {
+        VecDeriv force, dforce, batchedForce, batchedDForce;
+        computeGridForces(method, false, force, dforce);
+        computeGridForces(method, true, batchedForce, batchedDForce);
+
+        ASSERT_EQ(force.size(), batchedForce.size());
+        ASSERT_EQ(dforce.size(), batchedDForce.size());
+        for (std::size_t i = 0; i < force.size(); ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                EXPECT_NEAR(force[i][k], batchedForce[i][k], 1e-8);
+                EXPECT_NEAR(dforce[i][k], batchedDForce[i][k], 1e-8);
+            }
+        }
+    }
+
+    /// Time the force and force derivative computations with and without the batched kernels, on a grid of
+    /// nbrGrid vertices (6 tetrahedra per hexahedron)
+    void testBatchedPerformance(type::Vec3 nbrGrid, int nbrStep)
+    {
+        for (bool batched : {false, true})
+        {
+            const TetrahedronFEMForceField3::SPtr tetraFEM = createBatchedGridScene(nbrGrid, "large", batched);
+            ASSERT_TRUE(tetraFEM.get() != nullptr);
+
+            const typename MState::SPtr dofs = m_root->getTreeObject<MState>();
+            const VecCoord& x = dofs->read(core::ConstVecCoordId::position())->getValue();
+
+            core::MechanicalParams mparams;
+            mparams.setKFactor(1.0);
+
+            core::objectmodel::Data<VecCoord> dataX;
+            core::objectmodel::Data<VecDeriv> dataV, dataF, dataDx, dataDf;
+            dataX.setValue(x);
+            dataV.setValue(VecDeriv(x.size()));
+            dataF.setValue(VecDeriv(x.size()));
+            dataDx.setValue(VecDeriv(x.size(), Deriv(0.01, 0.02, 0.03)));
+            dataDf.setValue(VecDeriv(x.size()));
+
+            const helper::system::thread::ctime_t startTime = sofa::helper::system::thread::CTime::getRefTime();
+            for (int i = 0; i < nbrStep; i++)
+            {
+                tetraFEM->addForce(&mparams, dataF, dataX, dataV);
+                tetraFEM->addDForce(&mparams, dataDf, dataDx);
+            }
+            const double diffTimed = sofa::helper::system::thread::CTime::toSecond(
+                sofa::helper::system::thread::CTime::getRefTime() - startTime);
+
+            std::cout << tetraFEM->l_topology->getNbTetrahedra() << " tetrahedra, "
+                      << (batched ? "batched" : "per element") << ": "
+                      << nbrStep * tetraFEM->l_topology->getNbTetrahedra() / diffTimed << " tetrahedra/s" << std::endl;
+
+            sofa::simulation::node::unload(m_root);
+            m_root.reset();
+        }
+    }
 };
 
 TEST_F(TetrahedronFEMForceField_test, init)
@@ -101,4 +230,22 @@ TEST_F(TetrahedronFEMForceField_test, checkGracefullHandlingWhenTopologyIsMissin
     this->checkGracefullHandlingWhenTopologyIsMissing();
 }
 
+TEST_F(TetrahedronFEMForceField_test, batchedLarge)
+{
+    this->checkBatchedForces("large");
+}
+
+TEST_F(TetrahedronFEMForceField_test, batchedPolar)
+{
+    this->checkBatchedForces("polar");
+}
+
+TEST_F(TetrahedronFEMForceField_test, DISABLED_testBatchedPerformance)
+{
+    // from 10k to 1M tetrahedra, with the same total number of element computations
+    this->testBatchedPerformance(type::Vec3(12, 12, 14), 100);  //   9438 tetrahedra
+    this->testBatchedPerformance(type::Vec3(26, 26, 27), 10);   //  97500 tetrahedra
+    this->testBatchedPerformance(type::Vec3(56, 56, 56), 1);    // 998250 tetrahedra
+}
+
 } // namespace sofa
@@ -60,6 +60,7 @@ public:
 
     typedef sofa::core::behavior::MechanicalState<DataTypes>      Inherited;
     typedef typename Inherited::VMultiOp    VMultiOp;
+    typedef typename Inherited::VMultiOpEntry VMultiOpEntry;
     typedef typename DataTypes::Real        Real;
     typedef typename DataTypes::Coord       Coord;
     typedef typename DataTypes::Deriv       Deriv;
@@ -303,6 +304,8 @@ public:
 
     void vMultiOp(const core::ExecParams* params, const VMultiOp& ops) override;
 
+    SReal vMultiOpDot(const core::ExecParams* params, const VMultiOp& ops, core::ConstVecId a, core::ConstVecId b) override;
+
     void vThreshold(core::VecId a, SReal threshold ) override;
 
     SReal vDot(const core::ExecParams* params, core::ConstVecId a, core::ConstVecId b) override;
@@ -435,6 +438,15 @@ protected :
     helper::ReadAccessor<core::objectmodel::Data<core::StateVecType_t<DataTypes, vtype> > >
         getReadAccessor(core::ConstVecId v);
 
+    /// Implementation of vOp as a flat loop over the scalars of the vectors, for DataTypes
+    /// stored as contiguous arrays of scalars (Vec types).
+    /// Handles v = a + b*f and v *= f, and returns false for any other case.
+    template<core::VecType vtype>
+    bool vOpFlat(core::VecId v, core::ConstVecId a, core::ConstVecId b, SReal f);
+
+    /// Return true if the operation is v = v + a*f, with v and a two distinct V_DERIV vectors
+    bool isDerivAccumulation(const VMultiOpEntry& op) const;
+
     /**
     * @brief Internal function : Draw indices in 3d coordinates.
     */
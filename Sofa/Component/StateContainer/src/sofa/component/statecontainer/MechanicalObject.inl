@@ -126,6 +126,87 @@ bool applyPredicateIfCoordOrDeriv(sofa::core::VecType vtype_a, sofa::core::VecTy
     return false;
 }
 
+/**
+ * State vectors of Vec types are contiguous arrays of scalars. Element-wise operations and
+ * reductions on them can be written as flat loops over these scalars, without copying the
+ * data into another layout. Such loops are much easier to auto-vectorize than loops over
+ * Vec elements.
+ */
+template<class T>
+struct FlatScalarLayout : std::false_type {};
+
+template<sofa::Size N, class Real>
+struct FlatScalarLayout<sofa::type::Vec<N, Real> > : std::true_type
+{
+    static_assert(sizeof(sofa::type::Vec<N, Real>) == N * sizeof(Real), "Vec must be a contiguous array of scalars");
+    static constexpr sofa::Size size = N;
+};
+
+/// v = a + b*f on n scalars. v may alias a and/or b.
+template<class Real>
+void flatAxpy(Real* v, const Real* a, const Real* b, std::size_t n, Real f)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        v[i] = a[i] + b[i] * f;
+}
+
+/// v *= f on n scalars
+template<class Real>
+void flatScale(Real* v, std::size_t n, Real f)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        v[i] *= f;
+}
+
+/// Dot product of n scalars. The independent partial sums break the dependency
+/// chain on a single accumulator, so that the loop can be vectorized without
+/// relaxing floating-point semantics.
+template<class Real>
+Real flatDot(const Real* a, const Real* b, std::size_t n)
+{
+    Real s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        s0 += a[i  ] * b[i  ];
+        s1 += a[i+1] * b[i+1];
+        s2 += a[i+2] * b[i+2];
+        s3 += a[i+3] * b[i+3];
+    }
+    for (; i < n; ++i)
+        s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+/// r += q*f on n scalars, returning the new r.r computed with independent partial sums as in flatDot
+template<class Real>
+Real flatAxpyDot(Real* r, const Real* q, std::size_t n, Real f)
+{
+    Real s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        r[i  ] += q[i  ] * f; s0 += r[i  ] * r[i  ];
+        r[i+1] += q[i+1] * f; s1 += r[i+1] * r[i+1];
+        r[i+2] += q[i+2] * f; s2 += r[i+2] * r[i+2];
+        r[i+3] += q[i+3] * f; s3 += r[i+3] * r[i+3];
+    }
+    for (; i < n; ++i)
+    {
+        r[i] += q[i] * f;
+        s0 += r[i] * r[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+/// x += p*fx, r += q*fr on n scalars, returning the new r.r
+template<class Real>
+Real flatConjugateGradientStepDot(Real* x, const Real* p, Real* r, const Real* q, std::size_t n, Real fx, Real fr)
+{
+    flatAxpy(x, x, p, n, fx);
+    return flatAxpyDot(r, q, n, fr);
+}
+
 } // anonymous namespace
 
 
@@ -1784,6 +1865,52 @@ DataTypes>::getReadAccessor(core::ConstVecId v)
         *this->read(core::TVecId<vtype, core::V_READ>(v)));
 }
 
+template <class DataTypes>
+bool MechanicalObject<DataTypes>::isDerivAccumulation(const VMultiOpEntry& op) const
+{
+    return op.second.size() == 2
+        && op.first.getId(this).type == sofa::core::V_DERIV
+        && op.second[0].first.getId(this) == op.first.getId(this)
+        && op.second[0].second == 1.0
+        && op.second[1].first.getId(this).type == sofa::core::V_DERIV
+        && op.second[1].first.getId(this) != op.first.getId(this);
+}
+
+template <class DataTypes>
+template <core::VecType vtype>
+bool MechanicalObject<DataTypes>::vOpFlat(core::VecId v, core::ConstVecId a, core::ConstVecId b, SReal f)
+{
+    if (b.isNull() || b.type != vtype || (!a.isNull() && a.type != vtype))
+        return false;
+
+    const bool aliasA = !a.isNull() && v == a;
+    const bool aliasB = v == b;
+    if (a.isNull() && !aliasB)
+        return false;
+
+    auto vv = getWriteAccessor<vtype>(v);
+    const auto& va = (a.isNull() || aliasA) ? vv.ref() : this->read(core::TVecId<vtype, core::V_READ>(a))->getValue();
+    const auto& vb = aliasB ? vv.ref() : this->read(core::TVecId<vtype, core::V_READ>(b))->getValue();
+
+    const auto n = vv.size();
+    if (n == 0 || va.size() != n || vb.size() != n)
+        return false;
+
+    constexpr auto N = FlatScalarLayout<Coord>::size;
+    Real* pv = vv[0].ptr();
+    if (a.isNull())
+    {
+        // v *= f
+        flatScale(pv, n * N, static_cast<Real>(f));
+    }
+    else
+    {
+        // v = a + b*f
+        flatAxpy(pv, va[0].ptr(), vb[0].ptr(), n * N, static_cast<Real>(f));
+    }
+    return true;
+}
+
 template <class DataTypes>
 void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecId v,
                                       core::ConstVecId a,
@@ -1798,6 +1925,17 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
         return;
     }
 
+    if constexpr (FlatScalarLayout<Coord>::value && std::is_same_v<Coord, Deriv>)
+    {
+        bool isApplied = false;
+        applyPredicateIfCoordOrDeriv(v.type, [this, &v, &a, &b, f, &isApplied](auto vtype_v)
+        {
+            isApplied = this->vOpFlat<vtype_v>(v, a, b, f);
+        });
+        if (isApplied)
+            return;
+    }
+
     if (a.isNull())
     {
         if (b.isNull())
@@ -2047,6 +2185,29 @@ void MechanicalObject<DataTypes>::vMultiOp(const core::ExecParams* params, const
             }
         }
     }
+    // optimize the conjugate gradient step: x += p*alpha, r -= q*alpha
+    else if (ops.size() == 2
+            && isDerivAccumulation(ops[0])
+            && isDerivAccumulation(ops[1])
+            && ops[0].first.getId(this) != ops[1].first.getId(this)
+            && ops[0].first.getId(this) != ops[1].second[1].first.getId(this)
+            && ops[1].first.getId(this) != ops[0].second[1].first.getId(this))
+    {
+        auto vp = getReadAccessor<core::V_DERIV>(ops[0].second[1].first.getId(this));
+        auto vq = getReadAccessor<core::V_DERIV>(ops[1].second[1].first.getId(this));
+        auto vx = getWriteAccessor<core::V_DERIV>(ops[0].first.getId(this));
+        auto vr = getWriteAccessor<core::V_DERIV>(ops[1].first.getId(this));
+
+        const auto n = vx.size();
+        const Real f_x_p = (Real)(ops[0].second[1].second);
+        const Real f_r_q = (Real)(ops[1].second[1].second);
+
+        for (unsigned int i=0; i<n; ++i)
+        {
+            vx[i] += vp[i]*f_x_p;
+            vr[i] += vq[i]*f_r_q;
+        }
+    }
     else if(ops.size()==2 //used in the ExplicitBDF solver only (Electrophysiology)
             && ops[0].second.size()==1
             && ops[0].second[0].second == 1.0
@@ -2078,6 +2239,79 @@ void MechanicalObject<DataTypes>::vMultiOp(const core::ExecParams* params, const
         Inherited::vMultiOp(params, ops);
 }
 
+template <class DataTypes>
+SReal MechanicalObject<DataTypes>::vMultiOpDot(const core::ExecParams* params, const VMultiOp& ops, core::ConstVecId a, core::ConstVecId b)
+{
+    // the squared norm of the last accumulated vector is computed while it is still in cache:
+    // r += q*f ; r.r  or  x += p*alpha, r -= q*alpha ; r.r
+    if (a == b && !ops.empty() && ops.size() <= 2
+            && ops.back().first.getId(this) == a
+            && isDerivAccumulation(ops.back()))
+    {
+        const VMultiOpEntry& opR = ops.back();
+        if (ops.size() == 1)
+        {
+            auto vq = getReadAccessor<core::V_DERIV>(opR.second[1].first.getId(this));
+            auto vr = getWriteAccessor<core::V_DERIV>(opR.first.getId(this));
+
+            const auto n = vr.size();
+            const Real f_r_q = (Real)(opR.second[1].second);
+
+            if constexpr (FlatScalarLayout<Coord>::value && std::is_same_v<Coord, Deriv>)
+            {
+                if (n > 0 && vq.size() == n)
+                {
+                    return flatAxpyDot(vr[0].ptr(), vq[0].ptr(), n * FlatScalarLayout<Coord>::size, f_r_q);
+                }
+            }
+
+            Real d = 0.0;
+            for (unsigned int i=0; i<n; ++i)
+            {
+                vr[i] += vq[i]*f_r_q;
+                d += vr[i]*vr[i];
+            }
+            return d;
+        }
+
+        const VMultiOpEntry& opX = ops.front();
+        if (isDerivAccumulation(opX)
+                && opX.first.getId(this) != opR.first.getId(this)
+                && opX.first.getId(this) != opR.second[1].first.getId(this)
+                && opR.first.getId(this) != opX.second[1].first.getId(this))
+        {
+            auto vp = getReadAccessor<core::V_DERIV>(opX.second[1].first.getId(this));
+            auto vq = getReadAccessor<core::V_DERIV>(opR.second[1].first.getId(this));
+            auto vx = getWriteAccessor<core::V_DERIV>(opX.first.getId(this));
+            auto vr = getWriteAccessor<core::V_DERIV>(opR.first.getId(this));
+
+            const auto n = vr.size();
+            const Real f_x_p = (Real)(opX.second[1].second);
+            const Real f_r_q = (Real)(opR.second[1].second);
+
+            if constexpr (FlatScalarLayout<Coord>::value && std::is_same_v<Coord, Deriv>)
+            {
+                if (n > 0 && vq.size() == n && vx.size() == n && vp.size() == n)
+                {
+                    return flatConjugateGradientStepDot(vx[0].ptr(), vp[0].ptr(), vr[0].ptr(), vq[0].ptr(),
+                                                        n * FlatScalarLayout<Coord>::size, f_x_p, f_r_q);
+                }
+            }
+
+            Real d = 0.0;
+            for (unsigned int i=0; i<n; ++i)
+            {
+                vx[i] += vp[i]*f_x_p;
+                vr[i] += vq[i]*f_r_q;
+                d += vr[i]*vr[i];
+            }
+            return d;
+        }
+    }
+
+    return Inherited::vMultiOpDot(params, ops, a, b);
+}
+
 template <class T> inline void clear( T& t )
 {
     t.clear();
@@ -2125,6 +2359,14 @@ SReal MechanicalObject<DataTypes>::vDot(const core::ExecParams*, core::ConstVecI
         {
             auto va = this->getReadAccessor<vtype>(a);
             auto vb = this->getReadAccessor<vtype>(b);
+            if constexpr (FlatScalarLayout<Coord>::value && std::is_same_v<Coord, Deriv>)
+            {
+                if (!va.empty() && va.size() == vb.size())
+                {
+                    r = flatDot(va[0].ptr(), vb[0].ptr(), va.size() * FlatScalarLayout<Coord>::size);
+                    return;
+                }
+            }
             for (unsigned int i = 0; i < va.size(); ++i)
             {
                 r += va[i] * vb[i];
@@ -24,6 +24,9 @@
 #include <sofa/testing/BaseTest.h>
 using sofa::testing::BaseTest;
 
+#include <chrono>
+#include <iostream>
+
 namespace sofa
 {
 
@@ -43,6 +46,22 @@ struct MechanicalObject_test :  public BaseTest
     typedef typename StubMechanicalObject<T>::DataTypes::Real   Real;
 
     StubMechanicalObject<T> mechanicalObject;
+
+    /// Resize a deriv vector and fill it with distinct values
+    void fill(core::VecDerivId id, std::size_t n, Real offset)
+    {
+        mechanicalObject.resize(n);
+        auto v = helper::getWriteOnlyAccessor(*mechanicalObject.write(id));
+        v.resize(n);
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t j = 0; j < T::Deriv::total_size; ++j)
+                v[i][j] = offset + static_cast<Real>(i) - static_cast<Real>(0.5 * j);
+    }
+
+    const typename T::VecDeriv& read(core::VecDerivId id)
+    {
+        return mechanicalObject.read(core::ConstVecDerivId(id))->getValue();
+    }
 };
 
 
@@ -110,6 +129,232 @@ TYPED_TEST(MechanicalObject_test, checkThatPositionDefaultValueIsAVectorOfValueI
     TestHelpers::CheckPosition(this->mechanicalObject);
 }
 
+TYPED_TEST(MechanicalObject_test, checkThatFusedConjugateGradientStepMatchesSeparateOperations)
+{
+    typedef typename TypeParam::Deriv Deriv;
+    typedef typename TypeParam::Real Real;
+    typedef core::behavior::BaseMechanicalState::VMultiOp VMultiOp;
+    typedef core::behavior::BaseMechanicalState::VMultiOpEntry VMultiOpEntry;
+    using core::VecDerivId;
+
+    constexpr std::size_t n = 11;
+    const Real alpha = static_cast<Real>(0.3);
+
+    const VecDerivId x = VecDerivId::velocity();
+    const VecDerivId r = VecDerivId::force();
+    const VecDerivId p = VecDerivId::dx();
+    const VecDerivId q = VecDerivId::freeVelocity();
+
+    this->fill(x, n, 1);
+    this->fill(r, n, -2);
+    this->fill(p, n, 3);
+    this->fill(q, n, 4);
+
+    type::vector<Deriv> expectedX(n), expectedR(n);
+    Real expectedDot = 0;
+    {
+        const auto& vx = this->read(x);
+        const auto& vr = this->read(r);
+        const auto& vp = this->read(p);
+        const auto& vq = this->read(q);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            expectedX[i] = vx[i] + vp[i] * alpha;
+            expectedR[i] = vr[i] - vq[i] * alpha;
+            expectedDot += expectedR[i] * expectedR[i];
+        }
+    }
+
+    VMultiOp ops;
+    ops.push_back(VMultiOpEntry(core::MultiVecDerivId(x), core::MultiVecDerivId(x), core::MultiVecDerivId(p), alpha));
+    ops.push_back(VMultiOpEntry(core::MultiVecDerivId(r), core::MultiVecDerivId(r), core::MultiVecDerivId(q), -alpha));
+
+    const SReal dot = this->mechanicalObject.vMultiOpDot(core::execparams::defaultInstance(), ops, r, r);
+
+    EXPECT_NEAR(expectedDot, dot, 1e-4 * std::abs(expectedDot));
+    const auto& vx = this->read(x);
+    const auto& vr = this->read(r);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        for (std::size_t j = 0; j < Deriv::total_size; ++j)
+        {
+            EXPECT_NEAR(expectedX[i][j], vx[i][j], 1e-5);
+            EXPECT_NEAR(expectedR[i][j], vr[i][j], 1e-5);
+        }
+    }
+}
+
+TYPED_TEST(MechanicalObject_test, checkThatVectorOperationsHandleAliasedOperands)
+{
+    typedef typename TypeParam::Deriv Deriv;
+    typedef typename TypeParam::Real Real;
+    using core::VecDerivId;
+
+    constexpr std::size_t n = 13;
+    const VecDerivId a = VecDerivId::velocity();
+    const VecDerivId b = VecDerivId::force();
+    const VecDerivId c = VecDerivId::dx();
+
+    this->fill(a, n, 1);
+    this->fill(b, n, -3);
+    this->fill(c, n, 0);
+
+    const type::vector<Deriv> a0 = this->read(a);
+    const type::vector<Deriv> b0 = this->read(b);
+    const auto* params = core::execparams::defaultInstance();
+
+    this->mechanicalObject.vOp(params, c, a, b, 2.0);   // c = a + b*2
+    this->mechanicalObject.vOp(params, a, a, b, -1.0);  // a = a - b
+    this->mechanicalObject.vOp(params, b, c, b, 0.5);   // b = c + b*0.5
+    this->mechanicalObject.vOp(params, c, core::ConstVecId::null(), c, 3.0); // c *= 3
+
+    Real expectedDot = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const Deriv c1 = a0[i] + b0[i] * static_cast<Real>(2);
+        const Deriv a1 = a0[i] - b0[i];
+        const Deriv b1 = c1 + b0[i] * static_cast<Real>(0.5);
+        const Deriv c2 = c1 * static_cast<Real>(3);
+        expectedDot += a1 * b1;
+        for (std::size_t j = 0; j < Deriv::total_size; ++j)
+        {
+            EXPECT_NEAR(a1[j], this->read(a)[i][j], 1e-5);
+            EXPECT_NEAR(b1[j], this->read(b)[i][j], 1e-5);
+            EXPECT_NEAR(c2[j], this->read(c)[i][j], 1e-5);
+        }
+    }
+
+    EXPECT_NEAR(expectedDot, this->mechanicalObject.vDot(params, a, b), 1e-4 * std::abs(expectedDot));
+}
+
+/// Time of the vector operations of a Vec3 state, run on the flat scalar view of the state vectors, compared with the
+/// equivalent loops on Vec elements (the previous implementation)
+TEST(MechanicalObject_benchmark, DISABLED_vectorOperations)
+{
+    using core::VecDerivId;
+    static constexpr int NbRepetitions = 100;
+
+    const VecDerivId v = VecDerivId::velocity();
+    const VecDerivId a = VecDerivId::force();
+    const VecDerivId b = VecDerivId::dx();
+    const auto* params = core::execparams::defaultInstance();
+
+    const auto time = [](const auto& operation)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NbRepetitions; ++i)
+            operation();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / NbRepetitions;
+    };
+
+    for (const std::size_t n : { 10000u, 100000u, 1000000u })
+    {
+        StubMechanicalObject<Vec3Types> mechanicalObject;
+        mechanicalObject.resize(n);
+        type::vector<type::Vec3> refV(n), refA(n), refB(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            refV[i] = refA[i] = type::Vec3(std::sin(i), 0.5, std::cos(i));
+            refB[i] = type::Vec3(std::cos(0.7 * i), 3 * std::sin(i), 1.0 / (i + 1));
+        }
+        for (const auto& [id, values] : { std::make_pair(v, &refV), std::make_pair(a, &refA), std::make_pair(b, &refB) })
+        {
+            auto w = helper::getWriteOnlyAccessor(*mechanicalObject.write(id));
+            w.wref() = *values;
+        }
+
+        SReal flatDot = 0, elementDot = 0;
+        const double flatAxpyTime = time([&] { mechanicalObject.vOp(params, v, a, b, 0.5); });
+        const double flatScaleTime = time([&] { mechanicalObject.vOp(params, v, core::ConstVecId::null(), v, 0.999); });
+        const double flatDotTime = time([&] { flatDot += mechanicalObject.vDot(params, a, b); });
+
+        const double elementAxpyTime = time([&] { for (std::size_t i = 0; i < n; ++i) refV[i] = refA[i] + refB[i] * 0.5; });
+        const double elementScaleTime = time([&] { for (std::size_t i = 0; i < n; ++i) refV[i] *= 0.999; });
+        const double elementDotTime = time([&] { for (std::size_t i = 0; i < n; ++i) elementDot += refA[i] * refB[i]; });
+
+        std::cout << n << " points (ms, flat vs Vec elements): v=a+b*f " << flatAxpyTime << " vs " << elementAxpyTime
+            << ", v*=f " << flatScaleTime << " vs " << elementScaleTime
+            << ", a.b " << flatDotTime << " vs " << elementDotTime
+            << " (relative difference of the dot products " << std::abs(flatDot - elementDot) / std::abs(elementDot) << ")" << std::endl;
+    }
+}
+
+/// Conjugate gradient iterations per second on a Vec3 state, with the fused CG step (x += p*alpha, r -= q*alpha and r.r
+/// in a single loop) and with the separate vector operations it replaces. The matrix is applied without assembly.
+TEST(MechanicalObject_benchmark, DISABLED_conjugateGradientFusion)
+{
+    typedef core::behavior::BaseMechanicalState::VMultiOp VMultiOp;
+    typedef core::behavior::BaseMechanicalState::VMultiOpEntry VMultiOpEntry;
+    using core::VecDerivId;
+    static constexpr int NbIterations = 50;
+
+    const VecDerivId x = VecDerivId::velocity();
+    const VecDerivId r = VecDerivId::force();
+    const VecDerivId p = VecDerivId::dx();
+    const VecDerivId q = VecDerivId::freeVelocity();
+    const auto* params = core::execparams::defaultInstance();
+
+    for (const std::size_t n : { 10000u, 100000u, 1000000u })
+    {
+        for (const bool fused : { false, true })
+        {
+            StubMechanicalObject<Vec3Types> mechanicalObject;
+            mechanicalObject.resize(n);
+            for (const VecDerivId id : { x, r, p, q })
+            {
+                auto v = helper::getWriteOnlyAccessor(*mechanicalObject.write(id));
+                v.resize(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    v[i] = (id == x || id == q) ? type::Vec3() : type::Vec3(1, std::sin(i), 0.5);
+            }
+
+            SReal rho = mechanicalObject.vDot(params, r, r);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int iteration = 0; iteration < NbIterations; ++iteration)
+            {
+                // q = A p, with A the 1D Laplacian slightly shifted to be positive definite
+                {
+                    auto vq = helper::getWriteOnlyAccessor(*mechanicalObject.write(q));
+                    const auto& vp = mechanicalObject.read(core::ConstVecDerivId(p))->getValue();
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        vq[i] = vp[i] * 2.001;
+                        if (i > 0) vq[i] -= vp[i - 1];
+                        if (i + 1 < n) vq[i] -= vp[i + 1];
+                    }
+                }
+
+                const SReal alpha = rho / mechanicalObject.vDot(params, p, q);
+
+                SReal newRho;
+                if (fused)
+                {
+                    VMultiOp ops;
+                    ops.push_back(VMultiOpEntry(core::MultiVecDerivId(x), core::MultiVecDerivId(x), core::MultiVecDerivId(p), alpha));
+                    ops.push_back(VMultiOpEntry(core::MultiVecDerivId(r), core::MultiVecDerivId(r), core::MultiVecDerivId(q), -alpha));
+                    newRho = mechanicalObject.vMultiOpDot(params, ops, r, r);
+                }
+                else
+                {
+                    mechanicalObject.vOp(params, x, x, p, alpha);
+                    mechanicalObject.vOp(params, r, r, q, -alpha);
+                    newRho = mechanicalObject.vDot(params, r, r);
+                }
+
+                // p = r + p*beta
+                mechanicalObject.vOp(params, p, r, p, newRho / rho);
+                rho = newRho;
+            }
+            const auto end = std::chrono::steady_clock::now();
+
+            std::cout << n << " points, " << (fused ? "fused" : "separate") << " CG step: "
+                << NbIterations / std::chrono::duration<double>(end - start).count() << " iterations/s"
+                << " (residual " << std::sqrt(rho) << ")" << std::endl;
+        }
+    }
+}
+
 } // namespace
 
 } // namespace sofa
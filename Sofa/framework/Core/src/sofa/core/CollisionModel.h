@@ -86,6 +86,7 @@ public:
         RDISTANCE_GRIDE_TYPE,
         FFDDISTANCE_GRIDE_TYPE,
         CYLINDER_TYPE,
+        CONVEX_HULL_TYPE,
         ENUM_TYPE_SIZE
     };
 
@@ -78,6 +78,15 @@ void BaseMechanicalState::vMultiOp(const ExecParams* params, const VMultiOp& ops
     }
 }
 
+/// Perform a vMultiOp followed by the scalar product between the vectors a and b.
+///
+/// By default this method calls vMultiOp and then vDot.
+SReal BaseMechanicalState::vMultiOpDot(const ExecParams* params, const VMultiOp& ops, ConstVecId a, ConstVecId b)
+{
+    vMultiOp(params, ops);
+    return vDot(params, a, b);
+}
+
 /// Handle state Changes from a given Topology
 void BaseMechanicalState::handleStateChange(core::topology::Topology* /*t*/)
 {
@@ -157,6 +157,13 @@ public:
     /// By default this method decompose the computation into multiple vOp calls.
     virtual void vMultiOp(const ExecParams* params, const VMultiOp& ops);
 
+    /// \brief Perform a vMultiOp followed by the scalar product between the vectors a and b.
+    ///
+    /// This allows implementations to fuse the update and the reduction in a single pass over the data,
+    /// e.g. the conjugate gradient step $x = x + p*alpha, r = r - q*alpha$ followed by $r.r$.
+    /// By default this method calls vMultiOp and then vDot.
+    virtual SReal vMultiOpDot(const ExecParams* params, const VMultiOp& ops, ConstVecId a, ConstVecId b);
+
     /// Compute the scalar products between two vectors.
     virtual SReal vDot(const ExecParams* params, ConstVecId a, ConstVecId b) = 0;
 
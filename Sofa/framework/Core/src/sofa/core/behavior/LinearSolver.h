@@ -24,6 +24,7 @@
 #include <sofa/core/behavior/BaseLinearSolver.h>
 #include <sofa/linearalgebra/BaseMatrix.h>
 #include <sofa/core/MultiVecId.h>
+#include <sofa/type/vector.h>
 
 namespace sofa::core::behavior
 {
@@ -148,6 +149,31 @@ public:
         return false;
     }
 
+    /// Multiply the inverse of the system matrix by the transpose of the given rows of J, and multiply the result with J
+    ///
+    /// This method computes only the columns of the compliance matrix projected in the constraints space (see addJMInvJt)
+    /// corresponding to the given rows: result(i, r) += fact * J_i A^{-1} J_r^T for each row i of J and each r in rows.
+    ///
+    /// @param result the variable where the result will be added
+    /// @param J the matrix J to use
+    /// @param rows the rows of J for which the columns are computed
+    /// @param fact integrator parameter
+    /// @return false if the solver does not support this operation, or if the system matrix is not invertible
+    virtual bool addJMInvJtColumns(linearalgebra::BaseMatrix* result, linearalgebra::BaseMatrix* J, const sofa::type::vector<linearalgebra::BaseMatrix::Index>& rows, SReal fact)
+    {
+        SOFA_UNUSED(result);
+        SOFA_UNUSED(J);
+        SOFA_UNUSED(rows);
+        SOFA_UNUSED(fact);
+        return false;
+    }
+
+    /// Number of times the system matrix has been inverted (e.g. factorized), or 0 if the solver does not keep track of it
+    ///
+    /// Once invertSystem() has been called, the products with the inverse of the system matrix (see addJMInvJt) give the
+    /// same result as long as this number does not change.
+    virtual std::size_t getSystemInversionCount() const { return 0; }
+
     /// Get the linear system matrix, or nullptr if this solver does not build it
     virtual linearalgebra::BaseMatrix* getSystemBaseMatrix() { return nullptr; }
 
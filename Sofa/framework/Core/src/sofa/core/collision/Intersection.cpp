@@ -27,6 +27,22 @@ namespace sofa::core::collision
 
 using namespace sofa::defaulttype;
 
+int ElementIntersector::intersectRanges(const std::pair<core::CollisionElementIterator, core::CollisionElementIterator>& elems1,
+                                        const std::pair<core::CollisionElementIterator, core::CollisionElementIterator>& elems2,
+                                        bool selfCollision, DetectionOutputVector* contacts, const core::collision::Intersection* currentIntersection)
+{
+    int n = 0;
+    for (auto it1 = elems1.first; it1 != elems1.second; ++it1)
+    {
+        for (auto it2 = elems2.first; it2 != elems2.second; ++it2)
+        {
+            if (!selfCollision || it1.canCollideWith(it2))
+                n += intersect(it1, it2, contacts, currentIntersection);
+        }
+    }
+    return n;
+}
+
 IntersectorMap::~IntersectorMap()
 {
     for(InternalMap::const_iterator it = intersectorsMap.begin(), itEnd = intersectorsMap.end(); it != itEnd; ++it)
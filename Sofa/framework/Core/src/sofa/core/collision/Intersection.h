@@ -76,6 +76,13 @@ public:
 
     /// Compute the intersection between 2 elements. Return the number of contacts written in the contacts vector.
     virtual int intersect(core::CollisionElementIterator elem1, core::CollisionElementIterator elem2, DetectionOutputVector* contacts, const core::collision::Intersection* currentIntersection) = 0;
+
+    /// Compute the intersection between all the pairs of elements of two ranges, in the same order as calling intersect
+    /// on each pair. If selfCollision is true, the pairs of elements which cannot collide with each other are skipped.
+    /// Return the number of contacts written in the contacts vector.
+    virtual int intersectRanges(const std::pair<core::CollisionElementIterator, core::CollisionElementIterator>& elems1,
+                                const std::pair<core::CollisionElementIterator, core::CollisionElementIterator>& elems2,
+                                bool selfCollision, DetectionOutputVector* contacts, const core::collision::Intersection* currentIntersection);
     
     /// End intersection tests between two collision models. Return the number of contacts written in the contacts vector.
     virtual int endIntersect(core::CollisionModel* model1, core::CollisionModel* model2, DetectionOutputVector* contacts) = 0;
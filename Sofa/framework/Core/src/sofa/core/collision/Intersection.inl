@@ -26,9 +26,22 @@
 
 #include <sofa/version.h>
 
+#include <type_traits>
+
 namespace sofa::core::collision
 {
 
+/// Detect if the intersection class T can compute the intersection between all the pairs of elements of two ranges
+/// at once, with a method computeIntersections(std::pair<Elem1, Elem1>, std::pair<Elem2, Elem2>, selfCollision, contacts, currentIntersection)
+template<class T, class Elem1, class Elem2, class = void>
+struct HasRangeIntersection : std::false_type {};
+
+template<class T, class Elem1, class Elem2>
+struct HasRangeIntersection<T, Elem1, Elem2, std::void_t<decltype(std::declval<T&>().computeIntersections(
+    std::declval<const std::pair<Elem1, Elem1>&>(), std::declval<const std::pair<Elem2, Elem2>&>(), false,
+    std::declval<T&>().getOutputVector(std::declval<typename Elem1::Model*>(), std::declval<typename Elem2::Model*>(), std::declval<DetectionOutputVector*>()),
+    std::declval<const Intersection*>()))> > : std::true_type {};
+
 template<class Elem1, class Elem2, class T>
 class MemberElementIntersector : public ElementIntersector
 {
@@ -71,6 +84,30 @@ public:
         return impl->computeIntersection(e1, e2, impl->getOutputVector(e1.getCollisionModel(), e2.getCollisionModel(), contacts), currentIntersection);
     }
 
+    /// Compute the intersection between all the pairs of elements of two ranges, at once if the intersection class
+    /// supports it
+    int intersectRanges(const std::pair<core::CollisionElementIterator, core::CollisionElementIterator>& elems1,
+                        const std::pair<core::CollisionElementIterator, core::CollisionElementIterator>& elems2,
+                        bool selfCollision, DetectionOutputVector* contacts, const core::collision::Intersection* currentIntersection) override
+    {
+        if constexpr (HasRangeIntersection<T, Elem1, Elem2>::value)
+        {
+            // The elements are iterated by index: the ranges built on a vector of indices are processed pair by pair
+            const auto isContiguous = [](const std::pair<core::CollisionElementIterator, core::CollisionElementIterator>& elems)
+            {
+                return elems.first.getVIterator() == elems.first.getVIteratorEnd();
+            };
+            if (isContiguous(elems1) && isContiguous(elems2))
+            {
+                const std::pair<Elem1, Elem1> range1(Elem1(elems1.first), Elem1(elems1.second));
+                const std::pair<Elem2, Elem2> range2(Elem2(elems2.first), Elem2(elems2.second));
+                return impl->computeIntersections(range1, range2, selfCollision,
+                    impl->getOutputVector(range1.first.getCollisionModel(), range2.first.getCollisionModel(), contacts), currentIntersection);
+            }
+        }
+        return ElementIntersector::intersectRanges(elems1, elems2, selfCollision, contacts, currentIntersection);
+    }
+
     std::string name() const override
     {
         return sofa::helper::gettypename(typeid(Elem1))+std::string("-")+sofa::helper::gettypename(typeid(Elem2));
@@ -47,6 +47,14 @@ public:
     static constexpr int matrixType = 1;
 };
 
+/// Mechanical policy storing only the upper triangle of the symmetric matrix: the blocks below the diagonal
+/// are the transposed of the blocks above, and are not stored. The matrix-vector product reads half the blocks.
+class CRSMechanicalSymmetricPolicy : public CRSMechanicalPolicy
+{
+public:
+    static constexpr bool StoreLowerTriangularBlock = false;
+};
+
 template<typename TBlock, typename TPolicy = CRSMechanicalPolicy >
 class CompressedRowSparseMatrixMechanical final // final is used to allow the compiler to inline virtual methods
     : public CompressedRowSparseMatrixGeneric<TBlock, TPolicy>, public sofa::linearalgebra::BaseMatrix
@@ -1028,6 +1036,21 @@ protected:
 
         ((Matrix*)this)->compress();
         vresize(res, this->rowBSize(), this->rowSize());
+
+        if constexpr (std::is_same_v<V1, FullVector<Real2> > && std::is_same_v<V2, FullVector<Real2> >)
+        {
+            addMulBlockRows(0, static_cast<Index>(this->rowIndex.size()), vec.ptr(), res.ptr(), res.ptr());
+            return;
+        }
+
+        if constexpr (!Policy::StoreLowerTriangularBlock)
+        {
+            // the transposed blocks also contribute to the empty block rows
+            for (Index i = 0; i < this->rowBSize(); ++i)
+                for (Index bi = 0; bi < (Index)NL; ++bi)
+                    vset(res, i, NL, bi, 0);
+        }
+
         for (Index xi = 0; xi < (Index)this->rowIndex.size(); ++xi)  // for each non-empty block row
         {
             type::Vec<NL, Real2> r;  // local block-sized vector to accumulate the product of the block row  with the large vector
@@ -1054,6 +1077,29 @@ protected:
             for (Index bi = 0; bi < (Index)NL; ++bi)
                 vset(res, this->rowIndex[xi], NL, bi, r[bi]);
         }
+
+        if constexpr (!Policy::StoreLowerTriangularBlock)
+        {
+            // only the upper triangle is stored: add the products of the transposed blocks, once the rows are set
+            for (Index xi = 0; xi < (Index)this->rowIndex.size(); ++xi)
+            {
+                Range rowRange(this->rowBegin[xi], this->rowBegin[xi + 1]);
+                for (Index xj = rowRange.begin(); xj < rowRange.end(); ++xj)
+                {
+                    if (this->colsIndex[xj] == this->rowIndex[xi])
+                        continue;
+
+                    const Block& b = this->colsValue[xj];
+                    for (Index bj = 0; bj < (Index)NC; ++bj)
+                    {
+                        Real2 t {};
+                        for (Index bi = 0; bi < (Index)NL; ++bi)
+                            t += traits::v(b, bi, bj) * vget(vec, this->rowIndex[xi], NL, bi);
+                        vadd(res, this->colsIndex[xj], NC, bj, t);
+                    }
+                }
+            }
+        }
     }
 
 
@@ -1064,6 +1110,17 @@ protected:
         assert( vec.size()%bColSize() == 0 ); // vec.size() must be a multiple of block size.
 
         if constexpr (Policy::AutoCompress) const_cast<Matrix*>(this)->compress(); /// \warning this violates the const-ness of the method !
+        if constexpr (std::is_same_v<V1, FullVector<Real2> > && std::is_same_v<V2, FullVector<Real2> >)
+        {
+            // resizing a FullVector clears it
+            if (res.size() != rowSize())
+            {
+                res.resize(rowSize());
+            }
+            addMulBlockRows(0, static_cast<Index>(this->rowIndex.size()), vec.ptr(), res.ptr(), res.ptr());
+            return;
+        }
+
         vresize( res, this->rowBSize(), rowSize() );
 
         for (Index xi = 0; xi < static_cast<Index>(this->rowIndex.size()); ++xi)
@@ -1197,6 +1254,63 @@ public:
 
     using CompressedRowSparseMatrixGeneric<TBlock, TPolicy>::mul; // CRS x CRS mul version
 
+    /// y += this * x, restricted to the non-empty block rows [xiBegin, xiEnd), where x and y are contiguous
+    /// scalar arrays. The blocks are streamed once, and the products of a block row are accumulated in local
+    /// variables before being written.
+    /// If only the upper triangle is stored, the products of the transposed blocks are accumulated in yTranspose,
+    /// which is y for a sequential product, or a buffer per thread for a parallel product.
+    template<class Real2>
+    void addMulBlockRows(Index xiBegin, Index xiEnd, const Real2* x, Real2* y, Real2* yTranspose) const
+    {
+        SOFA_UNUSED(yTranspose);
+        const Index* colsIndex = this->colsIndex.data();
+        const Block* colsValue = this->colsValue.data();
+
+        for (Index xi = xiBegin; xi < xiEnd; ++xi)
+        {
+            const Index row = this->rowIndex[xi];
+
+            Real2 r[NL] {};
+            for (Index xj = this->rowBegin[xi], xjEnd = this->rowBegin[xi + 1]; xj < xjEnd; ++xj)
+            {
+                const Index col = colsIndex[xj];
+                const Block& b = colsValue[xj];
+                const Real2* xCol = x + col * NC;
+                for (sofa::Index bi = 0; bi < NL; ++bi)
+                {
+                    for (sofa::Index bj = 0; bj < NC; ++bj)
+                    {
+                        r[bi] += traits::v(b, bi, bj) * xCol[bj];
+                    }
+                }
+
+                if constexpr (!Policy::StoreLowerTriangularBlock)
+                {
+                    if (col != row)
+                    {
+                        const Real2* xRow = x + row * NL;
+                        Real2* yCol = yTranspose + col * NC;
+                        for (sofa::Index bj = 0; bj < NC; ++bj)
+                        {
+                            Real2 t {};
+                            for (sofa::Index bi = 0; bi < NL; ++bi)
+                            {
+                                t += traits::v(b, bi, bj) * xRow[bi];
+                            }
+                            yCol[bj] += t;
+                        }
+                    }
+                }
+            }
+
+            Real2* yRow = y + row * NL;
+            for (sofa::Index bi = 0; bi < NL; ++bi)
+            {
+                yRow[bi] += r[bi];
+            }
+        }
+    }
+
     /// equal result = this * v
     /// @warning The block sizes must be compatible ie v.size() must be a multiple of block size.
     template< typename V1, typename V2, std::enable_if_t<sofa::type::trait::is_vector<V1>::value && sofa::type::trait::is_vector<V2>::value, int> = 0 >
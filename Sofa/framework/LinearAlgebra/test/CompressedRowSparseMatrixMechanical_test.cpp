@@ -0,0 +1,214 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/linearalgebra/CompressedRowSparseMatrixMechanical.h>
+#include <sofa/linearalgebra/FullVector.h>
+
+#include <sofa/testing/NumericTest.h>
+#include <sofa/testing/LinearCongruentialRandomGenerator.h>
+
+#include <chrono>
+#include <vector>
+
+namespace
+{
+
+/// Symmetric matrix with the structure of a hexahedral FEM mesh: each node of the grid is coupled with its 26 neighbors
+template<class TMatrix>
+void generateGridMatrix(TMatrix& matrix, int nx, int ny, int nz)
+{
+    sofa::testing::LinearCongruentialRandomGenerator lcg(8137);
+
+    const int nbNodes = nx * ny * nz;
+    matrix.resize(3 * nbNodes, 3 * nbNodes);
+    const auto index = [nx, ny](int x, int y, int z) { return x + nx * (y + ny * z); };
+
+    for (int z = 0; z < nz; ++z)
+    {
+        for (int y = 0; y < ny; ++y)
+        {
+            for (int x = 0; x < nx; ++x)
+            {
+                const int i = index(x, y, z);
+                for (int dz = -1; dz <= 1; ++dz)
+                for (int dy = -1; dy <= 1; ++dy)
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const int X = x + dx, Y = y + dy, Z = z + dz;
+                    if (X < 0 || Y < 0 || Z < 0 || X >= nx || Y >= ny || Z >= nz)
+                        continue;
+                    const int j = index(X, Y, Z);
+                    if (j < i)
+                        continue;
+
+                    sofa::type::Mat<3, 3, SReal> block;
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        for (int b = 0; b < 3; ++b)
+                        {
+                            block(a, b) = lcg.generateInRange(-1., 1.);
+                        }
+                    }
+                    if (i == j)
+                    {
+                        block = block + block.transposed();
+                    }
+                    matrix.add(3 * i, 3 * j, block);
+                    if (i != j)
+                    {
+                        matrix.add(3 * j, 3 * i, block.transposed());
+                    }
+                }
+            }
+        }
+    }
+    matrix.compress();
+}
+
+sofa::linearalgebra::FullVector<SReal> generateVector(sofa::Index size)
+{
+    sofa::testing::LinearCongruentialRandomGenerator lcg(5623);
+    sofa::linearalgebra::FullVector<SReal> v(size);
+    for (sofa::Index i = 0; i < size; ++i)
+    {
+        v[i] = lcg.generateInRange(-1., 1.);
+    }
+    return v;
+}
+
+using Mat3x3Matrix = sofa::linearalgebra::CompressedRowSparseMatrixMechanical<sofa::type::Mat<3, 3, SReal> >;
+using SymmetricMat3x3Matrix = sofa::linearalgebra::CompressedRowSparseMatrixMechanical<sofa::type::Mat<3, 3, SReal>, sofa::linearalgebra::CRSMechanicalSymmetricPolicy>;
+
+}
+
+TEST(CompressedRowSparseMatrixMechanical, blockProduct)
+{
+    Mat3x3Matrix A;
+    generateGridMatrix(A, 4, 3, 5);
+    const auto x = generateVector(A.colSize());
+
+    sofa::linearalgebra::FullVector<SReal> y;
+    A.mul(y, x);
+    ASSERT_EQ(y.size(), A.rowSize());
+
+    for (sofa::Index i = 0; i < static_cast<sofa::Index>(A.rowSize()); ++i)
+    {
+        SReal expected = 0;
+        for (sofa::Index j = 0; j < static_cast<sofa::Index>(A.colSize()); ++j)
+        {
+            expected += A.element(i, j) * x[j];
+        }
+        EXPECT_NEAR(y[i], expected, 1e-12);
+    }
+
+    // y += A * x
+    sofa::linearalgebra::FullVector<SReal> y2 = y;
+    A.addMul(y2, x);
+    for (sofa::linearalgebra::FullVector<SReal>::Index i = 0; i < y.size(); ++i)
+    {
+        EXPECT_NEAR(y2[i], 2 * y[i], 1e-12);
+    }
+}
+
+TEST(CompressedRowSparseMatrixMechanical, symmetricBlockProduct)
+{
+    Mat3x3Matrix A;
+    SymmetricMat3x3Matrix S;
+    generateGridMatrix(A, 4, 3, 5);
+    generateGridMatrix(S, 4, 3, 5);
+
+    // only the upper triangle is stored
+    EXPECT_LT(S.colsValue.size(), A.colsValue.size());
+
+    const auto x = generateVector(A.colSize());
+    sofa::linearalgebra::FullVector<SReal> y, yS;
+    A.mul(y, x);
+    S.mul(yS, x);
+
+    ASSERT_EQ(y.size(), yS.size());
+    for (sofa::linearalgebra::FullVector<SReal>::Index i = 0; i < y.size(); ++i)
+    {
+        EXPECT_NEAR(y[i], yS[i], 1e-12);
+    }
+}
+
+TEST(CompressedRowSparseMatrixMechanical, symmetricGenericProduct)
+{
+    Mat3x3Matrix A;
+    SymmetricMat3x3Matrix S;
+    generateGridMatrix(A, 4, 3, 5);
+    generateGridMatrix(S, 4, 3, 5);
+
+    const auto x = generateVector(A.colSize());
+    sofa::linearalgebra::FullVector<SReal> y;
+    A.mul(y, x);
+
+    // vectors of blocks and of scalars do not use the block-row product
+    sofa::type::vector<sofa::type::Vec3> xBlocks(A.colBSize()), yBlocks;
+    std::vector<SReal> xScalars(A.colSize()), yScalars(A.rowSize(), 0);
+    for (sofa::Index i = 0; i < static_cast<sofa::Index>(A.colSize()); ++i)
+    {
+        xBlocks[i / 3][i % 3] = x[i];
+        xScalars[i] = x[i];
+    }
+    S.mul(yBlocks, xBlocks);
+    S.addMul(yScalars, xScalars);
+
+    ASSERT_EQ(yBlocks.size(), A.rowBSize());
+    ASSERT_EQ(yScalars.size(), A.rowSize());
+    for (sofa::linearalgebra::FullVector<SReal>::Index i = 0; i < y.size(); ++i)
+    {
+        EXPECT_NEAR(y[i], yBlocks[i / 3][i % 3], 1e-12);
+        EXPECT_NEAR(y[i], yScalars[i], 1e-12);
+    }
+}
+
+/// Measures the throughput of the matrix-vector product on a FEM-like matrix, with and without the symmetric storage.
+/// Disabled by default: run with --gtest_also_run_disabled_tests
+TEST(CompressedRowSparseMatrixMechanical, DISABLED_blockProductPerformance)
+{
+    const auto measure = [](const auto& matrix, const char* name)
+    {
+        const auto x = generateVector(matrix.colSize());
+        sofa::linearalgebra::FullVector<SReal> y;
+        matrix.mul(y, x);
+
+        constexpr int nbRepetitions = 50;
+        const auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < nbRepetitions; ++r)
+        {
+            matrix.mul(y, x);
+        }
+        const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+        // the number of operations is the one of the full matrix, for comparison
+        const double nbFlops = 2. * 9. * (2. * static_cast<double>(matrix.rowSize()) / 3. * 27.) * nbRepetitions;
+        std::cout << name << ": " << nbFlops / duration.count() * 1e-9 << " GFLOP/s" << std::endl;
+    };
+
+    Mat3x3Matrix A;
+    generateGridMatrix(A, 32, 32, 32);
+    measure(A, "Mat3x3");
+
+    SymmetricMat3x3Matrix S;
+    generateGridMatrix(S, 32, 32, 32);
+    measure(S, "Symmetric Mat3x3");
+}
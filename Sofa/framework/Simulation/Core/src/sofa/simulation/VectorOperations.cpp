@@ -42,6 +42,9 @@ using sofa::simulation::mechanicalvisitor::MechanicalVMultiOpVisitor;
 #include <sofa/simulation/mechanicalvisitor/MechanicalVDotVisitor.h>
 using sofa::simulation::mechanicalvisitor::MechanicalVDotVisitor;
 
+#include <sofa/simulation/mechanicalvisitor/MechanicalVMultiOpDotVisitor.h>
+using sofa::simulation::mechanicalvisitor::MechanicalVMultiOpDotVisitor;
+
 #include <sofa/simulation/mechanicalvisitor/MechanicalVNormVisitor.h>
 using sofa::simulation::mechanicalvisitor::MechanicalVNormVisitor;
 
@@ -164,6 +167,12 @@ void VectorOperations::v_dot( sofa::core::ConstMultiVecId a, sofa::core::ConstMu
     MechanicalVDotVisitor(params, a,b,&result).setTags(ctx->getTags()).execute( ctx, executeVisitor.precomputedTraversalOrder );
 }
 
+void VectorOperations::v_multiop_dot(const core::behavior::BaseMechanicalState::VMultiOp& o, sofa::core::ConstMultiVecId a, sofa::core::ConstMultiVecId b)
+{
+    result = 0;
+    MechanicalVMultiOpDotVisitor(params, o, a, b, &result).setTags(ctx->getTags()).execute( ctx, executeVisitor.precomputedTraversalOrder );
+}
+
 void VectorOperations::v_norm( sofa::core::ConstMultiVecId a, unsigned l)
 {
     MechanicalVNormVisitor vis(params, a,l);
@@ -62,6 +62,7 @@ public:
     void v_op(core::MultiVecId v, core::ConstMultiVecId a, core::ConstMultiVecId  b, SReal f=1.0) override ; ///< v=a+b*f
     void v_multiop(const core::behavior::BaseMechanicalState::VMultiOp& o) override;
     void v_dot(core::ConstMultiVecId a, core::ConstMultiVecId  b) override; ///< a dot b ( get result using finish )
+    void v_multiop_dot(const core::behavior::BaseMechanicalState::VMultiOp& o, core::ConstMultiVecId a, core::ConstMultiVecId b) override; ///< v_multiop then a dot b ( get result using finish )
     void v_norm(core::ConstMultiVecId a, unsigned l) override; ///< Compute the norm of a vector ( get result using finish ). The type of norm is set by parameter l. Use 0 for the infinite norm. Note that the 2-norm is more efficiently computed using the square root of the dot product.
     void v_threshold(core::MultiVecId a, SReal threshold) override; ///< nullify the values below the given threshold
 
@@ -158,6 +158,11 @@ public:
     /// Specify whether this visitor can be parallelized.
     virtual bool isThreadSafe() const { return false; }
 
+    /// Specify whether independent sibling subtrees can be traversed concurrently by this visitor.
+    /// It requires that the callbacks only modify data local to the visited node, and that
+    /// no value is accumulated in the visitor across nodes (e.g. a dot product).
+    virtual bool canParallelizeSubtrees() const { return false; }
+
     /// Callback method called when descending to a new node. Recursion will stop if this method returns RESULT_PRUNE
     /// This version is offered a LocalStorage to store temporary data
     SOFA_ATTRIBUTE_DISABLED_LOCALSTORAGE()
@@ -0,0 +1,199 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sofa::simulation
+{
+
+/**
+ * Lock-free double-ended queue of pointers, following the Chase-Lev algorithm
+ * (as formalized by Le, Pop, Cohen and Zappa Nardelli for the C11 memory model).
+ *
+ * A single thread, the owner, pushes and pops at the bottom of the queue. Any other thread can
+ * steal from the top of the queue concurrently. The underlying circular buffer grows when it is
+ * full. Old buffers are kept alive until the queue is destroyed, because a concurrent thief may
+ * still be reading them.
+ */
+template<class T>
+class WorkStealingDeque
+{
+public:
+
+    explicit WorkStealingDeque(const std::int64_t initialCapacity = 256)
+    {
+        std::int64_t capacity = 1;
+        while (capacity < initialCapacity)
+        {
+            capacity <<= 1;
+        }
+        m_buffers.emplace_back(std::make_unique<Buffer>(capacity));
+        m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /// Add an element at the bottom of the queue. Must be called only by the owner thread.
+    void push(T* item)
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_acquire);
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+        if (b - t > buffer->capacity() - 1)
+        {
+            buffer = grow(buffer, b, t);
+        }
+
+        buffer->put(b, item);
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    /// Remove the element at the bottom of the queue (LIFO order). Must be called only by the
+    /// owner thread. Returns nullptr if the queue is empty.
+    T* pop()
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = m_top.load(std::memory_order_relaxed);
+
+        T* item = nullptr;
+        if (t <= b)
+        {
+            item = buffer->get(b);
+            if (t == b)
+            {
+                // last element: race against the thieves
+                if (!m_top.compare_exchange_strong(t, t + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    item = nullptr;
+                }
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /// Remove the element at the top of the queue (FIFO order). Can be called by any thread.
+    /// Returns nullptr if the queue is empty or if another thread won the race for the element.
+    T* steal()
+    {
+        std::int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = m_bottom.load(std::memory_order_acquire);
+
+        if (t < b)
+        {
+            const Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+            T* item = buffer->get(t);
+            if (!m_top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return item;
+        }
+        return nullptr;
+    }
+
+    /// Approximation of the number of elements in the queue. Exact only if called by the owner
+    /// thread while no thief is active.
+    std::int64_t size() const
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+private:
+
+    class Buffer
+    {
+    public:
+        explicit Buffer(const std::int64_t capacity)
+            : m_mask(capacity - 1)
+            , m_items(new std::atomic<T*>[static_cast<std::size_t>(capacity)])
+        {}
+
+        std::int64_t capacity() const { return m_mask + 1; }
+
+        void put(const std::int64_t i, T* item)
+        {
+            m_items[i & m_mask].store(item, std::memory_order_relaxed);
+        }
+
+        T* get(const std::int64_t i) const
+        {
+            return m_items[i & m_mask].load(std::memory_order_relaxed);
+        }
+
+    private:
+        const std::int64_t m_mask;
+        std::unique_ptr<std::atomic<T*>[]> m_items;
+    };
+
+    Buffer* grow(const Buffer* buffer, const std::int64_t bottom, const std::int64_t top)
+    {
+        m_buffers.emplace_back(std::make_unique<Buffer>(2 * buffer->capacity()));
+        Buffer* newBuffer = m_buffers.back().get();
+        for (std::int64_t i = top; i < bottom; ++i)
+        {
+            newBuffer->put(i, buffer->get(i));
+        }
+        m_buffer.store(newBuffer, std::memory_order_release);
+        return newBuffer;
+    }
+
+    enum
+    {
+        CACHE_LINE = 64
+    };
+
+    // top and bottom are written by different threads: keep them on separate cache lines
+    alignas(CACHE_LINE) std::atomic<std::int64_t> m_top { 0 };
+    alignas(CACHE_LINE) std::atomic<std::int64_t> m_bottom { 0 };
+    alignas(CACHE_LINE) std::atomic<Buffer*> m_buffer { nullptr };
+
+    /// All the buffers allocated so far. Only accessed by the owner thread.
+    std::vector<std::unique_ptr<Buffer> > m_buffers;
+};
+
+} // namespace sofa::simulation
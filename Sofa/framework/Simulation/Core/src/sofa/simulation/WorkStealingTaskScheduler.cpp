@@ -0,0 +1,473 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+
+#include <sofa/helper/logging/Messaging.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/WorkStealingDeque.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(WIN32)
+#include <windows.h>
+#endif
+
+namespace sofa::simulation
+{
+
+const bool WorkStealingTaskSchedulerRegistered = MainTaskSchedulerFactory::registerScheduler(
+    WorkStealingTaskScheduler::name(),
+    &WorkStealingTaskScheduler::create);
+
+namespace
+{
+
+class WorkStealingTaskAllocator : public Task::Allocator
+{
+public:
+
+    void* allocate(std::size_t sz) final
+    {
+        return ::operator new(sz);
+    }
+
+    void free(void* ptr, std::size_t sz) final
+    {
+        SOFA_UNUSED(sz);
+        ::operator delete(ptr);
+    }
+};
+
+/// The worker associated to the calling thread. The scheduler is stored alongside, so that several
+/// schedulers can coexist in the same process.
+struct ThreadContext
+{
+    const WorkStealingTaskScheduler* scheduler { nullptr };
+    void* worker { nullptr };
+};
+thread_local ThreadContext currentThreadContext;
+
+struct CpuSlot
+{
+    int cpu { -1 };
+    int numaNode { 0 };
+};
+
+/// Parse a Linux cpu list such as "0-3,8,10-11"
+void parseCpuList(const std::string& cpuList, const int numaNode, std::vector<CpuSlot>& slots)
+{
+    std::istringstream stream(cpuList);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty())
+        {
+            continue;
+        }
+        const auto dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            slots.push_back({cpu, numaNode});
+        }
+    }
+}
+
+/// List of the CPU cores, ordered by NUMA node
+std::vector<CpuSlot> computeCpuSlots()
+{
+    std::vector<CpuSlot> slots;
+
+#if defined(__linux__)
+    for (int node = 0; ; ++node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file.is_open())
+        {
+            break;
+        }
+        std::string cpuList;
+        std::getline(file, cpuList);
+        parseCpuList(cpuList, node, slots);
+    }
+#endif
+
+    if (slots.empty())
+    {
+        const auto nbCpus = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int cpu = 0; cpu < nbCpus; ++cpu)
+        {
+            slots.push_back({static_cast<int>(cpu), 0});
+        }
+    }
+
+    return slots;
+}
+
+bool pinCurrentThread(const int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#elif defined(WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    SOFA_UNUSED(cpu);
+    return false;
+#endif
+}
+
+} // anonymous namespace
+
+struct WorkStealingTaskScheduler::Worker
+{
+    Worker(const unsigned int index, const std::string& name)
+        : m_index(index)
+        , m_name(name + std::to_string(index))
+        , m_randomState(0x9E3779B97F4A7C15ull * (index + 1))
+    {}
+
+    /// xorshift64 generator used to pick steal victims
+    std::uint64_t nextRandom()
+    {
+        m_randomState ^= m_randomState << 13;
+        m_randomState ^= m_randomState >> 7;
+        m_randomState ^= m_randomState << 17;
+        return m_randomState;
+    }
+
+    const unsigned int m_index;
+    const std::string m_name;
+    std::uint64_t m_randomState;
+
+    int m_cpu { -1 };
+    int m_numaNode { 0 };
+
+    WorkStealingDeque<Task> m_tasks;
+    std::thread m_thread;
+};
+
+WorkStealingTaskScheduler* WorkStealingTaskScheduler::create()
+{
+    return new WorkStealingTaskScheduler();
+}
+
+WorkStealingTaskScheduler::WorkStealingTaskScheduler()
+    : TaskScheduler()
+    , m_mainThreadId(std::this_thread::get_id())
+{
+    m_workers.emplace_back(std::make_unique<Worker>(0, "Main  "));
+}
+
+WorkStealingTaskScheduler::~WorkStealingTaskScheduler()
+{
+    stop();
+}
+
+Task::Allocator* WorkStealingTaskScheduler::getTaskAllocator()
+{
+    static WorkStealingTaskAllocator taskAllocator;
+    return &taskAllocator;
+}
+
+void WorkStealingTaskScheduler::init(const unsigned int nbThread)
+{
+    if (m_isInitialized)
+    {
+        if ((nbThread == m_threadCount) || (nbThread == 0 && m_threadCount == GetHardwareThreadsCount()))
+        {
+            return;
+        }
+        stop();
+    }
+
+    start(nbThread);
+}
+
+void WorkStealingTaskScheduler::start(const unsigned int nbThread)
+{
+    stop();
+
+    m_isClosing.store(false);
+    m_mainThreadId = std::this_thread::get_id();
+
+    m_threadCount = nbThread > 0 ? nbThread : std::max(1u, GetHardwareThreadsCount());
+
+    const std::vector<CpuSlot> cpuSlots = computeCpuSlots();
+
+    // all the workers must exist before the first thread starts: thieves iterate over m_workers
+    m_workers[0]->m_numaNode = cpuSlots.front().numaNode;
+    for (unsigned int i = 1; i < m_threadCount; ++i)
+    {
+        auto& worker = m_workers.emplace_back(std::make_unique<Worker>(i, "Worker"));
+        const CpuSlot& slot = cpuSlots[i % cpuSlots.size()];
+        worker->m_numaNode = slot.numaNode;
+        if (m_threadPinning)
+        {
+            worker->m_cpu = slot.cpu;
+        }
+    }
+
+    for (unsigned int i = 1; i < m_threadCount; ++i)
+    {
+        Worker* worker = m_workers[i].get();
+        worker->m_thread = std::thread([this, worker] { run(*worker); });
+    }
+
+    m_isInitialized = true;
+}
+
+void WorkStealingTaskScheduler::stop()
+{
+    if (!m_isInitialized)
+    {
+        return;
+    }
+
+    m_isClosing.store(true);
+    {
+        std::lock_guard lock(m_parkMutex);
+        ++m_wakeUpEpoch;
+    }
+    m_parkEvent.notify_all();
+
+    for (std::size_t i = 1; i < m_workers.size(); ++i)
+    {
+        if (m_workers[i]->m_thread.joinable())
+        {
+            m_workers[i]->m_thread.join();
+        }
+    }
+
+    m_workers.resize(1);
+    m_threadCount = 1;
+    m_isInitialized = false;
+}
+
+WorkStealingTaskScheduler::Worker* WorkStealingTaskScheduler::getCurrentWorker() const
+{
+    if (currentThreadContext.scheduler == this)
+    {
+        return static_cast<Worker*>(currentThreadContext.worker);
+    }
+    if (std::this_thread::get_id() == m_mainThreadId)
+    {
+        return m_workers.front().get();
+    }
+    return nullptr;
+}
+
+const char* WorkStealingTaskScheduler::getCurrentThreadName()
+{
+    const Worker* worker = getCurrentWorker();
+    return worker ? worker->m_name.c_str() : "Unknown";
+}
+
+int WorkStealingTaskScheduler::getCurrentThreadType()
+{
+    return 0;
+}
+
+bool WorkStealingTaskScheduler::addTask(Task* task)
+{
+    Worker* worker = getCurrentWorker();
+
+    // single thread, or thread unknown to the scheduler: run the task
+    if (m_threadCount < 2 || worker == nullptr)
+    {
+        if (task->run() & Task::MemoryAlloc::Dynamic)
+        {
+            delete task;
+        }
+        return false;
+    }
+
+    task->m_id = task->getStatus()->setBusy(true);
+    worker->m_tasks.push(task);
+    notifyWorkers();
+
+    return true;
+}
+
+void WorkStealingTaskScheduler::workUntilDone(Task::Status* status)
+{
+    Worker* worker = getCurrentWorker();
+
+    unsigned int nbFailedAttempts = 0;
+    while (status->isBusy())
+    {
+        Task* task = worker ? findTask(*worker) : nullptr;
+        if (task)
+        {
+            runTask(task);
+            nbFailedAttempts = 0;
+        }
+        else if (++nbFailedAttempts > m_spinCount)
+        {
+            // remaining tasks are being processed by other threads
+            std::this_thread::yield();
+        }
+    }
+
+    // pairs with the fence in runTask
+    std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+Task* WorkStealingTaskScheduler::findTask(Worker& worker)
+{
+    if (Task* task = worker.m_tasks.pop())
+    {
+        return task;
+    }
+    return stealTask(worker);
+}
+
+Task* WorkStealingTaskScheduler::stealTask(Worker& worker)
+{
+    const std::size_t nbWorkers = m_workers.size();
+    if (nbWorkers < 2)
+    {
+        return nullptr;
+    }
+
+    const std::size_t first = static_cast<std::size_t>(worker.nextRandom() % nbWorkers);
+
+    // first try the victims on the same NUMA node, then the others
+    for (const bool sameNode : {true, false})
+    {
+        for (std::size_t i = 0; i < nbWorkers; ++i)
+        {
+            Worker* victim = m_workers[(first + i) % nbWorkers].get();
+            if (victim == &worker || (victim->m_numaNode == worker.m_numaNode) != sameNode)
+            {
+                continue;
+            }
+            if (Task* task = victim->m_tasks.steal())
+            {
+                return task;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void WorkStealingTaskScheduler::runTask(Task* task)
+{
+    // the task may be deleted after run(): keep its status
+    Task::Status* status = task->getStatus();
+
+    if (task->run() & Task::MemoryAlloc::Dynamic)
+    {
+        delete task;
+    }
+
+    // the status is updated with relaxed atomics: publish the results of the task to the thread
+    // waiting on the status
+    std::atomic_thread_fence(std::memory_order_release);
+    status->setBusy(false);
+}
+
+void WorkStealingTaskScheduler::run(Worker& worker)
+{
+    currentThreadContext.scheduler = this;
+    currentThreadContext.worker = &worker;
+
+    if (worker.m_cpu >= 0 && !pinCurrentThread(worker.m_cpu))
+    {
+        msg_warning("WorkStealingTaskScheduler") << "Cannot pin thread " << worker.m_name
+            << " to CPU " << worker.m_cpu;
+    }
+
+    unsigned int nbFailedAttempts = 0;
+    while (!m_isClosing.load(std::memory_order_relaxed))
+    {
+        if (Task* task = findTask(worker))
+        {
+            runTask(task);
+            nbFailedAttempts = 0;
+        }
+        else if (++nbFailedAttempts > m_spinCount)
+        {
+            park();
+            nbFailedAttempts = 0;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    currentThreadContext = ThreadContext();
+}
+
+bool WorkStealingTaskScheduler::hasPendingTasks() const
+{
+    return std::any_of(m_workers.begin(), m_workers.end(),
+        [](const std::unique_ptr<Worker>& worker) { return !worker->m_tasks.empty(); });
+}
+
+void WorkStealingTaskScheduler::park()
+{
+    std::unique_lock lock(m_parkMutex);
+    m_parkedWorkers.fetch_add(1);
+
+    // pairs with the fence in notifyWorkers: either the pusher sees this worker as parked, or
+    // this worker sees the pushed task
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    const auto epoch = m_wakeUpEpoch;
+    if (!hasPendingTasks() && !m_isClosing.load())
+    {
+        m_parkEvent.wait(lock, [this, epoch]
+        {
+            return m_wakeUpEpoch != epoch || m_isClosing.load();
+        });
+    }
+
+    m_parkedWorkers.fetch_sub(1);
+}
+
+void WorkStealingTaskScheduler::notifyWorkers()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_parkedWorkers.load(std::memory_order_relaxed) > 0)
+    {
+        {
+            std::lock_guard lock(m_parkMutex);
+            ++m_wakeUpEpoch;
+        }
+        m_parkEvent.notify_one();
+    }
+}
+
+} // namespace sofa::simulation
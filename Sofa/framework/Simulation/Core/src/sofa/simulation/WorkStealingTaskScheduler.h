@@ -0,0 +1,139 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace sofa::simulation
+{
+
+/**
+ * Task scheduler based on work stealing.
+ *
+ * Each thread (the main thread and the worker threads) owns a lock-free deque
+ * (@WorkStealingDeque). A thread pushes and pops its own tasks at the bottom of its deque, and
+ * steals from the top of the deque of a randomly chosen victim when its own deque is empty.
+ * No mutex is taken on the task path: idle workers spin for a while before parking on a
+ * condition variable, and are woken up only if some of them are actually parked.
+ *
+ * Optionally, worker threads are pinned to CPU cores. Cores are ordered by NUMA node, so that
+ * consecutive workers share the same memory node, and thieves look for work on their own node
+ * first.
+ *
+ * Registered in @MainTaskSchedulerFactory under the name returned by name().
+ */
+class SOFA_SIMULATION_CORE_API WorkStealingTaskScheduler : public TaskScheduler
+{
+public:
+
+    ~WorkStealingTaskScheduler() override;
+
+    /**
+     * Call stop() and start() if not already initialized with the same number of threads
+     * @param nbThread If 0, the number of threads is GetHardwareThreadsCount()
+     */
+    void init(const unsigned int nbThread = 0) final;
+
+    /**
+     * Wait and destroy worker threads
+     */
+    void stop() final;
+
+    unsigned int getThreadCount() const final { return m_threadCount; }
+    const char* getCurrentThreadName() final;
+    int getCurrentThreadType() final;
+
+    // queue task if there is more than one thread, and run it otherwise
+    bool addTask(Task* task) final;
+    void workUntilDone(Task::Status* status) final;
+    Task::Allocator* getTaskAllocator() final;
+
+    /// Pin worker threads to CPU cores (NUMA-aware ordering). Taken into account at the next init().
+    void setThreadPinning(bool enable) { m_threadPinning = enable; }
+    bool isThreadPinningEnabled() const { return m_threadPinning; }
+
+    /// Number of failed steal rounds a worker spins before parking
+    void setSpinCount(unsigned int spinCount) { m_spinCount = spinCount; }
+    unsigned int getSpinCount() const { return m_spinCount; }
+
+    // factory methods: name, creator function
+    static const char* name() { return "_workstealing"; }
+
+    static WorkStealingTaskScheduler* create();
+
+private:
+
+    struct Worker;
+
+    WorkStealingTaskScheduler();
+    WorkStealingTaskScheduler(const WorkStealingTaskScheduler&) = delete;
+
+    void start(unsigned int nbThread);
+
+    /// Worker associated to the calling thread, or nullptr if the thread is unknown to the scheduler
+    Worker* getCurrentWorker() const;
+
+    /// Pop a task from the own deque of the worker, or steal one from another worker
+    Task* findTask(Worker& worker);
+    Task* stealTask(Worker& worker);
+
+    void runTask(Task* task);
+
+    /// Main loop of a worker thread
+    void run(Worker& worker);
+
+    /// Park the worker until new tasks are pushed or the scheduler is closing
+    void park();
+
+    /// Wake up a parked worker, if any
+    void notifyWorkers();
+
+    bool hasPendingTasks() const;
+
+    std::vector<std::unique_ptr<Worker> > m_workers;
+
+    std::thread::id m_mainThreadId;
+
+    unsigned int m_threadCount { 0 };
+    bool m_isInitialized { false };
+    std::atomic<bool> m_isClosing { false };
+
+    bool m_threadPinning { false };
+    unsigned int m_spinCount { 64 };
+
+    std::mutex m_parkMutex;
+    std::condition_variable m_parkEvent;
+    std::atomic<int> m_parkedWorkers { 0 };
+    std::uint64_t m_wakeUpEpoch { 0 };
+};
+
+} // namespace sofa::simulation
@@ -60,6 +60,11 @@ public:
     {
         return true;
     }
+
+    bool canParallelizeSubtrees() const override
+    {
+        return true;
+    }
 #ifdef SOFA_DUMP_VISITOR_INFO
     void setReadWriteVectors() override
     {
@@ -0,0 +1,289 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <gtest/gtest.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingDeque.h>
+#include <sofa/simulation/CpuTask.h>
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <chrono>
+#include <iostream>
+#include <numeric>
+
+namespace sofa
+{
+
+namespace
+{
+
+// compute recursively the Fibonacci number for input N, spawning super lightweight tasks
+class WorkStealingFibonacciTask : public simulation::CpuTask
+{
+public:
+    WorkStealingFibonacciTask(simulation::TaskScheduler* scheduler, const int64_t N, int64_t* const sum, simulation::CpuTask::Status* status)
+    : CpuTask(status)
+    , m_scheduler(scheduler)
+    , m_N(N)
+    , m_sum(sum)
+    {}
+
+    MemoryAlloc run() final
+    {
+        if (m_N < 2)
+        {
+            *m_sum = m_N;
+            return MemoryAlloc::Stack;
+        }
+
+        simulation::CpuTask::Status status;
+        int64_t x, y;
+
+        WorkStealingFibonacciTask task0(m_scheduler, m_N - 1, &x, &status);
+        WorkStealingFibonacciTask task1(m_scheduler, m_N - 2, &y, &status);
+
+        m_scheduler->addTask(&task0);
+        m_scheduler->addTask(&task1);
+        m_scheduler->workUntilDone(&status);
+
+        *m_sum = x + y;
+        return MemoryAlloc::Stack;
+    }
+
+private:
+    simulation::TaskScheduler* m_scheduler;
+    const int64_t m_N;
+    int64_t* const m_sum;
+};
+
+int64_t Fibonacci(const int64_t N, const unsigned int nbThread, const bool threadPinning = false)
+{
+    auto* scheduler = dynamic_cast<simulation::WorkStealingTaskScheduler*>(
+        simulation::MainTaskSchedulerFactory::createInRegistry(simulation::WorkStealingTaskScheduler::name()));
+    EXPECT_NE(scheduler, nullptr);
+    if (!scheduler)
+    {
+        return -1;
+    }
+
+    scheduler->setThreadPinning(threadPinning);
+    scheduler->init(nbThread);
+
+    simulation::CpuTask::Status status;
+    int64_t result = 0;
+
+    WorkStealingFibonacciTask task(scheduler, N, &result, &status);
+    scheduler->addTask(&task);
+    scheduler->workUntilDone(&status);
+
+    scheduler->stop();
+    return result;
+}
+
+}
+
+TEST(WorkStealingDeque, ownerIsLIFOThiefIsFIFO)
+{
+    simulation::WorkStealingDeque<int> deque(2);
+    std::vector<int> values(10);
+    std::iota(values.begin(), values.end(), 0);
+
+    // more elements than the initial capacity: the buffer grows
+    for (auto& v : values)
+    {
+        deque.push(&v);
+    }
+    EXPECT_EQ(deque.size(), 10);
+
+    EXPECT_EQ(deque.pop(), &values[9]);
+    EXPECT_EQ(deque.steal(), &values[0]);
+    EXPECT_EQ(deque.steal(), &values[1]);
+    EXPECT_EQ(deque.pop(), &values[8]);
+    EXPECT_EQ(deque.size(), 6);
+
+    while (deque.pop() != nullptr) {}
+    EXPECT_TRUE(deque.empty());
+    EXPECT_EQ(deque.steal(), nullptr);
+}
+
+TEST(WorkStealingDeque, concurrentSteal)
+{
+    constexpr int nbElements = 100000;
+    constexpr int nbThieves = 3;
+
+    std::vector<int> values(nbElements, 0);
+    simulation::WorkStealingDeque<int> deque;
+    std::atomic<bool> done { false };
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < nbThieves; ++t)
+    {
+        thieves.emplace_back([&deque, &done]
+        {
+            while (!done.load())
+            {
+                if (int* v = deque.steal())
+                {
+                    ++(*v);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < nbElements; ++i)
+    {
+        deque.push(&values[i]);
+        if (i % 3 == 0)
+        {
+            if (int* v = deque.pop())
+            {
+                ++(*v);
+            }
+        }
+    }
+    while (int* v = deque.pop())
+    {
+        ++(*v);
+    }
+
+    done.store(true);
+    for (auto& t : thieves)
+    {
+        t.join();
+    }
+
+    // each element has been processed exactly once
+    for (const int v : values)
+    {
+        EXPECT_EQ(v, 1);
+    }
+}
+
+TEST(WorkStealingTaskScheduler, factory)
+{
+    const auto schedulers = simulation::MainTaskSchedulerFactory::getAvailableSchedulers();
+    EXPECT_NE(schedulers.find(simulation::WorkStealingTaskScheduler::name()), schedulers.end());
+
+    const simulation::TaskScheduler* scheduler = simulation::MainTaskSchedulerFactory::createInRegistry(simulation::WorkStealingTaskScheduler::name());
+    EXPECT_NE(dynamic_cast<const simulation::WorkStealingTaskScheduler*>(scheduler), nullptr);
+}
+
+TEST(WorkStealingTaskScheduler, FibonacciSingle)
+{
+    EXPECT_EQ(Fibonacci(27, 1), 196418);
+}
+
+TEST(WorkStealingTaskScheduler, FibonacciMulti)
+{
+    EXPECT_EQ(Fibonacci(27, 4), 196418);
+}
+
+TEST(WorkStealingTaskScheduler, FibonacciMultiPinned)
+{
+    EXPECT_EQ(Fibonacci(23, 4, true), 28657);
+}
+
+TEST(WorkStealingTaskScheduler, restart)
+{
+    EXPECT_EQ(Fibonacci(20, 2), 6765);
+    EXPECT_EQ(Fibonacci(20, 3), 6765);
+    EXPECT_EQ(Fibonacci(20, 0), 6765);
+}
+
+TEST(WorkStealingTaskScheduler, Lambda)
+{
+    const auto scheduler = std::unique_ptr<simulation::TaskScheduler>(
+        simulation::MainTaskSchedulerFactory::instantiate(simulation::WorkStealingTaskScheduler::name()));
+    scheduler->init(4);
+
+    std::vector<unsigned int> ones(64, 0u);
+
+    simulation::CpuTaskStatus status;
+    for (auto& one : ones)
+    {
+        scheduler->addTask(status, [&one]{ one = 1u; });
+    }
+
+    scheduler->workUntilDone(&status);
+    scheduler->stop();
+
+    for (const auto one : ones)
+    {
+        EXPECT_EQ(one, 1u);
+    }
+}
+
+TEST(WorkStealingTaskScheduler, parallelForEach)
+{
+    std::vector<int> integers(1024);
+    std::iota(integers.begin(), integers.end(), 0);
+
+    simulation::TaskScheduler* scheduler = simulation::MainTaskSchedulerFactory::createInRegistry(simulation::WorkStealingTaskScheduler::name());
+    scheduler->init(4);
+
+    // many small ranges, as generated in a time step
+    for (unsigned int step = 0; step < 100; ++step)
+    {
+        simulation::parallelForEach(*scheduler, integers.begin(), integers.end(), [](int& i) { ++i; });
+    }
+    scheduler->stop();
+
+    for (std::size_t i = 0; i < integers.size(); ++i)
+    {
+        EXPECT_EQ(integers[i], static_cast<int>(i) + 100);
+    }
+}
+
+/// Throughput of the default and the work-stealing schedulers on many small parallelForEach ranges, as generated in a
+/// time step by the visitors and the vector operations
+TEST(WorkStealingTaskScheduler, DISABLED_parallelForEachThroughputBenchmark)
+{
+    static constexpr unsigned int NbRanges = 20000;
+    const unsigned int nbThreads = std::max(2u, std::thread::hardware_concurrency());
+
+    for (const std::size_t rangeSize : { 64u, 512u, 4096u })
+    {
+        for (const char* schedulerName : { simulation::DefaultTaskScheduler::name(), simulation::WorkStealingTaskScheduler::name() })
+        {
+            const auto scheduler = std::unique_ptr<simulation::TaskScheduler>(
+                simulation::MainTaskSchedulerFactory::instantiate(schedulerName));
+            scheduler->init(nbThreads);
+
+            std::vector<double> values(rangeSize, 1.0);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned int r = 0; r < NbRanges; ++r)
+            {
+                simulation::parallelForEach(*scheduler, values.begin(), values.end(), [](double& v) { v = v * 1.000001 + 1e-9; });
+            }
+            const auto end = std::chrono::steady_clock::now();
+            scheduler->stop();
+
+            const double seconds = std::chrono::duration<double>(end - start).count();
+            std::cout << schedulerName << " scheduler, " << nbThreads << " threads, ranges of " << rangeSize << " elements: "
+                << NbRanges / seconds << " ranges/s" << std::endl;
+        }
+    }
+}
+
+} // namespace sofa
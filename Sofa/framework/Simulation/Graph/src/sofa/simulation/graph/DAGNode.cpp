@@ -23,6 +23,13 @@
 #include <sofa/simulation/common/xml/NodeElement.h>
 #include <sofa/helper/Factory.inl>
 #include <sofa/core/Mapping.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/behavior/StateAccessor.h>
+#include <sofa/simulation/CpuTaskStatus.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <numeric>
 
 namespace sofa::simulation::graph
 {
@@ -121,6 +128,7 @@ GetUpObjectsVisitor::~GetUpObjectsVisitor(){}
 
 DAGNode::DAGNode(const std::string& name, DAGNode* parent)
     : simulation::Node(name)
+    , d_parallelSubtrees(initData(&d_parallelSubtrees, false, "parallelSubtrees", "If true, the child subtrees which do not share any node nor mechanical state are traversed in parallel by the visitors supporting it (e.g. force computation)"))
     , l_parents(initLink("parents", "Parents nodes in the graph"))
 {
     if( parent )
@@ -216,6 +224,18 @@ void DAGNode::doMoveChild(BaseNode::SPtr node, BaseNode::SPtr previous_parent)
     addChild(node);
 }
 
+bool DAGNode::doAddObject(sofa::core::objectmodel::BaseObject::SPtr obj, sofa::core::objectmodel::TypeOfInsertion insertionLocation)
+{
+    setDirtyParallelSubtreeGroups();
+    return Node::doAddObject(obj, insertionLocation);
+}
+
+bool DAGNode::doRemoveObject(sofa::core::objectmodel::BaseObject::SPtr obj)
+{
+    setDirtyParallelSubtreeGroups();
+    return Node::doRemoveObject(obj);
+}
+
 /// Remove a child
 void DAGNode::detachFromGraph()
 {
@@ -601,12 +621,18 @@ void DAGNode::doExecuteVisitor(simulation::Visitor* action, bool precomputedOrde
             // that can have ancestors in another branch that is not pruned...
             // An already pruned node is ignored.
 
-            NodeList executedNodes;
+            // If enabled, the child subtrees that are independent are traversed in parallel, each
+            // one following this same order.
+
+            if( !executeVisitorParallelSubtrees( action ) )
             {
-                StatusMap statusMap;
-                executeVisitorTopDown( action, executedNodes, statusMap, this );
+                NodeList executedNodes;
+                {
+                    StatusMap statusMap;
+                    executeVisitorTopDown( action, executedNodes, statusMap, this );
+                }
+                executeVisitorBottomUp( action, executedNodes );
             }
-            executeVisitorBottomUp( action, executedNodes );
         }
     }
 }
@@ -717,6 +743,7 @@ void DAGNode::executeVisitorBottomUp( simulation::Visitor* action, NodeList& exe
 void DAGNode::setDirtyDescendancy()
 {
     _descendancy.clear();
+    _parallelSubtreeGroupsDirty = true;
     const LinkParents::Container &parents = l_parents.getValue();
     for ( unsigned int i = 0; i < parents.size() ; i++ )
     {
@@ -740,6 +767,217 @@ void DAGNode::updateDescendancy()
 
 
 
+void DAGNode::setDirtyParallelSubtreeGroups()
+{
+    _parallelSubtreeGroupsDirty = true;
+    const LinkParents::Container &parents = l_parents.getValue();
+    for ( unsigned int i = 0; i < parents.size() ; i++ )
+    {
+        parents[i]->setDirtyParallelSubtreeGroups();
+    }
+}
+
+const DAGNode::SubtreeGroups& DAGNode::getParallelSubtreeGroups()
+{
+    if( !_parallelSubtreeGroupsDirty )
+    {
+        return _parallelSubtreeGroups;
+    }
+
+    _parallelSubtreeGroups.clear();
+    _parallelSubtreeGroupsDirty = false;
+
+    updateDescendancy();
+
+    const std::size_t nbChildren = child.size();
+    if( nbChildren < 2 )
+    {
+        return _parallelSubtreeGroups;
+    }
+
+    // union-find on the child indices
+    std::vector<std::size_t> groupRoot(nbChildren);
+    std::iota(groupRoot.begin(), groupRoot.end(), 0);
+    const auto findRoot = [&groupRoot](std::size_t i)
+    {
+        while( groupRoot[i] != i )
+        {
+            groupRoot[i] = groupRoot[groupRoot[i]];
+            i = groupRoot[i];
+        }
+        return i;
+    };
+    const auto merge = [&groupRoot, &findRoot](const std::size_t i, const std::size_t j)
+    {
+        const std::size_t ri = findRoot(i);
+        const std::size_t rj = findRoot(j);
+        if( ri != rj )
+        {
+            groupRoot[std::max(ri, rj)] = std::min(ri, rj);
+        }
+    };
+
+    // a node reachable from several children (multi-parent node) merges their subtrees
+    std::map<DAGNode*, std::size_t> nodeOwner;
+    std::map<const sofa::core::behavior::BaseMechanicalState*, std::size_t> stateOwner;
+    for( std::size_t i = 0; i < nbChildren; ++i )
+    {
+        DAGNode* dagnode = static_cast<DAGNode*>(child[i].get());
+        std::vector<DAGNode*> subtree { dagnode };
+        subtree.insert( subtree.end(), dagnode->_descendancy.begin(), dagnode->_descendancy.end() );
+
+        for( DAGNode* node : subtree )
+        {
+            const auto inserted = nodeOwner.emplace(node, i);
+            if( !inserted.second )
+            {
+                merge(inserted.first->second, i);
+            }
+            else if( node->mechanicalState )
+            {
+                stateOwner.emplace(node->mechanicalState.get(), i);
+            }
+        }
+    }
+
+    // a component referring to the mechanical states of several subtrees merges them
+    const auto mergeState = [&stateOwner, &merge](const sofa::core::behavior::BaseMechanicalState* state, const std::size_t owner)
+    {
+        if( state == nullptr )
+        {
+            return true;
+        }
+        const auto it = stateOwner.find(state);
+        if( it == stateOwner.end() )
+        {
+            return false; // the state is outside of the child subtrees (e.g. in this node)
+        }
+        merge(it->second, owner);
+        return true;
+    };
+
+    for( const auto& [node, owner] : nodeOwner )
+    {
+        for( const auto& obj : node->object )
+        {
+            bool insideSubtrees = true;
+
+            if( const auto* accessor = dynamic_cast<const sofa::core::behavior::StateAccessor*>(obj.get()) )
+            {
+                for( const auto* state : accessor->getMechanicalStates() )
+                {
+                    insideSubtrees = mergeState(state, owner) && insideSubtrees;
+                }
+            }
+
+            if( auto* mapping = obj->toBaseMapping() )
+            {
+                for( const auto* state : mapping->getMechFrom() )
+                {
+                    insideSubtrees = mergeState(state, owner) && insideSubtrees;
+                }
+                for( const auto* state : mapping->getMechTo() )
+                {
+                    insideSubtrees = mergeState(state, owner) && insideSubtrees;
+                }
+            }
+
+            if( !insideSubtrees )
+            {
+                msg_info() << "Child subtrees are not traversed in parallel: '" << obj->getPathName()
+                           << "' refers to a mechanical state outside of them";
+                return _parallelSubtreeGroups;
+            }
+        }
+    }
+
+    // groups keep the order of the children
+    std::map<std::size_t, std::size_t> groupIndex;
+    for( std::size_t i = 0; i < nbChildren; ++i )
+    {
+        const auto inserted = groupIndex.emplace(findRoot(i), _parallelSubtreeGroups.size());
+        if( inserted.second )
+        {
+            _parallelSubtreeGroups.emplace_back();
+        }
+        _parallelSubtreeGroups[inserted.first->second].push_back( static_cast<DAGNode*>(child[i].get()) );
+    }
+
+    if( _parallelSubtreeGroups.size() < 2 )
+    {
+        _parallelSubtreeGroups.clear();
+    }
+
+    return _parallelSubtreeGroups;
+}
+
+bool DAGNode::executeVisitorParallelSubtrees( simulation::Visitor* action )
+{
+#ifdef SOFA_DUMP_VISITOR_INFO
+    // the visitor trace is not thread-safe
+    SOFA_UNUSED(action);
+    return false;
+#else
+    if( !d_parallelSubtrees.getValue() || !action->canParallelizeSubtrees() )
+    {
+        return false;
+    }
+
+    const SubtreeGroups& groups = getParallelSubtreeGroups();
+    if( groups.empty() )
+    {
+        return false;
+    }
+
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+    if( taskScheduler == nullptr )
+    {
+        return false;
+    }
+    if( taskScheduler->getThreadCount() < 1 )
+    {
+        taskScheduler->init(0);
+        msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+    }
+
+    // this node is processed first, as in the sequential top-down traversal
+    const Visitor::Result result = action->processNodeTopDown(this);
+
+    if( result != simulation::Visitor::RESULT_PRUNE )
+    {
+        const bool reversed = action->childOrderReversed(this);
+
+        simulation::CpuTaskStatus status;
+        for( const auto& group : groups )
+        {
+            taskScheduler->addTask(status, [this, action, &group, reversed]()
+            {
+                // within a group, the traversal is the sequential one restricted to the group subtrees
+                NodeList executedNodes;
+                {
+                    StatusMap statusMap;
+                    statusMap[this] = VISITED;
+
+                    if( reversed )
+                        for( auto it = group.rbegin(); it != group.rend(); ++it )
+                            (*it)->executeVisitorTopDown( action, executedNodes, statusMap, this );
+                    else
+                        for( DAGNode* dagnode : group )
+                            dagnode->executeVisitorTopDown( action, executedNodes, statusMap, this );
+                }
+                executeVisitorBottomUp( action, executedNodes );
+            });
+        }
+        taskScheduler->workUntilDone(&status);
+    }
+
+    updateDescendancy();
+    action->processNodeBottomUp(this);
+
+    return true;
+#endif
+}
+
 void DAGNode::executeVisitorTreeTraversal( simulation::Visitor* action, StatusMap& statusMap, Visitor::TreeTraversalRepetition repeat, bool alreadyRepeated )
 {
     if( !this->isActive() )
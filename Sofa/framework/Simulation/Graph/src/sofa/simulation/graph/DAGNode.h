@@ -46,6 +46,16 @@ public:
     typedef MultiLink<DAGNode,DAGNode,BaseLink::FLAG_STOREPATH|BaseLink::FLAG_DOUBLELINK> LinkParents;
     typedef LinkParents::const_iterator ParentIterator;
 
+    Data<bool> d_parallelSubtrees; ///< Traverse the independent child subtrees of this node in parallel, for the visitors supporting it
+
+    /// groups of child nodes. The subtrees of two different groups share neither nodes nor
+    /// mechanical states, and no component of a group refers to a mechanical state of another group
+    typedef std::vector<std::vector<DAGNode*> > SubtreeGroups;
+
+    /// compute (if needed) and return the groups of independent child subtrees traversed in parallel
+    /// Returns an empty list if a component in the subtrees refers to a mechanical state outside of the subtrees
+    const SubtreeGroups& getParallelSubtreeGroups();
+
 
 protected:
     DAGNode( const std::string& name="", DAGNode* parent=nullptr  );
@@ -149,6 +159,9 @@ protected:
     virtual void doRemoveChild(BaseNode::SPtr node) override;
     virtual void doMoveChild(BaseNode::SPtr node, BaseNode::SPtr previous_parent) override;
 
+    bool doAddObject(sofa::core::objectmodel::BaseObject::SPtr obj, sofa::core::objectmodel::TypeOfInsertion insertionLocation = sofa::core::objectmodel::TypeOfInsertion::AtEnd) override;
+    bool doRemoveObject(sofa::core::objectmodel::BaseObject::SPtr obj) override;
+
 
     /// Execute a recursive action starting from this node.
     void doExecuteVisitor(simulation::Visitor* action, bool precomputedOrder=false) override;
@@ -210,6 +223,20 @@ protected:
     /// @internal tree traversal implementation
     void executeVisitorTreeTraversal( Visitor* action, StatusMap& statusMap, Visitor::TreeTraversalRepetition repeat, bool alreadyRepeated=false );
 
+    /// @name @internal stuff related to the parallel traversal of independent subtrees
+    /// @{
+
+    SubtreeGroups _parallelSubtreeGroups;
+    bool _parallelSubtreeGroupsDirty { true };
+
+    /// bottom-up traversal invalidating the subtree groups
+    void setDirtyParallelSubtreeGroups();
+
+    /// DAG traversal processing each group of independent child subtrees in a separated task
+    /// Returns false if the visitor or the graph do not allow it, in which case nothing has been executed
+    bool executeVisitorParallelSubtrees( simulation::Visitor* action );
+    /// @}
+
     /// @name @internal stuff related to getObjects
     /// @{
 
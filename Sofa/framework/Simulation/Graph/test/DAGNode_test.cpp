@@ -23,10 +23,136 @@
 using sofa::testing::BaseTest;
 
 #include <sofa/simulation/graph/DAGNode.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/Visitor.h>
+#include <sofa/simulation/mechanicalvisitor/MechanicalComputeForceVisitor.h>
+
+#include <sofa/component/statecontainer/MechanicalObject.h>
+#include <sofa/core/Mapping.h>
+#include <sofa/core/behavior/ForceField.h>
+#include <sofa/core/behavior/PairInteractionForceField.h>
+#include <sofa/core/MechanicalParams.h>
+
+#include <cstring>
+#include <mutex>
 
 using namespace sofa;
 using namespace simulation::graph;
 
+namespace
+{
+
+using defaulttype::Vec3Types;
+using MechanicalObject3 = component::statecontainer::MechanicalObject<Vec3Types>;
+
+/// Nonlinear force f = -|x| x, so that the result depends on the order of the floating-point operations
+class NonlinearForceField : public core::behavior::ForceField<Vec3Types>
+{
+public:
+    SOFA_CLASS(NonlinearForceField, SOFA_TEMPLATE(core::behavior::ForceField, Vec3Types));
+
+    void addForce(const core::MechanicalParams*, DataVecDeriv& f, const DataVecCoord& x, const DataVecDeriv&) override
+    {
+        auto force = helper::getWriteAccessor(f);
+        const auto position = helper::getReadAccessor(x);
+        for (std::size_t i = 0; i < position.size(); ++i)
+        {
+            force[i] -= position[i] * position[i].norm();
+        }
+    }
+
+    void addDForce(const core::MechanicalParams*, DataVecDeriv&, const DataVecDeriv&) override {}
+    SReal getPotentialEnergy(const core::MechanicalParams*, const DataVecCoord&) const override { return 0; }
+};
+
+/// Springs between the points of same index of two mechanical states
+class PairSprings : public core::behavior::PairInteractionForceField<Vec3Types>
+{
+public:
+    SOFA_CLASS(PairSprings, SOFA_TEMPLATE(core::behavior::PairInteractionForceField, Vec3Types));
+
+    void addForce(const core::MechanicalParams*, DataVecDeriv& f1, DataVecDeriv& f2, const DataVecCoord& x1,
+                  const DataVecCoord& x2, const DataVecDeriv&, const DataVecDeriv&) override
+    {
+        auto force1 = helper::getWriteAccessor(f1);
+        auto force2 = helper::getWriteAccessor(f2);
+        const auto position1 = helper::getReadAccessor(x1);
+        const auto position2 = helper::getReadAccessor(x2);
+        for (std::size_t i = 0; i < std::min(position1.size(), position2.size()); ++i)
+        {
+            const auto f = (position2[i] - position1[i]) * 0.3;
+            force1[i] += f;
+            force2[i] -= f;
+        }
+    }
+
+    void addDForce(const core::MechanicalParams*, DataVecDeriv&, DataVecDeriv&, const DataVecDeriv&, const DataVecDeriv&) override {}
+    SReal getPotentialEnergy(const core::MechanicalParams*, const DataVecCoord&, const DataVecCoord&) const override { return 0; }
+
+protected:
+    PairSprings(core::behavior::MechanicalState<Vec3Types>* mm1 = nullptr, core::behavior::MechanicalState<Vec3Types>* mm2 = nullptr)
+        : core::behavior::PairInteractionForceField<Vec3Types>(mm1, mm2) {}
+};
+
+/// Mapping x_out = 2 x_in
+class ScaleMapping : public core::Mapping<Vec3Types, Vec3Types>
+{
+public:
+    SOFA_CLASS(ScaleMapping, SOFA_TEMPLATE2(core::Mapping, Vec3Types, Vec3Types));
+
+    void apply(const core::MechanicalParams*, OutDataVecCoord& out, const InDataVecCoord& in) override
+    {
+        auto x = helper::getWriteOnlyAccessor(out);
+        const auto xIn = helper::getReadAccessor(in);
+        x.resize(xIn.size());
+        for (std::size_t i = 0; i < xIn.size(); ++i)
+            x[i] = xIn[i] * 2.;
+    }
+
+    void applyJ(const core::MechanicalParams*, OutDataVecDeriv& out, const InDataVecDeriv& in) override
+    {
+        auto v = helper::getWriteOnlyAccessor(out);
+        const auto vIn = helper::getReadAccessor(in);
+        v.resize(vIn.size());
+        for (std::size_t i = 0; i < vIn.size(); ++i)
+            v[i] = vIn[i] * 2.;
+    }
+
+    void applyJT(const core::MechanicalParams*, InDataVecDeriv& out, const OutDataVecDeriv& in) override
+    {
+        auto f = helper::getWriteAccessor(out);
+        const auto fIn = helper::getReadAccessor(in);
+        for (std::size_t i = 0; i < std::min(f.size(), fIn.size()); ++i)
+            f[i] += fIn[i] * 2.;
+    }
+};
+
+MechanicalObject3::SPtr addState(const DAGNode::SPtr& node, const unsigned int nbPoints, const SReal offset)
+{
+    const auto state = core::objectmodel::New<MechanicalObject3>();
+    state->resize(nbPoints);
+    {
+        auto x = state->writePositions();
+        for (unsigned int i = 0; i < nbPoints; ++i)
+        {
+            x[i] = type::Vec3(std::sin(offset + i), std::cos(0.3 * i + offset), 0.1 * i - offset);
+        }
+    }
+    node->addObject(state);
+    return state;
+}
+
+ScaleMapping::SPtr addMapping(const DAGNode::SPtr& node, MechanicalObject3* from, MechanicalObject3* to)
+{
+    const auto mapping = core::objectmodel::New<ScaleMapping>();
+    mapping->setModels(from, to);
+    node->addObject(mapping);
+    return mapping;
+}
+
+} // namespace
+
 struct DAGNode_test : public BaseTest
 {
     DAGNode_test() {}
@@ -91,7 +217,239 @@ struct DAGNode_test : public BaseTest
         commonParent = node11->findCommonParent(static_cast<simulation::Node*>(node23.get()));
         EXPECT_STREQ(node2->getName().c_str(), commonParent->getName().c_str());
     }
+
+    /// Visitor recording the top-down and bottom-up callbacks
+    class RecordingVisitor : public simulation::Visitor
+    {
+    public:
+        explicit RecordingVisitor(bool parallel)
+            : simulation::Visitor(core::execparams::defaultInstance())
+            , m_parallel(parallel)
+        {}
+
+        Result processNodeTopDown(simulation::Node* node) override
+        {
+            record(node, true);
+            return RESULT_CONTINUE;
+        }
+
+        void processNodeBottomUp(simulation::Node* node) override
+        {
+            record(node, false);
+        }
+
+        bool canParallelizeSubtrees() const override { return m_parallel; }
+        const char* getClassName() const override { return "RecordingVisitor"; }
+
+        /// the records restricted to a set of nodes, in the order of execution
+        std::vector<std::pair<std::string, bool> > getRecords(const std::set<std::string>& nodeNames) const
+        {
+            std::vector<std::pair<std::string, bool> > records;
+            for (const auto& r : m_records)
+            {
+                if (nodeNames.count(r.first))
+                {
+                    records.push_back(r);
+                }
+            }
+            return records;
+        }
+
+        std::size_t getNbRecords() const { return m_records.size(); }
+
+    private:
+        void record(simulation::Node* node, bool topDown)
+        {
+            std::lock_guard lock(m_mutex);
+            m_records.emplace_back(node->getName(), topDown);
+        }
+
+        bool m_parallel;
+        std::mutex m_mutex;
+        std::vector<std::pair<std::string, bool> > m_records;
+    };
+
+    void test_parallelSubtrees()
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+        ASSERT_NE(taskScheduler, nullptr);
+        taskScheduler->init(4);
+
+        const DAGNode::SPtr root = core::objectmodel::New<DAGNode>("root");
+        const DAGNode::SPtr node1 = core::objectmodel::New<DAGNode>("node1");
+        const DAGNode::SPtr node2 = core::objectmodel::New<DAGNode>("node2");
+        const DAGNode::SPtr node3 = core::objectmodel::New<DAGNode>("node3");
+        const DAGNode::SPtr node4 = core::objectmodel::New<DAGNode>("node4");
+        const DAGNode::SPtr node11 = core::objectmodel::New<DAGNode>("node11");
+        const DAGNode::SPtr node12 = core::objectmodel::New<DAGNode>("node12");
+        const DAGNode::SPtr node24 = core::objectmodel::New<DAGNode>("node24");
+        const DAGNode::SPtr node31 = core::objectmodel::New<DAGNode>("node31");
+
+        root->addChild(node1);
+        root->addChild(node2);
+        root->addChild(node3);
+        root->addChild(node4);
+
+        node1->addChild(node11);
+        node1->addChild(node12);
+        node3->addChild(node31);
+
+        // node2 and node4 share a child: they cannot be traversed independently
+        node2->addChild(node24);
+        node4->addChild(node24);
+
+        root->d_parallelSubtrees.setValue(true);
+
+        RecordingVisitor sequential(false);
+        root->executeVisitor(&sequential);
+
+        RecordingVisitor parallel(true);
+        root->executeVisitor(&parallel);
+
+        EXPECT_EQ(sequential.getNbRecords(), 18);
+        EXPECT_EQ(parallel.getNbRecords(), sequential.getNbRecords());
+
+        // the root is processed first and last
+        const std::vector<std::pair<std::string, bool> > rootRecords { {"root", true}, {"root", false} };
+        EXPECT_EQ(parallel.getRecords({"root"}), rootRecords);
+
+        // each group of subtrees follows the sequential order
+        for (const std::set<std::string>& group : std::vector<std::set<std::string> >{
+                 {"root", "node1", "node11", "node12"},
+                 {"root", "node2", "node4", "node24"},
+                 {"root", "node3", "node31"}})
+        {
+            EXPECT_EQ(parallel.getRecords(group), sequential.getRecords(group));
+        }
+
+        taskScheduler->stop();
+    }
+
+    /// Children of the root, whose subtrees are grouped:
+    /// - node1 is independent
+    /// - node2 and node3 are coupled by a mapping from a state of node2 to a state of node3
+    /// - node4 and node5 are coupled by an interaction force field
+    /// - node6 and node7 share a child (multi-parent node)
+    struct CoupledSubtrees
+    {
+        DAGNode::SPtr root;
+        std::vector<DAGNode::SPtr> children;
+        std::vector<MechanicalObject3::SPtr> states;
+
+        CoupledSubtrees()
+        {
+            root = core::objectmodel::New<DAGNode>("root");
+            for (unsigned int i = 1; i <= 7; ++i)
+            {
+                children.push_back(core::objectmodel::New<DAGNode>("node" + std::to_string(i)));
+                root->addChild(children.back());
+                states.push_back(addState(children.back(), 20, i));
+                children.back()->addObject(core::objectmodel::New<NonlinearForceField>());
+            }
+
+            const auto node21 = core::objectmodel::New<DAGNode>("node21");
+            children[1]->addChild(node21);
+            states.push_back(addState(node21, 20, 8));
+            node21->addObject(core::objectmodel::New<NonlinearForceField>());
+
+            const auto node31 = core::objectmodel::New<DAGNode>("node31");
+            children[2]->addChild(node31);
+            addMapping(node31, states[7].get(), addState(node31, 20, 0).get());
+            node31->addObject(core::objectmodel::New<NonlinearForceField>());
+
+            children[3]->addObject(core::objectmodel::New<PairSprings>(states[3].get(), states[4].get()));
+
+            const auto node67 = core::objectmodel::New<DAGNode>("node67");
+            children[5]->addChild(node67);
+            children[6]->addChild(node67);
+            states.push_back(addState(node67, 20, 9));
+            node67->addObject(core::objectmodel::New<NonlinearForceField>());
+
+            root->init(core::execparams::defaultInstance());
+        }
+
+        std::vector<std::set<std::string> > getGroupNames() const
+        {
+            std::vector<std::set<std::string> > groups;
+            for (const auto& group : root->getParallelSubtreeGroups())
+            {
+                groups.emplace_back();
+                for (const auto* node : group)
+                {
+                    groups.back().insert(node->getName());
+                }
+            }
+            return groups;
+        }
+
+        /// forces of all the states after a MechanicalComputeForceVisitor
+        std::vector<type::vector<type::Vec3> > computeForces(bool parallel)
+        {
+            root->d_parallelSubtrees.setValue(parallel);
+
+            const core::MechanicalParams mparams;
+            simulation::mechanicalvisitor::MechanicalComputeForceVisitor visitor(&mparams, core::VecDerivId::force());
+            root->executeVisitor(&visitor);
+
+            std::vector<type::vector<type::Vec3> > forces;
+            std::vector<MechanicalObject3*> allStates;
+            root->getTreeObjects<MechanicalObject3>(&allStates);
+            for (const auto* state : allStates)
+            {
+                forces.push_back(state->read(core::ConstVecDerivId::force())->getValue());
+            }
+            return forces;
+        }
+    };
+
+    void test_parallelSubtreeGroups()
+    {
+        CoupledSubtrees scene;
+
+        const std::vector<std::set<std::string> > expectedGroups {
+            {"node1"}, {"node2", "node3"}, {"node4", "node5"}, {"node6", "node7"} };
+        EXPECT_EQ(scene.getGroupNames(), expectedGroups);
+
+        // a mapping from a state of the root: the subtrees cannot be traversed in parallel anymore
+        const auto rootState = addState(scene.root, 20, 10);
+        const auto node11 = core::objectmodel::New<DAGNode>("node11");
+        scene.children[0]->addChild(node11);
+        addMapping(node11, rootState.get(), addState(node11, 20, 0).get());
+        EXPECT_TRUE(scene.root->getParallelSubtreeGroups().empty());
+
+        // removing the mapping restores the groups
+        scene.children[0]->removeChild(node11);
+        EXPECT_EQ(scene.getGroupNames(), expectedGroups);
+    }
+
+    void test_parallelSubtreesForces()
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+        ASSERT_NE(taskScheduler, nullptr);
+        taskScheduler->init(4);
+
+        // the forces are accumulated by the visitor: each traversal is run on its own scene
+        CoupledSubtrees sequentialScene, parallelScene;
+        ASSERT_EQ(parallelScene.root->getParallelSubtreeGroups().size(), 4);
+
+        const auto sequentialForces = sequentialScene.computeForces(false);
+        const auto parallelForces = parallelScene.computeForces(true);
+
+        ASSERT_EQ(sequentialForces.size(), parallelForces.size());
+        for (std::size_t i = 0; i < sequentialForces.size(); ++i)
+        {
+            ASSERT_EQ(sequentialForces[i].size(), parallelForces[i].size());
+            ASSERT_FALSE(sequentialForces[i].empty());
+            EXPECT_EQ(std::memcmp(sequentialForces[i].data(), parallelForces[i].data(),
+                                  sequentialForces[i].size() * sizeof(type::Vec3)), 0) << "state " << i;
+        }
+
+        taskScheduler->stop();
+    }
 };
 
 TEST_F(DAGNode_test, test_findCommonParent) { test_findCommonParent(); }
 TEST_F(DAGNode_test, test_findCommonParent_MultipleParents) { test_findCommonParent_MultipleParents(); }
+TEST_F(DAGNode_test, test_parallelSubtrees) { test_parallelSubtrees(); }
+TEST_F(DAGNode_test, test_parallelSubtreeGroups) { test_parallelSubtreeGroups(); }
+TEST_F(DAGNode_test, test_parallelSubtreesForces) { test_parallelSubtreesForces(); }
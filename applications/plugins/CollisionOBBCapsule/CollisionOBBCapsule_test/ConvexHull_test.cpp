@@ -0,0 +1,211 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <CollisionOBBCapsule/geometry/ConvexHullModel.h>
+#include <CollisionOBBCapsule/detection/intersection/IntrConvexHull.h>
+#include <CollisionOBBCapsule/detection/intersection/ConvexHullIntersection.h>
+
+#include <sofa/component/collision/detection/intersection/NewProximityIntersection.h>
+#include <sofa/component/statecontainer/MechanicalObject.h>
+#include <sofa/simulation/graph/DAGNode.h>
+
+#include <sofa/testing/BaseTest.h>
+
+#include <set>
+
+namespace
+{
+
+using sofa::type::Vec3;
+using sofa::type::Quat;
+using sofa::core::objectmodel::New;
+using sofa::defaulttype::Rigid3Types;
+using collisionobbcapsule::detection::intersection::ConvexSupport;
+using collisionobbcapsule::detection::intersection::IntrConvexHull;
+using sofa::component::collision::detection::intersection::NewProximityIntersection;
+
+typedef collisionobbcapsule::geometry::ConvexHullCollisionModel<Rigid3Types> ConvexHullModel;
+typedef sofa::component::statecontainer::MechanicalObject<Rigid3Types> MechanicalObjectRigid3;
+
+/// Vertices of the box of the given half extents, centered on the origin
+sofa::type::vector<Vec3> makeBox(const Vec3& extents)
+{
+    sofa::type::vector<Vec3> vertices;
+    for (const SReal x : { -1, 1 })
+        for (const SReal y : { -1, 1 })
+            for (const SReal z : { -1, 1 })
+                vertices.emplace_back(x * extents[0], y * extents[1], z * extents[2]);
+    return vertices;
+}
+
+struct ConvexHull_test : public sofa::testing::BaseTest
+{
+    sofa::simulation::Node::SPtr root;
+
+    ConvexHullModel::SPtr makeHull(const std::string& name, const sofa::type::vector<Vec3>& vertices, const Rigid3Types::Coord& frame)
+    {
+        const auto node = root->createChild(name);
+        const auto dofs = New<MechanicalObjectRigid3>();
+        dofs->resize(1);
+        sofa::helper::getWriteAccessor(*dofs->write(sofa::core::VecCoordId::position()))[0] = frame;
+        node->addObject(dofs);
+
+        const auto hull = New<ConvexHullModel>();
+        hull->d_vertices.setValue(vertices);
+        node->addObject(hull);
+        hull->init();
+        return hull;
+    }
+
+    void onSetUp() override
+    {
+        root = New<sofa::simulation::graph::DAGNode>();
+    }
+};
+
+TEST_F(ConvexHull_test, hullOfBoxWithInteriorPoints)
+{
+    auto points = makeBox(Vec3(1, 2, 3));
+    points.emplace_back(0, 0, 0);
+    points.emplace_back(0.5, -1, 2);
+    points.emplace_back(1, 0, 0); // on a face of the box
+
+    ConvexHullModel::VecCoord vertices;
+    sofa::type::vector<ConvexHullModel::Triangle> triangles;
+    ASSERT_TRUE(ConvexHullModel::computeConvexHull(points, vertices, triangles));
+    EXPECT_EQ(vertices.size(), 8u);
+    EXPECT_EQ(triangles.size(), 12u);
+
+    // The triangles are oriented outward
+    for (const auto& triangle : triangles)
+    {
+        const Vec3 normal = (vertices[triangle[1]] - vertices[triangle[0]]).cross(vertices[triangle[2]] - vertices[triangle[0]]);
+        EXPECT_GT(normal * vertices[triangle[0]], 0);
+    }
+}
+
+TEST_F(ConvexHull_test, distanceOfSeparatedBoxes)
+{
+    const auto box = makeBox(Vec3(1, 1, 1));
+    const ConvexSupport first(box.data(), box.size(), Vec3(0, 0, 0), Quat<SReal>::identity());
+    const ConvexSupport second(box.data(), box.size(), Vec3(0.5, 0.3, 2.5), Quat<SReal>(Vec3(0, 0, 1), 0.3));
+
+    IntrConvexHull intr(first, second);
+    EXPECT_TRUE(intr.Find());
+    EXPECT_NEAR(intr.distance(), 0.5, 1e-9);
+    EXPECT_FALSE(intr.colliding());
+    EXPECT_LT((intr.separatingAxis() - Vec3(0, 0, 1)).norm(), 1e-9);
+    EXPECT_NEAR(intr.pointOnFirst()[2], 1, 1e-9);
+    EXPECT_NEAR(intr.pointOnSecond()[2], 1.5, 1e-9);
+}
+
+TEST_F(ConvexHull_test, penetrationOfOverlappingBoxes)
+{
+    const auto box = makeBox(Vec3(1, 1, 1));
+    const ConvexSupport first(box.data(), box.size(), Vec3(0, 0, 0), Quat<SReal>::identity());
+    const ConvexSupport second(box.data(), box.size(), Vec3(0.2, 0.1, 1.8), Quat<SReal>::identity());
+
+    IntrConvexHull intr(first, second);
+    EXPECT_TRUE(intr.Find());
+    EXPECT_NEAR(intr.distance(), -0.2, 1e-9);
+    EXPECT_TRUE(intr.colliding());
+    EXPECT_LT((intr.separatingAxis() - Vec3(0, 0, 1)).norm(), 1e-9);
+    EXPECT_NEAR((intr.pointOnSecond() - intr.pointOnFirst()) * intr.separatingAxis(), -0.2, 1e-9);
+}
+
+TEST_F(ConvexHull_test, sphereAgainstFace)
+{
+    const auto box = makeBox(Vec3(1, 1, 1));
+    const Vec3 center(0.3, 1.4, -0.2);
+    const ConvexSupport sphere(&center, 1, 0.5);
+    const ConvexSupport hull(box.data(), box.size(), Vec3(0, 0, 0), Quat<SReal>::identity());
+
+    IntrConvexHull intr(sphere, hull);
+    EXPECT_TRUE(intr.Find());
+    EXPECT_NEAR(intr.distance(), -0.1, 1e-9);
+    EXPECT_LT((intr.separatingAxis() - Vec3(0, -1, 0)).norm(), 1e-9);
+    EXPECT_LT((intr.pointOnFirst() - Vec3(0.3, 0.9, -0.2)).norm(), 1e-9);
+    EXPECT_LT((intr.pointOnSecond() - Vec3(0.3, 1, -0.2)).norm(), 1e-9);
+}
+
+TEST_F(ConvexHull_test, manifoldOfRockingBox)
+{
+    const auto intersection = New<NewProximityIntersection>();
+    intersection->setAlarmDistance(0.05);
+    intersection->setContactDistance(0.01);
+    root->addObject(intersection);
+    intersection->init();
+
+    // A unit box on a large flat box whose top face is z = 0
+    const auto box = makeHull("box", makeBox(Vec3(0.5, 0.5, 0.5)), Rigid3Types::Coord(Vec3(0, 0, 0.5), Quat<SReal>::identity()));
+    const auto ground = makeHull("ground", makeBox(Vec3(5, 5, 1)), Rigid3Types::Coord(Vec3(0, 0, -1), Quat<SReal>::identity()));
+    ASSERT_EQ(box->hullVertices().size(), 8u);
+
+    bool swapModels = false;
+    auto* intersector = intersection->findIntersector(box.get(), ground.get(), swapModels);
+    ASSERT_NE(intersector, nullptr);
+    ASSERT_FALSE(swapModels);
+
+    const auto detect = [&]()
+    {
+        sofa::core::collision::DetectionOutputVector* outputs = nullptr;
+        intersector->beginIntersect(box.get(), ground.get(), outputs);
+        intersector->intersect(box->begin(), ground->begin(), outputs, intersection.get());
+        intersector->endIntersect(box.get(), ground.get(), outputs);
+        auto contacts = *dynamic_cast<sofa::type::vector<sofa::core::collision::DetectionOutput>*>(outputs);
+        outputs->release();
+        return contacts;
+    };
+
+    // The box rocks slightly toward each of its bottom corners in turn, penetrating the ground by it
+    const Vec3 corners[4] = { Vec3(1, 1, 0), Vec3(-1, 1, 0), Vec3(-1, -1, 0), Vec3(1, -1, 0) };
+    std::set<sofa::core::collision::DetectionOutput::ContactId> ids;
+    for (unsigned int step = 0; step < 8; ++step)
+    {
+        const Vec3& corner = corners[step % 4];
+        const Quat<SReal> tilt(Vec3(0, 0, 1).cross(corner).normalized(), 0.01);
+        sofa::helper::getWriteAccessor(*box->getMechanicalState()->write(sofa::core::VecCoordId::position()))[0] =
+            Rigid3Types::Coord(Vec3(0, 0, 0.5), tilt);
+
+        const auto contacts = detect();
+        ASSERT_EQ(contacts.size(), std::min(step + 1, 4u)) << "step " << step;
+
+        for (const auto& contact : contacts)
+        {
+            EXPECT_LT((contact.normal - Vec3(0, 0, -1)).norm(), 1e-6);
+            EXPECT_LT(contact.value, 0.05);
+            ids.insert(contact.id);
+        }
+        EXPECT_EQ(ids.size(), std::min(step + 1, 4u)) << "step " << step;
+
+        // The corner toward which the box rocks is the deepest contact point
+        const auto deepest = std::min_element(contacts.begin(), contacts.end(),
+            [](const auto& a, const auto& b) { return a.value < b.value; });
+        EXPECT_LT((deepest->point[0] - Vec3(0, 0, 0.5) - tilt.rotate(corner * 0.5 - Vec3(0, 0, 0.5))).norm(), 1e-6);
+    }
+
+    // The box moves away: the manifold is emptied
+    sofa::helper::getWriteAccessor(*box->getMechanicalState()->write(sofa::core::VecCoordId::position()))[0] =
+        Rigid3Types::Coord(Vec3(0, 0, 1), Quat<SReal>::identity());
+    EXPECT_TRUE(detect().empty());
+}
+
+} // namespace
@@ -0,0 +1,286 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <CollisionOBBCapsule/detection/intersection/ConvexHullIntersection.h>
+
+#include <sofa/core/collision/IntersectorFactory.h>
+#include <sofa/core/collision/Intersection.inl>
+
+#include <sofa/component/collision/detection/intersection/LocalMinDistance.h>
+#include <sofa/component/collision/detection/intersection/NewProximityIntersection.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace collisionobbcapsule::detection::intersection
+{
+
+using namespace sofa::defaulttype;
+using namespace sofa::core::collision;
+using namespace sofa::component::collision::geometry;
+using sofa::component::collision::detection::intersection::LocalMinDistance;
+using sofa::component::collision::detection::intersection::NewProximityIntersection;
+
+typedef ConvexHullCollisionModel<Rigid3Types> ConvexHullModel;
+
+IntersectorCreator<NewProximityIntersection, ConvexHullIntersection> ConvexHullNewProximityIntersectors("ConvexHull");
+IntersectorCreator<LocalMinDistance, ConvexHullIntersection> ConvexHullLocalMinDistanceIntersectors("ConvexHull");
+
+ConvexHullIntersection::ConvexHullIntersection(BaseProximityIntersection* intersection)
+{
+    intersection->intersectors.add<ConvexHullModel, ConvexHullModel, ConvexHullIntersection>(this);
+    intersection->intersectors.add<SphereCollisionModel<Vec3Types>, ConvexHullModel, ConvexHullIntersection>(this);
+    intersection->intersectors.add<RigidSphereModel, ConvexHullModel, ConvexHullIntersection>(this);
+    intersection->intersectors.add<PointCollisionModel<Vec3Types>, ConvexHullModel, ConvexHullIntersection>(this);
+    intersection->intersectors.add<LineCollisionModel<Vec3Types>, ConvexHullModel, ConvexHullIntersection>(this);
+    intersection->intersectors.add<TriangleCollisionModel<Vec3Types>, ConvexHullModel, ConvexHullIntersection>(this);
+}
+
+ConvexHullIntersection::ModelPairManifolds& ConvexHullIntersection::getModelPairManifolds(const sofa::core::CollisionModel* model1, const sofa::core::CollisionModel* model2)
+{
+    std::lock_guard<std::mutex> lock(m_manifoldsMutex);
+    return m_manifolds[std::make_pair(model1, model2)];
+}
+
+int ConvexHullIntersection::beginIntersection(ConvexHullModel* model1, ConvexHullModel* model2, OutputVector* /*contacts*/)
+{
+    ModelPairManifolds& pairManifolds = getModelPairManifolds(model1, model2);
+    for (auto it = pairManifolds.manifolds.begin(); it != pairManifolds.manifolds.end();)
+    {
+        if (it->second.lastStep != pairManifolds.step)
+            it = pairManifolds.manifolds.erase(it);
+        else
+            ++it;
+    }
+    ++pairManifolds.step;
+    return 0;
+}
+
+ConvexSupport ConvexHullIntersection::getSupport(ConvexHull& hull, SReal margin)
+{
+    const ConvexHullModel* model = hull.getCollisionModel();
+    const auto& vertices = model->hullVertices();
+    return ConvexSupport(vertices.data(), vertices.size(), hull.center(), hull.orientation(), &model->hullNeighbors(), margin);
+}
+
+int ConvexHullIntersection::intersectSupport(const ConvexSupport& first, sofa::core::CollisionElementIterator e1, ConvexHull& e2,
+                                             OutputVector* contacts, const sofa::core::collision::Intersection* intersection)
+{
+    const SReal alarmDist = intersection->getAlarmDistance() + e1.getProximity() + e2.getProximity();
+    const SReal contactDist = intersection->getContactDistance() + e1.getProximity() + e2.getProximity();
+
+    const ConvexSupport second = getSupport(e2);
+    IntrConvexHull intr(first, second);
+    intr.Find();
+    if (intr.distance() >= alarmDist)
+        return 0;
+
+    contacts->resize(contacts->size() + 1);
+    DetectionOutput* detection = &*(contacts->end() - 1);
+    detection->elem = std::pair<sofa::core::CollisionElementIterator, sofa::core::CollisionElementIterator>(e1, e2);
+    detection->id = e1.getIndex() * e2.getCollisionModel()->getSize() + e2.getIndex();
+    detection->normal = intr.separatingAxis();
+    detection->point[0] = intr.pointOnFirst();
+    detection->point[1] = intr.pointOnSecond();
+    detection->value = intr.distance() - contactDist;
+
+    return 1;
+}
+
+int ConvexHullIntersection::computeIntersection(Sphere& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection)
+{
+    const Coord center = e1.center();
+    return intersectSupport(ConvexSupport(&center, 1, e1.r()), e1, e2, contacts, intersection);
+}
+
+int ConvexHullIntersection::computeIntersection(RigidSphere& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection)
+{
+    const Coord center = e1.center();
+    return intersectSupport(ConvexSupport(&center, 1, e1.r()), e1, e2, contacts, intersection);
+}
+
+int ConvexHullIntersection::computeIntersection(Point& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection)
+{
+    const Coord point = e1.p();
+    return intersectSupport(ConvexSupport(&point, 1), e1, e2, contacts, intersection);
+}
+
+int ConvexHullIntersection::computeIntersection(Line& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection)
+{
+    const Coord vertices[2] = { e1.p1(), e1.p2() };
+    return intersectSupport(ConvexSupport(vertices, 2), e1, e2, contacts, intersection);
+}
+
+int ConvexHullIntersection::computeIntersection(Triangle& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection)
+{
+    const Coord vertices[3] = { e1.p1(), e1.p2(), e1.p3() };
+    return intersectSupport(ConvexSupport(vertices, 3), e1, e2, contacts, intersection);
+}
+
+int ConvexHullIntersection::computeIntersection(ConvexHull& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection)
+{
+    const SReal alarmDist = intersection->getAlarmDistance() + e1.getProximity() + e2.getProximity();
+    const SReal contactDist = intersection->getContactDistance() + e1.getProximity() + e2.getProximity();
+    const ConvexHullModel* model1 = e1.getCollisionModel();
+    const ConvexHullModel* model2 = e2.getCollisionModel();
+
+    ModelPairManifolds& pairManifolds = getModelPairManifolds(model1, model2);
+    Manifold& manifold = pairManifolds.manifolds[std::make_pair(e1.getIndex(), e2.getIndex())];
+    manifold.lastStep = pairManifolds.step;
+
+    // The query starts from the result of the previous time step
+    const ConvexSupport first = getSupport(e1);
+    const ConvexSupport second = getSupport(e2);
+    first.hint = manifold.firstHint;
+    second.hint = manifold.secondHint;
+
+    IntrConvexHull intr(first, second);
+    intr.Find(manifold.separatingAxis);
+    manifold.separatingAxis = intr.separatingAxis();
+    manifold.firstHint = first.hint;
+    manifold.secondHint = second.hint;
+
+    if (intr.distance() >= alarmDist)
+    {
+        manifold.points.clear();
+        return 0;
+    }
+
+    const Coord& normal = intr.separatingAxis();
+    const SReal breakingDist = std::max(alarmDist, BreakingRatio * std::min(model1->hullRadius(), model2->hullRadius()));
+    const unsigned int maxPoints = std::max(1u, std::min(model1->d_maxManifoldPoints.getValue(), model2->d_maxManifoldPoints.getValue()));
+
+    // The points of the previous time steps which moved apart, or slid tangentially, are removed
+    const auto isBroken = [&](const ManifoldPoint& point)
+    {
+        const Coord gap = e2.generalCoordinates(point.localSecond) - e1.generalCoordinates(point.localFirst);
+        const SReal distance = gap * normal;
+        return distance >= alarmDist || (gap - normal * distance).norm2() > breakingDist * breakingDist;
+    };
+    manifold.points.erase(std::remove_if(manifold.points.begin(), manifold.points.end(), isBroken), manifold.points.end());
+
+    // The new point replaces the closest point of the manifold, if it is close enough, and takes its id
+    ManifoldPoint newPoint;
+    newPoint.localFirst = e1.orientation().inverseRotate(intr.pointOnFirst() - e1.center());
+    newPoint.localSecond = e2.orientation().inverseRotate(intr.pointOnSecond() - e2.center());
+
+    auto replaced = manifold.points.end();
+    SReal closestDistance2 = breakingDist * breakingDist;
+    for (auto it = manifold.points.begin(); it != manifold.points.end(); ++it)
+    {
+        const SReal distance2 = (e1.generalCoordinates(it->localFirst) - intr.pointOnFirst()).norm2();
+        if (distance2 <= closestDistance2)
+        {
+            closestDistance2 = distance2;
+            replaced = it;
+        }
+    }
+    if (replaced != manifold.points.end())
+    {
+        newPoint.slot = replaced->slot;
+        *replaced = newPoint;
+    }
+    else
+    {
+        const auto isUsed = [&manifold](unsigned int slot)
+        {
+            return std::any_of(manifold.points.begin(), manifold.points.end(), [slot](const ManifoldPoint& point) { return point.slot == slot; });
+        };
+        while (isUsed(newPoint.slot))
+            ++newPoint.slot;
+        manifold.points.push_back(newPoint);
+    }
+
+    if (manifold.points.size() > maxPoints)
+    {
+        reduceManifold(manifold, e1, e2, normal, maxPoints);
+    }
+
+    // The slots of the points go up to maxPoints, as a new point is added before the manifold is reduced
+    const DetectionOutput::ContactId pairId = e1.getIndex() * model2->getSize() + e2.getIndex();
+    const auto nbSlots = maxPoints + 1;
+    for (const auto& point : manifold.points)
+    {
+        const Coord p = e1.generalCoordinates(point.localFirst);
+        const Coord q = e2.generalCoordinates(point.localSecond);
+
+        contacts->resize(contacts->size() + 1);
+        DetectionOutput* detection = &*(contacts->end() - 1);
+        detection->elem = std::pair<sofa::core::CollisionElementIterator, sofa::core::CollisionElementIterator>(e1, e2);
+        detection->id = pairId * nbSlots + point.slot;
+        detection->normal = normal;
+        detection->point[0] = p;
+        detection->point[1] = q;
+        detection->value = (q - p) * normal - contactDist;
+    }
+
+    return static_cast<int>(manifold.points.size());
+}
+
+void ConvexHullIntersection::reduceManifold(Manifold& manifold, ConvexHull& e1, ConvexHull& e2, const Coord& normal, unsigned int maxPoints)
+{
+    const auto nbPoints = manifold.points.size();
+    sofa::type::vector<Coord> positions(nbPoints);
+    std::size_t deepest = 0;
+    SReal deepestDistance = std::numeric_limits<SReal>::max();
+    for (std::size_t i = 0; i < nbPoints; ++i)
+    {
+        positions[i] = e1.generalCoordinates(manifold.points[i].localFirst);
+        const SReal distance = (e2.generalCoordinates(manifold.points[i].localSecond) - positions[i]) * normal;
+        if (distance < deepestDistance)
+        {
+            deepestDistance = distance;
+            deepest = i;
+        }
+    }
+
+    // Each next point is the furthest, in the contact plane, from the points already kept
+    sofa::type::vector<SReal> distance2ToKept(nbPoints, std::numeric_limits<SReal>::max());
+    sofa::type::vector<std::size_t> kept { deepest };
+    while (kept.size() < maxPoints)
+    {
+        const std::size_t last = kept.back();
+        distance2ToKept[last] = -1;
+        std::size_t furthest = last;
+        for (std::size_t i = 0; i < nbPoints; ++i)
+        {
+            if (distance2ToKept[i] < 0)
+                continue;
+            Coord gap = positions[i] - positions[last];
+            gap -= normal * (gap * normal);
+            distance2ToKept[i] = std::min(distance2ToKept[i], gap.norm2());
+            if (furthest == last || distance2ToKept[i] > distance2ToKept[furthest])
+                furthest = i;
+        }
+        kept.push_back(furthest);
+    }
+
+    std::sort(kept.begin(), kept.end());
+    sofa::type::vector<ManifoldPoint> points;
+    points.reserve(kept.size());
+    for (const auto i : kept)
+    {
+        points.push_back(manifold.points[i]);
+    }
+    manifold.points.swap(points);
+}
+
+} // namespace collisionobbcapsule::detection::intersection
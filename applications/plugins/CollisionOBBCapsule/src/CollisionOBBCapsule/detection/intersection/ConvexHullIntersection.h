@@ -0,0 +1,127 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <CollisionOBBCapsule/config.h>
+
+#include <sofa/core/collision/Intersection.h>
+
+#include <sofa/component/collision/detection/intersection/BaseProximityIntersection.h>
+#include <sofa/component/collision/geometry/LineModel.h>
+#include <sofa/component/collision/geometry/PointModel.h>
+#include <sofa/component/collision/geometry/SphereModel.h>
+#include <sofa/component/collision/geometry/TriangleModel.h>
+#include <CollisionOBBCapsule/geometry/ConvexHullModel.h>
+#include <CollisionOBBCapsule/detection/intersection/IntrConvexHull.h>
+
+#include <map>
+#include <mutex>
+
+namespace collisionobbcapsule::detection::intersection
+{
+using sofa::component::collision::detection::intersection::BaseProximityIntersection;
+using collisionobbcapsule::geometry::ConvexHull;
+using collisionobbcapsule::geometry::ConvexHullCollisionModel;
+
+/**
+  *Intersections of convex hulls with convex hulls, spheres and mesh primitives, for the
+  *proximity intersection methods (NewProximityIntersection and LocalMinDistance).
+  *
+  *The distance between two elements is computed with the GJK algorithm, and their penetration
+  *with the EPA algorithm, which give a single contact point per pair of elements. Between two
+  *hulls, the contact points of the previous time steps are kept in a contact manifold, expressed
+  *in the local frames of both hulls, as long as they stay in contact: a box resting on a hull
+  *gets its 4 corners in contact after a few time steps. The manifold points keep their contact
+  *id from a time step to the next one.
+  */
+class COLLISIONOBBCAPSULE_API ConvexHullIntersection : public sofa::core::collision::BaseIntersector
+{
+    typedef BaseProximityIntersection::OutputVector OutputVector;
+    typedef sofa::type::Vec3 Coord;
+
+public:
+    ConvexHullIntersection(BaseProximityIntersection* intersection);
+
+    using BaseIntersector::beginIntersection;
+
+    /// Removes the contact manifolds between the hulls of the two models which were not updated at the previous time step
+    int beginIntersection(ConvexHullCollisionModel<sofa::defaulttype::Rigid3Types>* model1, ConvexHullCollisionModel<sofa::defaulttype::Rigid3Types>* model2, OutputVector* contacts);
+
+    template <class Elem1, class Elem2>
+    bool testIntersection(Elem1&, Elem2&, const sofa::core::collision::Intersection*) {
+        return true;
+    }
+
+    int computeIntersection(ConvexHull& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection);
+    int computeIntersection(sofa::component::collision::geometry::Sphere& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection);
+    int computeIntersection(sofa::component::collision::geometry::RigidSphere& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection);
+    int computeIntersection(sofa::component::collision::geometry::Point& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection);
+    int computeIntersection(sofa::component::collision::geometry::Line& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection);
+    int computeIntersection(sofa::component::collision::geometry::Triangle& e1, ConvexHull& e2, OutputVector* contacts, const sofa::core::collision::Intersection* intersection);
+
+    /// Ratio of the size of the smallest hull under which the contact points of a manifold which slide tangentially
+    /// are kept, and a new contact point replaces an existing one
+    static constexpr SReal BreakingRatio = 0.02;
+
+protected:
+    /// Contact point between two hulls, in their local frames
+    struct ManifoldPoint
+    {
+        Coord localFirst;
+        Coord localSecond;
+        unsigned int slot { 0 };
+    };
+
+    /// Contact points between two hulls, and the state of the last distance query between them
+    struct Manifold
+    {
+        sofa::type::vector<ManifoldPoint> points;
+        Coord separatingAxis;
+        sofa::Index firstHint { 0 };
+        sofa::Index secondHint { 0 };
+        unsigned int lastStep { 0 };
+    };
+
+    /// Contact manifolds between the hulls of two models, by pair of element indices
+    struct ModelPairManifolds
+    {
+        std::map<std::pair<sofa::Index, sofa::Index>, Manifold> manifolds;
+        unsigned int step { 0 };
+    };
+
+    /// Convex support of a hull, positioned with its frame
+    static ConvexSupport getSupport(ConvexHull& hull, SReal margin = 0);
+
+    /// Computes the intersection between a convex shape given by its support and a hull, without any manifold
+    static int intersectSupport(const ConvexSupport& first, sofa::core::CollisionElementIterator e1, ConvexHull& e2,
+                                OutputVector* contacts, const sofa::core::collision::Intersection* intersection);
+
+    /// Keeps the most spread out points of the manifold, the deepest one first
+    static void reduceManifold(Manifold& manifold, ConvexHull& e1, ConvexHull& e2, const Coord& normal, unsigned int maxPoints);
+
+    ModelPairManifolds& getModelPairManifolds(const sofa::core::CollisionModel* model1, const sofa::core::CollisionModel* model2);
+
+    /// The model pairs are processed concurrently by the parallel narrow phases, but the pairs of elements of a model pair are not
+    std::map<std::pair<const sofa::core::CollisionModel*, const sofa::core::CollisionModel*>, ModelPairManifolds> m_manifolds;
+    std::mutex m_manifoldsMutex;
+};
+
+} // namespace collisionobbcapsule::detection::intersection
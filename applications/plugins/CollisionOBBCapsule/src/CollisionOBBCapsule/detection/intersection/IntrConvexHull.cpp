@@ -0,0 +1,555 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <CollisionOBBCapsule/detection/intersection/IntrConvexHull.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <vector>
+
+namespace collisionobbcapsule::detection::intersection
+{
+
+typedef ConvexSupport::Coord Coord;
+
+namespace
+{
+
+/// Squared relative progress of an iteration of GJK under which the closest point is found
+constexpr SReal GJKRelativeTolerance = 1e-10;
+
+/// Squared norm of a point of the Minkowski difference, relative to its size, under which the point is the origin
+constexpr SReal AbsoluteTolerance = 1e-16;
+
+/// Progress of an iteration of EPA, relative to the size of the Minkowski difference, under which the
+/// closest face is found
+constexpr SReal EPARelativeTolerance = 1e-8;
+
+/// Barycentric coordinates of the point of the segment [a, b] closest to the origin
+void closestOnSegment(const Coord& a, const Coord& b, SReal* lambda)
+{
+    const Coord ab = b - a;
+    const SReal ab2 = ab.norm2();
+    const SReal t = ab2 > 0 ? std::clamp(-(a * ab) / ab2, SReal(0), SReal(1)) : SReal(0);
+    lambda[0] = 1 - t;
+    lambda[1] = t;
+}
+
+/// Barycentric coordinates of the point of the triangle (a, b, c) closest to the origin,
+/// from "Real-Time Collision Detection" (C. Ericson)
+void closestOnTriangle(const Coord& a, const Coord& b, const Coord& c, SReal* lambda)
+{
+    const Coord ab = b - a;
+    const Coord ac = c - a;
+
+    const SReal d1 = -(ab * a);
+    const SReal d2 = -(ac * a);
+    if (d1 <= 0 && d2 <= 0)
+    {
+        lambda[0] = 1; lambda[1] = 0; lambda[2] = 0;
+        return;
+    }
+
+    const SReal d3 = -(ab * b);
+    const SReal d4 = -(ac * b);
+    if (d3 >= 0 && d4 <= d3)
+    {
+        lambda[0] = 0; lambda[1] = 1; lambda[2] = 0;
+        return;
+    }
+
+    const SReal vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0)
+    {
+        const SReal v = d1 / (d1 - d3);
+        lambda[0] = 1 - v; lambda[1] = v; lambda[2] = 0;
+        return;
+    }
+
+    const SReal d5 = -(ab * c);
+    const SReal d6 = -(ac * c);
+    if (d6 >= 0 && d5 <= d6)
+    {
+        lambda[0] = 0; lambda[1] = 0; lambda[2] = 1;
+        return;
+    }
+
+    const SReal vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0)
+    {
+        const SReal w = d2 / (d2 - d6);
+        lambda[0] = 1 - w; lambda[1] = 0; lambda[2] = w;
+        return;
+    }
+
+    const SReal va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+    {
+        const SReal w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        lambda[0] = 0; lambda[1] = 1 - w; lambda[2] = w;
+        return;
+    }
+
+    const SReal sum = va + vb + vc;
+    if (sum <= 0)
+    {
+        // Degenerate triangle: its closest point is on its longest edge
+        closestOnSegment(a, b, lambda);
+        lambda[2] = 0;
+        return;
+    }
+    lambda[1] = vb / sum;
+    lambda[2] = vc / sum;
+    lambda[0] = 1 - lambda[1] - lambda[2];
+}
+
+/// Barycentric coordinates of a point of the plane of the triangle (a, b, c)
+void barycentricCoordinates(const Coord& p, const Coord& a, const Coord& b, const Coord& c, SReal* lambda)
+{
+    const Coord v0 = b - a, v1 = c - a, v2 = p - a;
+    const SReal d00 = v0 * v0, d01 = v0 * v1, d11 = v1 * v1, d20 = v2 * v0, d21 = v2 * v1;
+    const SReal denominator = d00 * d11 - d01 * d01;
+    if (denominator <= std::numeric_limits<SReal>::min())
+    {
+        lambda[0] = 1; lambda[1] = 0; lambda[2] = 0;
+        return;
+    }
+    lambda[1] = (d11 * d20 - d01 * d21) / denominator;
+    lambda[2] = (d00 * d21 - d01 * d20) / denominator;
+    lambda[0] = 1 - lambda[1] - lambda[2];
+}
+
+} // namespace
+
+ConvexSupport::ConvexSupport(const Coord* vertices, sofa::Size nbVertices, SReal margin)
+    : m_vertices(vertices)
+    , m_nbVertices(nbVertices)
+    , m_margin(margin)
+{}
+
+ConvexSupport::ConvexSupport(const Coord* vertices, sofa::Size nbVertices, const Coord& translation, const Quaternion& rotation,
+                             const VecNeighbors* neighbors, SReal margin)
+    : m_vertices(vertices)
+    , m_nbVertices(nbVertices)
+    , m_translation(translation)
+    , m_rotation(rotation)
+    , m_isRigid(true)
+    , m_neighbors(neighbors)
+    , m_margin(margin)
+{}
+
+Coord ConvexSupport::support(const Coord& direction) const
+{
+    const Coord localDirection = m_isRigid ? m_rotation.inverseRotate(direction) : direction;
+
+    sofa::Index best = hint < m_nbVertices ? hint : 0;
+    SReal bestDot = m_vertices[best] * localDirection;
+    if (m_neighbors != nullptr && m_neighbors->size() == m_nbVertices)
+    {
+        // On a convex hull, a vertex which is not further than its neighbors is the furthest one
+        bool improved = true;
+        while (improved)
+        {
+            improved = false;
+            for (const auto neighbor : (*m_neighbors)[best])
+            {
+                const SReal dot = m_vertices[neighbor] * localDirection;
+                if (dot > bestDot)
+                {
+                    bestDot = dot;
+                    best = neighbor;
+                    improved = true;
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        for (sofa::Index i = 0; i < m_nbVertices; ++i)
+        {
+            const SReal dot = m_vertices[i] * localDirection;
+            if (dot > bestDot)
+            {
+                bestDot = dot;
+                best = i;
+            }
+        }
+    }
+
+    hint = best;
+    return m_isRigid ? m_rotation.rotate(m_vertices[best]) + m_translation : m_vertices[best];
+}
+
+Coord ConvexSupport::vertex() const
+{
+    return m_isRigid ? m_rotation.rotate(m_vertices[0]) + m_translation : m_vertices[0];
+}
+
+IntrConvexHull::IntrConvexHull(const ConvexSupport& first, const ConvexSupport& second)
+    : m_first(first)
+    , m_second(second)
+{
+    _is_colliding = false;
+    mContactTime = 0;
+}
+
+IntrConvexHull::Vertex IntrConvexHull::supportVertex(const Coord& direction) const
+{
+    Vertex vertex;
+    vertex.a = m_first.support(direction);
+    vertex.b = m_second.support(-direction);
+    vertex.w = vertex.a - vertex.b;
+    return vertex;
+}
+
+bool IntrConvexHull::Find(const Coord& initialDirection)
+{
+    // The closest point of the Minkowski difference to the origin is opposite to the separating axis
+    Coord direction = initialDirection;
+    if (direction.norm2() == 0)
+        direction = m_second.vertex() - m_first.vertex();
+    if (direction.norm2() == 0)
+        direction = Coord(1, 0, 0);
+
+    m_simplex[0] = supportVertex(direction);
+    m_barycentric[0] = 1;
+    m_simplexSize = 1;
+
+    Coord closest = m_simplex[0].w;
+    SReal scale2 = std::max(closest.norm2(), (m_first.vertex() - m_second.vertex()).norm2());
+    bool converged = false;
+    for (unsigned int iteration = 0; iteration < MaxIterations && !converged; ++iteration)
+    {
+        const SReal closest2 = closest.norm2();
+        if (closest2 <= AbsoluteTolerance * scale2)
+        {
+            // The cores of the shapes touch or intersect
+            return penetration();
+        }
+
+        const Vertex vertex = supportVertex(-closest);
+        scale2 = std::max(scale2, vertex.w.norm2());
+
+        // No progress toward the origin: the closest point of the Minkowski difference is found
+        if (closest2 - closest * vertex.w <= GJKRelativeTolerance * closest2)
+        {
+            converged = true;
+            break;
+        }
+        for (unsigned int i = 0; i < m_simplexSize; ++i)
+        {
+            if ((m_simplex[i].w - vertex.w).norm2() <= AbsoluteTolerance * scale2)
+                converged = true;
+        }
+        if (converged)
+            break;
+
+        m_simplex[m_simplexSize++] = vertex;
+        if (!closestOnSimplex(closest))
+        {
+            // The origin is inside the tetrahedron
+            return penetration();
+        }
+    }
+
+    Coord a, b;
+    for (unsigned int i = 0; i < m_simplexSize; ++i)
+    {
+        a += m_simplex[i].a * m_barycentric[i];
+        b += m_simplex[i].b * m_barycentric[i];
+    }
+    const SReal coreDistance = closest.norm();
+    setResult(coreDistance, -closest / coreDistance, a, b);
+
+    return converged;
+}
+
+bool IntrConvexHull::closestOnSimplex(Coord& closest)
+{
+    unsigned int indices[3] = { 0, 1, 2 };
+    SReal lambda[3] = { 1, 0, 0 };
+    unsigned int nbIndices = m_simplexSize;
+
+    if (m_simplexSize == 2)
+    {
+        closestOnSegment(m_simplex[0].w, m_simplex[1].w, lambda);
+    }
+    else if (m_simplexSize == 3)
+    {
+        closestOnTriangle(m_simplex[0].w, m_simplex[1].w, m_simplex[2].w, lambda);
+    }
+    else if (m_simplexSize == 4)
+    {
+        // The closest point is on a face which separates the origin from the opposite vertex
+        static constexpr unsigned int faces[4][4] = { { 1, 2, 3, 0 }, { 0, 2, 3, 1 }, { 0, 1, 3, 2 }, { 0, 1, 2, 3 } };
+        SReal bestDistance2 = std::numeric_limits<SReal>::max();
+        bool outside = false;
+        for (const auto& face : faces)
+        {
+            const Coord& p0 = m_simplex[face[0]].w;
+            const Coord& p1 = m_simplex[face[1]].w;
+            const Coord& p2 = m_simplex[face[2]].w;
+            const Coord normal = (p1 - p0).cross(p2 - p0);
+            const SReal originSide = -(normal * p0);
+            const SReal oppositeSide = normal * (m_simplex[face[3]].w - p0);
+            if (originSide * oppositeSide > 0)
+                continue;
+
+            outside = true;
+            SReal faceLambda[3];
+            closestOnTriangle(p0, p1, p2, faceLambda);
+            const SReal distance2 = (p0 * faceLambda[0] + p1 * faceLambda[1] + p2 * faceLambda[2]).norm2();
+            if (distance2 < bestDistance2)
+            {
+                bestDistance2 = distance2;
+                std::copy(face, face + 3, indices);
+                std::copy(faceLambda, faceLambda + 3, lambda);
+            }
+        }
+        if (!outside)
+            return false;
+        nbIndices = 3;
+    }
+
+    // Only the vertices of the closest feature are kept
+    std::array<Vertex, 4> simplex;
+    unsigned int size = 0;
+    closest = Coord();
+    for (unsigned int i = 0; i < nbIndices; ++i)
+    {
+        if (lambda[i] > 0)
+        {
+            simplex[size] = m_simplex[indices[i]];
+            m_barycentric[size] = lambda[i];
+            closest += simplex[size].w * lambda[i];
+            ++size;
+        }
+    }
+    m_simplex = simplex;
+    m_simplexSize = size;
+
+    return true;
+}
+
+bool IntrConvexHull::penetration()
+{
+    std::vector<Vertex> vertices(m_simplex.begin(), m_simplex.begin() + m_simplexSize);
+
+    SReal scale2 = (m_first.vertex() - m_second.vertex()).norm2();
+    for (const auto& vertex : vertices)
+    {
+        scale2 = std::max(scale2, vertex.w.norm2());
+    }
+    const SReal tolerance2 = AbsoluteTolerance * std::max(scale2, std::numeric_limits<SReal>::min());
+
+    // The simplex found by GJK is blown up to a tetrahedron
+    static const Coord axes[6] = { Coord(1, 0, 0), Coord(-1, 0, 0), Coord(0, 1, 0), Coord(0, -1, 0), Coord(0, 0, 1), Coord(0, 0, -1) };
+    if (vertices.size() == 1)
+    {
+        for (const auto& axis : axes)
+        {
+            const Vertex vertex = supportVertex(axis);
+            if ((vertex.w - vertices[0].w).norm2() > tolerance2)
+            {
+                vertices.push_back(vertex);
+                break;
+            }
+        }
+    }
+    if (vertices.size() == 2)
+    {
+        const Coord line = vertices[1].w - vertices[0].w;
+        unsigned int smallest = 0;
+        for (unsigned int c = 1; c < 3; ++c)
+        {
+            if (std::abs(line[c]) < std::abs(line[smallest]))
+                smallest = c;
+        }
+        const Coord u = line.cross(axes[2 * smallest]);
+        const Coord v = line.cross(u);
+        for (const Coord& direction : { u, v, -u, -v })
+        {
+            const Vertex vertex = supportVertex(direction);
+            if (line.cross(vertex.w - vertices[0].w).norm2() > tolerance2 * line.norm2())
+            {
+                vertices.push_back(vertex);
+                break;
+            }
+        }
+    }
+    if (vertices.size() == 3)
+    {
+        const Coord normal = (vertices[1].w - vertices[0].w).cross(vertices[2].w - vertices[0].w);
+        for (const Coord& direction : { normal, -normal })
+        {
+            const Vertex vertex = supportVertex(direction);
+            const SReal height = normal * (vertex.w - vertices[0].w);
+            if (height * height > tolerance2 * normal.norm2())
+            {
+                vertices.push_back(vertex);
+                break;
+            }
+        }
+    }
+    if (vertices.size() < 4)
+    {
+        // The Minkowski difference is flat: the cores touch without penetration
+        Coord a, b;
+        for (unsigned int i = 0; i < m_simplexSize; ++i)
+        {
+            a += m_simplex[i].a * m_barycentric[i];
+            b += m_simplex[i].b * m_barycentric[i];
+        }
+        Coord normal = m_second.vertex() - m_first.vertex();
+        if (normal.norm2() == 0)
+            normal = Coord(1, 0, 0);
+        setResult(0, normal.normalized(), a, b);
+        return true;
+    }
+
+    struct Face
+    {
+        unsigned int v[3];
+        Coord normal;
+        SReal distance;
+    };
+
+    const Coord inside = (vertices[0].w + vertices[1].w + vertices[2].w + vertices[3].w) * SReal(0.25);
+    std::vector<Face> faces;
+    const auto addFace = [&vertices, &faces, &inside](unsigned int a, unsigned int b, unsigned int c)
+    {
+        Face face { { a, b, c }, (vertices[b].w - vertices[a].w).cross(vertices[c].w - vertices[a].w), 0 };
+        if (face.normal * (inside - vertices[a].w) > 0)
+        {
+            std::swap(face.v[1], face.v[2]);
+            face.normal = -face.normal;
+        }
+        const SReal norm = face.normal.norm();
+        if (norm <= std::numeric_limits<SReal>::min())
+            return;
+        face.normal /= norm;
+        face.distance = face.normal * vertices[a].w;
+        faces.push_back(face);
+    };
+
+    addFace(0, 1, 2);
+    addFace(0, 1, 3);
+    addFace(0, 2, 3);
+    addFace(1, 2, 3);
+
+    const SReal tolerance = EPARelativeTolerance * std::sqrt(scale2);
+    std::set<std::pair<unsigned int, unsigned int> > visibleEdges;
+    bool converged = false;
+    std::size_t closestFace = 0;
+    for (unsigned int iteration = 0; iteration < MaxIterations && !faces.empty(); ++iteration)
+    {
+        closestFace = 0;
+        for (std::size_t f = 1; f < faces.size(); ++f)
+        {
+            if (faces[f].distance < faces[closestFace].distance)
+                closestFace = f;
+        }
+
+        const Face face = faces[closestFace];
+        const Vertex vertex = supportVertex(face.normal);
+        if (vertex.w * face.normal - face.distance <= tolerance)
+        {
+            converged = true;
+            break;
+        }
+
+        // The faces seen from the new vertex are replaced by the cone joining it to their boundary
+        const auto newVertex = static_cast<unsigned int>(vertices.size());
+        vertices.push_back(vertex);
+        visibleEdges.clear();
+        std::vector<Face> remainingFaces;
+        remainingFaces.reserve(faces.size());
+        for (const auto& f : faces)
+        {
+            if (f.normal * (vertex.w - vertices[f.v[0]].w) > tolerance)
+            {
+                for (unsigned int j = 0; j < 3; ++j)
+                {
+                    visibleEdges.emplace(f.v[j], f.v[(j + 1) % 3]);
+                }
+            }
+            else
+            {
+                remainingFaces.push_back(f);
+            }
+        }
+        if (visibleEdges.empty())
+        {
+            converged = true;
+            break;
+        }
+        faces.swap(remainingFaces);
+        for (const auto& [a, b] : visibleEdges)
+        {
+            if (visibleEdges.find({ b, a }) == visibleEdges.end())
+            {
+                addFace(a, b, newVertex);
+            }
+        }
+        closestFace = 0;
+    }
+
+    if (faces.empty())
+        return false;
+
+    if (!converged)
+    {
+        closestFace = 0;
+        for (std::size_t f = 1; f < faces.size(); ++f)
+        {
+            if (faces[f].distance < faces[closestFace].distance)
+                closestFace = f;
+        }
+    }
+
+    const Face& face = faces[closestFace];
+    SReal lambda[3];
+    barycentricCoordinates(face.normal * face.distance,
+                           vertices[face.v[0]].w, vertices[face.v[1]].w, vertices[face.v[2]].w, lambda);
+    Coord a, b;
+    for (unsigned int j = 0; j < 3; ++j)
+    {
+        a += vertices[face.v[j]].a * lambda[j];
+        b += vertices[face.v[j]].b * lambda[j];
+    }
+    setResult(-face.distance, face.normal, a, b);
+
+    return converged;
+}
+
+void IntrConvexHull::setResult(SReal coreDistance, const Coord& normal, const Coord& a, const Coord& b)
+{
+    m_distance = coreDistance - m_first.margin() - m_second.margin();
+    _sep_axis = normal;
+    _pt_on_first = a + normal * m_first.margin();
+    _pt_on_second = b - normal * m_second.margin();
+    _is_colliding = m_distance < 0;
+}
+
+} // namespace collisionobbcapsule::detection::intersection
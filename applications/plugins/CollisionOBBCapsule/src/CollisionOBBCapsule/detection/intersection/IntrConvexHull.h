@@ -0,0 +1,143 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <CollisionOBBCapsule/config.h>
+
+#include <CollisionOBBCapsule/detection/intersection/Intersector.h>
+#include <sofa/type/Quat.h>
+#include <sofa/type/vector.h>
+
+#include <array>
+
+namespace collisionobbcapsule::detection::intersection
+{
+
+/**
+  *A convex shape seen through its support mapping: the convex hull of a set of vertices given
+  *in a rigid frame, inflated by a margin. A point is a shape of one vertex, a sphere is a point
+  *with a margin, a segment or a triangle are shapes of 2 or 3 vertices.
+  */
+class COLLISIONOBBCAPSULE_API ConvexSupport
+{
+public:
+    typedef sofa::type::Vec3 Coord;
+    typedef sofa::type::Quat<SReal> Quaternion;
+    typedef sofa::type::vector<sofa::type::vector<sofa::Index> > VecNeighbors;
+
+    /**
+      *Shape whose vertices are given in the general coordinate system.
+      */
+    ConvexSupport(const Coord* vertices, sofa::Size nbVertices, SReal margin = 0);
+
+    /**
+      *Shape whose vertices are given in a rigid frame. If the neighbors of each vertex along the
+      *edges of the hull are given, the support point is found by hill climbing from the last one.
+      */
+    ConvexSupport(const Coord* vertices, sofa::Size nbVertices, const Coord& translation, const Quaternion& rotation,
+                  const VecNeighbors* neighbors = nullptr, SReal margin = 0);
+
+    /**
+      *Returns the vertex furthest along the direction, in the general coordinate system, without the margin.
+      */
+    Coord support(const Coord& direction)const;
+
+    /**
+      *Returns a vertex of the shape, in the general coordinate system.
+      */
+    Coord vertex()const;
+
+    SReal margin()const { return m_margin; }
+
+    /**
+      *Index of the last support vertex, from which the next hill climbing starts. It can be kept
+      *from a query to the next one between the same shapes.
+      */
+    mutable sofa::Index hint { 0 };
+
+private:
+    const Coord* m_vertices { nullptr };
+    sofa::Size m_nbVertices { 0 };
+    Coord m_translation;
+    Quaternion m_rotation;
+    bool m_isRigid { false };
+    const VecNeighbors* m_neighbors { nullptr };
+    SReal m_margin { 0 };
+};
+
+/**
+  *Distance between two convex shapes computed with the GJK algorithm, and penetration of the
+  *shapes computed with the EPA algorithm when their cores (the shapes without their margins)
+  *intersect.
+  *
+  *The separating axis is a unit vector pointing outward from the first shape, toward the second
+  *one, and the points on both shapes are on their surface, including the margins.
+  */
+class COLLISIONOBBCAPSULE_API IntrConvexHull : public Intersector<SReal>
+{
+public:
+    typedef sofa::type::Vec3 Coord;
+
+    IntrConvexHull(const ConvexSupport& first, const ConvexSupport& second);
+
+    /**
+      *Computes the distance, or the penetration, of the shapes. The search starts along the given
+      *direction if it is not null, typically the separating axis of a previous query between the
+      *same shapes. Returns false if the algorithms did not converge, in which case the result is
+      *the best approximation found.
+      */
+    bool Find(const Coord& initialDirection = Coord());
+
+    /**
+      *Signed distance between the shapes, including the margins: negative if they intersect.
+      */
+    SReal distance()const { return m_distance; }
+
+    static constexpr unsigned int MaxIterations = 64;
+
+private:
+    /// Point of the Minkowski difference of the cores of the shapes, with the support points which define it
+    struct Vertex
+    {
+        Coord w, a, b;
+    };
+
+    Vertex supportVertex(const Coord& direction)const;
+
+    /// Reduces the simplex to the smallest sub-simplex containing the point closest to the origin, and
+    /// returns this point. Returns false if the origin is inside the tetrahedron.
+    bool closestOnSimplex(Coord& closest);
+
+    bool penetration();
+
+    void setResult(SReal coreDistance, const Coord& normal, const Coord& a, const Coord& b);
+
+    const ConvexSupport& m_first;
+    const ConvexSupport& m_second;
+
+    std::array<Vertex, 4> m_simplex;
+    std::array<SReal, 4> m_barycentric;
+    unsigned int m_simplexSize { 0 };
+
+    SReal m_distance { 0 };
+};
+
+} // namespace collisionobbcapsule::detection::intersection
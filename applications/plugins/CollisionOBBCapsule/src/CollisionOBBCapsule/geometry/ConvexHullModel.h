@@ -0,0 +1,231 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <CollisionOBBCapsule/config.h>
+
+#include <sofa/core/behavior/MechanicalState.h>
+#include <sofa/core/CollisionModel.h>
+#include <sofa/defaulttype/RigidTypes.h>
+#include <sofa/type/fixed_array.h>
+
+namespace collisionobbcapsule::geometry
+{
+
+using namespace sofa;
+
+template<class DataTypes>
+class ConvexHullCollisionModel;
+
+/**
+  *A convex hull attached to a frame of a rigid mechanical object. All the hulls of a
+  *ConvexHullCollisionModel share the same shape, given in the local frame of the rigid.
+  */
+template<class TDataTypes>
+class TConvexHull : public core::TCollisionElementIterator< ConvexHullCollisionModel<TDataTypes> >
+{
+public:
+    typedef TDataTypes DataTypes;
+    typedef typename DataTypes::Real Real;
+    typedef typename DataTypes::Coord::Pos Coord;
+    typedef typename DataTypes::Quat Quaternion;
+
+    typedef ConvexHullCollisionModel<DataTypes> ParentModel;
+
+    using Index = sofa::Index;
+
+    TConvexHull(ParentModel* model, Index index);
+
+    explicit TConvexHull(const core::CollisionElementIterator& i);
+
+    const Coord & center()const;
+
+    /**
+      *Returns the quaternion representing the rotation of the local frame.
+      */
+    const Quaternion & orientation()const;
+
+    /**
+      *Returns the coordinates of c (in the local frame) in the general coordinate system.
+      */
+    Coord generalCoordinates(const Coord &c)const;
+};
+
+using ConvexHull = TConvexHull<sofa::defaulttype::Rigid3Types>;
+
+
+/**
+  *A convex hull model is a set of convex hulls, one per frame of a rigid mechanical object.
+  *The hull is computed at init from a set of points given in the local frame of the rigid,
+  *typically the positions of a mesh loader. It is meant to replace a rigid tool approximated
+  *by many spheres or triangles: the intersection of two hulls, computed with the GJK and EPA
+  *algorithms, gives at most one contact point per pair of hulls and per time step, and the
+  *contact points of the previous time steps are kept in a contact manifold.
+  */
+template< class TDataTypes>
+class ConvexHullCollisionModel : public core::CollisionModel
+{
+public:
+    SOFA_CLASS(SOFA_TEMPLATE(ConvexHullCollisionModel, TDataTypes), sofa::core::CollisionModel);
+    typedef TDataTypes DataTypes;
+    typedef DataTypes InDataTypes;
+    typedef typename DataTypes::Coord::Pos Coord;
+    typedef sofa::type::vector<Coord> VecCoord;
+    typedef typename DataTypes::Real Real;
+    typedef typename DataTypes::Quat Quaternion;
+    typedef sofa::type::fixed_array<sofa::Index, 3> Triangle;
+
+    typedef TConvexHull<DataTypes> Element;
+    friend class TConvexHull<DataTypes>;
+
+    Data<VecCoord> d_vertices; ///< Points in the local frame of the rigid, whose convex hull is the shape of the model
+    Data<unsigned int> d_maxManifoldPoints; ///< Maximum number of contact points kept between two hulls, from a time step to the next
+
+protected:
+    ConvexHullCollisionModel();
+    ConvexHullCollisionModel(sofa::core::behavior::MechanicalState<TDataTypes>* mstate);
+public:
+    void init() override;
+
+    // -- CollisionModel interface
+
+    void resize(sofa::Size size) override;
+
+    void computeBoundingTree(int maxDepth=0) override;
+
+    void draw(const sofa::core::visual::VisualParams* vparams, sofa::Index index) override;
+
+    void draw(const sofa::core::visual::VisualParams* vparams) override;
+
+    sofa::core::behavior::MechanicalState<DataTypes>* getMechanicalState() { return _mstate; }
+
+    /// Pre-construction check method called by ObjectFactory.
+    /// Check that DataTypes matches the MechanicalState.
+    template<class T>
+    static bool canCreate(T*& obj, sofa::core::objectmodel::BaseContext* context, sofa::core::objectmodel::BaseObjectDescription* arg)
+    {
+        if (dynamic_cast<sofa::core::behavior::MechanicalState<TDataTypes>*>(context->getMechanicalState()) == nullptr && context->getMechanicalState() != nullptr)
+        {
+            arg->logError(std::string("No mechanical state with the datatype '") + DataTypes::Name() +
+                          "' found in the context node.");
+            return false;
+        }
+
+        return BaseObject::canCreate(obj, context, arg);
+    }
+
+    /**
+      *Computes the convex hull of the given points: the vertices of the hull are the points
+      *which are not inside it, and its faces are oriented outward. Returns false if the points
+      *are coplanar, in which case all the points are kept as vertices, without any face.
+      */
+    static bool computeConvexHull(const VecCoord& points, VecCoord& hullVertices, sofa::type::vector<Triangle>& hullTriangles);
+
+    /**
+      *Vertices of the hull, in the local frame of the rigid.
+      */
+    const VecCoord & hullVertices()const { return m_hullVertices; }
+
+    /**
+      *Triangles of the hull, oriented outward.
+      */
+    const sofa::type::vector<Triangle> & hullTriangles()const { return m_hullTriangles; }
+
+    /**
+      *Neighbors of each vertex of the hull along its edges, used to find the vertex furthest
+      *along a direction by hill climbing.
+      */
+    const sofa::type::vector<sofa::type::vector<sofa::Index> > & hullNeighbors()const { return m_hullNeighbors; }
+
+    /**
+      *Distance from the origin of the local frame to the furthest vertex of the hull.
+      */
+    Real hullRadius()const { return m_hullRadius; }
+
+    const Coord & center(sofa::Index index)const;
+
+    /**
+      *Returns the quaternion representing the rotation of the local frame of the hull at index index.
+      */
+    const Quaternion & orientation(sofa::Index index)const;
+
+    /**
+      *Returns the coordinates of c (in the local frame) in the general coordinate system of the hull at index index.
+      */
+    Coord generalCoordinates(const Coord & c, sofa::Index index)const;
+
+    void computeBBox(const sofa::core::ExecParams* params, bool onlyVisible=false) override;
+
+protected:
+    sofa::core::behavior::MechanicalState<DataTypes>* _mstate;
+
+    VecCoord m_hullVertices;
+    sofa::type::vector<Triangle> m_hullTriangles;
+    sofa::type::vector<sofa::type::vector<sofa::Index> > m_hullNeighbors;
+    Real m_hullRadius { 0 };
+};
+
+template<class DataTypes>
+inline TConvexHull<DataTypes>::TConvexHull(ParentModel* model, sofa::Index index)
+    : sofa::core::TCollisionElementIterator<ParentModel>(model, index)
+{}
+
+template<class DataTypes>
+inline TConvexHull<DataTypes>::TConvexHull(const sofa::core::CollisionElementIterator& i)
+    : sofa::core::TCollisionElementIterator<ParentModel>(static_cast<ParentModel*>(i.getCollisionModel()), i.getIndex())
+{}
+
+template<class DataTypes>
+inline const typename TConvexHull<DataTypes>::Coord & TConvexHull<DataTypes>::center()const{
+    return this->model->center(this->index);
+}
+
+template<class DataTypes>
+inline const typename TConvexHull<DataTypes>::Quaternion & TConvexHull<DataTypes>::orientation()const{
+    return this->model->orientation(this->index);
+}
+
+template<class DataTypes>
+inline typename TConvexHull<DataTypes>::Coord TConvexHull<DataTypes>::generalCoordinates(const Coord &c)const{
+    return this->model->generalCoordinates(c, this->index);
+}
+
+template<class DataTypes>
+inline const typename ConvexHullCollisionModel<DataTypes>::Coord & ConvexHullCollisionModel<DataTypes>::center(sofa::Index index)const{
+    return _mstate->read(core::ConstVecCoordId::position())->getValue()[index].getCenter();
+}
+
+template<class DataTypes>
+inline const typename ConvexHullCollisionModel<DataTypes>::Quaternion & ConvexHullCollisionModel<DataTypes>::orientation(sofa::Index index)const{
+    return _mstate->read(core::ConstVecCoordId::position())->getValue()[index].getOrientation();
+}
+
+template<class DataTypes>
+inline typename ConvexHullCollisionModel<DataTypes>::Coord ConvexHullCollisionModel<DataTypes>::generalCoordinates(const Coord &c, sofa::Index index)const{
+    return orientation(index).rotate(c) + center(index);
+}
+
+#if !defined(SOFA_COMPONENT_COLLISION_CONVEXHULLMODEL_CPP)
+extern template class COLLISIONOBBCAPSULE_API TConvexHull<sofa::defaulttype::Rigid3Types>;
+extern template class COLLISIONOBBCAPSULE_API ConvexHullCollisionModel<sofa::defaulttype::Rigid3Types>;
+#endif
+
+} // namespace collisionobbcapsule::geometry
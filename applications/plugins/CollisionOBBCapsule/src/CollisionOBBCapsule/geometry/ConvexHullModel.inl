@@ -0,0 +1,386 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <CollisionOBBCapsule/geometry/ConvexHullModel.h>
+
+#include <sofa/component/collision/geometry/CubeModel.h>
+#include <sofa/core/visual/VisualParams.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+
+namespace collisionobbcapsule::geometry
+{
+
+template<class DataTypes>
+ConvexHullCollisionModel<DataTypes>::ConvexHullCollisionModel():
+    d_vertices(initData(&d_vertices, "vertices", "Points in the local frame of the rigid, whose convex hull is the shape of the model")),
+    d_maxManifoldPoints(initData(&d_maxManifoldPoints, 4u, "maxManifoldPoints", "Maximum number of contact points kept between two hulls, from a time step to the next")),
+    _mstate(nullptr)
+{
+    enum_type = CONVEX_HULL_TYPE;
+}
+
+template<class DataTypes>
+ConvexHullCollisionModel<DataTypes>::ConvexHullCollisionModel(sofa::core::behavior::MechanicalState<DataTypes>* mstate):
+    d_vertices(initData(&d_vertices, "vertices", "Points in the local frame of the rigid, whose convex hull is the shape of the model")),
+    d_maxManifoldPoints(initData(&d_maxManifoldPoints, 4u, "maxManifoldPoints", "Maximum number of contact points kept between two hulls, from a time step to the next")),
+    _mstate(mstate)
+{
+    enum_type = CONVEX_HULL_TYPE;
+}
+
+
+template<class DataTypes>
+void ConvexHullCollisionModel<DataTypes>::init()
+{
+    this->CollisionModel::init();
+    _mstate = dynamic_cast< core::behavior::MechanicalState<DataTypes>* > (getContext()->getMechanicalState());
+    if (_mstate==nullptr)
+    {
+        msg_error()<<"ConvexHullCollisionModel requires a Rigid Mechanical Model";
+        return;
+    }
+
+    const VecCoord& vertices = d_vertices.getValue();
+    if (vertices.empty())
+    {
+        msg_error() << "No vertex given to compute the convex hull";
+        return;
+    }
+
+    if (!computeConvexHull(vertices, m_hullVertices, m_hullTriangles))
+    {
+        msg_warning() << "The " << vertices.size() << " vertices are coplanar: the hull is their polygon, which is not drawn";
+    }
+    msg_info() << "Convex hull of " << m_hullVertices.size() << " vertices and " << m_hullTriangles.size()
+               << " triangles, computed from " << vertices.size() << " vertices";
+
+    std::vector<std::set<sofa::Index> > neighbors(m_hullVertices.size());
+    for (const auto& triangle : m_hullTriangles)
+    {
+        for (unsigned int j = 0; j < 3; ++j)
+        {
+            neighbors[triangle[j]].insert(triangle[(j + 1) % 3]);
+            neighbors[triangle[(j + 1) % 3]].insert(triangle[j]);
+        }
+    }
+    m_hullNeighbors.resize(neighbors.size());
+    for (std::size_t i = 0; i < neighbors.size(); ++i)
+    {
+        m_hullNeighbors[i].assign(neighbors[i].begin(), neighbors[i].end());
+    }
+
+    m_hullRadius = 0;
+    for (const auto& v : m_hullVertices)
+    {
+        m_hullRadius = std::max(m_hullRadius, v.norm());
+    }
+
+    resize(_mstate->getSize());
+}
+
+
+template<class DataTypes>
+bool ConvexHullCollisionModel<DataTypes>::computeConvexHull(const VecCoord& points, VecCoord& hullVertices, sofa::type::vector<Triangle>& hullTriangles)
+{
+    hullVertices.clear();
+    hullTriangles.clear();
+
+    const auto nbPoints = static_cast<sofa::Index>(points.size());
+    if (nbPoints < 4)
+    {
+        hullVertices = points;
+        return false;
+    }
+
+    // The tolerance of the tests is relative to the size of the point set
+    Coord minCoord = points[0], maxCoord = points[0];
+    for (const auto& p : points)
+    {
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            minCoord[c] = std::min(minCoord[c], p[c]);
+            maxCoord[c] = std::max(maxCoord[c], p[c]);
+        }
+    }
+    const Coord extent = maxCoord - minCoord;
+    const unsigned int axis = static_cast<unsigned int>(std::max_element(extent.begin(), extent.end()) - extent.begin());
+    const Real epsilon = extent[axis] * Real(1e-9);
+
+    // Initial tetrahedron: the extreme points along the largest dimension, the point furthest from
+    // the line joining them, and the point furthest from the plane of the three others
+    sofa::Index i0 = 0, i1 = 0;
+    for (sofa::Index i = 1; i < nbPoints; ++i)
+    {
+        if (points[i][axis] < points[i0][axis]) i0 = i;
+        if (points[i][axis] > points[i1][axis]) i1 = i;
+    }
+
+    const Coord lineDirection = (points[i1] - points[i0]).normalized();
+    sofa::Index i2 = i0;
+    Real maxDistance = 0;
+    for (sofa::Index i = 0; i < nbPoints; ++i)
+    {
+        const Real distance = (points[i] - points[i0]).cross(lineDirection).norm();
+        if (distance > maxDistance)
+        {
+            maxDistance = distance;
+            i2 = i;
+        }
+    }
+
+    sofa::Index i3 = i0;
+    if (maxDistance > epsilon)
+    {
+        const Coord planeNormal = (points[i1] - points[i0]).cross(points[i2] - points[i0]).normalized();
+        maxDistance = 0;
+        for (sofa::Index i = 0; i < nbPoints; ++i)
+        {
+            const Real distance = std::abs(planeNormal * (points[i] - points[i0]));
+            if (distance > maxDistance)
+            {
+                maxDistance = distance;
+                i3 = i;
+            }
+        }
+    }
+
+    if (maxDistance <= epsilon)
+    {
+        hullVertices = points;
+        return false;
+    }
+
+    struct Face
+    {
+        sofa::Index v[3];
+        Coord normal;
+        Real offset;
+    };
+
+    const Coord inside = (points[i0] + points[i1] + points[i2] + points[i3]) / Real(4);
+    std::vector<Face> faces;
+    const auto addFace = [&points, &faces, &inside](sofa::Index a, sofa::Index b, sofa::Index c)
+    {
+        Face face { { a, b, c }, (points[b] - points[a]).cross(points[c] - points[a]), 0 };
+        if (face.normal * (inside - points[a]) > 0)
+        {
+            std::swap(face.v[1], face.v[2]);
+            face.normal = -face.normal;
+        }
+        face.normal.normalize();
+        face.offset = face.normal * points[a];
+        faces.push_back(face);
+    };
+
+    addFace(i0, i1, i2);
+    addFace(i0, i1, i3);
+    addFace(i0, i2, i3);
+    addFace(i1, i2, i3);
+
+    std::vector<bool> visible;
+    std::set<std::pair<sofa::Index, sofa::Index> > visibleEdges;
+    for (sofa::Index i = 0; i < nbPoints; ++i)
+    {
+        if (i == i0 || i == i1 || i == i2 || i == i3)
+            continue;
+
+        const Coord& p = points[i];
+        visible.assign(faces.size(), false);
+        visibleEdges.clear();
+        for (std::size_t f = 0; f < faces.size(); ++f)
+        {
+            if (faces[f].normal * p - faces[f].offset > epsilon)
+            {
+                visible[f] = true;
+                for (unsigned int j = 0; j < 3; ++j)
+                {
+                    visibleEdges.emplace(faces[f].v[j], faces[f].v[(j + 1) % 3]);
+                }
+            }
+        }
+        if (visibleEdges.empty())
+            continue; // inside the current hull
+
+        // The faces seen from the point are replaced by the cone joining the point to their boundary
+        std::vector<Face> remainingFaces;
+        remainingFaces.reserve(faces.size());
+        for (std::size_t f = 0; f < faces.size(); ++f)
+        {
+            if (!visible[f])
+                remainingFaces.push_back(faces[f]);
+        }
+        faces.swap(remainingFaces);
+
+        for (const auto& [a, b] : visibleEdges)
+        {
+            if (visibleEdges.find({ b, a }) == visibleEdges.end())
+            {
+                addFace(a, b, i);
+            }
+        }
+    }
+
+    // Only the points which are vertices of the faces are kept
+    std::map<sofa::Index, sofa::Index> vertexIndex;
+    hullTriangles.reserve(faces.size());
+    for (const auto& face : faces)
+    {
+        Triangle triangle;
+        for (unsigned int j = 0; j < 3; ++j)
+        {
+            const auto it = vertexIndex.emplace(face.v[j], static_cast<sofa::Index>(hullVertices.size())).first;
+            if (it->second == hullVertices.size())
+                hullVertices.push_back(points[face.v[j]]);
+            triangle[j] = it->second;
+        }
+        hullTriangles.push_back(triangle);
+    }
+
+    return true;
+}
+
+
+template<class DataTypes>
+void ConvexHullCollisionModel<DataTypes>::resize(sofa::Size size)
+{
+    this->core::CollisionModel::resize(size);
+}
+
+
+template<class DataTypes>
+void ConvexHullCollisionModel<DataTypes>::computeBoundingTree(int maxDepth)
+{
+    sofa::component::collision::geometry::CubeCollisionModel* cubeModel = createPrevious<sofa::component::collision::geometry::CubeCollisionModel>();
+    const auto npoints = _mstate->getSize();
+    bool updated = false;
+    if (npoints != size)
+    {
+        resize(npoints);
+        updated = true;
+        cubeModel->resize(0);
+    }
+
+    if (!isMoving() && !cubeModel->empty() && !updated)
+        return; // No need to recompute BBox if immobile
+
+    cubeModel->resize(size);
+    if (!empty() && !m_hullVertices.empty())
+    {
+        const Real distance = (Real)this->proximity.getValue();
+
+        for (sofa::Size i = 0; i < size; i++)
+        {
+            Coord minElem = generalCoordinates(m_hullVertices[0], i);
+            Coord maxElem = minElem;
+            for (const auto& v : m_hullVertices)
+            {
+                const Coord p = generalCoordinates(v, i);
+                for (int c = 0; c < 3; ++c)
+                {
+                    minElem[c] = std::min(minElem[c], p[c]);
+                    maxElem[c] = std::max(maxElem[c], p[c]);
+                }
+            }
+
+            for (int c = 0; c < 3; ++c)
+            {
+                minElem[c] -= distance;
+                maxElem[c] += distance;
+            }
+
+            cubeModel->setParentOf(i, minElem, maxElem);
+        }
+        cubeModel->computeBoundingTree(maxDepth);
+    }
+}
+
+
+template<class DataTypes>
+void ConvexHullCollisionModel<DataTypes>::draw(const sofa::core::visual::VisualParams* vparams, sofa::Index index)
+{
+    std::vector<sofa::type::Vec3> points;
+    points.reserve(3 * m_hullTriangles.size());
+    for (const auto& triangle : m_hullTriangles)
+    {
+        for (const auto v : triangle)
+        {
+            points.push_back(generalCoordinates(m_hullVertices[v], index));
+        }
+    }
+
+    const sofa::type::RGBAColor color(getColor4f()[0], getColor4f()[1], getColor4f()[2], getColor4f()[3]);
+    vparams->drawTool()->drawTriangles(points, color);
+}
+
+template<class DataTypes>
+void ConvexHullCollisionModel<DataTypes>::draw(const sofa::core::visual::VisualParams* vparams)
+{
+    if (vparams->displayFlags().getShowCollisionModels())
+    {
+        vparams->drawTool()->setPolygonMode(0,vparams->displayFlags().getShowWireFrame());
+
+        const auto npoints = _mstate->getSize();
+        vparams->drawTool()->setLightingEnabled(true); //Enable lightning
+        for(sofa::Size i = 0 ; i < npoints ; ++i )
+            draw(vparams,i);
+        vparams->drawTool()->setLightingEnabled(false); //Disable lightning
+    }
+
+    if (getPrevious()!=nullptr && vparams->displayFlags().getShowBoundingCollisionModels())
+        getPrevious()->draw(vparams);
+
+    vparams->drawTool()->setPolygonMode(0,false);
+}
+
+
+template<class DataTypes>
+void ConvexHullCollisionModel<DataTypes>::computeBBox(const core::ExecParams*, bool onlyVisible)
+{
+    if( !onlyVisible || _mstate == nullptr || m_hullVertices.empty()) return;
+
+    static const Real max_real = std::numeric_limits<Real>::max();
+    static const Real min_real = std::numeric_limits<Real>::lowest();
+    Real maxBBox[3] = {min_real,min_real,min_real};
+    Real minBBox[3] = {max_real,max_real,max_real};
+
+    const auto npoints = _mstate->getSize();
+    for(sofa::Size i = 0 ; i < npoints ; ++i )
+    {
+        for (const auto& v : m_hullVertices)
+        {
+            const Coord p = generalCoordinates(v, i);
+            for (int c=0; c<3; c++)
+            {
+                if (p[c] > maxBBox[c]) maxBBox[c] = Real(p[c]);
+                if (p[c] < minBBox[c]) minBBox[c] = Real(p[c]);
+            }
+        }
+    }
+
+    this->f_bbox.setValue(sofa::type::TBoundingBox<Real>(minBBox,maxBBox));
+}
+
+} // namespace collisionobbcapsule::geometry
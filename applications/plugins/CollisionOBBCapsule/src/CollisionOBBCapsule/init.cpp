@@ -67,7 +67,7 @@ const char* getModuleLicense()
 
 const char* getModuleDescription()
 {
-    return "This plugin contains OBB and capsule collision components.";
+    return "This plugin contains OBB, capsule and convex hull collision components.";
 }
 
 const char* getModuleComponentList()
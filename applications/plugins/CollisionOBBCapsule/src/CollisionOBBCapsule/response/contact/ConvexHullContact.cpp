@@ -0,0 +1,69 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <CollisionOBBCapsule/geometry/ConvexHullModel.h>
+#include <sofa/component/collision/geometry/LineModel.h>
+#include <sofa/component/collision/geometry/PointModel.h>
+#include <sofa/component/collision/geometry/SphereModel.h>
+#include <sofa/component/collision/geometry/TriangleModel.h>
+#include <sofa/component/collision/response/contact/BarycentricPenalityContact.inl>
+#include <sofa/component/collision/response/contact/FrictionContact.inl>
+#include <CollisionOBBCapsule/response/mapper/ConvexHullContactMapper.h>
+
+
+namespace sofa::component::collision::response::contact
+{
+
+using namespace sofa::core::collision;
+using namespace sofa::component::collision::geometry;
+using namespace collisionobbcapsule::geometry;
+
+typedef ConvexHullCollisionModel<sofa::defaulttype::Rigid3Types> ConvexHullModel;
+
+Creator<Contact::Factory, BarycentricPenalityContact<ConvexHullModel, ConvexHullModel> > ConvexHullConvexHullPenalityContactClass("PenalityContactForceField", true);
+Creator<Contact::Factory, BarycentricPenalityContact<SphereCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel> > SphereConvexHullPenalityContactClass("PenalityContactForceField", true);
+Creator<Contact::Factory, BarycentricPenalityContact<RigidSphereModel, ConvexHullModel> > RigidSphereConvexHullPenalityContactClass("PenalityContactForceField", true);
+Creator<Contact::Factory, BarycentricPenalityContact<PointCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel> > PointConvexHullPenalityContactClass("PenalityContactForceField", true);
+Creator<Contact::Factory, BarycentricPenalityContact<LineCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel> > LineConvexHullPenalityContactClass("PenalityContactForceField", true);
+Creator<Contact::Factory, BarycentricPenalityContact<TriangleCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel> > TriangleConvexHullPenalityContactClass("PenalityContactForceField", true);
+
+Creator<Contact::Factory, FrictionContact<ConvexHullModel, ConvexHullModel> > ConvexHullConvexHullFrictionContactClass("FrictionContactConstraint", true);
+Creator<Contact::Factory, FrictionContact<SphereCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel> > SphereConvexHullFrictionContactClass("FrictionContactConstraint", true);
+Creator<Contact::Factory, FrictionContact<RigidSphereModel, ConvexHullModel> > RigidSphereConvexHullFrictionContactClass("FrictionContactConstraint", true);
+Creator<Contact::Factory, FrictionContact<PointCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel> > PointConvexHullFrictionContactClass("FrictionContactConstraint", true);
+Creator<Contact::Factory, FrictionContact<LineCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel> > LineConvexHullFrictionContactClass("FrictionContactConstraint", true);
+Creator<Contact::Factory, FrictionContact<TriangleCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel> > TriangleConvexHullFrictionContactClass("FrictionContactConstraint", true);
+
+template class COLLISIONOBBCAPSULE_API response::contact::BarycentricPenalityContact<ConvexHullModel, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::BarycentricPenalityContact<SphereCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::BarycentricPenalityContact<RigidSphereModel, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::BarycentricPenalityContact<PointCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::BarycentricPenalityContact<LineCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::BarycentricPenalityContact<TriangleCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel>;
+
+template class COLLISIONOBBCAPSULE_API response::contact::FrictionContact<ConvexHullModel, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::FrictionContact<SphereCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::FrictionContact<RigidSphereModel, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::FrictionContact<PointCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::FrictionContact<LineCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel>;
+template class COLLISIONOBBCAPSULE_API response::contact::FrictionContact<TriangleCollisionModel<sofa::defaulttype::Vec3Types>, ConvexHullModel>;
+
+} // namespace sofa::component::collision::response::contact
@@ -26,6 +26,7 @@
 #include <sofa/helper/ScopedAdvancedTimer.h>
 #include <sofa/core/CollisionModel.h>
 #include <sofa/core/collision/Intersection.h>
+#include <sofa/core/collision/DetectionOutput.h>
 #include <sofa/core/topology/BaseMeshTopology.h>
 #include <sofa/simulation/MainTaskSchedulerFactory.h>
 #include <MultiThreading/ParallelImplementationsRegistry.h>
@@ -46,6 +47,17 @@ int ParallelBVHNarrowPhaseClass = sofa::core::RegisterObject("Narrow phase colli
 ParallelBVHNarrowPhase::ParallelBVHNarrowPhase()
 {}
 
+ParallelBVHNarrowPhase::~ParallelBVHNarrowPhase()
+{
+    for (auto& [finestModels, outputs] : m_freeOutputs)
+    {
+        for (auto* output : outputs)
+        {
+            output->release();
+        }
+    }
+}
+
 void ParallelBVHNarrowPhase::init()
 {
     NarrowPhaseDetection::init();
@@ -72,9 +84,12 @@ void ParallelBVHNarrowPhase::addCollisionPairs(const sofa::type::vector< std::pa
 
     {
         SCOPED_TIMER_VARNAME(createTasksTimer, "TasksCreation");
-        for (const auto &pair : v)
+        for (unsigned int i = 0; i < nbPairs; ++i)
         {
-            m_tasks.emplace_back(&status, this, pair);
+            if (m_pairOutputs[i].finestModels.first == nullptr)
+                continue;
+
+            m_tasks.emplace_back(&status, this, v[i], &m_pairOutputs[i].outputs);
             m_taskScheduler->addTask(&m_tasks.back());
         }
     }
@@ -86,6 +101,8 @@ void ParallelBVHNarrowPhase::addCollisionPairs(const sofa::type::vector< std::pa
 
     m_tasks.clear();
 
+    mergeOutputs();
+
     // m_outputsMap should just be filled in addCollisionPair function
     m_primitiveTestCount = m_outputsMap.size();
 }
@@ -95,32 +112,117 @@ void ParallelBVHNarrowPhase::createOutput(
 {
     SCOPED_TIMER_VARNAME(createTasksTimer, "OutputCreation");
 
+    m_pairOutputs.clear();
+    m_pairOutputs.reserve(v.size());
+
     for (const auto &pair : v)
     {
+        auto& pairOutput = m_pairOutputs.emplace_back();
+
         sofa::core::CollisionModel *cm1 = pair.first;
         sofa::core::CollisionModel *cm2 = pair.second;
 
-        sofa::core::CollisionModel *finestCollisionModel1 = cm1->getLast();//get the finest CollisionModel which is not a CubeModel
-        sofa::core::CollisionModel *finestCollisionModel2 = cm2->getLast();
-
-        initializeTopology(finestCollisionModel1->getCollisionTopology());
-        initializeTopology(finestCollisionModel2->getCollisionTopology());
+        initializeTopology(cm1->getLast()->getCollisionTopology());
+        initializeTopology(cm2->getLast()->getCollisionTopology());
 
+        // The intersection method caches the types of the collision models it looks up. The cache is filled here for
+        // the bounding volumes, as it cannot be filled concurrently
         bool swapModels = false;
-        sofa::core::collision::ElementIntersector *finestIntersector = intersectionMethod->findIntersector(
-                finestCollisionModel1, finestCollisionModel2,
-                swapModels);//find the method for the finest CollisionModels
-        if (finestIntersector == nullptr)
+        intersectionMethod->findIntersector(cm1, cm2, swapModels);
+
+        pairOutput.finestModels = getFinestCollisionModels(pair);
+        if (pairOutput.finestModels.first == nullptr)
             continue;
-        if (swapModels)
+
+        //force the creation of all Detection Output before the parallel computation
+        getDetectionOutputs(pairOutput.finestModels.first, pairOutput.finestModels.second);
+
+        const auto freeOutputsIt = m_freeOutputs.find(pairOutput.finestModels);
+        if (freeOutputsIt != m_freeOutputs.end() && !freeOutputsIt->second.empty())
         {
-            std::swap(cm1, cm2);
-            std::swap(finestCollisionModel1, finestCollisionModel2);
+            pairOutput.outputs = freeOutputsIt->second.back();
+            freeOutputsIt->second.pop_back();
         }
+    }
+}
 
-        //force the creation of all Detection Output before the parallel computation
-        getDetectionOutputs(finestCollisionModel1, finestCollisionModel2);
+void ParallelBVHNarrowPhase::mergeOutputs()
+{
+    SCOPED_TIMER_VARNAME(mergeOutputsTimer, "OutputsMerge");
+
+    // Indices of the pairs sharing the same finest collision models, in the order of the pairs
+    std::map<CollisionModelPair, sofa::type::vector<std::size_t> > pairsPerOutput;
+    for (std::size_t i = 0; i < m_pairOutputs.size(); ++i)
+    {
+        if (m_pairOutputs[i].outputs != nullptr)
+        {
+            pairsPerOutput[m_pairOutputs[i].finestModels].push_back(i);
+        }
+    }
+
+    for (const auto& [finestModels, pairs] : pairsPerOutput)
+    {
+        sofa::core::collision::DetectionOutputVector*& outputs = getDetectionOutputs(finestModels.first, finestModels.second);
+
+        auto pairIt = pairs.begin();
+        if (outputs == nullptr || outputs->size() == 0)
+        {
+            // The output vector of the first pair becomes the detection output, without copy
+            std::swap(outputs, m_pairOutputs[*pairIt].outputs);
+            ++pairIt;
+        }
+        if (pairIt == pairs.end())
+            continue;
+
+        // The contacts of the other pairs are appended after the existing ones: the position of each block of
+        // contacts is the prefix sum of the sizes of the previous blocks
+        auto* contacts = dynamic_cast<sofa::type::vector<sofa::core::collision::DetectionOutput>*>(outputs);
+        if (contacts == nullptr)
+        {
+            msg_error() << "The contacts between " << finestModels.first->getPathName() << " and "
+                << finestModels.second->getPathName() << " cannot be merged: some contacts are lost.";
+            continue;
+        }
+
+        sofa::type::vector<std::size_t> offsets(1, contacts->size());
+        for (auto it = pairIt; it != pairs.end(); ++it)
+        {
+            offsets.push_back(offsets.back() + m_pairOutputs[*it].outputs->size());
+        }
+        contacts->resize(offsets.back());
+
+        for (auto it = pairIt; it != pairs.end(); ++it)
+        {
+            const auto* pairContacts = dynamic_cast<const sofa::type::vector<sofa::core::collision::DetectionOutput>*>(m_pairOutputs[*it].outputs);
+            if (pairContacts != nullptr)
+            {
+                std::copy(pairContacts->begin(), pairContacts->end(),
+                          contacts->begin() + offsets[std::distance(pairIt, it)]);
+            }
+        }
+    }
+
+    // The output vectors which were not swapped with a detection output are kept for the next time step. The ones
+    // of the pairs which are not examined anymore are released.
+    std::map<CollisionModelPair, std::vector<sofa::core::collision::DetectionOutputVector*> > freeOutputs;
+    for (auto& pairOutput : m_pairOutputs)
+    {
+        if (pairOutput.outputs != nullptr)
+        {
+            pairOutput.outputs->clear();
+            freeOutputs[pairOutput.finestModels].push_back(pairOutput.outputs);
+        }
+    }
+    m_pairOutputs.clear();
+
+    for (const auto& [finestModels, outputs] : m_freeOutputs)
+    {
+        for (auto* output : outputs)
+        {
+            output->release();
+        }
     }
+    m_freeOutputs = std::move(freeOutputs);
 }
 
 void ParallelBVHNarrowPhase::initializeTopology(sofa::core::topology::BaseMeshTopology* topology)
@@ -153,17 +255,20 @@ void ParallelBVHNarrowPhase::initializeTopology(sofa::core::topology::BaseMeshTo
 ParallelBVHNarrowPhasePairTask::ParallelBVHNarrowPhasePairTask(
         sofa::simulation::CpuTask::Status* status,
         ParallelBVHNarrowPhase* bvhNarrowPhase,
-        std::pair<sofa::core::CollisionModel*, sofa::core::CollisionModel*> pair)
+        std::pair<sofa::core::CollisionModel*, sofa::core::CollisionModel*> pair,
+        sofa::core::collision::DetectionOutputVector** outputs)
     : sofa::simulation::CpuTask(status)
     , m_bvhNarrowPhase(bvhNarrowPhase)
     , m_pair(pair)
+    , m_outputs(outputs)
 {}
 
 sofa::simulation::Task::MemoryAlloc ParallelBVHNarrowPhasePairTask::run()
 {
     assert(m_bvhNarrowPhase != nullptr);
+    assert(m_outputs != nullptr);
 
-    m_bvhNarrowPhase->addCollisionPair(m_pair);
+    m_bvhNarrowPhase->addCollisionPair(m_pair, *m_outputs);
 
     return sofa::simulation::Task::Stack;
 }
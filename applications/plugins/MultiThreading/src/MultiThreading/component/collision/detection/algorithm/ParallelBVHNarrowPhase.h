@@ -26,6 +26,7 @@
 
 #include <sofa/component/collision/detection/algorithm/BVHNarrowPhase.h>
 #include <sofa/simulation/CpuTask.h>
+#include <map>
 #include <unordered_set>
 
 namespace multithreading::component::collision::detection::algorithm
@@ -42,9 +43,30 @@ public:
 
 protected:
     ParallelBVHNarrowPhase();
+    ~ParallelBVHNarrowPhase() override;
+
+    friend class ParallelBVHNarrowPhasePairTask;
 
     std::vector<ParallelBVHNarrowPhasePairTask> m_tasks;
 
+    using CollisionModelPair = std::pair<sofa::core::CollisionModel*, sofa::core::CollisionModel*>;
+
+    /// Output of the intersection of a pair of collision models, computed by a task in its own output vector
+    struct PairOutput
+    {
+        /// Finest collision models of the pair, i.e. the key of the detection outputs the contacts are merged into
+        CollisionModelPair finestModels { nullptr, nullptr };
+
+        /// Contacts detected by the task, allocated by the intersector if nullptr
+        sofa::core::collision::DetectionOutputVector* outputs { nullptr };
+    };
+
+    /// One output per pair of collision models, in the order of the pairs given to addCollisionPairs
+    std::vector<PairOutput> m_pairOutputs;
+
+    /// Cleared output vectors, reused by the tasks of the next pairs having the same finest collision models
+    std::map<CollisionModelPair, std::vector<sofa::core::collision::DetectionOutputVector*> > m_freeOutputs;
+
     std::unordered_set< sofa::core::topology::BaseMeshTopology* > m_initializedTopology;
     std::set< std::pair<sofa::core::CollisionModel*, sofa::core::CollisionModel*> > m_initializedPairs;
 
@@ -56,9 +78,14 @@ public:
 private:
 
     /// Unlike the sequential algorithm which creates the output on the fly, the parallel implementation
-    /// requires to create the outputs before the computation, in order to avoid iterators invalidation
+    /// requires to create the outputs before the computation, in order to avoid iterators invalidation.
+    /// Each task also gets its own output vector, so that no output is shared between the tasks.
     void createOutput(const sofa::type::vector<std::pair<sofa::core::CollisionModel *, sofa::core::CollisionModel *>> &v);
 
+    /// Merge the output vectors of the tasks into the detection outputs, in the order of the pairs, so that the
+    /// contacts do not depend on the scheduling of the tasks. The output vectors are then kept for reuse.
+    void mergeOutputs();
+
     /// This function makes sure some topology arrays are initialized. They cannot be initialized concurrently
     void initializeTopology(sofa::core::topology::BaseMeshTopology*);
 };
@@ -69,7 +96,8 @@ public:
     ParallelBVHNarrowPhasePairTask(
             sofa::simulation::CpuTask::Status* status,
             ParallelBVHNarrowPhase* bvhNarrowPhase,
-            std::pair<sofa::core::CollisionModel*, sofa::core::CollisionModel*> pair);
+            std::pair<sofa::core::CollisionModel*, sofa::core::CollisionModel*> pair,
+            sofa::core::collision::DetectionOutputVector** outputs);
     ~ParallelBVHNarrowPhasePairTask() override = default;
     sofa::simulation::Task::MemoryAlloc run() final;
 
@@ -77,6 +105,9 @@ private:
 
     ParallelBVHNarrowPhase* m_bvhNarrowPhase { nullptr };
     std::pair<sofa::core::CollisionModel*, sofa::core::CollisionModel*> m_pair;
+
+    /// Output vector owned by this task
+    sofa::core::collision::DetectionOutputVector** m_outputs { nullptr };
 };
 
 } //namespace sofa::component::collision
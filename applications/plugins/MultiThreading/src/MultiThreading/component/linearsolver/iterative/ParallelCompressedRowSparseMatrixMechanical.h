@@ -110,6 +110,13 @@ public:
 
         const_cast<Base*>(&m_crs)->compress();
         vresize(res, this->rowBSize(), this->rowSize());
+
+        if constexpr (std::is_same_v<V1, sofa::linearalgebra::FullVector<Real> > && std::is_same_v<V2, sofa::linearalgebra::FullVector<Real> >)
+        {
+            parallelAddMulBlockRows(vec.ptr(), res.ptr());
+            return;
+        }
+
         sofa::simulation::parallelForEachRange(*m_taskScheduler, static_cast<std::size_t>(0), m_crs.rowIndex.size(),
         [this, &vec, &res](const auto& range)
         {
@@ -153,6 +160,16 @@ public:
 
     }
 
+    /// res += this * v
+    void addMul(sofa::linearalgebra::FullVector<Real>& res, const sofa::linearalgebra::FullVector<Real>& v) const
+    {
+        assert(v.size() % m_crs.bColSize() == 0); // v.size() must be a multiple of block size.
+        assert(res.size() == rowSize());
+
+        const_cast<Base*>(&m_crs)->compress();
+        parallelAddMulBlockRows(v.ptr(), res.ptr());
+    }
+
     template<class Vec>
     Vec operator*(const Vec& v) const
     {
@@ -207,6 +224,58 @@ public:
     }
 
 private:
+
+    /// y += this * x, where the block rows are partitioned among the threads
+    void parallelAddMulBlockRows(const Real* x, Real* y) const
+    {
+        const auto nbBlockRows = static_cast<Index>(m_crs.rowIndex.size());
+        if (nbBlockRows == 0)
+        {
+            return;
+        }
+
+        if constexpr (TPolicy::StoreLowerTriangularBlock)
+        {
+            sofa::simulation::parallelForEachRange(*m_taskScheduler, static_cast<Index>(0), nbBlockRows,
+                [this, x, y](const auto& range)
+                {
+                    m_crs.addMulBlockRows(range.start, range.end, x, y, y);
+                });
+        }
+        else
+        {
+            // The products of the transposed blocks of a range of rows are written in the rows of the next ranges.
+            // They are accumulated in a buffer per range, starting at the first row of the range, and summed afterwards.
+            // The buffers are local to the call, so that concurrent products with the same matrix are safe.
+            const auto ranges = sofa::simulation::makeRangesForLoop(static_cast<Index>(0), nbBlockRows, m_taskScheduler->getThreadCount());
+            const auto n = static_cast<Index>(rowSize());
+            sofa::type::vector<sofa::type::vector<Real> > transposeBuffers(ranges.size());
+            sofa::type::vector<Index> transposeBufferBegin(ranges.size());
+
+            sofa::simulation::parallelForEach(*m_taskScheduler, static_cast<std::size_t>(0), ranges.size(),
+                [this, &ranges, &transposeBuffers, &transposeBufferBegin, x, y, n](const std::size_t r)
+                {
+                    transposeBufferBegin[r] = m_crs.rowIndex[ranges[r].start] * NL;
+                    transposeBuffers[r].resize(n);
+
+                    m_crs.addMulBlockRows(ranges[r].start, ranges[r].end, x, y, transposeBuffers[r].data());
+                });
+
+            sofa::simulation::parallelForEachRange(*m_taskScheduler, static_cast<Index>(0), n,
+                [&transposeBuffers, &transposeBufferBegin, y](const auto& range)
+                {
+                    for (std::size_t r = 0; r < transposeBuffers.size(); ++r)
+                    {
+                        const Real* buffer = transposeBuffers[r].data();
+                        for (auto i = std::max(range.start, transposeBufferBegin[r]); i < range.end; ++i)
+                        {
+                            y[i] += buffer[i];
+                        }
+                    }
+                });
+        }
+    }
+
     Base m_crs;
     sofa::simulation::TaskScheduler* m_taskScheduler { nullptr };
 };
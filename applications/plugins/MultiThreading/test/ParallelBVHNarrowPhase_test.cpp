@@ -0,0 +1,150 @@
+﻿/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <MultiThreading/component/collision/detection/algorithm/ParallelBVHNarrowPhase.h>
+using multithreading::component::collision::detection::algorithm::ParallelBVHNarrowPhase;
+using sofa::component::collision::detection::algorithm::BVHNarrowPhase;
+
+#include <sofa/core/collision/DetectionOutput.h>
+#include <sofa/core/collision/Intersection.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simpleapi/SimpleApi.h>
+#include <sofa/testing/BaseSimulationTest.h>
+
+#include <random>
+#include <tuple>
+
+namespace multithreading
+{
+
+using sofa::core::CollisionModel;
+using sofa::core::collision::DetectionOutput;
+using sofa::core::collision::NarrowPhaseDetection;
+using CollisionModelPairs = sofa::type::vector<std::pair<CollisionModel*, CollisionModel*> >;
+using Contact = std::tuple<CollisionModel*, sofa::Index, CollisionModel*, sofa::Index, DetectionOutput::ContactId>;
+
+/**
+ * Three clouds of small spheres, the first one colliding with itself
+ */
+struct ParallelBVHNarrowPhase_test : public sofa::testing::BaseSimulationTest
+{
+    sofa::simulation::Node::SPtr root;
+    sofa::core::collision::Intersection* intersection { nullptr };
+    sofa::type::vector<CollisionModel*> clouds;
+
+    void onSetUp() override
+    {
+        sofa::simpleapi::importPlugin("Sofa.Component.StateContainer");
+        sofa::simpleapi::importPlugin("Sofa.Component.Collision.Geometry");
+        sofa::simpleapi::importPlugin("Sofa.Component.Collision.Detection.Intersection");
+
+        root = sofa::simulation::getSimulation()->createNewGraph("root");
+        const auto intersectionObject = sofa::simpleapi::createObject(root, "MinProximityIntersection",
+            {{"alarmDistance", "0.02"}, {"contactDistance", "0.01"}});
+        intersection = dynamic_cast<sofa::core::collision::Intersection*>(intersectionObject.get());
+        ASSERT_NE(intersection, nullptr);
+
+        std::mt19937 generator { 42 };
+        std::uniform_real_distribution<SReal> coordinate(0, 1);
+        for (const SReal offset : { 0.0, 0.6, 1.2 })
+        {
+            const auto node = sofa::simpleapi::createChild(root, "cloud" + std::to_string(clouds.size()));
+
+            std::stringstream positionStr;
+            for (unsigned int i = 0; i < 1000; ++i)
+            {
+                positionStr << sofa::type::Vec3(offset + coordinate(generator), coordinate(generator), 0.1 * coordinate(generator)) << " ";
+            }
+            sofa::simpleapi::createObject(node, "MechanicalObject", {{"template", "Vec3"}, {"position", positionStr.str()}});
+
+            const auto sphere = sofa::simpleapi::createObject(node, "SphereCollisionModel",
+                {{"radius", "0.005"}, {"selfCollision", clouds.empty() ? "true" : "false"}});
+            clouds.push_back(dynamic_cast<CollisionModel*>(sphere.get()));
+            ASSERT_NE(clouds.back(), nullptr);
+        }
+
+        sofa::simulation::node::initRoot(root.get());
+
+        for (auto* cloud : clouds)
+        {
+            cloud->computeBoundingTree(6);
+        }
+    }
+
+    sofa::type::vector<Contact> detect(NarrowPhaseDetection* narrowPhase, const CollisionModelPairs& pairs) const
+    {
+        narrowPhase->setIntersectionMethod(intersection);
+        narrowPhase->beginNarrowPhase();
+        narrowPhase->addCollisionPairs(pairs);
+        narrowPhase->endNarrowPhase();
+
+        sofa::type::vector<Contact> contacts;
+        for (const auto& [modelPair, outputs] : narrowPhase->getDetectionOutputs())
+        {
+            const auto* detectionOutputs = dynamic_cast<const sofa::type::vector<DetectionOutput>*>(outputs);
+            if (detectionOutputs == nullptr)
+                continue;
+
+            for (const auto& output : *detectionOutputs)
+            {
+                contacts.emplace_back(output.elem.first.getCollisionModel(), output.elem.first.getIndex(),
+                                      output.elem.second.getCollisionModel(), output.elem.second.getIndex(), output.id);
+            }
+        }
+        return contacts;
+    }
+
+    void onTearDown() override
+    {
+        if (root)
+        {
+            sofa::simulation::node::unload(root);
+        }
+    }
+};
+
+TEST_F(ParallelBVHNarrowPhase_test, sameContactsAsSequential)
+{
+    const auto sequential = sofa::core::objectmodel::New<BVHNarrowPhase>();
+    const auto parallel = sofa::core::objectmodel::New<ParallelBVHNarrowPhase>();
+    parallel->init();
+
+    // The pair between the first two clouds is given twice: its contacts are merged from two tasks
+    const CollisionModelPairs pairs {
+        { clouds[0]->getFirst(), clouds[0]->getFirst() },
+        { clouds[0]->getFirst(), clouds[1]->getFirst() },
+        { clouds[1]->getFirst(), clouds[2]->getFirst() },
+        { clouds[0]->getFirst(), clouds[1]->getFirst() } };
+
+    // Each step reuses the output vectors of the previous one
+    for (unsigned int step = 0; step < 3; ++step)
+    {
+        const auto expected = detect(sequential.get(), pairs);
+        EXPECT_FALSE(expected.empty());
+        EXPECT_EQ(detect(parallel.get(), pairs), expected) << "step " << step;
+    }
+
+    // Without the repeated pair
+    const CollisionModelPairs uniquePairs(pairs.begin(), pairs.begin() + 3);
+    EXPECT_EQ(detect(parallel.get(), uniquePairs), detect(sequential.get(), uniquePairs));
+}
+
+}
@@ -0,0 +1,118 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <gtest/gtest.h>
+#include <MultiThreading/component/linearsolver/iterative/ParallelCompressedRowSparseMatrixMechanical.h>
+#include <sofa/linearalgebra/FullVector.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+
+namespace multithreading
+{
+
+namespace
+{
+
+/// Fills the matrices with the same symmetric 3x3 blocks, coupling each node of a line with its 4 next nodes
+template<class... TMatrix>
+void generateMatrices(int nbNodes, TMatrix&... matrices)
+{
+    (matrices.resize(3 * nbNodes, 3 * nbNodes), ...);
+    for (int i = 0; i < nbNodes; ++i)
+    {
+        for (int j = i; j < std::min(nbNodes, i + 5); ++j)
+        {
+            sofa::type::Mat<3, 3, SReal> block;
+            for (int a = 0; a < 3; ++a)
+            {
+                for (int b = 0; b < 3; ++b)
+                {
+                    block(a, b) = std::sin(SReal(1 + 3 * a + b + 9 * i + 7 * j));
+                }
+            }
+            if (i == j)
+            {
+                block = block + block.transposed();
+            }
+            (matrices.add(3 * i, 3 * j, block), ...);
+            if (i != j)
+            {
+                (matrices.add(3 * j, 3 * i, block.transposed()), ...);
+            }
+        }
+    }
+}
+
+}
+
+template<class TPolicy>
+void testParallelProduct()
+{
+    using sofa::linearalgebra::FullVector;
+
+    sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::MainTaskSchedulerFactory::createInRegistry();
+    ASSERT_NE(taskScheduler, nullptr);
+    if (taskScheduler->getThreadCount() < 1)
+    {
+        taskScheduler->init(0);
+    }
+
+    constexpr int nbNodes = 500;
+    sofa::linearalgebra::CompressedRowSparseMatrixMechanical<sofa::type::Mat<3, 3, SReal>, TPolicy> sequential;
+    component::linearsolver::iterative::ParallelCompressedRowSparseMatrixMechanical<sofa::type::Mat<3, 3, SReal>, TPolicy> parallel;
+    parallel.setTaskScheduler(taskScheduler);
+    generateMatrices(nbNodes, sequential, parallel);
+    sequential.compress();
+
+    FullVector<SReal> x(3 * nbNodes);
+    for (FullVector<SReal>::Index i = 0; i < x.size(); ++i)
+    {
+        x[i] = std::cos(SReal(i));
+    }
+
+    FullVector<SReal> expected, result;
+    sequential.mul(expected, x);
+    result = parallel * x;
+
+    ASSERT_EQ(expected.size(), result.size());
+    for (FullVector<SReal>::Index i = 0; i < x.size(); ++i)
+    {
+        EXPECT_NEAR(expected[i], result[i], 1e-12);
+    }
+
+    // result += parallel * x
+    parallel.addMul(result, x);
+    for (FullVector<SReal>::Index i = 0; i < x.size(); ++i)
+    {
+        EXPECT_NEAR(2 * expected[i], result[i], 1e-12);
+    }
+}
+
+TEST(ParallelCompressedRowSparseMatrixMechanical, product)
+{
+    testParallelProduct<sofa::linearalgebra::CRSMechanicalPolicy>();
+}
+
+TEST(ParallelCompressedRowSparseMatrixMechanical, symmetricProduct)
+{
+    testParallelProduct<sofa::linearalgebra::CRSMechanicalSymmetricPolicy>();
+}
+
+}
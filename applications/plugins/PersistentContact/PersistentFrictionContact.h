@@ -140,6 +140,9 @@ public:
 
     void createResponse(core::objectmodel::BaseContext* group);
 
+    /// The persistent contact mappings are searched in the scene graph: no concurrent update
+    bool updateResponse(OutputVector* /*outputs*/) { return false; }
+
     virtual void removeResponse();
 
     void init();
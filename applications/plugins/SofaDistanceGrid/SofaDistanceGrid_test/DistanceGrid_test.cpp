@@ -21,10 +21,15 @@
 ******************************************************************************/
 #include <sofa/testing/NumericTest.h>
 #include <sofa/type/Vec.h>
+#include <sofa/helper/io/Mesh.h>
 
 #include <SofaDistanceGrid/DistanceGrid.h>
 using sofa::component::container::DistanceGrid ;
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
 namespace sofa
 {
 namespace component
@@ -72,6 +77,29 @@ struct DistanceGrid_test : public sofa::testing::NumericTest<SReal>
                           DistanceGrid::Coord(mx,my,mz),
                           DistanceGrid::Coord(ex,ey,ez)) ;
     }
+
+    /// Cube of the given half-size made of 6 quads oriented outwards
+    static void createCubeMesh(sofa::helper::io::Mesh& mesh, SReal dim)
+    {
+        for (int i=0; i<8; i++)
+            mesh.getVertices().emplace_back((i&1) ? dim : -dim, (i&2) ? dim : -dim, (i&4) ? dim : -dim);
+        const std::vector< std::vector<sofa::Index> > quads = {
+            {0,2,3,1}, {4,5,7,6}, {0,1,5,4}, {2,6,7,3}, {0,4,6,2}, {1,3,7,5} };
+        for (const auto& quad : quads)
+            mesh.getFacets().push_back({ sofa::type::vector<sofa::Index>(quad.begin(), quad.end()), {}, {} });
+    }
+
+    /// Exact signed distance to the cube of the given half-size
+    static SReal cubeDistance(const Vec3& p, SReal dim)
+    {
+        Vec3 q;
+        for (int c=0; c<3; c++)
+            q[c] = std::abs(p[c]) - dim;
+        Vec3 outside;
+        for (int c=0; c<3; c++)
+            outside[c] = std::max(q[c], (SReal)0);
+        return outside.norm() + std::min(std::max(q[0], std::max(q[1], q[2])), (SReal)0);
+    }
 };
 
 TEST_F(DistanceGrid_test, chekcValidConstructorsCube) {
@@ -95,6 +123,107 @@ TEST_F(DistanceGrid_test, chekcInvalidConstructorsCube) {
     }
 }
 
+TEST_F(DistanceGrid_test, sparseDistanceFromMesh)
+{
+    sofa::helper::io::Mesh mesh;
+    createCubeMesh(mesh, 0.5);
+
+    DistanceGrid grid(80, 80, 80, DistanceGrid::Coord(-1,-1,-1), DistanceGrid::Coord(1,1,1), 3);
+    grid.calcDistance(&mesh);
+
+    ASSERT_TRUE(grid.isSparse());
+    const SReal band = grid.getBandWidth();
+    EXPECT_NEAR(band, 3*2.0/79, 1e-12);
+    EXPECT_GT(grid.getNbTiles(), 0);
+    EXPECT_LT(grid.getNbTiles(), 10*10*10);
+
+    // exact distances within the band, clamped outside of it with the right sign
+    for (int z=0; z<grid.getNz(); z++)
+        for (int y=0; y<grid.getNy(); y++)
+            for (int x=0; x<grid.getNx(); x++)
+            {
+                const SReal expected = std::clamp(cubeDistance(grid.coord(x,y,z), 0.5), -band, band);
+                ASSERT_NEAR(grid.value(x,y,z), expected, 1e-9) << x << " " << y << " " << z;
+                ASSERT_EQ(grid[grid.index(x,y,z)], grid.value(x,y,z));
+            }
+
+    EXPECT_NEAR(grid.interp(Vec3(0.45, 0.1, 0.2)), -0.05, 1e-9);
+    EXPECT_NEAR(grid.interp(Vec3(0.1, 0.55, -0.2)), 0.05, 1e-9);
+    EXPECT_EQ(grid.interp(Vec3(0, 0, 0)), -band);
+    EXPECT_EQ(grid.interp(Vec3(0.9, -0.9, 0.9)), band);
+}
+
+TEST_F(DistanceGrid_test, makeSparseKeepsNarrowBand)
+{
+    DistanceGrid dense(40, 40, 40, DistanceGrid::Coord(-1,-1,-1), DistanceGrid::Coord(1,1,1));
+    dense.calcCubeDistance(0.5, 0);
+    DistanceGrid sparse(40, 40, 40, DistanceGrid::Coord(-1,-1,-1), DistanceGrid::Coord(1,1,1));
+    sparse.calcCubeDistance(0.5, 0);
+    sparse.makeSparse(2);
+
+    ASSERT_TRUE(sparse.isSparse());
+    ASSERT_FALSE(dense.isSparse());
+    const SReal band = sparse.getBandWidth();
+    for (int i=0; i<dense.size(); i++)
+    {
+        ASSERT_EQ(sparse[i], std::clamp(dense[i], -band, band)) << i;
+    }
+
+    const Vec3 p(0.48, -0.1, 0.3);
+    EXPECT_EQ(sparse.interp(p), dense.interp(p));
+    EXPECT_EQ(sparse.grad(p), dense.grad(p));
+}
+
+TEST_F(DistanceGrid_test, tricubicInterpolation)
+{
+    DistanceGrid grid(40, 40, 40, DistanceGrid::Coord(-1,-1,-1), DistanceGrid::Coord(1,1,1));
+    grid.calcCubeDistance(0.5, 0);
+
+    // the distance is linear around this point, which must be reproduced exactly
+    const Vec3 p(0.45, 0.01, 0.02);
+    EXPECT_NEAR(grid.interpCubic(p), -0.05, 1e-9);
+    EXPECT_NEAR(grid.interpCubic(p), grid.interp(p), 1e-9);
+    const Vec3 gradient = grid.gradCubic(p);
+    EXPECT_NEAR(gradient[0], grid.getCellWidth()[0], 1e-9);
+    EXPECT_NEAR(gradient[1], 0, 1e-9);
+    EXPECT_NEAR(gradient[2], 0, 1e-9);
+}
+
+TEST_F(DistanceGrid_test, sparseDistanceCache)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "DistanceGrid_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string meshFile = (directory / "cube.obj").string();
+    const std::string cacheDirectory = (directory / "cache").string();
+    {
+        std::ofstream obj(meshFile);
+        for (int i=0; i<8; i++)
+            obj << "v " << ((i&1) ? 0.5 : -0.5) << " " << ((i&2) ? 0.5 : -0.5) << " " << ((i&4) ? 0.5 : -0.5) << "\n";
+        obj << "f 1 3 4 2\nf 5 6 8 7\nf 1 2 6 5\nf 3 7 8 4\nf 1 5 7 3\nf 2 4 8 6\n";
+    }
+
+    DistanceGrid* computed = DistanceGrid::load(meshFile, 1.0, 0.0, 32, 32, 32, DistanceGrid::Coord(), DistanceGrid::Coord(), 2, cacheDirectory);
+    ASSERT_NE(computed, nullptr);
+    ASSERT_TRUE(computed->isSparse());
+    ASSERT_EQ(std::distance(std::filesystem::directory_iterator(cacheDirectory), std::filesystem::directory_iterator()), 1);
+
+    DistanceGrid* cached = DistanceGrid::load(meshFile, 1.0, 0.0, 32, 32, 32, DistanceGrid::Coord(), DistanceGrid::Coord(), 2, cacheDirectory);
+    ASSERT_NE(cached, nullptr);
+    ASSERT_TRUE(cached->isSparse());
+    EXPECT_EQ(cached->getPMin(), computed->getPMin());
+    EXPECT_EQ(cached->getPMax(), computed->getPMax());
+    EXPECT_EQ(cached->getNbTiles(), computed->getNbTiles());
+    EXPECT_EQ(cached->meshPts.size(), 8u);
+    for (int i=0; i<computed->size(); i++)
+    {
+        ASSERT_EQ((*cached)[i], (*computed)[i]) << i;
+    }
+
+    computed->release();
+    cached->release();
+    std::filesystem::remove_all(directory);
+}
 
 } // __distance_grid__
 } // container
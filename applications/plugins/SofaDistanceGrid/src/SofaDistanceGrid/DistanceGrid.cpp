@@ -30,8 +30,18 @@
 #include <flowvr/render/mesh.h>
 #endif
 
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
+#include <unordered_map>
 
 #include <sofa/helper/logging/Messaging.h>
 
@@ -70,6 +80,13 @@ const Coord calcInvCellWidth(const int nx, const int ny,const int nz,
     return Coord((nx-1)/(pmax[0]-pmin[0]), (ny-1)/(pmax[1]-pmin[1]),(nz-1)/(pmax[2]-pmin[2])) ;
 }
 
+/// Voxel size used to express the width of a narrow band: the band must be at least one cell wide in
+/// every direction for the signs of the voxels outside of it to be propagated from their neighbors
+SReal calcBandUnit(const Coord& cellWidth)
+{
+    return rmax(rmax(rabs(cellWidth[0]), rabs(cellWidth[1])), rabs(cellWidth[2]));
+}
+
 int validateDim(int n)
 {
     if(n<0){
@@ -79,17 +96,21 @@ int validateDim(int n)
     return n;
 }
 
-DistanceGrid::DistanceGrid(int nx, int ny, int nz, Coord pmin, Coord pmax)
+DistanceGrid::DistanceGrid(int nx, int ny, int nz, Coord pmin, Coord pmax, int narrowBand)
     : meshPts()
     , m_nbRef(1)
     , m_nx(validateDim(nx)), m_ny(validateDim(ny)), m_nz(validateDim(nz))
     , m_nxny(m_nx*m_ny), m_nxnynz(m_nx*m_ny*m_nz)
-    , m_dists(m_nx*m_ny*m_nz)
+    , m_dists(narrowBand > 0 ? 0 : m_nx*m_ny*m_nz)
     , m_pmin(pmin), m_pmax(pmax)
     , m_cellWidth   (calcCellWidth(m_nx,m_ny,m_nz,pmin,pmax))
     , m_invCellWidth(calcInvCellWidth(m_nx,m_ny,m_nz,pmin,pmax))
     , m_cubeDim(0)
+    , m_bandWidth(0)
+    , m_tnx(0), m_tny(0), m_tnz(0)
 {
+    if (narrowBand > 0)
+        initTiles(narrowBand * calcBandUnit(m_cellWidth));
 }
 
 DistanceGrid::~DistanceGrid()
@@ -120,8 +141,19 @@ bool DistanceGrid::release()
 //todo(dmarchal) we should make a loader for that...
 DistanceGrid* DistanceGrid::load(const std::string& filename,
                                  double scale, double sampling,
-                                 int nx, int ny, int nz, Coord pmin, Coord pmax)
+                                 int nx, int ny, int nz, Coord pmin, Coord pmax,
+                                 int narrowBand, const std::string& cacheDirectory)
 {
+    const bool isMesh = filename.length()>4 && filename.substr(filename.length()-4) == ".obj";
+    if (narrowBand > 0 && !isMesh)
+    {
+        // other sources provide dense distances: only the narrow band is kept once they are loaded
+        DistanceGrid* grid = load(filename, scale, sampling, nx, ny, nz, pmin, pmax);
+        if (grid && !grid->isSparse())
+            grid->makeSparse(narrowBand);
+        return grid;
+    }
+
     double absscale=fabs(scale);
     if (filename == "#cube")
     {
@@ -169,6 +201,10 @@ DistanceGrid* DistanceGrid::load(const std::string& filename,
     {
         return loadVTKFile(filename, scale, sampling);
     }
+    else if (filename.length()>4 && filename.substr(filename.length()-4) == ".sdf")
+    {
+        return loadSparseFile(filename, scale, sampling);
+    }
     else if (filename.length()>6 && filename.substr(filename.length()-6) == ".fmesh")
     {
 #if SOFADISTANCEGRID_HAVE_MINIFLOWVR
@@ -233,9 +269,14 @@ DistanceGrid* DistanceGrid::load(const std::string& filename,
         return NULL;
 #endif // SOFADISTANCEGRID_HAVE_MINIFLOWVR
     }
-    else if (filename.length()>4 && filename.substr(filename.length()-4) == ".obj")
+    else if (isMesh)
     {
         Mesh* mesh = Mesh::Create(filename);
+        if (!mesh)
+        {
+            msg_error("DistanceGrid")<<"loading mesh file "<<filename;
+            return NULL;
+        }
         const auto & vertices = mesh->getVertices();
 
         Coord bbmin, bbmax;
@@ -269,8 +310,27 @@ DistanceGrid* DistanceGrid::load(const std::string& filename,
                 if (bbmax[c] > pmax[c]) pmax[c] = bbmax[c];
             }
         }
-        DistanceGrid* grid = new DistanceGrid(nx, ny, nz, pmin, pmax);
-        grid->calcDistance(mesh, scale);
+        DistanceGrid* grid = nullptr;
+        std::string cacheFile;
+        if (narrowBand > 0 && !cacheDirectory.empty())
+        {
+            cacheFile = cacheDirectory + "/" + computeMeshHash(mesh, scale, nx, ny, nz, pmin, pmax, narrowBand) + ".sdf";
+            grid = loadSparseFile(cacheFile);
+            if (grid)
+                msg_info("DistanceGrid") << "Distance field of " << filename << " loaded from cache file " << cacheFile;
+        }
+        if (!grid)
+        {
+            grid = new DistanceGrid(nx, ny, nz, pmin, pmax, narrowBand);
+            grid->calcDistance(mesh, scale);
+            if (!cacheFile.empty())
+            {
+                std::error_code error;
+                std::filesystem::create_directories(cacheDirectory, error);
+                if (!grid->save(cacheFile))
+                    msg_warning("DistanceGrid") << "Unable to write cache file " << cacheFile;
+            }
+        }
         if (sampling)
             grid->sampleSurface(sampling);
         else
@@ -296,7 +356,30 @@ bool DistanceGrid::save(const std::string& filename)
     if (filename.length()>4 && filename.substr(filename.length()-4) == ".raw")
     {
         std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
-        out.write((char*)&(m_dists[0]), m_nxnynz*sizeof(SReal));
+        if (!isSparse())
+        {
+            out.write((char*)&(m_dists[0]), m_nxnynz*sizeof(SReal));
+        }
+        else
+        {
+            VecSReal row(m_nx);
+            for (int z=0; z<m_nz; z++)
+                for (int y=0; y<m_ny; y++)
+                {
+                    for (int x=0; x<m_nx; x++)
+                        row[x] = value(x,y,z);
+                    out.write((char*)&(row[0]), m_nx*sizeof(SReal));
+                }
+        }
+    }
+    else if (filename.length()>4 && filename.substr(filename.length()-4) == ".sdf")
+    {
+        if (!isSparse())
+        {
+            msg_error("DistanceGrid")<<" save(): the .sdf format requires a sparse grid: "<<filename;
+            return false;
+        }
+        return saveSparseFile(filename);
     }
     else
     {
@@ -557,6 +640,11 @@ void DistanceGrid::computeBBox()
 /// Also create a mesh of points using np points per axis
 void DistanceGrid::calcCubeDistance(SReal dim, int np)
 {
+    if (isSparse())
+    {
+        msg_error("DistanceGrid") << "calcCubeDistance() requires a dense grid, use makeSparse() once the distances are computed";
+        return;
+    }
     m_cubeDim = dim;
     if (np > 1)
     {
@@ -598,6 +686,12 @@ void DistanceGrid::calcCubeDistance(SReal dim, int np)
 /// Compute distance field from given mesh
 void DistanceGrid::calcDistance(sofa::helper::io::Mesh* mesh, double scale)
 {
+    if (isSparse())
+    {
+        calcSparseDistance(mesh, scale);
+        return;
+    }
+
     m_fmm_status.resize(m_nxnynz);
     m_fmm_heap.resize(m_nxnynz);
     m_fmm_heap_size = 0;
@@ -1141,6 +1235,642 @@ void DistanceGrid::fmm_push(int index)
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Sparse storage
+////////////////////////////////////////////////////////////////////////////////
+
+static const char SparseFileMagic[8] = "SOFASDF";
+static const std::uint32_t SparseFileVersion = 1;
+
+/// 64 bits FNV-1a hash
+struct FNVHash
+{
+    std::uint64_t value = 14695981039346656037ull;
+
+    template<class T>
+    void add(const T& v)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+        for (std::size_t i=0; i<sizeof(T); ++i)
+        {
+            value ^= bytes[i];
+            value *= 1099511628211ull;
+        }
+    }
+};
+
+/// Closest point of the triangle (a,b,c) to p, returning the feature it lies on: 0 to 2 for the
+/// vertices a, b and c, 3 to 5 for the edges ab, bc and ca, and 6 for the interior of the triangle
+int closestPointOnTriangle(const Coord& p, const Coord& a, const Coord& b, const Coord& c, Coord& closest)
+{
+    const Coord ab = b-a, ac = c-a, ap = p-a;
+    const SReal d1 = ab*ap, d2 = ac*ap;
+    if (d1 <= 0 && d2 <= 0) { closest = a; return 0; }
+
+    const Coord bp = p-b;
+    const SReal d3 = ab*bp, d4 = ac*bp;
+    if (d3 >= 0 && d4 <= d3) { closest = b; return 1; }
+
+    const SReal vc = d1*d4 - d3*d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) { closest = a + ab*(d1/(d1-d3)); return 3; }
+
+    const Coord cp = p-c;
+    const SReal d5 = ab*cp, d6 = ac*cp;
+    if (d6 >= 0 && d5 <= d6) { closest = c; return 2; }
+
+    const SReal vb = d5*d2 - d1*d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) { closest = a + ac*(d2/(d2-d6)); return 5; }
+
+    const SReal va = d3*d6 - d5*d4;
+    if (va <= 0 && (d4-d3) >= 0 && (d5-d6) >= 0) { closest = b + (c-b)*((d4-d3)/((d4-d3)+(d5-d6))); return 4; }
+
+    const SReal denom = 1/(va+vb+vc);
+    closest = a + ab*(vb*denom) + ac*(vc*denom);
+    return 6;
+}
+
+/// Catmull-Rom weights of the 4 samples around a point at t in [0,1] between the 2 middle samples
+void catmullRomWeights(SReal t, SReal w[4])
+{
+    w[0] = ((-t+2)*t-1)*t*0.5f;
+    w[1] = ((3*t-5)*t*t+2)*0.5f;
+    w[2] = ((-3*t+4)*t+1)*t*0.5f;
+    w[3] = (t-1)*t*t*0.5f;
+}
+
+void catmullRomDerivatives(SReal t, SReal dw[4])
+{
+    dw[0] = ((-3*t+4)*t-1)*0.5f;
+    dw[1] = (9*t-10)*t*0.5f;
+    dw[2] = ((-9*t+8)*t+1)*0.5f;
+    dw[3] = (3*t-2)*t*0.5f;
+}
+
+void DistanceGrid::initTiles(SReal bandWidth)
+{
+    m_bandWidth = bandWidth;
+    m_tnx = (m_nx+TileSize-1) >> TileBits;
+    m_tny = (m_ny+TileSize-1) >> TileBits;
+    m_tnz = (m_nz+TileSize-1) >> TileBits;
+    m_tiles.assign(m_tnx*m_tny*m_tnz, TILE_OUTSIDE);
+    m_tileValues.clear();
+}
+
+void DistanceGrid::makeSparse(int narrowBand)
+{
+    if (isSparse() || narrowBand <= 0)
+        return;
+
+    VecSReal dists;
+    dists.swap(m_dists);
+    initTiles(narrowBand * calcBandUnit(m_cellWidth));
+
+    for (int tz=0, t=0; tz<m_tnz; tz++)
+        for (int ty=0; ty<m_tny; ty++)
+            for (int tx=0; tx<m_tnx; tx++, t++)
+            {
+                const int x0 = tx << TileBits, x1 = std::min(x0+TileSize, m_nx);
+                const int y0 = ty << TileBits, y1 = std::min(y0+TileSize, m_ny);
+                const int z0 = tz << TileBits, z1 = std::min(z0+TileSize, m_nz);
+
+                bool inside = false, outside = false, band = false;
+                for (int z=z0; z<z1; z++)
+                    for (int y=y0; y<y1; y++)
+                        for (int x=x0; x<x1; x++)
+                        {
+                            const SReal d = dists[x+m_nx*(y+m_ny*z)];
+                            if (d <= -m_bandWidth) inside = true;
+                            else if (d >= m_bandWidth) outside = true;
+                            else band = true;
+                        }
+                if (!band && !(inside && outside))
+                {
+                    m_tiles[t] = inside ? TILE_INSIDE : TILE_OUTSIDE;
+                    continue;
+                }
+
+                const int offset = (int)m_tileValues.size();
+                m_tileValues.resize(offset + TileVoxels, m_bandWidth);
+                m_tiles[t] = offset;
+                for (int z=z0; z<z1; z++)
+                    for (int y=y0; y<y1; y++)
+                        for (int x=x0; x<x1; x++)
+                            m_tileValues[offset + tileOffset(x,y,z)] = std::clamp(dists[x+m_nx*(y+m_ny*z)], -m_bandWidth, m_bandWidth);
+            }
+
+    msg_info("DistanceGrid") << "Sparse storage: " << getNbTiles() << " tiles out of " << m_tiles.size()
+                             << " ( " << (m_tiles.empty() ? 0 : (getNbTiles()*100)/(int)m_tiles.size()) << " % )";
+}
+
+void DistanceGrid::calcSparseDistance(sofa::helper::io::Mesh* mesh, double scale)
+{
+    const auto& vertices = mesh->getVertices();
+    const auto& facets = mesh->getFacets();
+    const SReal band = m_bandWidth;
+    const SReal unknown = maxDist();
+
+    VecCoord points(vertices.size());
+    for (std::size_t i=0; i<vertices.size(); i++)
+        points[i] = vertices[i]*scale;
+
+    type::vector< type::Vec<3,int> > triangles;
+    for (const auto& facet : facets)
+    {
+        if (facet.empty()) continue;
+        const auto& pts = facet[0];
+        for (std::size_t pt2=2; pt2<pts.size(); pt2++)
+            triangles.emplace_back((int)pts[0], (int)pts[pt2-1], (int)pts[pt2]);
+    }
+
+    // The sign of the distance is given by the angle-weighted pseudo-normal of the closest feature
+    // (Baerentzen and Aanaes, "Signed distance computation using the angle weighted pseudonormal", 2005)
+    VecCoord triangleNormals(triangles.size());
+    VecCoord vertexNormals(points.size());
+    VecCoord edgeNormals;
+    type::vector< type::Vec<3,int> > triangleEdges(triangles.size());
+    std::unordered_map<std::uint64_t, int> edgeIds;
+    for (std::size_t t=0; t<triangles.size(); t++)
+    {
+        const auto& tri = triangles[t];
+        Coord n = (points[tri[1]]-points[tri[0]]).cross(points[tri[2]]-points[tri[0]]);
+        const SReal norm = n.norm();
+        if (norm <= std::numeric_limits<SReal>::min())
+            continue; // degenerate triangles are ignored
+        n /= norm;
+        triangleNormals[t] = n;
+        for (int j=0; j<3; j++)
+        {
+            const int a = tri[j], b = tri[(j+1)%3], c = tri[(j+2)%3];
+            const Coord e1 = points[b]-points[a], e2 = points[c]-points[a];
+            const SReal cosAngle = (e1*e2) / (e1.norm()*e2.norm());
+            vertexNormals[a] += n * acos(std::clamp(cosAngle, (SReal)-1, (SReal)1));
+
+            const std::uint64_t key = (std::uint64_t(std::min(a,b)) << 32) | std::uint64_t(std::max(a,b));
+            const auto edge = edgeIds.emplace(key, (int)edgeNormals.size());
+            if (edge.second)
+                edgeNormals.push_back(Coord());
+            edgeNormals[edge.first->second] += n;
+            triangleEdges[t][j] = edge.first->second;
+        }
+    }
+
+    // Find the triangles within the narrow band of each tile
+    const Coord tileExtent = m_cellWidth*(TileSize-1);
+    const SReal tileRadius = tileExtent.norm()*0.5f;
+    type::vector< type::vector<int> > tileTriangles(m_tiles.size());
+    for (std::size_t t=0; t<triangles.size(); t++)
+    {
+        const Coord& n = triangleNormals[t];
+        if (n.norm2() == 0) continue;
+        const auto& tri = triangles[t];
+        Coord bbmin = points[tri[0]], bbmax = bbmin;
+        for (int j=1; j<3; j++)
+            for (int c=0; c<3; c++)
+            {
+                bbmin[c] = std::min(bbmin[c], points[tri[j]][c]);
+                bbmax[c] = std::max(bbmax[c], points[tri[j]][c]);
+            }
+        const int n3[3] = { m_nx, m_ny, m_nz };
+        int i0[3], i1[3];
+        bool empty = false;
+        for (int c=0; c<3; c++)
+        {
+            i0[c] = std::max(0, (int)std::ceil((bbmin[c]-band-m_pmin[c])*m_invCellWidth[c]));
+            i1[c] = std::min(n3[c]-1, (int)std::floor((bbmax[c]+band-m_pmin[c])*m_invCellWidth[c]));
+            if (i0[c] > i1[c]) empty = true;
+        }
+        if (empty) continue;
+
+        for (int tz=(i0[2]>>TileBits); tz<=(i1[2]>>TileBits); tz++)
+            for (int ty=(i0[1]>>TileBits); ty<=(i1[1]>>TileBits); ty++)
+                for (int tx=(i0[0]>>TileBits); tx<=(i1[0]>>TileBits); tx++)
+                {
+                    // skip the tiles too far from the plane of the triangle
+                    const Coord center = m_pmin + Coord((tx<<TileBits)*m_cellWidth[0], (ty<<TileBits)*m_cellWidth[1], (tz<<TileBits)*m_cellWidth[2]) + tileExtent*0.5f;
+                    if (rabs((center-points[tri[0]])*n) > tileRadius + band) continue;
+                    tileTriangles[tx+m_tnx*(ty+m_tny*tz)].push_back((int)t);
+                }
+    }
+
+    type::vector<int> activeTiles;
+    for (std::size_t t=0; t<m_tiles.size(); t++)
+    {
+        if (tileTriangles[t].empty())
+        {
+            m_tiles[t] = TILE_OUTSIDE;
+        }
+        else
+        {
+            m_tiles[t] = (int)activeTiles.size()*TileVoxels;
+            activeTiles.push_back((int)t);
+        }
+    }
+    m_tileValues.assign(activeTiles.size()*TileVoxels, band);
+
+    // Exact distances within the band, computed in parallel over the tiles if the task scheduler has been
+    // initialized (see the parallelSparseDistance data of the components loading the grids)
+    simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+
+    const auto computeTile = [&](const std::size_t i)
+    {
+        const int tile = activeTiles[i];
+        const int tx = tile%m_tnx, ty = (tile/m_tnx)%m_tny, tz = tile/(m_tnx*m_tny);
+        const type::vector<int>& candidates = tileTriangles[tile];
+        SReal* values = &m_tileValues[i*TileVoxels];
+
+        for (int z=(tz<<TileBits); z<std::min((tz+1)<<TileBits, m_nz); z++)
+            for (int y=(ty<<TileBits); y<std::min((ty+1)<<TileBits, m_ny); y++)
+                for (int x=(tx<<TileBits); x<std::min((tx+1)<<TileBits, m_nx); x++)
+                {
+                    const Coord p = coord(x,y,z);
+                    SReal minDist2 = band*band;
+                    int closestTriangle = -1, closestFeature = 0;
+                    Coord closestPoint;
+                    for (const int t : candidates)
+                    {
+                        const auto& tri = triangles[t];
+                        Coord q;
+                        const int feature = closestPointOnTriangle(p, points[tri[0]], points[tri[1]], points[tri[2]], q);
+                        const SReal dist2 = (p-q).norm2();
+                        if (dist2 < minDist2)
+                        {
+                            minDist2 = dist2;
+                            closestTriangle = t;
+                            closestFeature = feature;
+                            closestPoint = q;
+                        }
+                    }
+
+                    SReal& d = values[tileOffset(x,y,z)];
+                    if (closestTriangle < 0)
+                    {
+                        d = unknown; // outside of the band, its sign is found below
+                        continue;
+                    }
+                    const Coord& normal = (closestFeature < 3) ? vertexNormals[triangles[closestTriangle][closestFeature]]
+                                        : (closestFeature < 6) ? edgeNormals[triangleEdges[closestTriangle][closestFeature-3]]
+                                        : triangleNormals[closestTriangle];
+                    d = helper::rsqrt(minDist2);
+                    if ((p-closestPoint)*normal < 0)
+                        d = -d;
+                }
+    };
+    if (taskScheduler->getThreadCount() > 0)
+        simulation::parallelForEach(*taskScheduler, std::size_t(0), activeTiles.size(), computeTile);
+    else
+        simulation::forEach(std::size_t(0), activeTiles.size(), computeTile);
+
+    // The voxels and tiles outside of the band take the sign of their neighbors: as the band is at
+    // least one cell wide, the surface cannot lie between them
+    const auto voxel = [this](int x, int y, int z) -> SReal*
+    {
+        const int tile = m_tiles[(x>>TileBits)+m_tnx*((y>>TileBits)+m_tny*(z>>TileBits))];
+        return (tile < 0) ? nullptr : &m_tileValues[tile + tileOffset(x,y,z)];
+    };
+    const auto inGrid = [this](int x, int y, int z)
+    {
+        return x>=0 && y>=0 && z>=0 && x<m_nx && y<m_ny && z<m_nz;
+    };
+    static const int neighbors[6][3] = { {-1,0,0}, {1,0,0}, {0,-1,0}, {0,1,0}, {0,0,-1}, {0,0,1} };
+
+    std::deque< type::Vec<3,int> > front;
+    const auto propagate = [&]()
+    {
+        while (!front.empty())
+        {
+            const type::Vec<3,int> v = front.front();
+            front.pop_front();
+            const SReal d = (*voxel(v[0],v[1],v[2]) < 0) ? -band : band;
+            for (const auto& n : neighbors)
+            {
+                const int x = v[0]+n[0], y = v[1]+n[1], z = v[2]+n[2];
+                if (!inGrid(x,y,z)) continue;
+                SReal* neighbor = voxel(x,y,z);
+                if (neighbor && *neighbor == unknown)
+                {
+                    *neighbor = d;
+                    front.emplace_back(x,y,z);
+                }
+            }
+        }
+    };
+    const auto forEachActiveVoxel = [&](const auto& f)
+    {
+        for (const int tile : activeTiles)
+        {
+            const int tx = tile%m_tnx, ty = (tile/m_tnx)%m_tny, tz = tile/(m_tnx*m_tny);
+            for (int z=(tz<<TileBits); z<std::min((tz+1)<<TileBits, m_nz); z++)
+                for (int y=(ty<<TileBits); y<std::min((ty+1)<<TileBits, m_ny); y++)
+                    for (int x=(tx<<TileBits); x<std::min((tx+1)<<TileBits, m_nx); x++)
+                        f(x, y, z);
+        }
+    };
+
+    // 1. voxels of the active tiles, from their neighbors in the band
+    forEachActiveVoxel([&](int x, int y, int z)
+    {
+        if (*voxel(x,y,z) != unknown) return;
+        for (const auto& n : neighbors)
+        {
+            if (!inGrid(x+n[0],y+n[1],z+n[2])) continue;
+            const SReal* neighbor = voxel(x+n[0],y+n[1],z+n[2]);
+            if (neighbor && *neighbor != unknown)
+            {
+                *voxel(x,y,z) = (*neighbor < 0) ? -band : band;
+                front.emplace_back(x,y,z);
+                break;
+            }
+        }
+    });
+    propagate();
+
+    // 2. connected groups of inactive tiles, from a voxel of an active tile next to one of them
+    type::vector<bool> visited(m_tiles.size(), false);
+    for (std::size_t t0=0; t0<m_tiles.size(); t0++)
+    {
+        if (m_tiles[t0] >= 0 || visited[t0]) continue;
+        type::vector<int> group(1, (int)t0);
+        visited[t0] = true;
+        int status = TILE_OUTSIDE;
+        bool found = false;
+        for (std::size_t g=0; g<group.size(); g++)
+        {
+            const int tile = group[g];
+            const int tx = tile%m_tnx, ty = (tile/m_tnx)%m_tny, tz = tile/(m_tnx*m_tny);
+            for (const auto& n : neighbors)
+            {
+                const int ntx = tx+n[0], nty = ty+n[1], ntz = tz+n[2];
+                if (ntx<0 || nty<0 || ntz<0 || ntx>=m_tnx || nty>=m_tny || ntz>=m_tnz) continue;
+                const int ntile = ntx+m_tnx*(nty+m_tny*ntz);
+                if (m_tiles[ntile] < 0)
+                {
+                    if (!visited[ntile])
+                    {
+                        visited[ntile] = true;
+                        group.push_back(ntile);
+                    }
+                }
+                else if (!found)
+                {
+                    // voxel of the active tile next to the corner voxel of this tile
+                    const int x = (n[0] < 0) ? (tx<<TileBits)-1 : (n[0] > 0) ? (ntx<<TileBits) : (tx<<TileBits);
+                    const int y = (n[1] < 0) ? (ty<<TileBits)-1 : (n[1] > 0) ? (nty<<TileBits) : (ty<<TileBits);
+                    const int z = (n[2] < 0) ? (tz<<TileBits)-1 : (n[2] > 0) ? (ntz<<TileBits) : (tz<<TileBits);
+                    const SReal neighbor = *voxel(x,y,z);
+                    if (neighbor != unknown)
+                    {
+                        status = (neighbor < 0) ? TILE_INSIDE : TILE_OUTSIDE;
+                        found = true;
+                    }
+                }
+            }
+        }
+        for (const int tile : group)
+            m_tiles[tile] = status;
+    }
+
+    // 3. remaining voxels of the active tiles, from the inactive tiles next to them
+    forEachActiveVoxel([&](int x, int y, int z)
+    {
+        if (*voxel(x,y,z) != unknown) return;
+        for (const auto& n : neighbors)
+        {
+            if (!inGrid(x+n[0],y+n[1],z+n[2])) continue;
+            if (voxel(x+n[0],y+n[1],z+n[2]) == nullptr)
+            {
+                *voxel(x,y,z) = value(x+n[0],y+n[1],z+n[2]);
+                front.emplace_back(x,y,z);
+                break;
+            }
+        }
+    });
+    propagate();
+    forEachActiveVoxel([&](int x, int y, int z)
+    {
+        if (*voxel(x,y,z) == unknown)
+            *voxel(x,y,z) = band;
+    });
+
+    msg_info("DistanceGrid") << "Sparse distance field of " << triangles.size() << " triangles: " << getNbTiles()
+                             << " tiles out of " << m_tiles.size() << " ( " << (m_tiles.empty() ? 0 : (getNbTiles()*100)/(int)m_tiles.size()) << " % )";
+}
+
+std::string DistanceGrid::computeMeshHash(const Mesh* mesh, double scale,
+                                          int nx, int ny, int nz,
+                                          const Coord& pmin, const Coord& pmax, int narrowBand)
+{
+    FNVHash hash;
+    hash.add(SparseFileVersion);
+    hash.add(std::uint32_t(sizeof(SReal)));
+    hash.add(scale);
+    hash.add(nx);
+    hash.add(ny);
+    hash.add(nz);
+    for (int c=0; c<3; c++)
+    {
+        hash.add(double(pmin[c]));
+        hash.add(double(pmax[c]));
+    }
+    hash.add(narrowBand);
+    for (const auto& v : mesh->getVertices())
+        for (int c=0; c<3; c++)
+            hash.add(double(v[c]));
+    for (const auto& facet : mesh->getFacets())
+    {
+        if (facet.empty()) continue;
+        hash.add(std::uint64_t(facet[0].size()));
+        for (const auto p : facet[0])
+            hash.add(std::uint64_t(p));
+    }
+
+    std::ostringstream str;
+    str << std::hex << std::setw(16) << std::setfill('0') << hash.value;
+    return str.str();
+}
+
+bool DistanceGrid::saveSparseFile(const std::string& filename) const
+{
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!out.is_open())
+        return false;
+
+    const std::uint32_t header[3] = { SparseFileVersion, std::uint32_t(sizeof(SReal)), std::uint32_t(TileSize) };
+    const std::int32_t dims[3] = { m_nx, m_ny, m_nz };
+    const double box[7] = { m_pmin[0], m_pmin[1], m_pmin[2], m_pmax[0], m_pmax[1], m_pmax[2], m_bandWidth };
+    const std::uint64_t nbValues = m_tileValues.size();
+    out.write(SparseFileMagic, sizeof(SparseFileMagic));
+    out.write((const char*)header, sizeof(header));
+    out.write((const char*)dims, sizeof(dims));
+    out.write((const char*)box, sizeof(box));
+    out.write((const char*)m_tiles.data(), m_tiles.size()*sizeof(int));
+    out.write((const char*)&nbValues, sizeof(nbValues));
+    out.write((const char*)m_tileValues.data(), nbValues*sizeof(SReal));
+    return out.good();
+}
+
+DistanceGrid* DistanceGrid::loadSparseFile(const std::string& filename, double scale, double sampling)
+{
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!in.is_open())
+        return nullptr;
+
+    char magic[sizeof(SparseFileMagic)];
+    std::uint32_t header[3];
+    std::int32_t dims[3];
+    double box[7];
+    in.read(magic, sizeof(magic));
+    in.read((char*)header, sizeof(header));
+    in.read((char*)dims, sizeof(dims));
+    in.read((char*)box, sizeof(box));
+    if (!in || std::memcmp(magic, SparseFileMagic, sizeof(magic)) != 0
+        || header[0] != SparseFileVersion || header[1] != sizeof(SReal) || header[2] != TileSize
+        || dims[0] < 2 || dims[1] < 2 || dims[2] < 2 || !(box[6] > 0))
+    {
+        msg_warning("DistanceGrid") << "Invalid or outdated sparse distance grid file " << filename;
+        return nullptr;
+    }
+
+    const double absscale = fabs(scale);
+    DistanceGrid* grid = new DistanceGrid(dims[0], dims[1], dims[2],
+                                          Coord(box[0], box[1], box[2])*absscale,
+                                          Coord(box[3], box[4], box[5])*absscale, 1);
+    grid->initTiles((SReal)(box[6]*absscale));
+    std::uint64_t nbValues = 0;
+    in.read((char*)grid->m_tiles.data(), grid->m_tiles.size()*sizeof(int));
+    in.read((char*)&nbValues, sizeof(nbValues));
+    bool ok = in && nbValues % TileVoxels == 0 && nbValues <= (std::uint64_t)std::numeric_limits<int>::max();
+    for (std::size_t t=0; ok && t<grid->m_tiles.size(); t++)
+    {
+        const int tile = grid->m_tiles[t];
+        ok = (tile == TILE_INSIDE || tile == TILE_OUTSIDE || (tile >= 0 && tile % TileVoxels == 0 && (std::uint64_t)tile < nbValues));
+    }
+    if (ok)
+    {
+        grid->m_tileValues.resize(nbValues);
+        in.read((char*)grid->m_tileValues.data(), nbValues*sizeof(SReal));
+        ok = (bool)in;
+    }
+    if (!ok)
+    {
+        msg_warning("DistanceGrid") << "Invalid or outdated sparse distance grid file " << filename;
+        delete grid;
+        return nullptr;
+    }
+    if (absscale != 1.0)
+    {
+        for (auto& d : grid->m_tileValues)
+            d *= (SReal)absscale;
+    }
+    grid->computeBBox();
+    if (sampling)
+        grid->sampleSurface(sampling);
+    return grid;
+}
+
+void DistanceGrid::cellValues(int index, SReal d[8]) const
+{
+    if (!isSparse())
+    {
+        d[0] = m_dists[index          ];
+        d[1] = m_dists[index+1        ];
+        d[2] = m_dists[index  +m_nx     ];
+        d[3] = m_dists[index+1+m_nx     ];
+        d[4] = m_dists[index     +m_nxny];
+        d[5] = m_dists[index+1   +m_nxny];
+        d[6] = m_dists[index  +m_nx+m_nxny];
+        d[7] = m_dists[index+1+m_nx+m_nxny];
+        return;
+    }
+
+    const int x = index%m_nx, y = (index/m_nx)%m_ny, z = index/m_nxny;
+    constexpr int last = TileSize-1;
+    if ((x&last) != last && (y&last) != last && (z&last) != last)
+    {
+        // the cell lies in a single tile
+        const int tile = m_tiles[(x>>TileBits)+m_tnx*((y>>TileBits)+m_tny*(z>>TileBits))];
+        if (tile < 0)
+        {
+            std::fill(d, d+8, (tile == TILE_INSIDE) ? -m_bandWidth : m_bandWidth);
+            return;
+        }
+        const SReal* v = &m_tileValues[tile + tileOffset(x,y,z)];
+        d[0] = v[0];
+        d[1] = v[1];
+        d[2] = v[TileSize];
+        d[3] = v[TileSize+1];
+        d[4] = v[TileSize*TileSize];
+        d[5] = v[TileSize*TileSize+1];
+        d[6] = v[TileSize*TileSize+TileSize];
+        d[7] = v[TileSize*TileSize+TileSize+1];
+        return;
+    }
+    for (int i=0; i<8; i++)
+        d[i] = value(x+(i&1), y+((i>>1)&1), z+(i>>2));
+}
+
+void DistanceGrid::cubicValues(const Coord& p, SReal d[64], Coord& coefs) const
+{
+    const int i = index(p, coefs);
+    const int x = i%m_nx, y = (i/m_nx)%m_ny, z = i/m_nxny;
+    for (int c=0, k=0; c<4; c++)
+    {
+        const int zc = std::clamp(z+c-1, 0, m_nz-1);
+        for (int b=0; b<4; b++)
+        {
+            const int yc = std::clamp(y+b-1, 0, m_ny-1);
+            for (int a=0; a<4; a++, k++)
+                d[k] = value(std::clamp(x+a-1, 0, m_nx-1), yc, zc);
+        }
+    }
+}
+
+SReal DistanceGrid::interpCubic(const Coord& p) const
+{
+    SReal d[64];
+    Coord coefs;
+    cubicValues(p, d, coefs);
+    SReal wx[4], wy[4], wz[4];
+    catmullRomWeights(coefs[0], wx);
+    catmullRomWeights(coefs[1], wy);
+    catmullRomWeights(coefs[2], wz);
+
+    SReal r = 0;
+    for (int c=0, k=0; c<4; c++)
+        for (int b=0; b<4; b++)
+        {
+            const SReal wyz = wy[b]*wz[c];
+            for (int a=0; a<4; a++, k++)
+                r += wx[a]*wyz*d[k];
+        }
+    return r;
+}
+
+Coord DistanceGrid::gradCubic(const Coord& p) const
+{
+    SReal d[64];
+    Coord coefs;
+    cubicValues(p, d, coefs);
+    SReal wx[4], wy[4], wz[4], dwx[4], dwy[4], dwz[4];
+    catmullRomWeights(coefs[0], wx);
+    catmullRomWeights(coefs[1], wy);
+    catmullRomWeights(coefs[2], wz);
+    catmullRomDerivatives(coefs[0], dwx);
+    catmullRomDerivatives(coefs[1], dwy);
+    catmullRomDerivatives(coefs[2], dwz);
+
+    // as grad(), the result is expressed per cell
+    Coord r;
+    for (int c=0, k=0; c<4; c++)
+        for (int b=0; b<4; b++)
+            for (int a=0; a<4; a++, k++)
+            {
+                r[0] += dwx[a]* wy[b]* wz[c]*d[k];
+                r[1] +=  wx[a]*dwy[b]* wz[c]*d[k];
+                r[2] +=  wx[a]* wy[b]*dwz[c]*d[k];
+            }
+    return r;
+}
+
 /// Sample the surface with points approximately separated by the given sampling distance (expressed in voxels if the value is negative)
 void DistanceGrid::sampleSurface(double sampling)
 {
@@ -1157,7 +1887,7 @@ void DistanceGrid::sampleSurface(double sampling)
             for (int y=1; y<m_ny-1; y+=stepY)
                 for (int x=1; x<m_nx-1; x+=stepX)
                 {
-                    SReal d = m_dists[index(x,y,z)];
+                    SReal d = value(x,y,z);
                     if (rabs(d) > maxD) continue;
 
                     type::Vec3 pos = coord(x,y,z);
@@ -1178,7 +1908,7 @@ void DistanceGrid::sampleSurface(double sampling)
                     {
                         msg_warning("DistanceGrid")
                                 << "Failed to converge at ("<<x<<","<<y<<","<<z<<"):"
-                                << " pos0 = " << coord(x,y,z) << " d0 = " << m_dists[index(x,y,z)] << " grad0 = " << grad(index(x,y,z), Coord())
+                                << " pos0 = " << coord(x,y,z) << " d0 = " << value(x,y,z) << " grad0 = " << grad(index(x,y,z), Coord())
                                 << " pos = " << pos << " d = " << d << " grad = " << n;
                         continue;
                     }
@@ -1220,7 +1950,7 @@ void DistanceGrid::sampleSurface(double sampling)
                     if (it == 10 && rabs(d) > 0.1f*maxD)
                     {
                         msg_warning("DistanceGrid")<< "Failed to converge at ("<<x<<","<<y<<","<<z<<"):"
-                                << " pos0 = " << coord(x,y,z) << " d0 = " << m_dists[index(x,y,z)] << " grad0 = " << grad(index(x,y,z), Coord())
+                                << " pos0 = " << coord(x,y,z) << " d0 = " << value(x,y,z) << " grad0 = " << grad(index(x,y,z), Coord())
                                 << " pos = " << pos << " d = " << d << " grad = " << n;
                         continue;
                     }
@@ -1236,7 +1966,8 @@ void DistanceGrid::sampleSurface(double sampling)
 
 
 DistanceGrid* DistanceGrid::loadShared(const std::string& filename,
-                                       double scale, double sampling, int nx, int ny, int nz, Coord pmin, Coord pmax)
+                                       double scale, double sampling, int nx, int ny, int nz, Coord pmin, Coord pmax,
+                                       int narrowBand, const std::string& cacheDirectory)
 {
     DistanceGridParams params;
     params.filename = filename;
@@ -1247,13 +1978,14 @@ DistanceGrid* DistanceGrid::loadShared(const std::string& filename,
     params.nz = nz;
     params.pmin = pmin;
     params.pmax = pmax;
+    params.narrowBand = narrowBand;
     std::map<DistanceGridParams, DistanceGrid*>& shared = getShared();
     std::map<DistanceGridParams, DistanceGrid*>::iterator it = shared.find(params);
     if (it != shared.end())
         return it->second->addRef();
     else
     {
-        return shared[params] = load(filename, scale, sampling, nx, ny, nz, pmin, pmax);
+        return shared[params] = load(filename, scale, sampling, nx, ny, nz, pmin, pmax, narrowBand, cacheDirectory);
     }
 }
 
@@ -1263,12 +1995,12 @@ SReal DistanceGrid::quickeval(const Coord& x) const
     SReal d;
     if (inGrid(x))
     {
-        d = m_dists[index(x)] - m_cellWidth[0]; // we underestimate the distance
+        d = (*this)[index(x)] - m_cellWidth[0]; // we underestimate the distance
     }
     else
     {
         Coord xclamp = clamp(x);
-        d = m_dists[index(xclamp)] - m_cellWidth[0]; // we underestimate the distance
+        d = (*this)[index(xclamp)] - m_cellWidth[0]; // we underestimate the distance
         d = helper::rsqrt((x-xclamp).norm2() + d*d);
     }
     return d;
@@ -1296,13 +2028,13 @@ SReal DistanceGrid::quickeval2(const Coord& x) const
     SReal d2;
     if (inGrid(x))
     {
-        SReal d = m_dists[index(x)] - m_cellWidth[0]; // we underestimate the distance
+        SReal d = (*this)[index(x)] - m_cellWidth[0]; // we underestimate the distance
         d2 = d*d;
     }
     else
     {
         Coord xclamp = clamp(x);
-        SReal d = m_dists[index(xclamp)] - m_cellWidth[0]; // we underestimate the distance
+        SReal d = (*this)[index(xclamp)] - m_cellWidth[0]; // we underestimate the distance
         d2 = ((x-xclamp).norm2() + d*d);
     }
     return d2;
@@ -1310,10 +2042,12 @@ SReal DistanceGrid::quickeval2(const Coord& x) const
 
 SReal DistanceGrid::interp(int index, const Coord& coefs) const
 {
-    return interp(coefs[2],interp(coefs[1],interp(coefs[0],m_dists[index          ],m_dists[index+1        ]),
-            interp(coefs[0],m_dists[index  +m_nx     ],m_dists[index+1+m_nx     ])),
-            interp(coefs[1],interp(coefs[0],m_dists[index     +m_nxny],m_dists[index+1   +m_nxny]),
-                    interp(coefs[0],m_dists[index  +m_nx+m_nxny],m_dists[index+1+m_nx+m_nxny])));
+    SReal d[8];
+    cellValues(index, d);
+    return interp(coefs[2],interp(coefs[1],interp(coefs[0],d[0],d[1]),
+            interp(coefs[0],d[2],d[3])),
+            interp(coefs[1],interp(coefs[0],d[4],d[5]),
+                    interp(coefs[0],d[6],d[7])));
 }
 
 
@@ -1338,14 +2072,16 @@ Coord DistanceGrid::grad(int index, const Coord& coefs) const
     //           + (dist[1][1][0]-dist[0][1][0]) * (  y) * (1-z)
     //           + (dist[1][0][1]-dist[0][0][1]) * (1-y) * (  z)
     //           + (dist[1][1][1]-dist[0][1][1]) * (  y) * (  z)
-    const SReal dist000 = m_dists[index          ];
-    const SReal dist100 = m_dists[index+1        ];
-    const SReal dist010 = m_dists[index  +m_nx     ];
-    const SReal dist110 = m_dists[index+1+m_nx     ];
-    const SReal dist001 = m_dists[index     +m_nxny];
-    const SReal dist101 = m_dists[index+1   +m_nxny];
-    const SReal dist011 = m_dists[index  +m_nx+m_nxny];
-    const SReal dist111 = m_dists[index+1+m_nx+m_nxny];
+    SReal d[8];
+    cellValues(index, d);
+    const SReal dist000 = d[0];
+    const SReal dist100 = d[1];
+    const SReal dist010 = d[2];
+    const SReal dist110 = d[3];
+    const SReal dist001 = d[4];
+    const SReal dist101 = d[5];
+    const SReal dist011 = d[6];
+    const SReal dist111 = d[7];
     return Coord(
             interp(coefs[2],interp(coefs[1],dist100-dist000,dist110-dist010),interp(coefs[1],dist101-dist001,dist111-dist011)), //*invCellWidth[0],
             interp(coefs[2],interp(coefs[0],dist010-dist000,dist110-dist100),interp(coefs[0],dist011-dist001,dist111-dist101)), //*invCellWidth[1],
@@ -1389,6 +2125,7 @@ bool DistanceGrid::DistanceGridParams::operator==(const DistanceGridParams& v) c
     if (!(pmax[0]  == v.pmax[0] )) return false;
     if (!(pmax[1]  == v.pmax[1] )) return false;
     if (!(pmax[2]  == v.pmax[2] )) return false;
+    if (!(narrowBand == v.narrowBand)) return false;
     return true;
 }
 
@@ -1418,6 +2155,8 @@ bool DistanceGrid::DistanceGridParams::operator<(const DistanceGridParams& v) co
     if (pmax[1]  > v.pmax[1] ) return true;
     if (pmax[2]  < v.pmax[2] ) return false;
     if (pmax[2]  > v.pmax[2] ) return true;
+    if (narrowBand < v.narrowBand) return false;
+    if (narrowBand > v.narrowBand) return true;
     return false;
 }
 
@@ -1447,6 +2186,8 @@ bool DistanceGrid::DistanceGridParams::operator>(const DistanceGridParams& v) co
     if (pmax[1]  < v.pmax[1] ) return true;
     if (pmax[2]  > v.pmax[2] ) return false;
     if (pmax[2]  < v.pmax[2] ) return true;
+    if (narrowBand > v.narrowBand) return false;
+    if (narrowBand < v.narrowBand) return true;
     return false;
 }
 
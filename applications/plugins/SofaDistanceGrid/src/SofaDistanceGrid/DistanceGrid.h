@@ -60,25 +60,42 @@ public:
     typedef type::vector<SReal> VecSReal;
     typedef type::vector<Coord> VecCoord;
 
-    DistanceGrid(int m_nx, int m_ny, int m_nz, Coord m_pmin, Coord m_pmax);
+    /// Sparse grids are made of tiles of TileSize^3 voxels
+    static constexpr int TileBits = 3;
+    static constexpr int TileSize = 1 << TileBits;
+    static constexpr int TileVoxels = TileSize * TileSize * TileSize;
+
+    /// Create a grid of the given resolution. If narrowBand is not zero, no dense storage is
+    /// allocated: the distances are only stored in the tiles lying within narrowBand voxels of the
+    /// surface, and are clamped to this band everywhere else.
+    DistanceGrid(int m_nx, int m_ny, int m_nz, Coord m_pmin, Coord m_pmax, int narrowBand=0);
 
     ~DistanceGrid();
 
 public:
     /// Load a distance grid
+    /// If narrowBand is not zero, the grid is sparse (see the constructor). Sparse grids built from
+    /// a mesh are cached in cacheDirectory (if not empty), in a file named after the hash of the mesh
+    /// and of the grid parameters.
     static DistanceGrid* load(const std::string& filename,
                               double scale=1.0, double sampling=0.0,
                               int m_nx=64, int m_ny=64, int m_nz=64,
-                              Coord m_pmin = Coord(), Coord m_pmax = Coord());
+                              Coord m_pmin = Coord(), Coord m_pmax = Coord(),
+                              int narrowBand=0, const std::string& cacheDirectory="");
 
     static DistanceGrid* loadVTKFile(const std::string& filename,
                                      double scale=1.0, double sampling=0.0);
 
+    /// Load a sparse grid saved in the .sdf format
+    static DistanceGrid* loadSparseFile(const std::string& filename,
+                                        double scale=1.0, double sampling=0.0);
+
     /// Load or reuse a distance grid
     static DistanceGrid* loadShared(const std::string& filename,
                                     double scale=1.0, double sampling=0.0,
                                     int m_nx=64, int m_ny=64, int m_nz=64,
-                                    Coord m_pmin = Coord(), Coord m_pmax = Coord());
+                                    Coord m_pmin = Coord(), Coord m_pmax = Coord(),
+                                    int narrowBand=0, const std::string& cacheDirectory="");
 
     /// Add one reference to this grid. Note that loadShared already does this.
     DistanceGrid* addRef();
@@ -86,12 +103,20 @@ public:
     /// Release one reference, deleting this grid if this is the last
     bool release();
 
-    /// Save current grid
+    /// Save current grid (.raw for all grids, .sdf for sparse grids)
     bool save(const std::string& filename);
 
     /// Compute distance field from given mesh
     void calcDistance(Mesh* mesh, double scale=1.0);
 
+    /// Convert a dense grid to sparse storage, keeping only the tiles within narrowBand voxels of the surface
+    void makeSparse(int narrowBand);
+
+    /// Hash of a mesh and of the parameters used to compute a distance grid from it, used to name cache files
+    static std::string computeMeshHash(const Mesh* mesh, double scale,
+                                       int m_nx, int m_ny, int m_nz,
+                                       const Coord& m_pmin, const Coord& m_pmax, int narrowBand);
+
     /// Compute distance field for a cube of the given half-size.
     /// Also create a mesh of points using np points per axis
     void calcCubeDistance(SReal dim=1, int np=5);
@@ -110,6 +135,12 @@ public:
 
     inline int size() const { return m_nxnynz; }
 
+    inline bool isSparse() const { return m_bandWidth != 0; }
+    /// Half-width of the narrow band of a sparse grid, outside of which distances are clamped
+    inline SReal getBandWidth() const { return m_bandWidth; }
+    /// Number of tiles storing distances in a sparse grid
+    inline int getNbTiles() const { return int(m_tileValues.size() / TileVoxels); }
+
     inline const Coord& getBBMin() const { return m_bbmin; }
     inline const Coord& getBBMax() const { return m_bbmax; }
     inline void setBBMin(const Coord& val) { m_bbmin = val; }
@@ -183,8 +214,19 @@ public:
         return m_pmin+Coord(x*m_cellWidth[0], y*m_cellWidth[1], z*m_cellWidth[2]);
     }
 
-    SReal operator[](int index) const { return m_dists[index]; }
-    SReal& operator[](int index) { return m_dists[index]; }
+    SReal operator[](int index) const
+    {
+        if (!isSparse()) return m_dists[index];
+        return value(index%m_nx, (index/m_nx)%m_ny, index/m_nxny);
+    }
+
+    SReal value(int x, int y, int z) const
+    {
+        if (!isSparse()) return m_dists[x+m_nx*(y+m_ny*(z))];
+        const int tile = m_tiles[(x>>TileBits)+m_tnx*((y>>TileBits)+m_tny*(z>>TileBits))];
+        if (tile < 0) return (tile == TILE_INSIDE) ? -m_bandWidth : m_bandWidth;
+        return m_tileValues[tile + tileOffset(x,y,z)];
+    }
 
     static SReal interp(SReal coef, SReal a, SReal b)
     {
@@ -195,6 +237,9 @@ public:
     SReal interp(const Coord& p) const ;
     Coord grad(int index, const Coord& coefs) const ;
     Coord grad(const Coord& p) const ;
+    /// Tricubic (Catmull-Rom) interpolation, smoother than interp() but reading 64 voxels instead of 8
+    SReal interpCubic(const Coord& p) const ;
+    Coord gradCubic(const Coord& p) const ;
     SReal eval(const Coord& x) const ;
     SReal quickeval(const Coord& x) const ;
     SReal eval2(const Coord& x) const ;
@@ -232,6 +277,27 @@ protected:
 
     SReal m_cubeDim; ///< Cube dimension (!=0 if this is actually a cube
 
+    /// Sparse storage
+    enum TileStatus { TILE_OUTSIDE = -1, TILE_INSIDE = -2 };
+    SReal m_bandWidth; ///< half-width of the narrow band (0 if the grid is dense)
+    int m_tnx, m_tny, m_tnz; ///< number of tiles on each axis
+    type::vector<int> m_tiles; ///< offset of each tile in m_tileValues, or its TileStatus if it is not stored
+    VecSReal m_tileValues;
+
+    static int tileOffset(int x, int y, int z)
+    {
+        return (x&(TileSize-1)) + TileSize*((y&(TileSize-1)) + TileSize*(z&(TileSize-1)));
+    }
+
+    void initTiles(SReal bandWidth);
+    void calcSparseDistance(Mesh* mesh, double scale);
+    bool saveSparseFile(const std::string& filename) const;
+
+    /// Values at the 8 corners of the cell starting at the given index
+    void cellValues(int index, SReal d[8]) const;
+    /// Values at the 4x4x4 voxels around the cell containing p, for tricubic interpolation
+    void cubicValues(const Coord& p, SReal d[64], Coord& coefs) const;
+
     /// Fast Marching Method Update
     enum Status { FMM_FRONT0 = 0, FMM_FAR = -1, FMM_KNOWN_OUT = -2, FMM_KNOWN_IN = -3 };
     type::vector<int> m_fmm_status;
@@ -250,6 +316,7 @@ protected:
         double sampling;
         int nx,ny,nz;
         Coord pmin,pmax;
+        int narrowBand;
         bool operator==(const DistanceGridParams& v) const ;
         bool operator<(const DistanceGridParams& v) const ;
         bool operator>(const DistanceGridParams& v) const ;
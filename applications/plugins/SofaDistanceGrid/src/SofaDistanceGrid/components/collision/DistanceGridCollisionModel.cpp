@@ -27,6 +27,8 @@
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/helper/Factory.inl>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/TaskScheduler.h>
 #include <sofa/component/collision/geometry/CubeModel.h>
 #include <sofa/component/collision/response/mapper/BarycentricContactMapper.inl>
 #include <sofa/component/collision/response/mapper/RigidContactMapper.inl>
@@ -79,6 +81,9 @@ RigidDistanceGridCollisionModel::RigidDistanceGridCollisionModel()
     , nx( initData( &nx, 64, "nx", "number of values on X axis") )
     , ny( initData( &ny, 64, "ny", "number of values on Y axis") )
     , nz( initData( &nz, 64, "nz", "number of values on Z axis") )
+    , narrowBand( initData( &narrowBand, 0, "narrowBand", "if not zero: store the distances only within this number of voxels around the surface, in sparse tiles instead of a dense grid") )
+    , cacheDirectory( initData( &cacheDirectory, "cacheDirectory", "if not empty: directory where the sparse distance fields computed from meshes are cached") )
+    , parallelSparseDistance( initData( &parallelSparseDistance, false, "parallelSparseDistance", "if true: compute the sparse distance fields from meshes in parallel over the tiles, initializing the task scheduler if needed") )
     , dumpfilename( initData( &dumpfilename, "dumpfilename","write distance grid to specified file"))
     , usePoints( initData( &usePoints, true, "usePoints", "use mesh vertices for collision detection"))
     , flipNormals( initData( &flipNormals, false, "flipNormals", "reverse surface direction, i.e. points are considered in collision if they move outside of the object instead of inside"))
@@ -119,7 +124,20 @@ void RigidDistanceGridCollisionModel::init()
     if (sampling.getValue()!=0.0) msg_info()<<" sampling="<<sampling.getValue();
     if (box.getValue()[0][0]<box.getValue()[1][0]) msg_info()<<" bbox=<"<<box.getValue()[0]<<">-<"<<box.getValue()[0]<<">";
 
-    grid = DistanceGrid::loadShared(fileRigidDistanceGrid.getFullPath(), scale.getValue(), sampling.getValue(), nx.getValue(),ny.getValue(),nz.getValue(),box.getValue()[0],box.getValue()[1]);
+    if (narrowBand.getValue()!=0) msg_info()<<" narrowBand="<<narrowBand.getValue();
+
+    if (parallelSparseDistance.getValue())
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
+
+    grid = DistanceGrid::loadShared(fileRigidDistanceGrid.getFullPath(), scale.getValue(), sampling.getValue(), nx.getValue(),ny.getValue(),nz.getValue(),box.getValue()[0],box.getValue()[1],
+                                    narrowBand.getValue(), cacheDirectory.getValue());
     if (grid->getNx() != this->nx.getValue())
         this->nx.setValue(grid->getNx());
     if (grid->getNy() != this->ny.getValue())
@@ -441,6 +459,9 @@ FFDDistanceGridCollisionModel::FFDDistanceGridCollisionModel()
     , nx( initData( &nx, 64, "nx", "number of values on X axis") )
     , ny( initData( &ny, 64, "ny", "number of values on Y axis") )
     , nz( initData( &nz, 64, "nz", "number of values on Z axis") )
+    , narrowBand( initData( &narrowBand, 0, "narrowBand", "if not zero: store the distances only within this number of voxels around the surface, in sparse tiles instead of a dense grid") )
+    , cacheDirectory( initData( &cacheDirectory, "cacheDirectory", "if not empty: directory where the sparse distance fields computed from meshes are cached") )
+    , parallelSparseDistance( initData( &parallelSparseDistance, false, "parallelSparseDistance", "if true: compute the sparse distance fields from meshes in parallel over the tiles, initializing the task scheduler if needed") )
     , dumpfilename( initData( &dumpfilename, "dumpfilename","write distance grid to specified file"))
     , usePoints( initData( &usePoints, true, "usePoints", "use mesh vertices for collision detection"))
     , singleContact( initData( &singleContact, false, "singleContact", "keep only the deepest contact in each cell"))
@@ -482,7 +503,20 @@ void FFDDistanceGridCollisionModel::init()
     if (sampling.getValue()!=0.0) msg_info()<<" sampling="<<sampling.getValue();
     if (box.getValue()[0][0]<box.getValue()[1][0]) msg_info()<<" bbox=<"<<box.getValue()[0]<<">-<"<<box.getValue()[0]<<">";
 
-    grid = DistanceGrid::loadShared(fileFFDDistanceGrid.getFullPath(), scale.getValue(), sampling.getValue(), nx.getValue(),ny.getValue(),nz.getValue(),box.getValue()[0],box.getValue()[1]);
+    if (narrowBand.getValue()!=0) msg_info()<<" narrowBand="<<narrowBand.getValue();
+
+    if (parallelSparseDistance.getValue())
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
+
+    grid = DistanceGrid::loadShared(fileFFDDistanceGrid.getFullPath(), scale.getValue(), sampling.getValue(), nx.getValue(),ny.getValue(),nz.getValue(),box.getValue()[0],box.getValue()[1],
+                                    narrowBand.getValue(), cacheDirectory.getValue());
     if (!dumpfilename.getValue().empty())
     {
         msg_info() << "Dump grid to "<<dumpfilename.getValue();
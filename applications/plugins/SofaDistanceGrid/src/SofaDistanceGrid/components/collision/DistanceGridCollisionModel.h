@@ -133,6 +133,9 @@ public:
     Data< int > nx; ///< number of values on X axis
     Data< int > ny; ///< number of values on Y axis
     Data< int > nz; ///< number of values on Z axis
+    Data< int > narrowBand; ///< if not zero: store the distances only within this number of voxels around the surface, in sparse tiles instead of a dense grid
+    Data< std::string > cacheDirectory; ///< if not empty: directory where the sparse distance fields computed from meshes are cached
+    Data< bool > parallelSparseDistance; ///< if true: compute the sparse distance fields from meshes in parallel over the tiles, initializing the task scheduler if needed
     sofa::core::objectmodel::DataFileName dumpfilename;
 
     Data< bool > usePoints; ///< use mesh vertices for collision detection
@@ -435,6 +438,9 @@ protected:
     Data< int > nx; ///< number of values on X axis
     Data< int > ny; ///< number of values on Y axis
     Data< int > nz; ///< number of values on Z axis
+    Data< int > narrowBand; ///< if not zero: store the distances only within this number of voxels around the surface, in sparse tiles instead of a dense grid
+    Data< std::string > cacheDirectory; ///< if not empty: directory where the sparse distance fields computed from meshes are cached
+    Data< bool > parallelSparseDistance; ///< if true: compute the sparse distance fields from meshes in parallel over the tiles, initializing the task scheduler if needed
     sofa::core::objectmodel::DataFileName dumpfilename;
 
     core::behavior::MechanicalState<defaulttype::Vec3Types>* ffd;
@@ -150,6 +150,9 @@ public:
     Data< int > nx; ///< number of values on X axis
     Data< int > ny; ///< number of values on Y axis
     Data< int > nz; ///< number of values on Z axis
+    Data< int > narrowBand; ///< if not zero: store the distances only within this number of voxels around the surface, in sparse tiles instead of a dense grid (the band should be wider than maxdist)
+    Data< std::string > cacheDirectory; ///< if not empty: directory where the sparse distance fields computed from meshes are cached
+    Data< bool > parallelSparseDistance; ///< if true: compute the sparse distance fields from meshes in parallel over the tiles, initializing the task scheduler if needed
 
     Data<Real> stiffnessIn; ///< force stiffness when inside of the object
     Data<Real> stiffnessOut; ///< force stiffness when outside of the object
@@ -177,6 +180,9 @@ protected:
         , nx( initData( &nx, 64, "nx", "number of values on X axis") )
         , ny( initData( &ny, 64, "ny", "number of values on Y axis") )
         , nz( initData( &nz, 64, "nz", "number of values on Z axis") )
+        , narrowBand( initData( &narrowBand, 0, "narrowBand", "if not zero: store the distances only within this number of voxels around the surface, in sparse tiles instead of a dense grid (the band should be wider than maxdist)") )
+        , cacheDirectory( initData( &cacheDirectory, "cacheDirectory", "if not empty: directory where the sparse distance fields computed from meshes are cached") )
+        , parallelSparseDistance( initData( &parallelSparseDistance, false, "parallelSparseDistance", "if true: compute the sparse distance fields from meshes in parallel over the tiles, initializing the task scheduler if needed") )
         , stiffnessIn(initData(&stiffnessIn, (Real)500, "stiffnessIn", "force stiffness when inside of the object"))
         , stiffnessOut(initData(&stiffnessOut, (Real)0, "stiffnessOut", "force stiffness when outside of the object"))
         , damping(initData(&damping, (Real)0.01, "damping", "force damping coefficient"))
@@ -30,6 +30,8 @@
 #include <iostream>
 
 #include <sofa/core/behavior/MultiMatrixAccessor.h>
+#include <sofa/simulation/MainTaskSchedulerFactory.h>
+#include <sofa/simulation/TaskScheduler.h>
 
 
 namespace sofa
@@ -63,9 +65,22 @@ void DistanceGridForceField<DataTypes>::init()
     msg_info_when(box.getValue()[0][0]<box.getValue()[1][0])
             <<" bbox=<"<<box.getValue()[0]<<">-<"<<box.getValue()[0]<<">";
 
+    msg_info_when(narrowBand.getValue()!=0) << " narrowBand="<<narrowBand.getValue();
+
+    if (parallelSparseDistance.getValue())
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::MainTaskSchedulerFactory::createInRegistry();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
+
     grid = DistanceGrid::loadShared(fileDistanceGrid.getFullPath(), scale.getValue(), 0.0,
                                     nx.getValue(),ny.getValue(),nz.getValue(),
-                                    box.getValue()[0],box.getValue()[1]);
+                                    box.getValue()[0],box.getValue()[1],
+                                    narrowBand.getValue(), cacheDirectory.getValue());
 
     if (grid == nullptr)
     {